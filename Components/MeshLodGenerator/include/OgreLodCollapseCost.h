@@ -33,6 +33,8 @@
 #include "OgreLodPrerequisites.h"
 #include "OgreLodData.h"
 
+#include <functional>
+
 namespace Ogre
 {
 /** \addtogroup Optional
@@ -60,6 +62,17 @@ public:
     /// Set true to prevent collapsing edges that would result in the destruction of a line.
     void setPreventBreakingLines(bool prevent) { mPreventBreakingLines = prevent; }
 protected:
+    /** Whether computeVertexCollapseCost may run for several vertices at once.
+
+        If so, initCollapseCosts computes the initial costs in parallel on the WorkQueue,
+        without calling initVertexCollapseCost. computeEdgeCollapseCost must then only read
+        the LodData and the state of the cost calculator.
+    */
+    virtual bool isThreadSafe() const { return false; }
+
+    /// Runs task for all indices below count, in parallel on the WorkQueue if there is one.
+    static void processParallel(size_t count, const std::function<void(size_t)>& task);
+
     // Helper functions:
     bool isBorderVertex(const LodData::Vertex* vertex) const;
 private:
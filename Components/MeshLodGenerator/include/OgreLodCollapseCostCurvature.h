@@ -42,6 +42,8 @@ class _OgreLodExport LodCollapseCostCurvature :
 {
 public:
     Real computeEdgeCollapseCost(LodData* data, LodData::Vertex* src, LodData::Edge* dstEdge) override;
+protected:
+    bool isThreadSafe() const override { return true; }
 };
 
 }
@@ -47,6 +47,7 @@ public:
     void updateVertexCollapseCost(LodData* data, LodData::Vertex* vertex) override;
     Real computeEdgeCollapseCost(LodData* data, LodData::Vertex* src, LodData::Edge* dstEdge) override;
 protected:
+    bool isThreadSafe() const override { return true; }
 
     struct TriangleQuadricPlane {
         Matrix4 quadric;
@@ -68,7 +68,7 @@ struct _OgreLodExport LodData {
     typedef std::vector<Line> LineList;
     typedef std::vector<Triangle> TriangleList;
     typedef std::unordered_set<Vertex*, VertexHash, VertexEqual> UniqueVertexSet;
-    typedef std::multimap<Real, Vertex*> CollapseCostHeap;
+    class CollapseCostHeap;
 
     typedef VectorSet<Edge, 8> VEdges;
     typedef VectorSet<Line*, 7> VLines;
@@ -110,12 +110,67 @@ struct _OgreLodExport LodData {
         
         Vertex* collapseTo;
         bool seam;
-        CollapseCostHeap::iterator costHeapPosition; /// Iterator pointing to the position in the mCollapseCostSet, which allows fast remove.
+        size_t costHeapPosition; /// Index in the mCollapseCostHeap or CollapseCostHeap::NOT_IN_HEAP, which allows fast remove.
 
         void addEdge(const Edge& edge);
         void removeEdge(const Edge& edge);
     };
 
+    /** Binary min heap of the vertices ordered by their collapse cost.
+
+        Every vertex knows its position in the heap, so it can be removed or get a new cost
+        without a search. Vertices with equal costs are ordered by the time they were pushed.
+    */
+    class _OgreLodExport CollapseCostHeap {
+    public:
+        /// Vertex::costHeapPosition of vertices not in the heap.
+        static const size_t NOT_IN_HEAP = ~size_t(0);
+
+        struct Entry {
+            Real cost;
+            uint64 order; /// Tie breaker, increasing with every push.
+            Vertex* vertex;
+        };
+        typedef std::vector<Entry>::const_iterator const_iterator;
+
+        CollapseCostHeap() : mNextOrder(0) {}
+
+        size_t size() const { return mEntries.size(); }
+        bool empty() const { return mEntries.empty(); }
+        void reserve(size_t count) { mEntries.reserve(count); }
+        /// Empties the heap, leaving Vertex::costHeapPosition of the former members as it is.
+        void clear() { mEntries.clear(); }
+
+        /// The entry of the cheapest vertex to collapse. Must not be called on an empty heap.
+        const Entry& top() const { return mEntries.front(); }
+        bool contains(const Vertex* v) const { return v->costHeapPosition != NOT_IN_HEAP; }
+        Real getCost(const Vertex* v) const { return mEntries[v->costHeapPosition].cost; }
+
+        /// Adds a vertex, which must not be in the heap yet.
+        void push(Vertex* v, Real cost);
+        /// Removes a vertex, if it is in the heap.
+        void erase(Vertex* v);
+
+        /// Iterates in heap order, which is not sorted.
+        const_iterator begin() const { return mEntries.begin(); }
+        const_iterator end() const { return mEntries.end(); }
+    private:
+        static bool less(const Entry& a, const Entry& b)
+        {
+            return a.cost < b.cost || (a.cost == b.cost && a.order < b.order);
+        }
+        void place(size_t pos, const Entry& e)
+        {
+            mEntries[pos] = e;
+            e.vertex->costHeapPosition = pos;
+        }
+        void siftUp(size_t pos, const Entry& e);
+        void siftDown(size_t pos, const Entry& e);
+
+        std::vector<Entry> mEntries;
+        uint64 mNextOrder;
+    };
+
     struct Line {
         Vertex* vertex[2];
         bool isRemoved;
@@ -77,6 +77,40 @@ public:
      */
     void generateAutoconfiguredLodLevels(MeshPtr& mesh);
 
+    /**
+     * @brief Generates the Lod levels for several meshes concurrently.
+     *
+     * Every mesh is reduced as a separate WorkQueue task using the buffer based input and output providers.
+     * At most WorkQueue::getWorkerThreadCount() meshes are in flight at once and, if a memory budget is given,
+     * only as many as fit into it (a single mesh exceeding the budget is still processed on its own).
+     * The generated Lod levels are injected into the meshes on the calling thread as soon as each mesh is done,
+     * so this must be called from the main thread. Returns when all meshes are finished.
+     *
+     * @param lodConfigs One configuration per mesh. The output fields of the levels are filled in.
+     *     LodConfig::Advanced::useBackgroundQueue is ignored.
+     * @param memoryBudget Upper bound in bytes for the estimated working set of the meshes in flight. 0 means no limit.
+     */
+    void generateBatchLodLevels(std::vector<LodConfig>& lodConfigs, size_t memoryBudget = 0);
+
+    /// Fills in the configuration of the next mesh of a batch, returns false if there is none left.
+    typedef std::function<bool(LodConfig&)> LodConfigSource;
+    /// Receives a mesh of a batch once its Lod levels are injected, along with its index in the order of the source.
+    typedef std::function<void(size_t, LodConfig&)> LodConfigSink;
+
+    /**
+     * @brief Generates the Lod levels for meshes which are provided one by one.
+     *
+     * Works like the overload taking a list, but only asks for the next mesh when it can be started. So the meshes
+     * can be loaded as they are needed and released once they are finished, and no more than the meshes in flight
+     * plus one are held at a time.
+     *
+     * @param source Called on the calling thread for the configuration of the next mesh.
+     * @param finished Called on the calling thread for every mesh that is done. The output fields of the levels are
+     *     filled in.
+     * @param memoryBudget Upper bound in bytes for the estimated working set of the meshes in flight. 0 means no limit.
+     */
+    void generateBatchLodLevels(const LodConfigSource& source, const LodConfigSink& finished, size_t memoryBudget = 0);
+
     /**
      * @brief Fills Lod Config with a config, which works on any mesh.
      *
@@ -30,12 +30,59 @@
 
 namespace Ogre
 {
+    namespace
+    {
+        /// vertices per task when computing the initial collapse costs
+        const size_t VERTICES_PER_TASK = 1024;
+    }
+
+    void LodCollapseCost::processParallel(size_t count, const std::function<void(size_t)>& task)
+    {
+        WorkQueue* queue = Root::getSingletonPtr() ? Root::getSingleton().getWorkQueue() : NULL;
+        if (queue && count > 1)
+        {
+            queue->processTasksParallel(count, task);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                task(i);
+        }
+    }
+
     void LodCollapseCost::initCollapseCosts( LodData* data )
     {
         data->mCollapseCostHeap.clear();
-        for (auto& v : data->mVertexList) {
+        data->mCollapseCostHeap.reserve(data->mVertexList.size());
+
+        // The costs do not depend on each other, only the heap has to be filled in order.
+        std::vector<Real> costs;
+        std::vector<LodData::Vertex*> collapseTo;
+        bool parallel = isThreadSafe();
+        if (parallel) {
+            size_t numVertices = data->mVertexList.size();
+            costs.resize(numVertices, LodData::UNINITIALIZED_COLLAPSE_COST);
+            collapseTo.resize(numVertices, NULL);
+            processParallel((numVertices + VERTICES_PER_TASK - 1) / VERTICES_PER_TASK, [&](size_t task) {
+                size_t end = std::min(numVertices, (task + 1) * VERTICES_PER_TASK);
+                for (size_t i = task * VERTICES_PER_TASK; i < end; ++i) {
+                    LodData::Vertex* v = &data->mVertexList[i];
+                    if (!v->edges.empty())
+                        computeVertexCollapseCost(data, v, costs[i], collapseTo[i]);
+                }
+            });
+        }
+
+        for (size_t i = 0; i < data->mVertexList.size(); ++i) {
+            LodData::Vertex& v = data->mVertexList[i];
+            v.costHeapPosition = LodData::CollapseCostHeap::NOT_IN_HEAP;
             if (!v.edges.empty()) {
-                initVertexCollapseCost(data, &v);
+                if (parallel) {
+                    v.collapseTo = collapseTo[i];
+                    data->mCollapseCostHeap.push(&v, costs[i]);
+                } else {
+                    initVertexCollapseCost(data, &v);
+                }
             } else {
 #if OGRE_DEBUG_MODE
                 LogManager::getSingleton().stream() << "In " << data->mMeshName << " never used vertex found with ID: " << data->mCollapseCostHeap.size() << ". "
@@ -118,7 +165,7 @@ namespace Ogre
         computeVertexCollapseCost(data, vertex, collapseCost, collapseTo);
 
         vertex->collapseTo = collapseTo;
-        vertex->costHeapPosition = data->mCollapseCostHeap.emplace(collapseCost, vertex);
+        data->mCollapseCostHeap.push(vertex, collapseCost);
     }
 
     void LodCollapseCost::updateVertexCollapseCost( LodData* data, LodData::Vertex* vertex )
@@ -127,16 +174,16 @@ namespace Ogre
         LodData::Vertex* collapseTo = NULL;
         computeVertexCollapseCost(data, vertex, collapseCost, collapseTo);
 
-        if (vertex->collapseTo != collapseTo || collapseCost != vertex->costHeapPosition->first) {
-            OgreAssert(vertex->costHeapPosition != data->mCollapseCostHeap.end(), "");
-            data->mCollapseCostHeap.erase(vertex->costHeapPosition);
+        OgreAssert(data->mCollapseCostHeap.contains(vertex), "");
+        if (vertex->collapseTo != collapseTo || collapseCost != data->mCollapseCostHeap.getCost(vertex)) {
+            // Pushed again, it goes after the vertices which already have the new cost.
+            data->mCollapseCostHeap.erase(vertex);
             if (collapseCost != LodData::UNINITIALIZED_COLLAPSE_COST) {
                 vertex->collapseTo = collapseTo;
-                vertex->costHeapPosition = data->mCollapseCostHeap.emplace(collapseCost, vertex);
+                data->mCollapseCostHeap.push(vertex, collapseCost);
             } else {
 #if OGRE_DEBUG_MODE
                 vertex->collapseTo = NULL;
-                vertex->costHeapPosition = data->mCollapseCostHeap.end();
 #endif
             }
         }
@@ -40,14 +40,23 @@ namespace Ogre
 
     void LodCollapseCostQuadric::initCollapseCosts( LodData* data )
     {
-        mTrianglePlaneQuadricList.resize(data->mTriangleList.size());
-        for(size_t i=0;i<mTrianglePlaneQuadricList.size();i++){
-            computeTrianglePlaneQuadric(data, i);
-        }
-        mVertexQuadricList.resize(data->mVertexList.size());
-        for (size_t i=0;i<mVertexQuadricList.size();i++) {
-            computeVertexQuadric(data, i);
-        }
+        const size_t blockSize = 4096;
+        size_t numTriangles = data->mTriangleList.size();
+        mTrianglePlaneQuadricList.resize(numTriangles);
+        processParallel((numTriangles + blockSize - 1) / blockSize, [&](size_t block) {
+            size_t end = std::min(numTriangles, (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++) {
+                computeTrianglePlaneQuadric(data, i);
+            }
+        });
+        size_t numVertices = data->mVertexList.size();
+        mVertexQuadricList.resize(numVertices);
+        processParallel((numVertices + blockSize - 1) / blockSize, [&](size_t block) {
+            size_t end = std::min(numVertices, (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++) {
+                computeVertexQuadric(data, i);
+            }
+        });
         LodCollapseCost::initCollapseCosts(data);
     }
 
@@ -32,6 +32,7 @@ namespace Ogre
 // Use float limits instead of Real limits, because LodConfigSerializer may convert them to float.
 const Real LodData::NEVER_COLLAPSE_COST = std::numeric_limits<float>::max();
 const Real LodData::UNINITIALIZED_COLLAPSE_COST = std::numeric_limits<float>::infinity();
+const size_t LodData::CollapseCostHeap::NOT_IN_HEAP;
 
 void LodData::Vertex::addEdge( const LodData::Edge& edge )
 {
@@ -55,6 +56,67 @@ void LodData::Vertex::removeEdge( const LodData::Edge& edge )
     }
 }
 
+void LodData::CollapseCostHeap::push( Vertex* v, Real cost )
+{
+    OgreAssertDbg(!contains(v), "Vertex is already in the heap");
+    Entry e = {cost, mNextOrder++, v};
+    mEntries.push_back(e);
+    siftUp(mEntries.size() - 1, e);
+}
+
+void LodData::CollapseCostHeap::erase( Vertex* v )
+{
+    size_t pos = v->costHeapPosition;
+    if (pos == NOT_IN_HEAP) {
+        return;
+    }
+    v->costHeapPosition = NOT_IN_HEAP;
+    Entry last = mEntries.back();
+    mEntries.pop_back();
+    if (pos == mEntries.size()) {
+        return;
+    }
+    // Move the last entry into the hole, towards whichever side it belongs.
+    if (pos > 0 && less(last, mEntries[(pos - 1) / 2])) {
+        siftUp(pos, last);
+    } else {
+        siftDown(pos, last);
+    }
+}
+
+void LodData::CollapseCostHeap::siftUp( size_t pos, const Entry& e )
+{
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!less(e, mEntries[parent])) {
+            break;
+        }
+        place(pos, mEntries[parent]);
+        pos = parent;
+    }
+    place(pos, e);
+}
+
+void LodData::CollapseCostHeap::siftDown( size_t pos, const Entry& e )
+{
+    size_t count = mEntries.size();
+    for (;;) {
+        size_t child = 2 * pos + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && less(mEntries[child + 1], mEntries[child])) {
+            child++;
+        }
+        if (!less(mEntries[child], e)) {
+            break;
+        }
+        place(pos, mEntries[child]);
+        pos = child;
+    }
+    place(pos, e);
+}
+
 bool LodData::VertexEqual::operator() (const LodData::Vertex* lhs, const LodData::Vertex* rhs) const
 {
     return lhs->position == rhs->position;
@@ -26,6 +26,8 @@
  * -----------------------------------------------------------------------------
  */
 
+#include <atomic>
+#include <exception>
 #include <memory>
 
 #include "OgreMeshLodPrecompiledHeaders.h"
@@ -217,6 +219,198 @@ void MeshLodGenerator::generateLodLevels(LodConfig& lodConfig,
     }
 }
 
+namespace
+{
+    /// Rough upper bound of the memory needed to reduce a mesh with the buffer providers.
+    size_t estimateLodMemory(const LodConfig& lodConfig)
+    {
+        const MeshPtr& mesh = lodConfig.mesh;
+        size_t vertexCount = mesh->sharedVertexData ? mesh->sharedVertexData->vertexCount : 0;
+        size_t indexCount = 0;
+        for(auto *submesh : mesh->getSubMeshes()) {
+            if(!submesh->useSharedVertices && submesh->vertexData) {
+                vertexCount += submesh->vertexData->vertexCount;
+            }
+            indexCount += submesh->indexData->indexCount;
+        }
+        // Input copy (position + normal), LodData representation and one index buffer per level.
+        return vertexCount * (2 * sizeof(Vector3f) + sizeof(LodData::Vertex)) +
+               indexCount / 3 * sizeof(LodData::Triangle) +
+               indexCount * sizeof(uint32) * (lodConfig.levels.size() + 1);
+    }
+
+    struct LodBatchJob {
+        LodWorkQueueRequest request;
+        size_t memory;
+        std::atomic<bool> started;
+        std::atomic<bool> done;
+        std::exception_ptr error;
+    };
+    typedef std::shared_ptr<LodBatchJob> LodBatchJobPtr;
+
+    /// Lets the calling thread sleep until a worker finishes a mesh.
+    struct LodBatchSync {
+        OGRE_WQ_MUTEX(mutex);
+        OGRE_WQ_THREAD_SYNCHRONISER(jobDone);
+        /// Number of finished meshes, guarded by the mutex.
+        size_t doneCount;
+
+        LodBatchSync() : doneCount(0) {}
+    };
+}
+
+void MeshLodGenerator::generateBatchLodLevels(std::vector<LodConfig>& lodConfigs, size_t memoryBudget)
+{
+    size_t next = 0;
+    generateBatchLodLevels(
+        [&lodConfigs, &next](LodConfig& lodConfig) {
+            if(next == lodConfigs.size()) {
+                return false;
+            }
+            lodConfig = lodConfigs[next++];
+            return true;
+        },
+        [&lodConfigs](size_t index, LodConfig& lodConfig) { lodConfigs[index].levels = lodConfig.levels; },
+        memoryBudget);
+}
+
+void MeshLodGenerator::generateBatchLodLevels(const LodConfigSource& source, const LodConfigSink& finished,
+                                              size_t memoryBudget)
+{
+    WorkQueue* queue = Root::getSingleton().getWorkQueue();
+    size_t maxJobs = std::max<size_t>(1, queue->getWorkerThreadCount());
+    std::shared_ptr<LodBatchSync> sync = std::make_shared<LodBatchSync>();
+
+    // Runs on a worker or, if no worker picked it up yet, on the calling thread.
+    auto runJob = [this, sync](const LodBatchJobPtr& job) {
+        if(job->started.exchange(true)) {
+            return;
+        }
+        LodWorkQueueRequest& req = job->request;
+        try {
+            _process(req.config, req.cost.get(), req.data.get(), req.input.get(), req.output.get(), req.collapser.get());
+        } catch(...) {
+            job->error = std::current_exception();
+        }
+        job->done = true;
+        {
+            OGRE_WQ_LOCK_MUTEX(sync->mutex);
+            sync->doneCount++;
+        }
+        OGRE_THREAD_NOTIFY_ALL(sync->jobDone);
+    };
+
+    // The meshes in flight, with their index in the order of the source.
+    std::vector<std::pair<size_t, LodBatchJobPtr>> jobs;
+    LodConfig pending;
+    bool hasPending = false, sourceEmpty = false;
+    size_t count = 0, usedMemory = 0, pendingMemory = 0;
+    std::exception_ptr error;
+    for(;;) {
+        // Start as many meshes as the workers and the memory budget allow.
+        while(!error && jobs.size() < maxJobs) {
+            if(!hasPending) {
+                if(sourceEmpty || !source(pending)) {
+                    sourceEmpty = true;
+                    break;
+                }
+                bool hasGeneratedLevels = false;
+                for(auto & level : pending.levels) {
+                    if(level.manualMeshName.empty()) {
+                        hasGeneratedLevels = true;
+                        break;
+                    }
+                }
+                if(!hasGeneratedLevels) {
+                    _generateManualLodLevels(pending);
+                    finished(count++, pending);
+                    continue;
+                }
+                hasPending = true;
+                pendingMemory = estimateLodMemory(pending);
+            }
+            if(memoryBudget && !jobs.empty() && usedMemory + pendingMemory > memoryBudget) {
+                break;
+            }
+
+            LodBatchJobPtr job = std::make_shared<LodBatchJob>();
+            job->memory = pendingMemory;
+            job->started = false;
+            job->done = false;
+            job->request.config = pending;
+            job->request.config.advanced.useBackgroundQueue = true;
+            job->request.isCancelled = false;
+            // The input provider reads the mesh buffers here, on the calling thread.
+            _resolveComponents(job->request.config, job->request.cost, job->request.data,
+                               job->request.input, job->request.output, job->request.collapser);
+            jobs.emplace_back(count++, job);
+            usedMemory += pendingMemory;
+            pending = LodConfig();
+            hasPending = false;
+            queue->addTask([runJob, job]() { runJob(job); });
+        }
+
+#if OGRE_THREAD_SUPPORT
+        size_t doneCount;
+        {
+            OGRE_WQ_LOCK_MUTEX(sync->mutex);
+            doneCount = sync->doneCount;
+        }
+#endif
+
+        // Inject the finished meshes.
+        bool progress = false;
+        LodBatchJobPtr unstarted;
+        for(auto it = jobs.begin(); it != jobs.end();) {
+            LodBatchJob* job = it->second.get();
+            if(!job->done) {
+                if(!unstarted && !job->started) {
+                    unstarted = it->second;
+                }
+                ++it;
+                continue;
+            }
+            if(job->error) {
+                if(!error) {
+                    error = job->error;
+                }
+            } else {
+                WorkQueue::Response res(NULL, true, &job->request);
+                handleResponse(&res, NULL);
+                finished(it->first, job->request.config);
+            }
+            usedMemory -= job->memory;
+            // A queued task may still hold the job, so drop the mesh and the Lod data now.
+            job->request = LodWorkQueueRequest();
+            it = jobs.erase(it);
+            progress = true;
+        }
+
+        if(jobs.empty()) {
+            if(error) {
+                std::rethrow_exception(error);
+            }
+            if(sourceEmpty && !hasPending) {
+                return;
+            }
+        } else if(!progress) {
+            // Help out with a mesh no worker has picked up yet. This also guarantees progress
+            // if the queue is not running or does not accept tasks.
+            if(unstarted) {
+                runJob(unstarted);
+            } else {
+#if OGRE_THREAD_SUPPORT
+                // All meshes in flight are running on workers, wait for one of them.
+                OGRE_WQ_LOCK_MUTEX_NAMED(sync->mutex, lock);
+                while(sync->doneCount == doneCount) {
+                    OGRE_THREAD_WAIT(sync->jobDone, sync->mutex, lock);
+                }
+#endif
+            }
+        }
+    }
+}
+
 void MeshLodGenerator::computeLods(LodConfig& lodConfig,
                                    LodData* data,
                                    LodCollapseCost* cost,
@@ -408,6 +408,43 @@ namespace Ogre
         /** Returns a list of cameras being tracked. */
         const CameraList& getCameraList() const;
 
+        /** Returns the velocity of a tracked camera, in world units per second.
+
+            The velocity is derived from the movement of the camera between frames,
+            it is zero for cameras that are not tracked.
+        */
+        Vector3 getCameraVelocity(const Camera* c) const;
+
+        /** Set how many seconds ahead page requests anticipate the camera movement.
+
+            Page strategies rank the pages to load by their distance to the position
+            the camera will have after this time if it keeps its velocity, so pages
+            ahead of a fast moving camera are loaded before the ones behind it.
+            The default is 1 second, 0 ranks pages by their current distance.
+        */
+        void setPagePredictionTime(Real seconds) { mPagePredictionTime = seconds; }
+        /** Get how many seconds ahead page requests anticipate the camera movement. */
+        Real getPagePredictionTime() const { return mPagePredictionTime; }
+
+        /** Set the maximum number of pages of a section being prepared at the same time.
+
+            Once that many pages are in flight, further page requests wait in the
+            order of their priority and are dropped if their page goes out of range
+            in the meantime. The default is 0, which means no limit.
+        */
+        void setMaxPagesInFlight(uint32 num) { mMaxPagesInFlight = num; }
+        /** Get the maximum number of pages of a section being prepared at the same time. */
+        uint32 getMaxPagesInFlight() const { return mMaxPagesInFlight; }
+
+        /** Set the maximum number of page loads a section starts per frame.
+
+            Use this to bound the main thread work of page loading, most notably
+            when loading synchronously. The default is 0, which means no limit.
+        */
+        void setMaxPageRequestsPerFrame(uint32 num) { mMaxPageRequestsPerFrame = num; }
+        /** Get the maximum number of page loads a section starts per frame. */
+        uint32 getMaxPageRequestsPerFrame() const { return mMaxPageRequestsPerFrame; }
+
         /** Set the debug display level.
 
             This setting controls how much debug information is displayed in the scene.
@@ -451,8 +488,17 @@ namespace Ogre
             bool frameEnded(const FrameEvent& evt) override;
         };
 
+        struct CameraMotion
+        {
+            Vector3 position;
+            Vector3 velocity;
+        };
+        typedef std::map<const Camera*, CameraMotion> CameraMotionMap;
+
         void createStandardStrategies();
         void createStandardContentFactories();
+        /// tracks the velocities of the cameras, called at the start of every frame
+        void updateCameraMotion(Real timeSinceLastFrame);
 
         WorldMap mWorlds;
         StrategyMap mStrategies;
@@ -463,9 +509,13 @@ namespace Ogre
         PageProvider* mPageProvider;
         String mPageResourceGroup;
         CameraList mCameraList;
+        CameraMotionMap mCameraMotion;
         EventRouter mEventRouter;
         uint8 mDebugDisplayLvl;
         bool mPagingEnabled;
+        Real mPagePredictionTime;
+        uint32 mMaxPagesInFlight;
+        uint32 mMaxPageRequestsPerFrame;
 
         Grid2DPageStrategy* mGrid2DPageStrategy;
         Grid3DPageStrategy* mGrid3DPageStrategy;
@@ -79,6 +79,14 @@ namespace Ogre
         PageMap mPages;
         PageProvider* mPageProvider;
         SceneManager* mSceneMgr;
+
+        /// priority and ID of a page to load
+        typedef std::pair<Real, PageID> PageRequest;
+        /// requests of the current frame, see requestPage
+        std::vector<PageRequest> mPageRequests;
+
+        /// loads the requested pages in the order of their priority, within the budgets of the PageManager
+        void dispatchPageRequests();
     private:
         /// Load data specific to a subtype of this class (if any)
         virtual void loadSubtypeData(StreamSerialiser& ser) {}
@@ -177,6 +185,23 @@ namespace Ogre
         */
         virtual void loadPage(PageID pageID, bool forceSynchronous = false);
 
+        /** Ask for a page to be loaded, in the order of a priority.
+
+            You would not normally call this manually, the PageStrategy is in
+            charge of it usually.
+            A page that is already loaded is held. Otherwise the request is queued
+            until the end of the frame, when the queued requests are passed to loadPage
+            in ascending order of priority until the limits set by
+            PageManager::setMaxPagesInFlight and PageManager::setMaxPageRequestsPerFrame
+            are reached. Requests are not carried over to the next frame, so the
+            strategy renews the ones still in range, and requests for pages that went
+            out of range are dropped.
+        @param pageID The page ID to load
+        @param priority Lower values load first, e.g. the predicted time or distance
+            until the page becomes visible
+        */
+        virtual void requestPage(PageID pageID, Real priority);
+
         /** Ask for a page to be unloaded with the given (section-relative) PageID
 
             You would not normally call this manually, the PageStrategy is in 
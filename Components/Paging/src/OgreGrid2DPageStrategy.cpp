@@ -331,6 +331,14 @@ namespace Ogre
         int32 loadymin = fymin < ymin ? ymin : (int32)floor(fymin);
         int32 loadymax = fymax > ymax ? ymax : (int32)ceil(fymax);
 
+        // rank pages by their distance to where the camera is heading, the ones
+        // in front of the camera first
+        Vector2 velocity, viewDir;
+        stratData->convertWorldToGridSpace(mManager->getCameraVelocity(cam), velocity);
+        stratData->convertWorldToGridSpace(cam->getDerivedDirection(), viewDir);
+        viewDir.normalise();
+        Vector2 predicted = gridpos + velocity * mManager->getPagePredictionTime();
+
         for (int32 cy = ymin; cy <= ymax; ++cy)
         {
             for (int32 cx = xmin; cx <= xmax; ++cx)
@@ -339,7 +347,13 @@ namespace Ogre
                 if (cx >= loadxmin && cx <= loadxmax && cy >= loadymin && cy <= loadymax)
                 {
                     // in the 'load' range, request it
-                    section->loadPage(pageID);
+                    Vector2 mid;
+                    stratData->getMidPointGridSpace(cx, cy, mid);
+                    Vector2 toPage = mid - predicted;
+                    Real dist = toPage.length();
+                    // pages behind the camera count up to twice their distance
+                    Real facing = dist > 0 ? viewDir.dotProduct(toPage) / dist : 1;
+                    section->requestPage(pageID, dist * (1.5f - 0.5f * facing));
                 }
                 else
                 {
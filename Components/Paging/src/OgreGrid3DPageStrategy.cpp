@@ -290,6 +290,8 @@ namespace Ogre
         int32 loadzmin = fzmin < zmin ? zmin : (int32)floor(fzmin);
         int32 loadzmax = fzmax > zmax ? zmax : (int32)ceil(fzmax);
 
+        Vector3 predicted = pos + mManager->getCameraVelocity(cam) * mManager->getPagePredictionTime();
+
         for (int32 cz = zmin; cz <= zmax; ++cz)
         {
             for (int32 cy = ymin; cy <= ymax; ++cy)
@@ -306,8 +308,9 @@ namespace Ogre
                         stratData->getBottomLeftGridSpace(cx, cy, cz, bl);
                         Ogre::AxisAlignedBox bbox(bl, bl+stratData->getCellSize());
 
+                        // nearest to where the camera is heading first
                         if( cam->isVisible(bbox) )
-                            section->loadPage(pageID);
+                            section->requestPage(pageID, bbox.getCenter().distance(predicted));
                         else
                             section->holdPage(pageID);
                     }
@@ -225,19 +225,28 @@ namespace Ogre
         // Main thread
         PageResponse pres = any_cast<PageResponse>(res->getData());
 
-        // final loading behaviour
-        if (res->succeeded())
+        // final loading behaviour, skipped if the page went out of range meanwhile
+        bool stale = !isHeld();
+        if (res->succeeded() && !stale)
         {
             if(!pres.pageData->collectionsToAdd.empty())
                 std::swap(mContentCollections, pres.pageData->collectionsToAdd);
 
             loadImpl();
         }
+        else
+        {
+            for (auto cc : pres.pageData->collectionsToAdd)
+                delete cc;
+        }
 
         OGRE_DELETE pres.pageData;
 
         mDeferredProcessInProgress = false;
 
+        // this deletes the page, so it must come last
+        if (stale)
+            mParent->unloadPage(this);
     }
     //---------------------------------------------------------------------
     bool Page::prepareImpl(PageData* dataToPopulate)
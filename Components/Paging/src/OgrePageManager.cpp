@@ -48,6 +48,9 @@ namespace Ogre
         , mPageResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
         , mDebugDisplayLvl(0)
         , mPagingEnabled(true)
+        , mPagePredictionTime(1)
+        , mMaxPagesInFlight(0)
+        , mMaxPageRequestsPerFrame(0)
         , mGrid2DPageStrategy(0)
         , mGrid3DPageStrategy(0)
         , mSimpleCollectionFactory(0)
@@ -492,6 +495,7 @@ namespace Ogre
         {
             c->removeListener(&mEventRouter);
             mCameraList.erase(i);
+            mCameraMotion.erase(c);
         }
     }
     //---------------------------------------------------------------------
@@ -505,6 +509,29 @@ namespace Ogre
         return mCameraList;
     }
     //---------------------------------------------------------------------
+    Vector3 PageManager::getCameraVelocity(const Camera* c) const
+    {
+        CameraMotionMap::const_iterator i = mCameraMotion.find(c);
+        return i != mCameraMotion.end() ? i->second.velocity : Vector3::ZERO;
+    }
+    //---------------------------------------------------------------------
+    void PageManager::updateCameraMotion(Real timeSinceLastFrame)
+    {
+        for (auto c : mCameraList)
+        {
+            CameraMotion motion = {c->getDerivedPosition(), Vector3::ZERO};
+            std::pair<CameraMotionMap::iterator, bool> ret = mCameraMotion.emplace(c, motion);
+            if (ret.second || timeSinceLastFrame <= 0)
+                continue;
+
+            // average over two frames, so a single jittery frame does not reorder all requests
+            CameraMotion& prev = ret.first->second;
+            Vector3 velocity = (motion.position - prev.position) / timeSinceLastFrame;
+            prev.velocity = (prev.velocity + velocity) * 0.5f;
+            prev.position = motion.position;
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     void PageManager::EventRouter::cameraPreRenderScene(Camera* cam)
     {
@@ -520,6 +547,8 @@ namespace Ogre
         if(pWorldMap->empty())
             return true;
 
+        pManager->updateCameraMotion(evt.timeSinceLastFrame);
+
         for(auto & i : *pWorldMap)
         {
             i.second->frameStart(evt.timeSinceLastFrame);
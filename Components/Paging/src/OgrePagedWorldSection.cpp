@@ -223,6 +223,50 @@ namespace Ogre
             i->second->touch();
     }
     //---------------------------------------------------------------------
+    void PagedWorldSection::requestPage(PageID pageID, Real priority)
+    {
+        PageMap::iterator i = mPages.find(pageID);
+        if (i != mPages.end())
+            i->second->touch();
+        else
+            mPageRequests.push_back(PageRequest(priority, pageID));
+    }
+    //---------------------------------------------------------------------
+    void PagedWorldSection::dispatchPageRequests()
+    {
+        if (mPageRequests.empty())
+            return;
+
+        PageManager* mgr = getManager();
+        uint32 maxInFlight = mgr->getMaxPagesInFlight();
+        uint32 maxRequests = mgr->getMaxPageRequestsPerFrame();
+
+        size_t inFlight = 0;
+        if (maxInFlight)
+        {
+            for (auto& p : mPages)
+                if (p.second->isDeferredProcessInProgress())
+                    ++inFlight;
+        }
+
+        std::sort(mPageRequests.begin(), mPageRequests.end());
+        uint32 started = 0;
+        for (const auto& r : mPageRequests)
+        {
+            // several cameras may have requested the same page
+            if (mPages.find(r.second) != mPages.end())
+                continue;
+            if ((maxInFlight && inFlight >= maxInFlight) || (maxRequests && started >= maxRequests))
+                break;
+
+            loadPage(r.second);
+            ++started;
+            ++inFlight;
+        }
+        // the strategy renews the requests still in range next frame
+        mPageRequests.clear();
+    }
+    //---------------------------------------------------------------------
     void PagedWorldSection::unloadPage(PageID pageID, bool sync)
     {
         if (!mParent->getManager()->getPagingOperationsEnabled())
@@ -331,6 +375,8 @@ namespace Ogre
     {
         mStrategy->frameEnd(timeElapsed, this);
 
+        dispatchPageRequests();
+
         for (PageMap::iterator i = mPages.begin(); i != mPages.end(); )
         {
             // if this page wasn't used, unload
@@ -338,7 +384,11 @@ namespace Ogre
             // pre-increment since unloading will remove it
             ++i;
             if (!p->isHeld())
-                unloadPage(p);
+            {
+                // pages still being prepared discard their data and unload themselves once done
+                if (!p->isDeferredProcessInProgress())
+                    unloadPage(p);
+            }
             else
                 p->frameEnd(timeElapsed);
         }
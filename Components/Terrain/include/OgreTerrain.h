@@ -1301,6 +1301,17 @@ namespace Ogre
         const MaterialPtr& getCompositeMapMaterial() const;
         /// Internal getting of material  for the terrain composite map
         const MaterialPtr& _getCompositeMapMaterial() const { return mCompositeMapMaterial; }
+        /** Internal - the CPU copy of the lightmap, in image space. Only present before load() or
+            if the material generator bakes the composite map on the CPU.
+        */
+        const Image& _getCpuLightmap() const { return mCpuLightmap; }
+        /// Internal - the CPU copy of a packed blend texture. Only present before load().
+        const Image* _getCpuBlendMap(uint8 blendTextureIndex) const
+        {
+            return blendTextureIndex < mCpuBlendMapStorage.size() ? &mCpuBlendMapStorage[blendTextureIndex] : NULL;
+        }
+        /// Internal - the CPU copy of the global colour map, in image space. Only present before load().
+        const Image& _getCpuColourMap() const { return mCpuColourMap; }
 
         /// Get the name of the material being used for the terrain
         const String& getMaterialName() const { return mMaterialName; }
@@ -1625,6 +1636,14 @@ namespace Ogre
         void createOrDestroyGPULightmap();
         void createOrDestroyGPUCompositeMap();
 
+        /// lightmap of rect by casting a ray per texel towards the light
+        void calculateLightmapRayCast(const Rect& rect, uint8* pData);
+        /// lightmap of rect by sweeping lines along the light direction
+        void calculateLightmapSweep(const Rect& rect, uint8* pData);
+        /** height at a terrain space position, which may lie in a neighbour
+            @return false if there is no terrain at the position */
+        bool getCascadedHeight(Real x, Real y, float* height) const;
+
         void convertSpace(Space inSpace, const Vector3& inVec, Space outSpace, Vector3& outVec, bool translation) const;
         Vector3 convertWorldToTerrainAxes(const Vector3& inVec) const;
         Vector3 convertTerrainToWorldAxes(const Vector3& inVec) const;
@@ -1679,6 +1698,10 @@ namespace Ogre
         float* mHeightData;
         /// The delta information defining how a vertex moves before it is removed at a lower LOD
         float* mDeltaData;
+        /** Pyramid of interleaved min/max heights, level 0 holding single quads and every
+            further level blocks of 2x2 blocks of the previous one, for skipping empty space
+            in rayIntersects */
+        std::vector<std::vector<float> > mHeightBounds;
         Alignment mAlign;
         Real mWorldSize;
         uint16 mSize;
@@ -1822,6 +1845,16 @@ namespace Ogre
     private:
         /// Test a single quad of the terrain for ray intersection.
         OGRE_FORCE_INLINE std::pair<bool, Vector3> checkQuadIntersection(int x, int y, const Ray& ray) const;
+        /// Update the min/max heights of the quads touching the points in rect
+        void updateHeightBounds(const Rect& rect);
+        /** Deltas of the vertices of a tile at a LOD, given the offset and step of the tile.
+            The maximum delta of each leaf of the quadtree is merged into maxDeltas. */
+        void calculateTileDeltas(int32 i, int32 j, int32 step, int32 leafSize, int32 numLeaves,
+                                 float* maxDeltas);
+        /// Normal of a point, using the neighbours across the border
+        void calculateNormal(int32 x, int32 y, uint8* pStore) const;
+        /// Normals of the points in [left, right) of row y, which must not touch the border
+        void calculateInteriorNormals(int32 y, int32 left, int32 right, uint8* pStore) const;
     };
 
 
@@ -1857,6 +1890,8 @@ namespace Ogre
         Real mCompositeMapDistance;
         String mResourceGroup;
         bool mUseVertexCompressionWhenAvailable;
+        bool mUseRayCastLightmap;
+        bool mUseQuantisedHeightData;
 
     public:
         TerrainGlobalOptions();
@@ -2037,6 +2072,29 @@ namespace Ogre
          */
         void setUseVertexCompressionWhenAvailable(bool enable) { mUseVertexCompressionWhenAvailable = enable; }
 
+        /** Get whether lightmaps are calculated by casting a ray per texel.
+        */
+        bool getUseRayCastLightmap() const { return mUseRayCastLightmap; }
+
+        /** Set whether lightmaps are calculated by casting a ray per texel.
+         @note By default, lightmaps are calculated by sweeping lines along the light
+         direction while tracking the horizon, which is linear in the number of texels
+         and runs on the threads of the WorkQueue. The ray cast is far slower, but
+         resolves shadows cast by features smaller than a lightmap texel.
+         */
+        void setUseRayCastLightmap(bool enable) { mUseRayCastLightmap = enable; }
+
+        /** Get whether height data is quantised when saving terrains.
+        */
+        bool getUseQuantisedHeightData() const { return mUseQuantisedHeightData; }
+
+        /** Set whether height data is quantised when saving terrains.
+         @note By default, heights are stored with 16 bits relative to the height range of
+         the terrain, which makes files several times smaller and faster to load. Disable
+         this to store the heights losslessly. Either kind of file can be loaded.
+         */
+        void setUseQuantisedHeightData(bool enable) { mUseQuantisedHeightData = enable; }
+
         /// @copydoc Singleton::getSingleton()
         static TerrainGlobalOptions& getSingleton(void);
         /// @copydoc Singleton::getSingleton()
@@ -428,6 +428,19 @@ namespace Ogre
          the terrain data occurs.
          */
         RayResult rayIntersects(const Ray& ray, Real distanceLimit = 0) const; 
+
+        typedef std::vector<RayResult> RayResultList;
+        /** Test many rays for intersection with the terrains in the group at once.
+
+            Equivalent to calling rayIntersects for every ray, but the rays are spread
+            over the threads of the WorkQueue.
+         @param rays The rays to test
+         @param results Receives the result of every ray, in the same order
+         @param distanceLimit The distance from the ray origins at which we will stop looking,
+            0 indicates no limit
+         @remarks Like the single ray version, no parallel write to the terrain data may occur.
+         */
+        void rayIntersects(const std::vector<Ray>& rays, RayResultList& results, Real distanceLimit = 0) const;
         
         typedef std::vector<Terrain*> TerrainList; 
         /** Test intersection of a box with the terrain. 
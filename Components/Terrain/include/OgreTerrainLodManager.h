@@ -90,7 +90,12 @@ namespace Ogre
         bool isOpen() const;
 
         void updateToLodLevel(int lodLevel, bool synchronous = false);
-        /// Save each LOD level separately compressed so seek is possible
+        /** Save each LOD level separately compressed so seek is possible
+        @remarks If TerrainGlobalOptions::getUseQuantisedHeightData is set, heights and deltas
+            are quantised to 16 bits relative to their range and stored as differences of
+            successive values in blocks that are decoded in parallel. Otherwise the floats
+            are deflated.
+        */
         static void saveLodData(StreamSerialiser& stream, Terrain* terrain);
 
         /** Copy geometry data from buffer to mHeightData/mDeltaData
@@ -103,8 +108,8 @@ namespace Ogre
         /** Read separated geometry data from file into allocated memory
           @param lowerLodBound Lower bound of LOD levels to load
           @param higherLodBound Upper bound of LOD levels to load
-          @remarks Geometry data are uncompressed using inflate() and stored into
-                allocated buffer
+          @remarks Geometry data are decoded or uncompressed using inflate(), depending on
+                the chunk version, and stored into allocated buffer
           */
         void readLodData(uint16 lowerLodBound, uint16 higherLodBound);
         void waitForDerivedProcesses();
@@ -126,6 +131,11 @@ namespace Ogre
         void init();
         void buildLodInfoTable();
 
+        /// Writes a LOD level in the quantised, block encoded format
+        static void writeQuantisedLodData(StreamSerialiser& stream, const LodData& data);
+        /// Reads the payload of a chunk written by writeQuantisedLodData
+        static void readQuantisedLodData(StreamSerialiser& stream, float* data, uint dataSize);
+
         /** Separate geometry data by LOD level
         @param data A geometry data to separate i.e. mHeightData/mDeltaData
         @param size Dimension of the input data
@@ -139,7 +139,12 @@ namespace Ogre
         generator is free to render into a texture to support this, so long as 
         the results are blitted into the Terrain's own composite map afterwards.
         */
-        void updateCompositeMap(const Terrain* terrain, const Rect& rect);
+        virtual void updateCompositeMap(const Terrain* terrain, const Rect& rect);
+
+        /** Whether the composite map is baked on the CPU instead of being rendered.
+        The terrain keeps CPU copies of the data the generator needs in that case.
+        */
+        virtual bool isCpuCompositeMapEnabled() const { return false; }
 
         /** Update parameters for the given terrain using the active profile.
         */
@@ -178,6 +183,9 @@ namespace Ogre
 
         Texture* _getCompositeMapRTT() { return mCompositeMapRTT; }
     protected:
+        /// Convert a dirty rect in terrain point space to the covered composite map region in image space
+        static Rect getCompositeMapImageRect(const Terrain* terrain, const Rect& rect, int32 compSize);
+
         unsigned long long int mChangeCounter;
         TerrainLayerDeclaration mLayerDecl;
         unsigned int mDebugLevel;
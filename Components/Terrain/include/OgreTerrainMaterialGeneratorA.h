@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreTerrainPrerequisites.h"
 #include "OgreTerrainMaterialGenerator.h"
+#include "OgreImage.h"
 
 namespace Ogre
 {
@@ -60,8 +61,13 @@ namespace Ogre
         std::unique_ptr<SM2Profile> mActiveProfile;
         bool mLightmapEnabled;
         bool mCompositeMapEnabled;
+        bool mCpuCompositeMapEnabled;
         bool mReceiveDynamicShadows;
         bool mLowLodShadows;
+        /// layer albedo textures for CPU compositing, keyed by name and mip level
+        std::map<std::pair<String, uint32>, Image> mCpuLayerTextures;
+
+        const Image& getCpuLayerTexture(const String& name, Real texelsPerCompositeTexel);
     public:
         TerrainMaterialGeneratorA();
         virtual ~TerrainMaterialGeneratorA();
@@ -116,6 +122,7 @@ namespace Ogre
 
             void setLightmapEnabled(bool enabled) { mParent->setLightmapEnabled(enabled); }
             void setCompositeMapEnabled(bool enabled) { mParent->setCompositeMapEnabled(enabled); }
+            void setCpuCompositeMapEnabled(bool enabled) { mParent->setCpuCompositeMapEnabled(enabled); }
             void setReceiveDynamicShadowsEnabled(bool enabled) { mParent->setReceiveDynamicShadowsEnabled(enabled); }
             void setReceiveDynamicShadowsLowLod(bool enabled) { mParent->setReceiveDynamicShadowsLowLod(enabled); }
         private:
@@ -166,6 +173,31 @@ namespace Ogre
         void setCompositeMapEnabled(bool enabled);
         bool isCompositeMapEnabled() const  { return mCompositeMapEnabled; }
 
+        /** Whether to bake the composite map on the CPU instead of rendering it (default false).
+
+        The layer albedo textures are blended by the layer blend maps and lit by the
+        composite map ambient and diffuse colours, the terrain normals and the lightmap.
+        This needs no render target or GPU readback, but the layer textures are loaded
+        a second time into system memory. Set this before loading terrains, so they
+        keep a CPU copy of their lightmap.
+        @note The global colour map of a loaded terrain only lives on the GPU, so terrains
+        using it keep rendering their composite map there and a warning is logged.
+        */
+        void setCpuCompositeMapEnabled(bool enabled);
+        bool isCpuCompositeMapEnabled() const override { return mCpuCompositeMapEnabled; }
+
+        /** Bake a region of the composite map on the CPU.
+
+        Works with terrains that are only prepared, which allows producing composite maps
+        without a render system. The global colour map is applied from its CPU copy, which
+        only exists before the terrain is loaded.
+        @param terrain The terrain to composite
+        @param rect The region to update, in composite map image space
+        @param dst Receives the region, so it is the size of rect. To write into a whole
+        composite map instead, pass PixelBox::getSubVolume of it.
+        */
+        void bakeCompositeMap(const Terrain* terrain, const Rect& rect, const PixelBox& dst);
+
         /// Get the active profile
         Profile* getActiveProfile() const override { return mActiveProfile.get(); }
 
@@ -177,6 +209,7 @@ namespace Ogre
         uint8 getMaxLayers(const Terrain* terrain) const override { return mActiveProfile->getMaxLayers(terrain); }
         void updateParams(const MaterialPtr& mat, const Terrain* terrain) override;
         void updateParamsForCompositeMap(const MaterialPtr& mat, const Terrain* terrain) override;
+        void updateCompositeMap(const Terrain* terrain, const Rect& rect) override;
     };
     /** @} */
     /** @} */
@@ -56,6 +56,16 @@ THE SOFTWARE.
 #endif
 namespace Ogre
 {
+    namespace
+    {
+        /// encode as RGB, object space
+        inline void storeNormal(const Vector3& normal, uint8* pStore)
+        {
+            pStore[0] = static_cast<uint8>((normal.x + 1.0f) * 0.5f * 255.0f);
+            pStore[1] = static_cast<uint8>((normal.y + 1.0f) * 0.5f * 255.0f);
+            pStore[2] = static_cast<uint8>((normal.z + 1.0f) * 0.5f * 255.0f);
+        }
+    }
     //---------------------------------------------------------------------
     const uint32 Terrain::TERRAIN_CHUNK_ID = StreamSerialiser::makeIdentifier("TERR");
     const uint16 Terrain::TERRAIN_CHUNK_VERSION = 2;
@@ -111,6 +121,8 @@ namespace Ogre
         , mCompositeMapDistance(4000)
         , mResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
         , mUseVertexCompressionWhenAvailable(true)
+        , mUseRayCastLightmap(false)
+        , mUseQuantisedHeightData(true)
     {
     }
     //---------------------------------------------------------------------
@@ -730,6 +742,7 @@ namespace Ogre
         // Create & load quadtree
         mQuadTree = OGRE_NEW TerrainQuadTreeNode(this, 0, 0, 0, mSize, mNumLodLevels - 1, 0);
         mQuadTree->prepare(stream);
+        updateHeightBounds(Rect(0, 0, mSize, mSize));
 
         // stop uncompressing
         if(mainChunk->version > 1)
@@ -862,6 +875,7 @@ namespace Ogre
 
         mQuadTree = OGRE_NEW TerrainQuadTreeNode(this, 0, 0, 0, mSize, mNumLodLevels - 1, 0);
         mQuadTree->prepare();
+        updateHeightBounds(Rect(0, 0, mSize, mSize));
 
         // calculate entire terrain
         Rect rect(0, 0, mSize, mSize);
@@ -1806,6 +1820,9 @@ namespace Ogre
     //---------------------------------------------------------------------
     void Terrain::dirtyRect(const Rect& rect)
     {
+        if (mHeightData)
+            updateHeightBounds(rect);
+
         mDirtyGeometryRect.merge(rect);
         mDirtyGeometryRectForNeighbours.merge(rect);
         mDirtyDerivedDataRect.merge(rect);
@@ -1944,6 +1961,7 @@ namespace Ogre
     {
         OGRE_FREE(mHeightData, MEMCATEGORY_GEOMETRY);
         mHeightData = 0;
+        mHeightBounds.clear();
 
         OGRE_FREE(mDeltaData, MEMCATEGORY_GEOMETRY);
         mDeltaData = 0;
@@ -2024,6 +2042,10 @@ namespace Ogre
 
         mQuadTree->preDeltaCalculation(clampedRect);
 
+        // vertices per side of the leaves of the quadtree
+        int32 leafSize = std::min(mMaxBatchSize, mSize) - 1;
+        int32 numLeaves = (mSize - 1) / leafSize;
+
         /// Iterate over target levels, 
         for (int targetLevel = 1; targetLevel < mNumLodLevels; ++targetLevel)
         {
@@ -2054,113 +2076,40 @@ namespace Ogre
             if (lodRect.bottom % step)
                 lodRect.bottom += step - (lodRect.bottom % step);
 
-            for (int j = lodRect.top; j < lodRect.bottom - step; j += step )
-            {
-                for (int i = lodRect.left; i < lodRect.right - step; i += step )
+            // rows of tiles are processed in bands in parallel, each reducing the
+            // deltas per quadtree leaf, so the quadtree is notified once per leaf
+            int numTileRows = (lodRect.bottom - lodRect.top) / step - 1;
+            if (numTileRows <= 0)
+                continue;
+            int tileRowsPerTask = std::max(1, 64 / step);
+            size_t numTasks = (numTileRows + tileRowsPerTask - 1) / tileRowsPerTask;
+            std::vector<float> leafDeltas(numTasks * numLeaves * numLeaves, -std::numeric_limits<float>::max());
+
+            Root::getSingleton().getWorkQueue()->processTasksParallel(numTasks, [&](size_t task) {
+                float* maxDeltas = &leafDeltas[task * numLeaves * numLeaves];
+                int jBegin = lodRect.top + int(task) * tileRowsPerTask * step;
+                int jEnd = std::min(lodRect.bottom - step, jBegin + tileRowsPerTask * step);
+                for (int j = jBegin; j < jEnd; j += step)
                 {
-                    // Form planes relating to the lower detail tris to be produced
-                    // For even tri strip rows, they are this shape:
-                    // 2---3
-                    // | / |
-                    // 0---1
-                    // For odd tri strip rows, they are this shape:
-                    // 2---3
-                    // | \ |
-                    // 0---1
-
-                    Vector3 v0, v1, v2, v3;
-                    getPointAlign(i, j, ALIGN_X_Y, &v0);
-                    getPointAlign(i + step, j, ALIGN_X_Y, &v1);
-                    getPointAlign(i, j + step, ALIGN_X_Y, &v2);
-                    getPointAlign(i + step, j + step, ALIGN_X_Y, &v3);
-
-                    Vector4 t1, t2;
-                    bool backwardTri = false;
-                    // Odd or even in terms of target level
-                    if ((j / step) % 2 == 0)
-                    {
-                        t1 = Math::calculateFaceNormalWithoutNormalize(v0, v1, v3);
-                        t2 = Math::calculateFaceNormalWithoutNormalize(v0, v3, v2);
-                    }
-                    else
-                    {
-                        t1 = Math::calculateFaceNormalWithoutNormalize(v1, v3, v2);
-                        t2 = Math::calculateFaceNormalWithoutNormalize(v0, v1, v2);
-                        backwardTri = true;
-                    }
-
-                    // include the bottommost row of vertices if this is the last row
-                    int yubound = (j == (mSize - step)? step : step - 1);
-                    for ( int y = 0; y <= yubound; y++ )
-                    {
-                        // include the rightmost col of vertices if this is the last col
-                        int xubound = (i == (mSize - step)? step : step - 1);
-                        for ( int x = 0; x <= xubound; x++ )
-                        {
-                            int fulldetailx = static_cast<int>(i + x);
-                            int fulldetaily = static_cast<int>(j + y);
-                            if ( fulldetailx % step == 0 && 
-                                fulldetaily % step == 0 )
-                            {
-                                // Skip, this one is a vertex at this level
-                                continue;
-                            }
-
-                            Real ypct = (Real)y / (Real)step;
-                            Real xpct = (Real)x / (Real)step;
-
-                            //interpolated height
-                            Vector3 actualPos;
-                            getPointAlign(fulldetailx, fulldetaily, ALIGN_X_Y, &actualPos);
-                            Real interp_h;
-                            // Determine which tri we're on 
-                            if ((xpct > ypct && !backwardTri) ||
-                                (xpct > (1-ypct) && backwardTri))
-                            {
-                                // Solve for x/z
-                                interp_h = 
-                                    (-t1.x * actualPos.x
-                                    - t1.y * actualPos.y
-                                    - t1.w) / t1.z;
-                            }
-                            else
-                            {
-                                // Second tri
-                                interp_h = 
-                                    (-t2.x * actualPos.x
-                                    - t2.y * actualPos.y
-                                    - t2.w) / t2.z;
-                            }
-
-                            Real actual_h = actualPos.z;
-                            Real delta = interp_h - actual_h;
-
-                            // max(delta) is the worst case scenario at this LOD
-                            // compared to the original heightmap
-
-                            // tell the quadtree about this 
-                            mQuadTree->notifyDelta(fulldetailx, fulldetaily, sourceLevel, delta);
-
-
-                            // If this vertex is being removed at this LOD, 
-                            // then save the height difference since that's the move
-                            // it will need to make. Vertices to be removed at this LOD
-                            // are halfway between the steps, but exclude those that
-                            // would have been eliminated at earlier levels
-                            int halfStep = step / 2;
-                            if (
-                             ((fulldetailx % step) == halfStep && (fulldetaily % halfStep) == 0) ||
-                             ((fulldetaily % step) == halfStep && (fulldetailx % halfStep) == 0))
-                            {
-                                // Save height difference 
-                                mDeltaData[fulldetailx + (fulldetaily * mSize)] = delta;
-                            }
-
-                        }
+                    for (int i = lodRect.left; i < lodRect.right - step; i += step)
+                        calculateTileDeltas(i, j, step, leafSize, numLeaves, maxDeltas);
+                }
+            });
 
-                    }
-                } // i
-            } // j
+            for (int32 y = 0; y < numLeaves; ++y)
+            {
+                for (int32 x = 0; x < numLeaves; ++x)
+                {
+                    float delta = leafDeltas[y * numLeaves + x];
+                    for (size_t task = 1; task < numTasks; ++task)
+                        delta = std::max(delta, leafDeltas[(task * numLeaves + y) * numLeaves + x]);
+
+                    // a point inside the leaf only, so exactly the nodes holding the
+                    // vertices of the leaf are notified
+                    if (delta > -std::numeric_limits<float>::max())
+                        mQuadTree->notifyDelta(x * leafSize + 1, y * leafSize + 1, sourceLevel, delta);
+                }
+            }
 
         } // targetLevel
 
@@ -2170,6 +2119,106 @@ namespace Ogre
 
     }
     //---------------------------------------------------------------------
+    void Terrain::calculateTileDeltas(int32 i, int32 j, int32 step, int32 leafSize, int32 numLeaves,
+                                      float* maxDeltas)
+    {
+        // Form planes relating to the lower detail tris to be produced
+        // For even tri strip rows, they are this shape:
+        // 2---3
+        // | / |
+        // 0---1
+        // For odd tri strip rows, they are this shape:
+        // 2---3
+        // | \ |
+        // 0---1
+        float h0 = *getHeightData(i, j), h1 = *getHeightData(i + step, j);
+        float h2 = *getHeightData(i, j + step), h3 = *getHeightData(i + step, j + step);
+
+        // both planes as h = a + b * xpct + c * ypct
+        float a1, b1, c1, a2, b2, c2;
+        bool backwardTri = false;
+        // Odd or even in terms of target level
+        if ((j / step) % 2 == 0)
+        {
+            // 0, 1, 3 and 0, 3, 2
+            a1 = h0; b1 = h1 - h0; c1 = h3 - h1;
+            a2 = h0; b2 = h3 - h2; c2 = h2 - h0;
+        }
+        else
+        {
+            // 1, 3, 2 and 0, 1, 2
+            a1 = h1 + h2 - h3; b1 = h3 - h2; c1 = h3 - h1;
+            a2 = h0; b2 = h1 - h0; c2 = h2 - h0;
+            backwardTri = true;
+        }
+
+        int halfStep = step / 2;
+        Real invStep = 1 / (Real)step;
+
+        // include the bottommost row of vertices if this is the last row
+        int yubound = (j == (mSize - step)? step : step - 1);
+        // include the rightmost col of vertices if this is the last col
+        int xubound = (i == (mSize - step)? step : step - 1);
+        for (int y = 0; y <= yubound; y++)
+        {
+            int fulldetaily = j + y;
+            const float* pHeight = getHeightData(i, fulldetaily);
+            Real ypct = y * invStep;
+
+            // the leaves holding the row, two on their shared edge
+            int32 leafY = std::min(fulldetaily / leafSize, numLeaves - 1);
+            bool sharedY = fulldetaily % leafSize == 0 && leafY > 0 && fulldetaily / leafSize == leafY;
+
+            for (int x = 0; x <= xubound; x++)
+            {
+                int fulldetailx = i + x;
+                if (fulldetailx % step == 0 && fulldetaily % step == 0)
+                {
+                    // Skip, this one is a vertex at this level
+                    continue;
+                }
+
+                Real xpct = x * invStep;
+
+                //interpolated height, determine which tri we're on
+                Real interp_h;
+                if ((xpct > ypct && !backwardTri) ||
+                    (xpct > (1-ypct) && backwardTri))
+                    interp_h = a1 + b1 * xpct + c1 * ypct;
+                else
+                    interp_h = a2 + b2 * xpct + c2 * ypct;
+
+                float delta = interp_h - pHeight[x];
+
+                // max(delta) is the worst case scenario at this LOD
+                // compared to the original heightmap
+                int32 leafX = std::min(fulldetailx / leafSize, numLeaves - 1);
+                bool sharedX = fulldetailx % leafSize == 0 && leafX > 0 && fulldetailx / leafSize == leafX;
+                for (int32 ly = leafY - sharedY; ly <= leafY; ++ly)
+                {
+                    for (int32 lx = leafX - sharedX; lx <= leafX; ++lx)
+                    {
+                        float& maxDelta = maxDeltas[ly * numLeaves + lx];
+                        maxDelta = std::max(maxDelta, delta);
+                    }
+                }
+
+                // If this vertex is being removed at this LOD, 
+                // then save the height difference since that's the move
+                // it will need to make. Vertices to be removed at this LOD
+                // are halfway between the steps, but exclude those that
+                // would have been eliminated at earlier levels
+                if (
+                 ((fulldetailx % step) == halfStep && (fulldetaily % halfStep) == 0) ||
+                 ((fulldetaily % step) == halfStep && (fulldetailx % halfStep) == 0))
+                {
+                    // Save height difference 
+                    mDeltaData[fulldetailx + (fulldetaily * mSize)] = delta;
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     void Terrain::finaliseHeightDeltas(const Rect& rect, bool cpuData)
     {
 
@@ -2306,9 +2355,10 @@ namespace Ogre
         rayDirection.normalise();
         Ray localRay (rayOrigin, rayDirection);
 
-        // test if the ray actually hits the terrain's bounds
-        Real maxHeight = getMaxHeight();
-        Real minHeight = getMinHeight();
+        // test if the ray actually hits the terrain's bounds, which the top of the
+        // pyramid holds even before the geometry was updated
+        Real minHeight = mHeightBounds.back()[0];
+        Real maxHeight = mHeightBounds.back()[1];
 
         AxisAlignedBox aabb (Vector3(0, minHeight, 0), Vector3(mSize, maxHeight, mSize));
         std::pair<bool, Real> aabbTest = localRay.intersects(aabb);
@@ -2326,43 +2376,59 @@ namespace Ogre
         // get intersection point and move inside
         Vector3 cur = localRay.getPoint(aabbTest.second);
 
-        // now check every quad the ray touches
-        int quadX = std::min(std::max(static_cast<int>(cur.x), 0), (int)mSize-2);
-        int quadZ = std::min(std::max(static_cast<int>(cur.z), 0), (int)mSize-2);
-        int flipX = (rayDirection.x < 0 ? 0 : 1);
-        int flipZ = (rayDirection.z < 0 ? 0 : 1);
-        int xDir = (rayDirection.x < 0 ? -1 : 1);
-        int zDir = (rayDirection.z < 0 ? -1 : 1);
+        // now check every quad the ray touches, descending the min/max pyramid and
+        // skipping whole blocks of quads the ray passes above or below
+        int lastQuad = (int)mSize - 2;
+        int quadX = std::min(std::max(static_cast<int>(cur.x), 0), lastQuad);
+        int quadZ = std::min(std::max(static_cast<int>(cur.z), 0), lastQuad);
+        int topLevel = static_cast<int>(mHeightBounds.size()) - 1;
+        int level = topLevel;
+        Real t = aabbTest.second;
 
-        Result result(true, Vector3::ZERO);
+        Result result(false, Vector3::ZERO);
         Real dummyHighValue = (Real)mSize * 10000.0f;
 
-
-        while (cur.y >= (minHeight - 1e-3) && cur.y <= (maxHeight + 1e-3))
+        while (quadX >= 0 && quadX <= lastQuad && quadZ >= 0 && quadZ <= lastQuad)
         {
-            if (quadX < 0 || quadX >= (int)mSize-1 || quadZ < 0 || quadZ >= (int)mSize-1)
-                break;
+            int blockX = quadX >> level, blockZ = quadZ >> level;
+            int minX = blockX << level, maxX = std::min((blockX + 1) << level, lastQuad + 1);
+            int minZ = blockZ << level, maxZ = std::min((blockZ + 1) << level, lastQuad + 1);
 
-            result = checkQuadIntersection(quadX, quadZ, localRay);
-            if (result.first)
-                break;
+            // where the ray leaves the block
+            Real exitX = Math::RealEqual(rayDirection.x, 0.0) ? dummyHighValue :
+                ((rayDirection.x < 0 ? minX : maxX) - rayOrigin.x) / rayDirection.x;
+            Real exitZ = Math::RealEqual(rayDirection.z, 0.0) ? dummyHighValue :
+                ((rayDirection.z < 0 ? minZ : maxZ) - rayOrigin.z) / rayDirection.z;
+            Real exit = std::max(t, std::min(exitX, exitZ));
+
+            const float* bounds = &mHeightBounds[level][2 * (blockZ * ((lastQuad >> level) + 1) + blockX)];
+            Real y0 = rayOrigin.y + rayDirection.y * t;
+            Real y1 = rayOrigin.y + rayDirection.y * exit;
+            if (std::max(y0, y1) >= bounds[0] - 1e-3 && std::min(y0, y1) <= bounds[1] + 1e-3)
+            {
+                if (level > 0)
+                {
+                    --level;
+                    continue;
+                }
+                result = checkQuadIntersection(quadX, quadZ, localRay);
+                if (result.first)
+                    break;
+            }
 
-            // determine next quad to test
-            Real xDist = Math::RealEqual(rayDirection.x, 0.0) ? dummyHighValue : 
-                (quadX - cur.x + flipX) / rayDirection.x;
-            Real zDist = Math::RealEqual(rayDirection.z, 0.0) ? dummyHighValue : 
-                (quadZ - cur.z + flipZ) / rayDirection.z;
-            if (xDist < zDist)
+            // determine next block to test
+            t = exit;
+            if (exitX < exitZ)
             {
-                quadX += xDir;
-                cur += rayDirection * xDist;
+                quadX = rayDirection.x < 0 ? minX - 1 : maxX;
+                quadZ = std::min(std::max(static_cast<int>(rayOrigin.z + rayDirection.z * t), minZ), maxZ - 1);
             }
             else
             {
-                quadZ += zDir;
-                cur += rayDirection * zDist;
+                quadZ = rayDirection.z < 0 ? minZ - 1 : maxZ;
+                quadX = std::min(std::max(static_cast<int>(rayOrigin.x + rayDirection.x * t), minX), maxX - 1);
             }
-
+            level = std::min(level + 1, topLevel);
         }
 
         if (result.first)
@@ -2399,6 +2465,75 @@ namespace Ogre
         return result;
     }
     //---------------------------------------------------------------------
+    void Terrain::updateHeightBounds(const Rect& rect)
+    {
+        int numQuads = (int)mSize - 1;
+        // down to a single block covering all quads
+        size_t numLevels = 1;
+        while ((numQuads - 1) >> (numLevels - 1))
+            ++numLevels;
+
+        // quads touching the points of the rect
+        long left = std::max<long>(rect.left - 1, 0), right = std::min<long>(rect.right, numQuads);
+        long top = std::max<long>(rect.top - 1, 0), bottom = std::min<long>(rect.bottom, numQuads);
+        if (mHeightBounds.size() != numLevels)
+        {
+            mHeightBounds.resize(numLevels);
+            for (size_t l = 0; l < numLevels; ++l)
+            {
+                size_t dim = ((numQuads - 1) >> l) + 1;
+                mHeightBounds[l].resize(2 * dim * dim);
+            }
+            left = top = 0;
+            right = bottom = numQuads;
+        }
+        if (left >= right || top >= bottom)
+            return;
+
+        float* bounds = mHeightBounds[0].data();
+        for (long y = top; y < bottom; ++y)
+        {
+            for (long x = left; x < right; ++x)
+            {
+                float h0 = *getHeightData(x, y), h1 = *getHeightData(x + 1, y);
+                float h2 = *getHeightData(x, y + 1), h3 = *getHeightData(x + 1, y + 1);
+                float* b = bounds + 2 * (y * numQuads + x);
+                b[0] = std::min(std::min(h0, h1), std::min(h2, h3));
+                b[1] = std::max(std::max(h0, h1), std::max(h2, h3));
+            }
+        }
+
+        for (size_t l = 1; l < numLevels; ++l)
+        {
+            long childDim = ((numQuads - 1) >> (l - 1)) + 1, dim = ((numQuads - 1) >> l) + 1;
+            left /= 2;
+            top /= 2;
+            right = (right + 1) / 2;
+            bottom = (bottom + 1) / 2;
+
+            const float* children = mHeightBounds[l - 1].data();
+            bounds = mHeightBounds[l].data();
+            for (long y = top; y < bottom; ++y)
+            {
+                for (long x = left; x < right; ++x)
+                {
+                    float* b = bounds + 2 * (y * dim + x);
+                    b[0] = std::numeric_limits<float>::max();
+                    b[1] = -std::numeric_limits<float>::max();
+                    for (long cy = 2 * y; cy < std::min(2 * y + 2, childDim); ++cy)
+                    {
+                        for (long cx = 2 * x; cx < std::min(2 * x + 2, childDim); ++cx)
+                        {
+                            const float* c = children + 2 * (cy * childDim + cx);
+                            b[0] = std::min(b[0], c[0]);
+                            b[1] = std::max(b[1], c[1]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     std::pair<bool, Vector3> Terrain::checkQuadIntersection(int x, int z, const Ray& ray) const
     {
         // build the two planes belonging to the quad's triangles
@@ -3149,57 +3284,109 @@ namespace Ogre
         PixelBox* pixbox = OGRE_NEW PixelBox(static_cast<uint32>(widenedRect.width()),
                                              static_cast<uint32>(widenedRect.height()), 1, PF_BYTE_RGB, pData);
 
+        // Rows are processed in bands in parallel. Points with all 8 neighbours inside
+        // the terrain read the height data directly, only the border ones go through
+        // getPointFromSelfOrNeighbour
+        const int rowsPerTask = 16;
+        int numRows = widenedRect.height();
+        Root::getSingleton().getWorkQueue()->processTasksParallel(
+            (numRows + rowsPerTask - 1) / rowsPerTask, [&](size_t task) {
+                int32 yEnd = std::min(widenedRect.bottom, widenedRect.top + int32(task + 1) * rowsPerTask);
+                for (int32 y = widenedRect.top + int32(task) * rowsPerTask; y < yEnd; ++y)
+                {
+                    // invert the Y to deal with image space
+                    uint8* pRow = pData + (widenedRect.bottom - y - 1) * widenedRect.width() * 3;
+
+                    bool interiorRow = y > 0 && y < mSize - 1;
+                    int32 interiorLeft = interiorRow ? std::max(widenedRect.left, 1) : widenedRect.right;
+                    int32 interiorRight = interiorRow ? std::min(widenedRect.right, mSize - 1) : widenedRect.right;
+
+                    for (int32 x = widenedRect.left; x < interiorLeft; ++x)
+                        calculateNormal(x, y, pRow + (x - widenedRect.left) * 3);
+                    if (interiorLeft < interiorRight)
+                        calculateInteriorNormals(y, interiorLeft, interiorRight,
+                                                 pRow + (interiorLeft - widenedRect.left) * 3);
+                    for (int32 x = std::max(interiorLeft, interiorRight); x < widenedRect.right; ++x)
+                        calculateNormal(x, y, pRow + (x - widenedRect.left) * 3);
+                }
+            });
+
+        finalRect = widenedRect;
+
+        return pixbox;
+    }
+    //---------------------------------------------------------------------
+    void Terrain::calculateNormal(int32 x, int32 y, uint8* pStore) const
+    {
         // Evaluate normal like this
         //  3---2---1
         //  | \ | / |
         //  4---P---0
         //  | / | \ |
         //  5---6---7
+        Vector3 cumulativeNormal = Vector3::ZERO;
 
-        for (int y = widenedRect.top; y < widenedRect.bottom; ++y)
-        {
-            for (int x = widenedRect.left; x < widenedRect.right; ++x)
-            {
-                Vector3 cumulativeNormal = Vector3::ZERO;
-
-                // Build points to sample
-                Vector3 centrePoint;
-                Vector3 adjacentPoints[8];
-                getPointFromSelfOrNeighbour(x  , y,   &centrePoint);
-                getPointFromSelfOrNeighbour(x+1, y,   &adjacentPoints[0]);
-                getPointFromSelfOrNeighbour(x+1, y+1, &adjacentPoints[1]);
-                getPointFromSelfOrNeighbour(x,   y+1, &adjacentPoints[2]);
-                getPointFromSelfOrNeighbour(x-1, y+1, &adjacentPoints[3]);
-                getPointFromSelfOrNeighbour(x-1, y,   &adjacentPoints[4]);
-                getPointFromSelfOrNeighbour(x-1, y-1, &adjacentPoints[5]);
-                getPointFromSelfOrNeighbour(x,   y-1, &adjacentPoints[6]);
-                getPointFromSelfOrNeighbour(x+1, y-1, &adjacentPoints[7]);
-
-                for (int i = 0; i < 8; ++i)
-                {
-                    cumulativeNormal += Math::calculateBasicFaceNormal(centrePoint, adjacentPoints[i], adjacentPoints[(i+1)%8]);
-                }
-
-                // normalise & store normal
-                cumulativeNormal.normalise();
+        // Build points to sample
+        Vector3 centrePoint;
+        Vector3 adjacentPoints[8];
+        getPointFromSelfOrNeighbour(x  , y,   &centrePoint);
+        getPointFromSelfOrNeighbour(x+1, y,   &adjacentPoints[0]);
+        getPointFromSelfOrNeighbour(x+1, y+1, &adjacentPoints[1]);
+        getPointFromSelfOrNeighbour(x,   y+1, &adjacentPoints[2]);
+        getPointFromSelfOrNeighbour(x-1, y+1, &adjacentPoints[3]);
+        getPointFromSelfOrNeighbour(x-1, y,   &adjacentPoints[4]);
+        getPointFromSelfOrNeighbour(x-1, y-1, &adjacentPoints[5]);
+        getPointFromSelfOrNeighbour(x,   y-1, &adjacentPoints[6]);
+        getPointFromSelfOrNeighbour(x+1, y-1, &adjacentPoints[7]);
 
-                // encode as RGB, object space
-                // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
+        for (int i = 0; i < 8; ++i)
+        {
+            cumulativeNormal += Math::calculateBasicFaceNormal(centrePoint, adjacentPoints[i], adjacentPoints[(i+1)%8]);
+        }
 
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX) * 3;
-                *pStore++ = static_cast<uint8>((cumulativeNormal.x + 1.0f) * 0.5f * 255.0f);
-                *pStore++ = static_cast<uint8>((cumulativeNormal.y + 1.0f) * 0.5f * 255.0f);
-                *pStore++ = static_cast<uint8>((cumulativeNormal.z + 1.0f) * 0.5f * 255.0f);
+        // normalise & store normal
+        cumulativeNormal.normalise();
+        storeNormal(cumulativeNormal, pStore);
+    }
+    //---------------------------------------------------------------------
+    void Terrain::calculateInteriorNormals(int32 y, int32 left, int32 right, uint8* pStore) const
+    {
+        // same as calculateNormal, in terrain axes, which are a rotation of the object
+        // axes: offsets to the adjacent points 0 to 7 are (dx * scale, dy * scale, dh)
+        static const float dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+        static const float dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+        const float* below = getHeightData(0, y - 1);
+        const float* row = getHeightData(0, y);
+        const float* above = getHeightData(0, y + 1);
+        float scale = mScale;
 
+        for (int32 x = left; x < right; ++x)
+        {
+            float h = row[x];
+            float dh[8] = {row[x + 1] - h,   above[x + 1] - h, above[x] - h, above[x - 1] - h,
+                           row[x - 1] - h,   below[x - 1] - h, below[x] - h, below[x + 1] - h};
 
+            float nx = 0, ny = 0, nz = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                int j = (i + 1) % 8;
+                float ax = dx[i] * scale, ay = dy[i] * scale;
+                float bx = dx[j] * scale, by = dy[j] * scale;
+                float cx = ay * dh[j] - dh[i] * by;
+                float cy = dh[i] * bx - ax * dh[j];
+                float cz = ax * by - ay * bx;
+                float invLength = 1 / std::sqrt(cx * cx + cy * cy + cz * cz);
+                nx += cx * invLength;
+                ny += cy * invLength;
+                nz += cz * invLength;
             }
-        }
 
-        finalRect = widenedRect;
-
-        return pixbox;
+            Vector3 normal(nx, ny, nz), objectNormal;
+            normal.normalise();
+            convertTerrainToWorldAxes(mAlign, normal, &objectNormal);
+            storeNormal(objectNormal, pStore);
+            pStore += 3;
+        }
     }
     //---------------------------------------------------------------------
     void Terrain::finaliseNormals(const Ogre::Rect &rect, Ogre::PixelBox *normalsBox)
@@ -3328,11 +3515,22 @@ namespace Ogre
         PixelBox* pixbox = OGRE_NEW PixelBox(static_cast<uint32>(widenedRect.width()),
                                              static_cast<uint32>(widenedRect.height()), 1, PF_L8, pData);
 
+        if (TerrainGlobalOptions::getSingleton().getUseRayCastLightmap())
+            calculateLightmapRayCast(widenedRect, pData);
+        else
+            calculateLightmapSweep(widenedRect, pData);
+
+        return pixbox;
+    }
+    //---------------------------------------------------------------------
+    void Terrain::calculateLightmapRayCast(const Rect& rect, uint8* pData)
+    {
+        const Vector3& lightVec = TerrainGlobalOptions::getSingleton().getLightMapDirection();
         Real heightPad = (getMaxHeight() - getMinHeight()) * 1.0e-3f;
 
-        for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
+        for (long y = rect.top; y < rect.bottom; ++y)
         {
-            for (long x = widenedRect.left; x < widenedRect.right; ++x)
+            for (long x = rect.left; x < rect.right; ++x)
             {
                 float litVal = 1.0f;
 
@@ -3357,18 +3555,141 @@ namespace Ogre
 
                 // encode as L8
                 // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
+                long storeX = x - rect.left;
+                long storeY = rect.bottom - y - 1;
 
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX);
+                uint8* pStore = pData + ((storeY * rect.width()) + storeX);
                 *pStore = (unsigned char)(litVal * 255.0);
 
             }
         }
+    }
+    //---------------------------------------------------------------------
+    bool Terrain::getCascadedHeight(Real x, Real y, float* height) const
+    {
+        long ox = static_cast<long>(std::floor(x)), oy = static_cast<long>(std::floor(y));
+        // the far edge still belongs to this terrain
+        if (x == 1)
+            ox = 0;
+        if (y == 1)
+            oy = 0;
 
-        return pixbox;
+        if (!ox && !oy)
+        {
+            *height = getHeightAtTerrainPosition(x, y);
+            return true;
+        }
+        if (std::abs(ox) > 1 || std::abs(oy) > 1)
+            return false;
 
+        const Terrain* neighbour = mNeighbours[getNeighbourIndex(ox, oy)];
+        if (!neighbour || !neighbour->getHeightData())
+            return false;
 
+        *height = neighbour->getHeightAtTerrainPosition(x - ox, y - oy);
+        return true;
+    }
+    //---------------------------------------------------------------------
+    void Terrain::calculateLightmapSweep(const Rect& rect, uint8* pData)
+    {
+        // Every texel is in shadow if the terrain between it and the light rises above
+        // the ray towards the light. Along a line towards the light that is the case if
+        // the horizon H = max(h(u') - (u - u') * slope) over the samples u' < u exceeds
+        // the height at u, which can be updated incrementally while sweeping the line
+        // away from the light: H(u + step) = max(H(u), h(u)) - step * slope.
+        // Lines are one texel apart, texels between two lines interpolate their horizon.
+        if (rect.width() <= 0 || rect.height() <= 0)
+            return;
+
+        Vector3 toLight = -convertWorldToTerrainAxes(TerrainGlobalOptions::getSingleton().getLightMapDirection());
+        Real horizontalLength = Vector2(toLight.x, toLight.y).length();
+        Real heightPad = (getMaxHeight() - getMinHeight()) * 1.0e-3f;
+        long texels = mLightmapSizeActual - 1;
+
+        auto store = [&](long x, long y, bool lit) {
+            // invert the Y to deal with image space
+            pData[(rect.bottom - y - 1) * rect.width() + x - rect.left] = lit ? 255 : 0;
+        };
+
+        if (horizontalLength <= toLight.length() * 1e-6f)
+        {
+            // light from straight above or below, the ray never meets other terrain
+            for (long y = rect.top; y < rect.bottom; ++y)
+                for (long x = rect.left; x < rect.right; ++x)
+                    store(x, y, toLight.z > 0);
+            return;
+        }
+
+        // sweep along the major axis 'a' of the light direction, lines advance by
+        // 'slope' texels on the minor axis 'b' per texel on 'a'
+        int a = std::abs(toLight.x) >= std::abs(toLight.y) ? 0 : 1;
+        int b = 1 - a;
+        Real slope = toLight[b] / toLight[a];
+        long dir = toLight[a] > 0 ? -1 : 1;
+        long rectMin[2] = {rect.left, rect.top}, rectMax[2] = {rect.right, rect.bottom};
+
+        // horizontal world distance of a step and the height the ray gains over it
+        Real stepLength = mWorldSize / texels * std::sqrt(1 + slope * slope);
+        float stepRise = static_cast<float>(stepLength * toLight.z / horizontalLength);
+        // start as far upstream as the ray cast would look, i.e. one world size into the neighbours
+        long upstreamSteps = static_cast<long>(std::ceil(mWorldSize * horizontalLength / toLight.length() / stepLength));
+        long first = (dir > 0 ? 0 : texels) - dir * upstreamSteps;
+        long last = dir > 0 ? rectMax[a] - 1 : rectMin[a];
+
+        // lines are identified by their intercept on 'b' at a = 0
+        Real i0 = rectMin[b] - slope * rectMin[a], i1 = rectMin[b] - slope * (rectMax[a] - 1);
+        Real i2 = rectMax[b] - 1 - slope * rectMin[a], i3 = rectMax[b] - 1 - slope * (rectMax[a] - 1);
+        long firstLine = static_cast<long>(std::floor(std::min(std::min(i0, i1), std::min(i2, i3))));
+        long numLines = static_cast<long>(std::floor(std::max(std::max(i0, i1), std::max(i2, i3)))) - firstLine + 2;
+        long numColumns = rectMax[a] - rectMin[a];
+
+        // the horizon of every line at every column of the rect
+        const float noHorizon = -std::numeric_limits<float>::max() / 2;
+        std::vector<float> horizons(numLines * numColumns);
+        const long linesPerTask = 64;
+
+        OGRE_LOCK_RW_MUTEX_READ(mNeighbourMutex);
+
+        WorkQueue* queue = Root::getSingleton().getWorkQueue();
+        queue->processTasksParallel((numLines + linesPerTask - 1) / linesPerTask, [&](size_t task) {
+            long end = std::min(numLines, long(task + 1) * linesPerTask);
+            for (long line = task * linesPerTask; line < end; ++line)
+            {
+                float horizon = noHorizon;
+                float* lineHorizons = &horizons[line * numColumns];
+                for (long i = first;; i += dir)
+                {
+                    if (i >= rectMin[a] && i < rectMax[a])
+                        lineHorizons[i - rectMin[a]] = horizon;
+                    if (i == last)
+                        break;
+
+                    Real pos[2];
+                    pos[a] = i;
+                    pos[b] = firstLine + line + slope * i;
+                    float height;
+                    if (getCascadedHeight(pos[0] / texels, pos[1] / texels, &height))
+                        horizon = std::max(horizon, height);
+                    horizon -= stepRise;
+                }
+            }
+        });
+
+        queue->processTasksParallel(rect.height(), [&](size_t row) {
+            long y = rect.top + row;
+            for (long x = rect.left; x < rect.right; ++x)
+            {
+                long p[2] = {x, y};
+                Real line = p[b] - slope * p[a] - firstLine;
+                long l = std::min(static_cast<long>(line), numLines - 2);
+                float t = line - l;
+                const float* h = &horizons[l * numColumns + p[a] - rectMin[a]];
+                float horizon = h[0] + (h[numColumns] - h[0]) * t;
+
+                float height = getHeightAtTerrainPosition(Real(x) / texels, Real(y) / texels);
+                store(x, y, horizon <= height + heightPad);
+            }
+        });
     }
     //---------------------------------------------------------------------
     void Terrain::finaliseLightmap(const Rect& rect, PixelBox* lightmapBox)
@@ -3393,6 +3714,20 @@ namespace Ogre
                 dstBox.bottom = static_cast<uint32>(mLightmapSizeActual - rect.top);
                 mLightmap->getBuffer()->blitFromMemory(*lightmapBox, dstBox);
             }
+
+            // keep the CPU copy the composite map is baked from in sync
+            if (mMaterialGenerator->isCpuCompositeMapEnabled())
+            {
+                if (!mCpuLightmap.getData())
+                {
+                    // one time download of what was calculated so far
+                    mCpuLightmap.create(PF_L8, mLightmapSizeActual, mLightmapSizeActual);
+                    mLightmap->getBuffer()->blitToMemory(mCpuLightmap.getPixelBox());
+                }
+                Box dstBox(static_cast<uint32>(rect.left), static_cast<uint32>(mLightmapSizeActual - rect.bottom),
+                           static_cast<uint32>(rect.right), static_cast<uint32>(mLightmapSizeActual - rect.top));
+                PixelUtil::bulkPixelConversion(*lightmapBox, mCpuLightmap.getPixelBox().getSubVolume(dstBox));
+            }
         }
 
         // delete memory
@@ -3515,8 +3850,9 @@ namespace Ogre
             {
                 // Load cached data
                 mLightmap->getBuffer()->blitFromMemory(mCpuLightmap.getPixelBox());
-                // release CPU copy, don't need it anymore
-                mCpuLightmap.freeMemory();
+                // release CPU copy, unless the composite map is baked from it
+                if (!mMaterialGenerator->isCpuCompositeMapEnabled())
+                    mCpuLightmap.freeMemory();
             }
             else
             {
@@ -3527,6 +3863,11 @@ namespace Ogre
                 memset(pInit, 255, mLightmapSizeActual * mLightmapSizeActual);
                 buf->unlock();
 
+                if (mMaterialGenerator->isCpuCompositeMapEnabled())
+                {
+                    mCpuLightmap.create(PF_L8, mLightmapSizeActual, mLightmapSizeActual);
+                    mCpuLightmap.setTo(ColourValue::White);
+                }
             }
         }
         else if (!mLightMapRequired && mLightmap)
@@ -3534,6 +3875,7 @@ namespace Ogre
             // destroy
             TextureManager::getSingleton().remove(mLightmap);
             mLightmap.reset();
+            mCpuLightmap.freeMemory();
         }
 
     }
@@ -4372,6 +4714,7 @@ namespace Ogre
 
             mQuadTree = OGRE_NEW TerrainQuadTreeNode(this, 0, 0, 0, mSize, mNumLodLevels - 1, 0);
             mQuadTree->prepare();
+            updateHeightBounds(Rect(0, 0, mSize, mSize));
 
             // calculate entire terrain
             Rect rect;
@@ -637,6 +637,20 @@ namespace Ogre
 
     }
     //---------------------------------------------------------------------
+    void TerrainGroup::rayIntersects(const std::vector<Ray>& rays, RayResultList& results,
+                                     Real distanceLimit /* = 0*/) const
+    {
+        const size_t raysPerTask = 64;
+        results.assign(rays.size(), RayResult(false, 0, Vector3::ZERO));
+
+        Root::getSingleton().getWorkQueue()->processTasksParallel(
+            (rays.size() + raysPerTask - 1) / raysPerTask, [&](size_t task) {
+                size_t end = std::min(rays.size(), (task + 1) * raysPerTask);
+                for (size_t i = task * raysPerTask; i < end; ++i)
+                    results[i] = rayIntersects(rays[i], distanceLimit);
+            });
+    }
+    //---------------------------------------------------------------------
     void TerrainGroup::boxIntersects(const AxisAlignedBox& box, TerrainList* resultList) const
     {
         resultList->clear();
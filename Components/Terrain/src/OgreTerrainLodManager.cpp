@@ -32,10 +32,93 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreTerrain.h"
 
+#include <atomic>
+
 namespace Ogre
 {
     const uint32 TerrainLodManager::TERRAINLODDATA_CHUNK_ID = StreamSerialiser::makeIdentifier("TLDA");
-    const uint16 TerrainLodManager::TERRAINLODDATA_CHUNK_VERSION = 1;
+    const uint16 TerrainLodManager::TERRAINLODDATA_CHUNK_VERSION = 2;
+
+    namespace
+    {
+        /// number of values in an independently decodable block of quantised LOD data
+        const uint32 LODDATA_BLOCK_SIZE = 4096;
+
+        /// maps values to the full 16 bit range, rounding up if they must not be underestimated
+        void quantise(const float* data, size_t count, bool roundUp, float& bias, float& scale,
+                      uint16* dst)
+        {
+            float minVal = count ? data[0] : 0, maxVal = minVal;
+            for (size_t i = 1; i < count; ++i)
+            {
+                minVal = std::min(minVal, data[i]);
+                maxVal = std::max(maxVal, data[i]);
+            }
+            bias = minVal;
+            scale = (maxVal - minVal) / 65535.0f;
+            float invScale = scale > 0 ? 1.0f / scale : 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                float q = (data[i] - minVal) * invScale;
+                q = roundUp ? std::ceil(q) : std::floor(q + 0.5f);
+                dst[i] = static_cast<uint16>(std::min(q, 65535.0f));
+            }
+        }
+
+        /** appends the residuals of predicting every value from the previous ones as zigzag
+            encoded varints. Heights are extrapolated linearly, which leaves the curvature of
+            smooth terrain, other data is predicted by the previous value. */
+        void encodeBlock(const uint16* values, size_t count, bool linear, std::vector<uint8>& out)
+        {
+            int32 p1 = 0, p2 = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                int32 v = values[i];
+                int32 r = v - (linear ? 2 * p1 - p2 : p1);
+                p2 = i ? p1 : v;
+                p1 = v;
+                uint32 z = (uint32(r) << 1) ^ uint32(r >> 31);
+                while (z >= 0x80)
+                {
+                    out.push_back(uint8(z | 0x80));
+                    z >>= 7;
+                }
+                out.push_back(uint8(z));
+            }
+        }
+
+        /// inverse of encodeBlock, returns false if the block does not hold count values
+        bool decodeBlock(const uint8* src, const uint8* end, size_t count, bool linear, float bias,
+                         float scale, float* dst)
+        {
+            int32 p1 = 0, p2 = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (src == end)
+                    return false;
+                uint32 z = *src++;
+                if (z & 0x80)
+                {
+                    // residuals of 16 bit values take at most 19 bits, i.e. three bytes
+                    z &= 0x7f;
+                    for (int shift = 7; ; shift += 7)
+                    {
+                        if (src == end || shift > 14)
+                            return false;
+                        uint8 b = *src++;
+                        z |= uint32(b & 0x7f) << shift;
+                        if (!(b & 0x80))
+                            break;
+                    }
+                }
+                int32 v = (linear ? 2 * p1 - p2 : p1) + (int32(z >> 1) ^ -int32(z & 1));
+                p2 = i ? p1 : v;
+                p1 = v;
+                dst[i] = bias + scale * v;
+            }
+            return src == end;
+        }
+    }
 
     TerrainLodManager::TerrainLodManager(Terrain* t, DataStreamPtr& stream)
         : mTerrain(t)
@@ -304,16 +387,101 @@ namespace Ogre
         separateData(terrain->mHeightData, terrain->getSize(), numLodLevels, lods);
         separateData(terrain->mDeltaData, terrain->getSize(), numLodLevels, lods);
 
+        bool quantise = TerrainGlobalOptions::getSingleton().getUseQuantisedHeightData();
         for (int level = numLodLevels - 1; level >=0; level--)
         {
-            stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, TERRAINLODDATA_CHUNK_VERSION);
+            if (quantise)
+            {
+                writeQuantisedLodData(stream, lods[level]);
+                continue;
+            }
+            stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, 1);
             stream.startDeflate();
             stream.write(&(lods[level][0]), lods[level].size());
             stream.stopDeflate();
             stream.writeChunkEnd(TERRAINLODDATA_CHUNK_ID);
         }
     }
+    //---------------------------------------------------------------------
+    void TerrainLodManager::writeQuantisedLodData(StreamSerialiser& stream, const LodData& data)
+    {
+        // first half is height data, second half delta data, see fillBufferAtLod
+        uint32 numValues = static_cast<uint32>(data.size() / 2);
+        uint32 blocksPerHalf = (numValues + LODDATA_BLOCK_SIZE - 1) / LODDATA_BLOCK_SIZE;
+
+        float bias[2], scale[2];
+        std::vector<uint16> values(data.size());
+        quantise(&data[0], numValues, false, bias[0], scale[0], &values[0]);
+        // deltas must not be underestimated, or LOD transitions may pop
+        quantise(&data[numValues], numValues, true, bias[1], scale[1], &values[numValues]);
+
+        std::vector<std::vector<uint8> > blocks(2 * blocksPerHalf);
+        Root::getSingleton().getWorkQueue()->processTasksParallel(
+            blocks.size(),
+            [&](size_t b)
+            {
+                uint32 first = uint32(b % blocksPerHalf) * LODDATA_BLOCK_SIZE;
+                uint32 count = std::min(LODDATA_BLOCK_SIZE, numValues - first);
+                blocks[b].reserve(count);
+                uint32 half = uint32(b / blocksPerHalf);
+                encodeBlock(&values[half * numValues + first], count, half == 0, blocks[b]);
+            });
+
+        std::vector<uint32> blockEnds;
+        uint32 payloadSize = 0;
+        for (const auto& block : blocks)
+        {
+            payloadSize += static_cast<uint32>(block.size());
+            blockEnds.push_back(payloadSize);
+        }
 
+        stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, TERRAINLODDATA_CHUNK_VERSION);
+        stream.write(&numValues);
+        stream.write(&LODDATA_BLOCK_SIZE);
+        stream.write(bias, 2);
+        stream.write(scale, 2);
+        stream.write(blockEnds.data(), blockEnds.size());
+        for (const auto& block : blocks)
+            stream.write(block.data(), block.size());
+        stream.writeChunkEnd(TERRAINLODDATA_CHUNK_ID);
+    }
+    //---------------------------------------------------------------------
+    void TerrainLodManager::readQuantisedLodData(StreamSerialiser& stream, float* data, uint dataSize)
+    {
+        uint32 numValues, blockSize;
+        float bias[2], scale[2];
+        stream.read(&numValues);
+        stream.read(&blockSize);
+        stream.read(bias, 2);
+        stream.read(scale, 2);
+        if (2 * numValues != dataSize || !blockSize)
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Terrain LOD data does not match the terrain size");
+
+        uint32 blocksPerHalf = (numValues + blockSize - 1) / blockSize;
+        std::vector<uint32> blockEnds(2 * blocksPerHalf);
+        stream.read(blockEnds.data(), blockEnds.size());
+        std::vector<uint8> payload(blockEnds.empty() ? 0 : blockEnds.back());
+        stream.read(payload.data(), payload.size());
+
+        // blocks are independent of each other, so decode them in parallel
+        std::atomic<bool> valid(true);
+        Root::getSingleton().getWorkQueue()->processTasksParallel(
+            blockEnds.size(),
+            [&](size_t b)
+            {
+                uint32 half = uint32(b / blocksPerHalf);
+                uint32 first = uint32(b % blocksPerHalf) * blockSize;
+                uint32 start = b ? blockEnds[b - 1] : 0;
+                if (start > blockEnds[b] ||
+                    !decodeBlock(&payload[0] + start, &payload[0] + blockEnds[b],
+                                 std::min(blockSize, numValues - first), half == 0, bias[half], scale[half],
+                                 data + half * numValues + first))
+                    valid = false;
+            });
+        if (!valid)
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Terrain LOD data is corrupt");
+    }
+    //---------------------------------------------------------------------
     void TerrainLodManager::readLodData(uint16 lowerLodBound, uint16 higherLodBound)
     {
         if(!mDataStream) // No file to read from
@@ -350,9 +518,16 @@ namespace Ogre
                 // reach and read the target lod data
                 const StreamSerialiser::Chunk *c = stream.readChunkBegin(TERRAINLODDATA_CHUNK_ID,
                         TERRAINLODDATA_CHUNK_VERSION);
-                stream.startDeflate(c->length);
-                stream.read(lodData, dataSize);
-                stream.stopDeflate();
+                if (c->version > 1)
+                {
+                    readQuantisedLodData(stream, lodData, dataSize);
+                }
+                else
+                {
+                    stream.startDeflate(c->length);
+                    stream.read(lodData, dataSize);
+                    stream.stopDeflate();
+                }
                 stream.readChunkEnd(TERRAINLODDATA_CHUNK_ID);
 
                 fillBufferAtLod(level, lodData, dataSize);
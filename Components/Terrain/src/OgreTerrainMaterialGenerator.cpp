@@ -165,10 +165,9 @@ namespace Ogre
     }
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void TerrainMaterialGenerator::updateCompositeMap(const Terrain* terrain, const Rect& rect)
+    Rect TerrainMaterialGenerator::getCompositeMapImageRect(const Terrain* terrain, const Rect& rect, int32 compSize)
     {
         // convert point-space rect into image space
-        int32 compSize = terrain->getCompositeMap()->getWidth();
         Rect imgRect;
         Vector3 inVec, outVec;
         inVec.x = rect.left;
@@ -182,8 +181,13 @@ namespace Ogre
         imgRect.right = outVec.x * (Real)compSize + 1; 
         imgRect.bottom = (1.0 - outVec.y) * compSize + 1;
 
-        imgRect = imgRect.intersect({0, 0, compSize, compSize});
-
+        return imgRect.intersect({0, 0, compSize, compSize});
+    }
+    //---------------------------------------------------------------------
+    void TerrainMaterialGenerator::updateCompositeMap(const Terrain* terrain, const Rect& rect)
+    {
+        int32 compSize = terrain->getCompositeMap()->getWidth();
+        Rect imgRect = getCompositeMapImageRect(terrain, rect, compSize);
         _renderCompositeMap(compSize, imgRect, terrain->getCompositeMapMaterial(), terrain->getCompositeMap());
     }
 
@@ -38,6 +38,8 @@ THE SOFTWARE.
 #include "OgreRoot.h"
 #include "OgreRenderSystem.h"
 #include "OgreTextureManager.h"
+#include "OgreHardwarePixelBuffer.h"
+#include "OgreWorkQueue.h"
 
 #include "OgreShaderGenerator.h"
 #include "OgreTerrainRTShaderSRS.h"
@@ -51,6 +53,7 @@ namespace Ogre
     TerrainMaterialGeneratorA::TerrainMaterialGeneratorA() :
         mLightmapEnabled(true),
         mCompositeMapEnabled(true),
+        mCpuCompositeMapEnabled(false),
         mReceiveDynamicShadows(true),
         mLowLodShadows(false)
     {
@@ -168,6 +171,13 @@ namespace Ogre
         }
     }
     //---------------------------------------------------------------------
+    void  TerrainMaterialGeneratorA::setCpuCompositeMapEnabled(bool enabled)
+    {
+        mCpuCompositeMapEnabled = enabled;
+        if (!enabled)
+            mCpuLayerTextures.clear();
+    }
+    //---------------------------------------------------------------------
     void  TerrainMaterialGeneratorA::setReceiveDynamicShadowsEnabled(bool enabled)
     {
         if (enabled != mReceiveDynamicShadows)
@@ -452,4 +462,319 @@ namespace Ogre
             static_cast<TerrainSurface*>(surface)->updateParams();
         }
     }
+    //---------------------------------------------------------------------
+    void TerrainMaterialGeneratorA::updateCompositeMap(const Terrain* terrain, const Rect& rect)
+    {
+        bool gpuColourMap = terrain->getGlobalColourMapEnabled() && !terrain->_getCpuColourMap().getData();
+        if (!mCpuCompositeMapEnabled || gpuColourMap)
+        {
+            if (mCpuCompositeMapEnabled)
+                LogManager::getSingleton().logWarning(
+                    "Terrain: the global colour map is only present on the GPU, rendering the composite map there");
+            TerrainMaterialGenerator::updateCompositeMap(terrain, rect);
+            return;
+        }
+
+        const TexturePtr& compositeMap = terrain->getCompositeMap();
+        Rect imgRect = getCompositeMapImageRect(terrain, rect, compositeMap->getWidth());
+        if (imgRect.isNull())
+            return;
+
+        // bake the dirty region only and upload it
+        Image region(PF_BYTE_RGBA, imgRect.width(), imgRect.height());
+        bakeCompositeMap(terrain, imgRect, region.getPixelBox());
+        compositeMap->getBuffer()->blitFromMemory(region.getPixelBox(), Box(imgRect));
+    }
+    //---------------------------------------------------------------------
+    const Image& TerrainMaterialGeneratorA::getCpuLayerTexture(const String& name, Real texelsPerCompositeTexel)
+    {
+        Image& base = mCpuLayerTextures[std::make_pair(name, 0u)];
+        if (!base.getData())
+        {
+            Image src;
+            src.load(name, ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
+            base.create(PF_BYTE_RGBA, src.getWidth(), src.getHeight());
+            PixelUtil::bulkPixelConversion(src.getPixelBox(), base.getPixelBox());
+        }
+
+        // use the mip level the GPU would sample when rendering the composite map
+        texelsPerCompositeTexel *= base.getWidth();
+        uint32 level = 0;
+        while (texelsPerCompositeTexel >= 2 && (base.getWidth() >> level) > 1)
+        {
+            texelsPerCompositeTexel /= 2;
+            ++level;
+        }
+        if (level == 0)
+            return base;
+
+        Image& mip = mCpuLayerTextures[std::make_pair(name, level)];
+        if (!mip.getData())
+        {
+            mip = base;
+            for (uint32 i = 0; i < level; ++i)
+                mip.resize(std::max(mip.getWidth() / 2, 1u), std::max(mip.getHeight() / 2, 1u));
+        }
+        return mip;
+    }
+    //---------------------------------------------------------------------
+    namespace
+    {
+        /// Square tiles the composite map is baked in, in parallel
+        const int32 COMPOSITE_TILE_SIZE = 64;
+        /// Same as in the TerrainSurface shader
+        const float MIN_BLEND_WEIGHT = 0.0039f;
+
+        /// A single channel of a square, image space map, sampled bilinearly with clamping
+        struct CompositeChannel
+        {
+            const uint8* bytes = NULL;
+            const float* floats = NULL;
+            size_t pixelSize = 1;
+            uint32 size = 0;
+
+            bool empty() const { return !bytes && !floats; }
+            float get(uint32 x, uint32 y) const
+            {
+                size_t i = size_t(y) * size + x;
+                return floats ? floats[i] : bytes[i * pixelSize] / 255.0f;
+            }
+            float sample(float u, float v) const
+            {
+                float x = Math::Clamp(u * size - 0.5f, 0.0f, float(size - 1));
+                float y = Math::Clamp(v * size - 0.5f, 0.0f, float(size - 1));
+                uint32 x0 = uint32(x), y0 = uint32(y);
+                uint32 x1 = std::min(x0 + 1, size - 1), y1 = std::min(y0 + 1, size - 1);
+                float fx = x - x0, fy = y - y0;
+                float top = get(x0, y0) + (get(x1, y0) - get(x0, y0)) * fx;
+                float bottom = get(x0, y1) + (get(x1, y1) - get(x0, y1)) * fx;
+                return top + (bottom - top) * fy;
+            }
+        };
+
+        /// Sample a row of a repeating RGBA layer texture into separate channels
+        void sampleLayerRow(const Image& tex, float uvMul, float u0, float du, float v, int32 count,
+                            float* r, float* g, float* b, float* a)
+        {
+            const uint8* data = tex.getData();
+            uint32 w = tex.getWidth(), h = tex.getHeight();
+
+            float y = v * uvMul * h - 0.5f;
+            y -= std::floor(y / h) * h;
+            uint32 y0 = std::min(uint32(y), h - 1);
+            uint32 y1 = (y0 + 1) % h;
+            float fy = y - y0;
+            const uint8* row0 = data + size_t(y0) * w * 4;
+            const uint8* row1 = data + size_t(y1) * w * 4;
+
+            for (int32 i = 0; i < count; ++i)
+            {
+                float x = (u0 + i * du) * uvMul * w - 0.5f;
+                x -= std::floor(x / w) * w;
+                uint32 x0 = std::min(uint32(x), w - 1);
+                uint32 x1 = (x0 + 1) % w;
+                float fx = x - x0;
+                float c[4];
+                for (int k = 0; k < 4; ++k)
+                {
+                    float top = row0[x0 * 4 + k] + (row0[x1 * 4 + k] - row0[x0 * 4 + k]) * fx;
+                    float bottom = row1[x0 * 4 + k] + (row1[x1 * 4 + k] - row1[x0 * 4 + k]) * fx;
+                    c[k] = (top + (bottom - top) * fy) * (1.0f / 255.0f);
+                }
+                r[i] = c[0];
+                g[i] = c[1];
+                b[i] = c[2];
+                a[i] = c[3];
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void TerrainMaterialGeneratorA::bakeCompositeMap(const Terrain* terrain, const Rect& rect, const PixelBox& dst)
+    {
+        const TexturePtr& compositeMap = terrain->getCompositeMap();
+        int32 compSize = compositeMap ? int32(compositeMap->getWidth()) : int32(terrain->getCompositeMapSize());
+        uint8 layerCount = terrain->getLayerCount();
+        OgreAssert(Rect(0, 0, compSize, compSize).intersect(rect) == rect, "rect outside of the composite map");
+        OgreAssert(dst.getWidth() == uint32(rect.width()) && dst.getHeight() == uint32(rect.height()),
+                   "dst must be the size of rect");
+
+        // gather everything on the calling thread, the tiles only read it
+        std::vector<const Image*> textures(layerCount);
+        std::vector<float> uvMuls(layerCount);
+        for (uint8 l = 0; l < layerCount; ++l)
+        {
+            const String& name = terrain->getLayerTextureName(l, 0);
+            uvMuls[l] = terrain->getLayerUVMultiplier(l);
+            if (!name.empty())
+                textures[l] = &getCpuLayerTexture(name, uvMuls[l] / compSize);
+        }
+
+        std::vector<CompositeChannel> weights(layerCount);
+        const auto& blendTextures = terrain->getBlendTextures();
+        for (uint8 l = 1; l < layerCount; ++l)
+        {
+            CompositeChannel& weight = weights[l];
+            if (!blendTextures.empty())
+            {
+                // once created, the blend maps keep an up to date CPU copy
+                TerrainLayerBlendMap* blendMap = const_cast<Terrain*>(terrain)->getLayerBlendMap(l);
+                weight.floats = blendMap->getBlendPointer();
+                weight.size = blendTextures[0]->getWidth();
+            }
+            else if (const Image* packed = terrain->_getCpuBlendMap((l - 1) / 4))
+            {
+                // PF_BYTE_RGBA, one layer per channel. The blend maps only exist once loaded,
+                // so getBlendTextureIndex cannot be used here
+                weight.bytes = packed->getData() + (l - 1) % 4;
+                weight.pixelSize = 4;
+                weight.size = packed->getWidth();
+            }
+        }
+
+        CompositeChannel lightmap;
+        const Image& cpuLightmap = terrain->_getCpuLightmap();
+        if (mLightmapEnabled && cpuLightmap.getData())
+        {
+            lightmap.bytes = cpuLightmap.getData();
+            lightmap.size = cpuLightmap.getWidth();
+        }
+
+        // the global colour map tints the layers, PF_BYTE_RGB
+        CompositeChannel colourMap[3];
+        if (terrain->getGlobalColourMapEnabled())
+        {
+            const Image& cpuColourMap = terrain->_getCpuColourMap();
+            if (!cpuColourMap.getData())
+                OGRE_EXCEPT(Exception::ERR_INVALID_STATE, "the global colour map is only present on the GPU",
+                            "TerrainMaterialGeneratorA::bakeCompositeMap");
+            for (int c = 0; c < 3; ++c)
+            {
+                colourMap[c].bytes = cpuColourMap.getData() + c;
+                colourMap[c].pixelSize = 3;
+                colourMap[c].size = cpuColourMap.getWidth();
+            }
+        }
+
+        const TerrainGlobalOptions& globalopts = TerrainGlobalOptions::getSingleton();
+        const ColourValue& ambient = globalopts.getCompositeMapAmbient();
+        const ColourValue& diffuse = globalopts.getCompositeMapDiffuse();
+        Vector3 toLight = -globalopts.getLightMapDirection();
+        uint32 lastPoint = terrain->getSize() - 1;
+
+        int32 tilesX = (rect.width() + COMPOSITE_TILE_SIZE - 1) / COMPOSITE_TILE_SIZE;
+        int32 tilesY = (rect.height() + COMPOSITE_TILE_SIZE - 1) / COMPOSITE_TILE_SIZE;
+
+        auto bakeTile = [&](size_t tile) {
+            Rect tileRect;
+            tileRect.left = rect.left + int32(tile % tilesX) * COMPOSITE_TILE_SIZE;
+            tileRect.top = rect.top + int32(tile / tilesX) * COMPOSITE_TILE_SIZE;
+            tileRect.right = std::min(tileRect.left + COMPOSITE_TILE_SIZE, rect.right);
+            tileRect.bottom = std::min(tileRect.top + COMPOSITE_TILE_SIZE, rect.bottom);
+            int32 count = tileRect.width();
+            float du = 1.0f / compSize;
+            float u0 = (tileRect.left + 0.5f) * du;
+
+            // normals of the terrain points under the tile, bilinearly interpolated below
+            float pointScale = float(lastPoint) / compSize;
+            uint32 px0 = uint32(tileRect.left * pointScale);
+            uint32 px1 = std::min(uint32(std::ceil(tileRect.right * pointScale)), lastPoint);
+            uint32 py0 = uint32((compSize - tileRect.bottom) * pointScale);
+            uint32 py1 = std::min(uint32(std::ceil((compSize - tileRect.top) * pointScale)), lastPoint);
+            uint32 pointsX = px1 - px0 + 1;
+            std::vector<Vector3> normals(size_t(pointsX) * (py1 - py0 + 1));
+            for (uint32 y = py0; y <= py1; ++y)
+            {
+                for (uint32 x = px0; x <= px1; ++x)
+                {
+                    Vector3 left, right, down, up;
+                    terrain->getPoint(x > 0 ? x - 1 : x, y, &left);
+                    terrain->getPoint(std::min(x + 1, lastPoint), y, &right);
+                    terrain->getPoint(x, y > 0 ? y - 1 : y, &down);
+                    terrain->getPoint(x, std::min(y + 1, lastPoint), &up);
+                    normals[(y - py0) * pointsX + (x - px0)] = (right - left).crossProduct(up - down).normalisedCopy();
+                }
+            }
+
+            float r[COMPOSITE_TILE_SIZE], g[COMPOSITE_TILE_SIZE], b[COMPOSITE_TILE_SIZE], a[COMPOSITE_TILE_SIZE];
+            float tr[COMPOSITE_TILE_SIZE], tg[COMPOSITE_TILE_SIZE], tb[COMPOSITE_TILE_SIZE], ta[COMPOSITE_TILE_SIZE];
+            float lr[COMPOSITE_TILE_SIZE], lg[COMPOSITE_TILE_SIZE], lb[COMPOSITE_TILE_SIZE], w[COMPOSITE_TILE_SIZE];
+            uint8 out[COMPOSITE_TILE_SIZE * 4];
+
+            for (int32 y = tileRect.top; y < tileRect.bottom; ++y)
+            {
+                float v = (y + 0.5f) / compSize;
+
+                // the layers, blended in order like the shader does
+                std::fill(r, r + count, 0.0f);
+                std::fill(g, g + count, 0.0f);
+                std::fill(b, b + count, 0.0f);
+                std::fill(a, a + count, 0.0f);
+                if (layerCount && textures[0])
+                    sampleLayerRow(*textures[0], uvMuls[0], u0, du, v, count, r, g, b, a);
+                for (uint8 l = 1; l < layerCount; ++l)
+                {
+                    if (!textures[l] || weights[l].empty())
+                        continue;
+                    bool visible = false;
+                    for (int32 i = 0; i < count; ++i)
+                    {
+                        float weight = weights[l].sample(u0 + i * du, v);
+                        w[i] = weight < MIN_BLEND_WEIGHT ? 0.0f : weight;
+                        visible = visible || w[i] > 0;
+                    }
+                    if (!visible)
+                        continue;
+                    sampleLayerRow(*textures[l], uvMuls[l], u0, du, v, count, tr, tg, tb, ta);
+                    // separate channels, so this vectorises
+                    for (int32 i = 0; i < count; ++i)
+                    {
+                        r[i] += (tr[i] - r[i]) * w[i];
+                        g[i] += (tg[i] - g[i]) * w[i];
+                        b[i] += (tb[i] - b[i]) * w[i];
+                        a[i] += (ta[i] - a[i]) * w[i];
+                    }
+                }
+
+                // lighting
+                for (int32 i = 0; i < count; ++i)
+                {
+                    float fx = (u0 + i * du) * lastPoint - px0;
+                    float fy = (1.0f - v) * lastPoint - py0;
+                    fx = Math::Clamp(fx, 0.0f, float(px1 - px0));
+                    fy = Math::Clamp(fy, 0.0f, float(py1 - py0));
+                    uint32 x0 = uint32(fx), y0 = uint32(fy);
+                    uint32 x1 = std::min(x0 + 1, px1 - px0), y1 = std::min(y0 + 1, py1 - py0);
+                    fx -= x0;
+                    fy -= y0;
+                    Vector3 n = Math::lerp(Math::lerp(normals[y0 * pointsX + x0], normals[y0 * pointsX + x1], fx),
+                                           Math::lerp(normals[y1 * pointsX + x0], normals[y1 * pointsX + x1], fx), fy);
+                    float lit = std::max(0.0f, float(n.normalisedCopy().dotProduct(toLight)));
+                    if (!lightmap.empty())
+                        lit *= lightmap.sample(u0 + i * du, v);
+                    lr[i] = ambient.r + diffuse.r * lit;
+                    lg[i] = ambient.g + diffuse.g * lit;
+                    lb[i] = ambient.b + diffuse.b * lit;
+                    if (!colourMap[0].empty())
+                    {
+                        lr[i] *= colourMap[0].sample(u0 + i * du, v);
+                        lg[i] *= colourMap[1].sample(u0 + i * du, v);
+                        lb[i] *= colourMap[2].sample(u0 + i * du, v);
+                    }
+                }
+                for (int32 i = 0; i < count; ++i)
+                {
+                    out[i * 4 + 0] = uint8(Math::saturate(r[i] * lr[i]) * 255.0f + 0.5f);
+                    out[i * 4 + 1] = uint8(Math::saturate(g[i] * lg[i]) * 255.0f + 0.5f);
+                    out[i * 4 + 2] = uint8(Math::saturate(b[i] * lb[i]) * 255.0f + 0.5f);
+                    out[i * 4 + 3] = uint8(Math::saturate(a[i]) * 255.0f + 0.5f);
+                }
+                PixelUtil::bulkPixelConversion(
+                    PixelBox(count, 1, 1, PF_BYTE_RGBA, out),
+                    dst.getSubVolume(Box(tileRect.left - rect.left, y - rect.top, tileRect.right - rect.left,
+                                         y - rect.top + 1)));
+            }
+        };
+
+        Root::getSingleton().getWorkQueue()->processTasksParallel(size_t(tilesX) * tilesY, bakeTile);
+    }
 }
@@ -71,6 +71,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     /** A plane.
@@ -102,6 +106,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     /** A not rotated cube.
@@ -166,6 +174,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     /** Abstract operation volume source holding two sources as operants.
@@ -192,6 +204,36 @@ namespace Volume {
         Protected to be callable from child classes.
         */
         CSGOperationSource(void);
+
+        /// Number of values of the second operand evaluated at once by combineValues
+        static const size_t BATCH_SIZE = 64;
+
+        /** Evaluates both operands at many positions and combines their values.
+        @param positions
+            The positions.
+        @param values
+            Receives the combined values.
+        @param count
+            The amount of positions.
+        @param op
+            Combines the values of the first and the second operand.
+        */
+        template<typename Op>
+        void combineValues(const Vector3 *positions, Real *values, size_t count, Op op) const
+        {
+            mA->getValues(positions, values, count);
+            Real valuesB[BATCH_SIZE];
+            for (size_t first = 0; first < count; first += BATCH_SIZE)
+            {
+                size_t num = count - first < BATCH_SIZE ? count - first : BATCH_SIZE;
+                mB->getValues(positions + first, valuesB, num);
+                Real *dst = values + first;
+                for (size_t i = 0; i < num; ++i)
+                {
+                    dst[i] = op(dst[i], valuesB[i]);
+                }
+            }
+        }
     public:
         
         /** Gets the first operator source.
@@ -244,6 +286,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     /** Builds the union between two sources.
@@ -271,6 +317,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     /** Builds the difference between two sources.
@@ -299,6 +349,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     /** Source which does a unary operation to another one.
@@ -359,6 +413,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     /** Scales the given volume source.
@@ -386,6 +444,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
     };
 
     class _OgreVolumeExport CSGNoiseSource: public CSGUnarySource
@@ -464,6 +526,10 @@ namespace Volume {
         /** Overridden from Source.
         */
         Real getValue(const Vector3 &position) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
         
         /** Gets the initial seed.
         @return
@@ -29,6 +29,9 @@ THE SOFTWARE.
 #define __Ogre_Volume_CacheSource_H__
 
 #include "OgreVector.h"
+#include "Threading/OgreThreadHeaders.h"
+
+#include <atomic>
 
 #include "OgreVolumeSource.h"
 #include "OgreVolumePrerequisites.h"
@@ -52,18 +55,77 @@ namespace Volume {
     bool _OgreVolumeExport operator<(const Vector3& a, const Vector3& b);
 
     /** A caching Source.
+
+        Density values and gradients are stored in a hash table. By default it is keyed
+        on the exact positions, so only the very same position hits the cache. Given a
+        quantum, the positions are quantized to a grid instead and positions closer than
+        the quantum share an entry.
+    @par
+        The table is split into shards which lock a mutex for inserts only, lookups are
+        lock free: every slot carries a sequence number that is odd while the slot is
+        written, and a lookup that sees it change counts as a miss. So several Chunks
+        can be prepared concurrently from the same cache.
+    @par
+        The memory use is bounded by the capacity. The slots of a shard are allocated
+        when the first value is stored in it. A key may only be stored in a short window
+        of slots following its hash. When the window is full, a clock hand evicts the
+        first slot that was not read since the hand passed it last.
     */
     class _OgreVolumeExport CacheSource : public Source
     {
     protected:
-        
-        /// Map for the cache
-        typedef std::map<Vector3, Vector4> UMapPositionValue;
-        mutable UMapPositionValue mCache;
+
+        /// number of slots a key may be stored in
+        static const uint32 PROBE_LENGTH = 8;
+        /// number of independently locked parts of the table
+        static const uint32 NUM_SHARDS = 16;
+
+        struct Slot
+        {
+            /// odd while the slot is written, 0 if it was never used
+            std::atomic<uint32> sequence;
+            /// set by lookups, cleared by the clock hand
+            std::atomic<uint8> referenced;
+            /// exact or quantized position
+            std::atomic<int64> key[3];
+            /// gradient and density
+            std::atomic<Real> value[4];
+
+            Slot() : sequence(0), referenced(0) {}
+        };
+
+        struct Shard
+        {
+            /// allocated by the first insert
+            std::atomic<Slot*> slots;
+            /// position of the clock hand within the probe window
+            uint32 hand;
+            OGRE_WQ_MUTEX(mutex);
+
+            Shard() : slots(0), hand(0) {}
+            ~Shard() { delete[] slots.load(); }
+        };
+
+        std::unique_ptr<Shard[]> mShards;
+        uint32 mSlotMask;
+        /// 0 to key on the exact positions
+        Real mInvQuantum;
 
         /// The source to cache.
         const Source *mSrc;
-        
+
+        /** Computes the key of a position and hashes it
+        @return
+            false if the quantized position does not fit the key, it is not cached then
+        */
+        bool getKey(const Vector3 &position, int64 key[3], uint32 &hash) const;
+
+        /// Looks up a key, returns false if it is not cached
+        bool lookup(const int64 key[3], uint32 hash, Vector4 &result) const;
+
+        /// Stores the value of a key, evicting another one if needed
+        void insert(const int64 key[3], uint32 hash, const Vector4 &value) const;
+
         /** Gets a density value and gradient from the cache.
         @param position
             The position of the density value and gradient.
@@ -72,16 +134,15 @@ namespace Volume {
         */
         inline Vector4 getFromCache(const Vector3 &position) const
         {
+            int64 key[3];
+            uint32 hash;
+            if (!getKey(position, key, hash))
+                return mSrc->getValueAndGradient(position);
             Vector4 result;
-            std::map<Vector3, Vector4>::iterator it = mCache.find(position);
-            if (it == mCache.end())
+            if (!lookup(key, hash, result))
             {
                 result = mSrc->getValueAndGradient(position);
-                mCache[position] = result;
-            }
-            else
-            {
-                result = it->second;
+                insert(key, hash, result);
             }
             return result;
         }
@@ -91,8 +152,16 @@ namespace Volume {
         /** Constructor.
         @param src
             The source to cache.
+        @param quantum
+            The grid spacing positions are quantized to, positions closer than this share
+            their cached value. The default of 0 caches the exact positions, as the
+            Chunks evaluate the source at the same grid corners over and over.
+        @param capacity
+            The maximum number of cached values, rounded up to a power of two. The default
+            holds the 33^3 corners of a 32^3 cell grid with room to spare, in about 3 MB
+            once every shard is in use.
         */
-        CacheSource(const Source *src);
+        CacheSource(const Source *src, Real quantum = 0, size_t capacity = 1 << 16);
         
         /** Overridden from Source.
         */
@@ -102,6 +171,13 @@ namespace Volume {
         */
         Real getValue(const Vector3 &position) const override;
 
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
+
+        /// Gets the maximum number of cached values
+        size_t getCapacity(void) const { return size_t(NUM_SHARDS) * (mSlotMask + 1); }
+
     };
     /** @} */
     /** @} */
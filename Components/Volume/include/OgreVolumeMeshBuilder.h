@@ -138,9 +138,13 @@ namespace Volume {
         /// The buffer binding.
         static const unsigned short MAIN_BINDING;
 
-        /// Map to get a vertex index.
-        typedef std::map<Vertex, uint32> UMapVertexIndex;
-        UMapVertexIndex mIndexMap;
+        /** Open addressing table to find the index of a known vertex, holding the index + 1
+            and 0 for free slots. Vertices are compared bitwise, like operator< does.
+        */
+        VecIndices mIndexTable;
+
+        /// Size of mIndexTable - 1, the size being a power of two.
+        uint32 mIndexMask;
 
          /// Holds the vertices of the mesh.
         VecVertex mVertices;
@@ -153,6 +157,19 @@ namespace Volume {
 
         /// Holds whether the initial bounding box has been set
         bool mBoxInit;
+
+        /** Doubles the size of the index table and reinserts the known vertices.
+        */
+        void growIndexTable(void);
+
+        /** Gets the index table slot where the search for a vertex starts.
+        @param v
+            The vertex.
+        */
+        inline uint32 getIndexSlot(const Vertex &v) const
+        {
+            return FastHash((const char*)&v, sizeof(Vertex)) & mIndexMask;
+        }
         
         /** Adds a vertex to the data structure, reusing the index if it is already known.
         @param v
@@ -160,20 +177,29 @@ namespace Volume {
         */
         inline void addVertex(const Vertex &v)
         {
-            uint32 i = 0;
-            if (mIndexMap.find(v) == mIndexMap.end())
+            // Keep the table at most half full, so the probe sequences stay short.
+            if (mVertices.size() * 2 >= mIndexTable.size())
             {
-                i = mVertices.size();
-                mIndexMap[v] = i;
-                mVertices.push_back(v);
-
-                // Update bounding box
-                mBox.merge(Vector3(v.x, v.y, v.z));
+                growIndexTable();
             }
-            else
+
+            uint32 slot = getIndexSlot(v);
+            while (uint32 entry = mIndexTable[slot])
             {
-                i = mIndexMap[v];
+                if (memcmp(&mVertices[entry - 1], &v, sizeof(Vertex)) == 0)
+                {
+                    mIndices.push_back(entry - 1);
+                    return;
+                }
+                slot = (slot + 1) & mIndexMask;
             }
+
+            uint32 i = (uint32)mVertices.size();
+            mIndexTable[slot] = i + 1;
+            mVertices.push_back(v);
+
+            // Update bounding box
+            mBox.merge(Vector3(v.x, v.y, v.z));
             mIndices.push_back(i);
         }
 
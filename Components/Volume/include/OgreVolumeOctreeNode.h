@@ -67,6 +67,18 @@ namespace Volume {
         /// The children of this node.
         OctreeNode **mChildren;
 
+        /// Block allocator for the nodes of one octree, defined in the source file.
+        class NodePool;
+
+        /// The pool of the octree, shared by all of its nodes once the root got split.
+        NodePool *mPool;
+
+        /// Whether this node created mPool and frees it on destruction, true for the root.
+        bool mOwnsPool;
+
+        /// Whether this node lives in mPool instead of being allocated on its own.
+        bool mPooled;
+
         /// Holds the debug visualization of the octree. Just set in the root.
         Entity* mOctreeGrid;
 
@@ -125,7 +137,8 @@ namespace Volume {
         */
         virtual ~OctreeNode(void);
 
-        /** Factory method to create octree nodes.
+        /** Factory method to create octree nodes. While splitting, the default
+            implementation places the children in a pool owned by the root node.
         @param from
             The back lower left corner of the cell.
         @param to
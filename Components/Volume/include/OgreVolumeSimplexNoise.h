@@ -113,6 +113,20 @@ namespace Volume {
             The noise value.
         */
         Real noise(Real xIn, Real yIn, Real zIn) const;
+
+        /** Adds an octave of noise to many values.
+        @param positions
+            The positions to evaluate the noise at.
+        @param frequency
+            The factor of the positions.
+        @param amplitude
+            The factor of the noise values.
+        @param values
+            The values the noise is added to.
+        @param count
+            The amount of positions.
+        */
+        void addNoise(const Vector3 *positions, Real frequency, Real amplitude, Real *values, size_t count) const;
         
         /** Gets the current seed.
         @return
@@ -101,6 +101,20 @@ namespace Volume {
         */
         virtual Real getValue(const Vector3 &position) const = 0;
 
+        /** Gets the density values at many positions at once.
+
+            The default implementation calls getValue for every position. Sources
+            override it to evaluate their inputs in batches and to process the values
+            in loops the compiler can vectorise.
+        @param positions
+            The positions.
+        @param values
+            Receives the densities, must hold count values.
+        @param count
+            The amount of positions.
+        */
+        virtual void getValues(const Vector3 *positions, Real *values, size_t count) const;
+
         /** Serializes a volume source to a discrete grid file with deflated
         compression. To achieve better compression, all density values are clamped
         within a maximum absolute value of (to - from).length() / 16.0. The values
@@ -30,6 +30,12 @@ THE SOFTWARE.
 namespace Ogre {
 namespace Volume {
 
+    namespace
+    {
+        /// Number of positions CSGScaleSource scales at once
+        const size_t SCALE_BATCH_SIZE = 64;
+    }
+
     Vector3 CSGCubeSource::mBoxNormals[6] = {
         Vector3::UNIT_X,
         Vector3::UNIT_Y,
@@ -69,6 +75,16 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGSphereSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = mR - (positions[i] - mCenter).length();
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGPlaneSource::CSGPlaneSource(const Real d, const Vector3 &normal) : mD(d), mNormal(normal.normalisedCopy())
     {
     }
@@ -96,6 +112,16 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGPlaneSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = mD - mNormal.dotProduct(positions[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGCubeSource::CSGCubeSource(const Vector3 &min, const Vector3 &max)
     {
         mBox.setExtents(min, max);
@@ -127,6 +153,16 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGCubeSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = distanceTo(positions[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGOperationSource::CSGOperationSource(const Source *a, const Source *b) : mA(a), mB(b)
     {
     }
@@ -205,6 +241,13 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGIntersectionSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        combineValues(positions, values, count, [](Real a, Real b) { return a < b ? a : b; });
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGUnionSource::CSGUnionSource(const Source *a, const Source *b) : CSGOperationSource(a, b)
     {
     }
@@ -243,6 +286,13 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGUnionSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        combineValues(positions, values, count, [](Real a, Real b) { return a > b ? a : b; });
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGDifferenceSource::CSGDifferenceSource(const Source *a, const Source *b) : CSGOperationSource(a, b)
     {
     }
@@ -281,6 +331,13 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGDifferenceSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        combineValues(positions, values, count, [](Real a, Real b) { return a < -b ? a : -b; });
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGUnarySource::CSGUnarySource(const Source *src) : mSrc(src)
     {
     }
@@ -333,6 +390,17 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGNegateSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        mSrc->getValues(positions, values, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = -values[i];
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGScaleSource::CSGScaleSource(const Source *src, const Real scale) : CSGUnarySource(src), mScale(scale)
     {
     }
@@ -353,6 +421,26 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGScaleSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        Vector3 scaled[SCALE_BATCH_SIZE];
+        for (size_t first = 0; first < count; first += SCALE_BATCH_SIZE)
+        {
+            size_t num = std::min(SCALE_BATCH_SIZE, count - first);
+            for (size_t i = 0; i < num; ++i)
+            {
+                scaled[i] = positions[first + i] / mScale;
+            }
+            mSrc->getValues(scaled, values + first, num);
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] *= mScale;
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     void CSGNoiseSource::setData(void)
     {
         mGradientOff = fabs(mFrequencies[0]);
@@ -403,6 +491,17 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGNoiseSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        mSrc->getValues(positions, values, count);
+        for (size_t i = 0; i < mNumOctaves; ++i)
+        {
+            mNoise.addNoise(positions, mFrequencies[i], mAmplitudes[i], values, count);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     long CSGNoiseSource::getSeed(void) const
     {
         return mSeed;
@@ -38,10 +38,138 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
-    CacheSource::CacheSource(const Source *src) : mSrc(src)
+    CacheSource::CacheSource(const Source *src, Real quantum, size_t capacity) :
+        mInvQuantum(quantum > 0 ? (Real)1.0 / quantum : 0), mSrc(src)
     {
+        uint32 slotsPerShard = PROBE_LENGTH;
+        while (size_t(slotsPerShard) * NUM_SHARDS < capacity)
+            slotsPerShard <<= 1;
+        mSlotMask = slotsPerShard - 1;
+
+        mShards.reset(new Shard[NUM_SHARDS]);
     }
-    
+
+    //-----------------------------------------------------------------------
+
+    bool CacheSource::getKey(const Vector3 &position, int64 key[3], uint32 &hash) const
+    {
+        // quantized coordinates beyond this are not cached
+        const Real keyLimit = Real(int64(1) << 62);
+
+        hash = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (mInvQuantum > 0)
+            {
+                Real quantized = std::floor(position[i] * mInvQuantum + (Real)0.5);
+                // also rejects NaN
+                if (!(std::abs(quantized) < keyLimit))
+                    return false;
+                key[i] = static_cast<int64>(quantized);
+            }
+            else
+            {
+                // the bits of the coordinate, as the former map compared them
+                Real coord = position[i];
+                int64 bits = 0;
+                memcpy(&bits, &coord, sizeof(Real));
+                key[i] = bits;
+            }
+            hash = (hash ^ uint32(key[i]) ^ uint32(uint64(key[i]) >> 32)) * 0x9E3779B1u;
+        }
+        hash ^= hash >> 16;
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool CacheSource::lookup(const int64 key[3], uint32 hash, Vector4 &result) const
+    {
+        const Shard &shard = mShards[hash % NUM_SHARDS];
+        Slot *slots = shard.slots.load(std::memory_order_acquire);
+        if (!slots)
+            return false;
+        for (uint32 i = 0; i < PROBE_LENGTH; ++i)
+        {
+            Slot &slot = slots[((hash >> 4) + i) & mSlotMask];
+            uint32 sequence = slot.sequence.load(std::memory_order_acquire);
+            // keys are stored in the first free slot of the window and never removed
+            if (!sequence)
+                return false;
+            if ((sequence & 1) || slot.key[0].load(std::memory_order_relaxed) != key[0] ||
+                slot.key[1].load(std::memory_order_relaxed) != key[1] ||
+                slot.key[2].load(std::memory_order_relaxed) != key[2])
+                continue;
+
+            Vector4 value(slot.value[0].load(std::memory_order_relaxed),
+                          slot.value[1].load(std::memory_order_relaxed),
+                          slot.value[2].load(std::memory_order_relaxed),
+                          slot.value[3].load(std::memory_order_relaxed));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // overwritten while reading
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+                return false;
+
+            // avoid writing to the shared cache line if possible
+            if (!slot.referenced.load(std::memory_order_relaxed))
+                slot.referenced.store(1, std::memory_order_relaxed);
+            result = value;
+            return true;
+        }
+        return false;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void CacheSource::insert(const int64 key[3], uint32 hash, const Vector4 &value) const
+    {
+        Shard &shard = mShards[hash % NUM_SHARDS];
+        OGRE_WQ_LOCK_MUTEX(shard.mutex);
+
+        Slot *slots = shard.slots.load(std::memory_order_relaxed);
+        if (!slots)
+        {
+            slots = new Slot[mSlotMask + 1];
+            shard.slots.store(slots, std::memory_order_release);
+        }
+
+        uint32 first = hash >> 4;
+        Slot *target = 0;
+        for (uint32 i = 0; i < PROBE_LENGTH && !target; ++i)
+        {
+            Slot &slot = slots[(first + i) & mSlotMask];
+            // another thread may have inserted the key meanwhile
+            if (!slot.sequence.load(std::memory_order_relaxed) ||
+                (slot.key[0].load(std::memory_order_relaxed) == key[0] &&
+                 slot.key[1].load(std::memory_order_relaxed) == key[1] &&
+                 slot.key[2].load(std::memory_order_relaxed) == key[2]))
+                target = &slot;
+        }
+
+        // the window is full, give recently read slots a second chance
+        for (uint32 i = 0; !target; ++i)
+        {
+            Slot &slot = slots[(first + shard.hand) & mSlotMask];
+            shard.hand = (shard.hand + 1) % PROBE_LENGTH;
+            if (i < PROBE_LENGTH && slot.referenced.load(std::memory_order_relaxed))
+                slot.referenced.store(0, std::memory_order_relaxed);
+            else
+                target = &slot;
+        }
+
+        uint32 sequence = target->sequence.load(std::memory_order_relaxed);
+        target->sequence.store(sequence | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < 3; ++i)
+            target->key[i].store(key[i], std::memory_order_relaxed);
+        for (int i = 0; i < 4; ++i)
+            target->value[i].store(value[i], std::memory_order_relaxed);
+        target->referenced.store(1, std::memory_order_relaxed);
+        // skip 0 on wrap around, it marks unused slots
+        sequence = (sequence | 1) + 1;
+        target->sequence.store(sequence ? sequence : 2, std::memory_order_release);
+    }
+
     //-----------------------------------------------------------------------
 
     Vector4 CacheSource::getValueAndGradient(const Vector3 &position) const
@@ -56,5 +184,13 @@ namespace Volume {
         return getFromCache(position).w;
     }
 
+    //-----------------------------------------------------------------------
+
+    void CacheSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+            values[i] = getFromCache(positions[i]).w;
+    }
+
 }
 }
\ No newline at end of file
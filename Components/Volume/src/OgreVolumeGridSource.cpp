@@ -240,17 +240,24 @@ namespace Volume {
         int yEnd = Math::Clamp(static_cast<int>(scaledCenter.y + radius * mPosYScale), 0, static_cast<int>(mHeight));
         int zStart = Math::Clamp(static_cast<int>(scaledCenter.z - radius * mPosZScale), 0, static_cast<int>(mDepth));
         int zEnd = Math::Clamp(static_cast<int>(scaledCenter.z + radius * mPosZScale), 0, static_cast<int>(mDepth));
-        Vector3 pos;
+        // evaluate a row at a time, every cell only reads its own value
+        std::vector<Vector3> positions(std::max(xEnd - xStart, 0));
+        std::vector<Real> values(positions.size());
         for (int z = zStart; z < zEnd; ++z)
         {
             for (y = yStart; y < yEnd; ++y)
             {
                 for (x = xStart; x < xEnd; ++x)
                 {
+                    Vector3& pos = positions[x - xStart];
                     pos.x = x * worldWidthScale;
                     pos.y = y * worldHeightScale;
                     pos.z = z * worldDepthScale;
-                    value = operation->getValue(pos);
+                }
+                operation->getValues(positions.data(), values.data(), positions.size());
+                for (x = xStart; x < xEnd; ++x)
+                {
+                    value = values[x - xStart];
                     setVolumeGridValue(x, y, z, value);
                 }
             }
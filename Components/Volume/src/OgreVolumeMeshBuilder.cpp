@@ -59,12 +59,30 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
-    MeshBuilder::MeshBuilder(void) : mBoxInit(false)
+    MeshBuilder::MeshBuilder(void) : mIndexMask(0), mBoxInit(false)
     {
     }
 
     //-----------------------------------------------------------------------
 
+    void MeshBuilder::growIndexTable(void)
+    {
+        size_t size = std::max<size_t>(mIndexTable.size() * 2, 1024);
+        mIndexTable.assign(size, 0);
+        mIndexMask = uint32(size - 1);
+        for (uint32 i = 0; i < mVertices.size(); ++i)
+        {
+            uint32 slot = getIndexSlot(mVertices[i]);
+            while (mIndexTable[slot])
+            {
+                slot = (slot + 1) & mIndexMask;
+            }
+            mIndexTable[slot] = i + 1;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
     size_t MeshBuilder::generateBuffers(RenderOperation &operation)
     {
         // Early out if nothing to do.
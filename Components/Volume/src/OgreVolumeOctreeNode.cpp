@@ -38,6 +38,48 @@ namespace Volume {
     const size_t OctreeNode::OCTREE_CHILDREN_COUNT = 8;
     uint32 OctreeNode::mGridPositionCount = 0;
     size_t OctreeNode::mNodeI = 0;
+
+    //-----------------------------------------------------------------------
+
+    /** Hands out memory from large blocks and frees it all at once, so splitting
+        an octree does not go to the allocator for every node.
+    */
+    class OctreeNode::NodePool : public UtilityAlloc
+    {
+    public:
+        /// Size of a block, enough for several hundred nodes.
+        static const size_t BLOCK_SIZE = 64 * 1024;
+
+        NodePool(void) : mUsed(BLOCK_SIZE)
+        {
+        }
+
+        ~NodePool(void)
+        {
+            for (auto block : mBlocks)
+            {
+                OGRE_FREE_SIMD(block, MEMCATEGORY_GENERAL);
+            }
+        }
+
+        void* allocate(size_t bytes)
+        {
+            bytes = (bytes + OGRE_SIMD_ALIGNMENT - 1) & ~size_t(OGRE_SIMD_ALIGNMENT - 1);
+            OgreAssertDbg(bytes <= BLOCK_SIZE, "allocation exceeds the block size");
+            if (mUsed + bytes > BLOCK_SIZE)
+            {
+                mBlocks.push_back((char*)OGRE_MALLOC_SIMD(BLOCK_SIZE, MEMCATEGORY_GENERAL));
+                mUsed = 0;
+            }
+            void* ret = mBlocks.back() + mUsed;
+            mUsed += bytes;
+            return ret;
+        }
+    private:
+        std::vector<char*> mBlocks;
+        /// Bytes used in the last block.
+        size_t mUsed;
+    };
     
     //-----------------------------------------------------------------------
 
@@ -76,7 +118,7 @@ namespace Volume {
     //-----------------------------------------------------------------------
 
     OctreeNode::OctreeNode(const Vector3 &from, const Vector3 &to) : mFrom(from), mTo(to),
-        mChildren(0), mOctreeGrid(0), mCenterValue(0.0, 0.0, 0.0, 0.0)
+        mChildren(0), mPool(0), mOwnsPool(false), mPooled(false), mOctreeGrid(0), mCenterValue(0.0, 0.0, 0.0, 0.0)
     {
     }
     
@@ -88,9 +130,20 @@ namespace Volume {
         {
             for (size_t i = 0; i < OCTREE_CHILDREN_COUNT; ++i)
             {
-                OGRE_DELETE mChildren[i];
+                if (mChildren[i]->mPooled)
+                {
+                    // The memory goes away with the pool.
+                    mChildren[i]->~OctreeNode();
+                }
+                else
+                {
+                    OGRE_DELETE mChildren[i];
+                }
             }
-            delete[] mChildren;
+        }
+        if (mOwnsPool)
+        {
+            OGRE_DELETE mPool;
         }
     }
     
@@ -98,7 +151,13 @@ namespace Volume {
 
     OctreeNode* OctreeNode::createInstance(const Vector3& from, const Vector3& to)
     {
-        return OGRE_NEW OctreeNode(from, to);
+        if (!mPool)
+        {
+            return OGRE_NEW OctreeNode(from, to);
+        }
+        OctreeNode *node = new (mPool->allocate(sizeof(OctreeNode))) OctreeNode(from, to);
+        node->mPooled = true;
+        return node;
     }
     
     //-----------------------------------------------------------------------
@@ -117,23 +176,26 @@ namespace Volume {
               0 == from
               6 == to
             */
-            mChildren = new OctreeNode*[OCTREE_CHILDREN_COUNT];
+            if (!mPool)
+            {
+                mPool = OGRE_NEW NodePool();
+                mOwnsPool = true;
+            }
+            mChildren = (OctreeNode**)mPool->allocate(sizeof(OctreeNode*) * OCTREE_CHILDREN_COUNT);
             mChildren[0] = createInstance(mFrom, newCenter);
-            mChildren[0]->split(splitPolicy, src, geometricError);
             mChildren[1] = createInstance(mFrom + xWidth, newCenter + xWidth);
-            mChildren[1]->split(splitPolicy, src, geometricError);
             mChildren[2] = createInstance(mFrom + xWidth + zWidth, newCenter + xWidth + zWidth);
-            mChildren[2]->split(splitPolicy, src, geometricError);
             mChildren[3] = createInstance(mFrom + zWidth, newCenter + zWidth);
-            mChildren[3]->split(splitPolicy, src, geometricError);
             mChildren[4] = createInstance(mFrom + yWidth, newCenter + yWidth);
-            mChildren[4]->split(splitPolicy, src, geometricError);
             mChildren[5] = createInstance(mFrom + yWidth + xWidth, newCenter + yWidth + xWidth);
-            mChildren[5]->split(splitPolicy, src, geometricError);
             mChildren[6] = createInstance(mFrom + yWidth + xWidth + zWidth, newCenter + yWidth + xWidth + zWidth);
-            mChildren[6]->split(splitPolicy, src, geometricError);
             mChildren[7] = createInstance(mFrom + yWidth + zWidth, newCenter + yWidth + zWidth);
-            mChildren[7]->split(splitPolicy, src, geometricError);
+            for (size_t i = 0; i < OCTREE_CHILDREN_COUNT; ++i)
+            {
+                // Nodes of an overridden createInstance still share the pool for their children.
+                mChildren[i]->mPool = mPool;
+                mChildren[i]->split(splitPolicy, src, geometricError);
+            }
         }
         else
         {
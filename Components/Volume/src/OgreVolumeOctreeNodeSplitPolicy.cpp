@@ -60,14 +60,18 @@ namespace Volume {
         }
 
         // Error metric of http://www.andrew.cmu.edu/user/jessicaz/publication/meshing/
-        Real f000 = mSrc->getValue(from);
-        Real f001 = mSrc->getValue(node->getCorner3());
-        Real f010 = mSrc->getValue(node->getCorner4());
-        Real f011 = mSrc->getValue(node->getCorner7());
-        Real f100 = mSrc->getValue(node->getCorner1());
-        Real f101 = mSrc->getValue(node->getCorner2());
-        Real f110 = mSrc->getValue(node->getCorner5());
-        Real f111 = mSrc->getValue(to);
+        Vector3 corners[8] = {from, node->getCorner3(), node->getCorner4(), node->getCorner7(),
+                              node->getCorner1(), node->getCorner2(), node->getCorner5(), to};
+        Real f[8];
+        mSrc->getValues(corners, f, 8);
+        Real f000 = f[0];
+        Real f001 = f[1];
+        Real f010 = f[2];
+        Real f011 = f[3];
+        Real f100 = f[4];
+        Real f101 = f[5];
+        Real f110 = f[6];
+        Real f111 = f[7];
 
         Vector3 positions[19][2] = {
             {node->getCenterBackBottom(), Vector3((Real)0.5, (Real)0.0, (Real)0.0)},
@@ -232,6 +232,17 @@ namespace Volume {
         return (Real)32.0 * (n0 + n1 + n2 + n3);
     }
     
+    //-----------------------------------------------------------------------
+
+    void SimplexNoise::addNoise(const Vector3 *positions, Real frequency, Real amplitude, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Vector3 &p = positions[i];
+            values[i] += noise(p.x * frequency, p.y * frequency, p.z * frequency) * amplitude;
+        }
+    }
+    
     //-----------------------------------------------------------------------
     
     long SimplexNoise::getSeed(void) const
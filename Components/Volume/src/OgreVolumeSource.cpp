@@ -61,6 +61,16 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
+    void Source::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = getValue(positions[i]);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
     void Source::serialize(const Vector3 &from, const Vector3 &to, float voxelWidth, const String &file)
     {
         Real maxClampedAbsoluteDensity = (from - to).length() / (Real)16.0;
@@ -93,8 +103,9 @@ namespace Volume {
         ser.write<size_t>(&gridHeight);
         ser.write<size_t>(&gridDepth);
 
-        // Go over the volume and write the density data.
-        Vector3 pos;
+        // Go over the volume and write the density data, a column at a time.
+        std::vector<Vector3> positions(gridHeight);
+        std::vector<Real> values(gridHeight);
         Real realVal;
         size_t x;
         size_t y;
@@ -106,10 +117,14 @@ namespace Volume {
             {
                 for (y = 0; y < gridHeight; ++y)
                 {
-                    pos.x = x * voxelWidth + from.x;
-                    pos.y = y * voxelWidth + from.y;
-                    pos.z = z * voxelWidth + from.z;
-                    realVal = Math::Clamp<Real>(getValue(pos), -maxClampedAbsoluteDensity, maxClampedAbsoluteDensity);
+                    positions[y].x = x * voxelWidth + from.x;
+                    positions[y].y = y * voxelWidth + from.y;
+                    positions[y].z = z * voxelWidth + from.z;
+                }
+                getValues(positions.data(), values.data(), gridHeight);
+                for (y = 0; y < gridHeight; ++y)
+                {
+                    realVal = Math::Clamp<Real>(values[y], -maxClampedAbsoluteDensity, maxClampedAbsoluteDensity);
                     buffer[bufferI] = Bitwise::floatToHalf(realVal);
                     bufferI++;
                     if (bufferI == SERIALIZATION_CHUNK_SIZE)
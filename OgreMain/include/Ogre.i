@@ -911,6 +911,7 @@ SHARED_PTR(Mesh);
 %ignore Ogre::SceneManager::getMovableObjectIterator;
 %ignore Ogre::SceneManager::getShadowTextureCount;
 %ignore Ogre::SceneManager::getShadowTextureConfigIterator;
+%ignore Ogre::SceneManager::_getQueryTree;
 %newobject Ogre::SceneManager::createRayQuery(const Ray&, uint32 mask);
 %newobject Ogre::SceneManager::createRayQuery(const Ray&);
 %rename(SceneManager_Listener) Ogre::SceneManager::Listener;
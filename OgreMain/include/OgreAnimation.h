@@ -448,6 +448,20 @@ namespace Ogre {
             object.
         */
         Animation* clone(const String& newName) const OGRE_NODISCARD;
+
+        /** Replaces the node tracks by an AnimationClip, which needs several times less
+            memory and is faster to apply to a Skeleton.
+
+            The tracks are resampled at a uniform rate and quantized, so this is lossy
+            and cannot be undone. A base keyframe, if any, is applied beforehand.
+            The clip is only applied to skeletons, not to nodes associated with tracks.
+        @param samplesPerSecond the rate to resample the node tracks at
+        */
+        void bakeNodeTracks(Real samplesPerSecond);
+        /// The baked node tracks, or NULL if the node tracks have not been baked
+        const AnimationClip* getClip() const { return mClip.get(); }
+        /// Internal method for setting the baked node tracks, takes ownership of the clip
+        void _setClip(AnimationClip* clip);
         
         /** Internal method used to tell the animation that keyframe list has been
             changed, which may cause it to rebuild some internal data */
@@ -534,6 +548,7 @@ namespace Ogre {
         Real mBaseKeyFrameTime;
         String mBaseKeyFrameAnimationName;
         AnimationContainer* mContainer;
+        std::unique_ptr<AnimationClip> mClip;
 
         void optimiseNodeTracks(bool discardIdentityTracks);
         void optimiseVertexTracks(void);
@@ -0,0 +1,161 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __AnimationClip_H__
+#define __AnimationClip_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreAnimation.h"
+#include "OgreQuaternion.h"
+#include "OgreVector.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Animation
+    *  @{
+    */
+    /** Compact, baked representation of the node tracks of a skeletal Animation.
+
+        The node tracks are resampled at a uniform rate, so finding the keys of a time
+        position is a multiplication instead of a search per track. Channels that do not
+        change over the course of the animation are stored once per track, the others
+        as 16 bit keys: translations and scales are quantized to the range of the
+        respective component, rotations use the smallest three encoding with 15 bits per
+        component.
+    @par
+        The keys of all tracks are stored contiguously per frame, so a whole skeleton
+        is sampled with a few linear passes over two frames. Rotations are interpolated
+        with a normalised lerp, which is accurate as long as the sample rate is high
+        enough for the rotation between two frames to be small.
+    @par
+        Clips are created by Animation::bakeNodeTracks or Skeleton::optimiseAllAnimations.
+        Baking is lossy, the original keyframes are discarded.
+    */
+    class _OgreExport AnimationClip : public AnimationAlloc
+    {
+    public:
+        /// Bakes the node tracks of an animation, taking samplesPerSecond samples per second
+        AnimationClip(const Animation* anim, Real samplesPerSecond);
+
+        /// Number of baked node tracks
+        size_t getNumTracks() const { return mTracks.size(); }
+        /// Handle of the bone the track at the given index animates
+        ushort getTrackHandle(size_t index) const { return mTracks[index].handle; }
+        /// Number of uniformly spaced frames, including the first and last one
+        uint32 getNumFrames() const { return mNumFrames; }
+        /// Approximate number of bytes used by the clip
+        size_t getMemoryUsage() const;
+
+        /** Samples all tracks at a time position.
+
+            The arrays must hold getNumTracks elements and receive the values of the
+            tracks in order. The time position is wrapped like in Animation::_getTimeIndex.
+        */
+        void sample(Real timePos, Vector3* translations, Quaternion* rotations, Vector3* scales) const;
+
+        /** Applies the clip to the bones of a skeleton, like NodeAnimationTrack::applyToNode
+            does for the original tracks.
+        @param skel the skeleton to apply to
+        @param timePos the time position
+        @param weight the influence of the animation
+        @param blendMask optional per bone weights, indexed by handle
+        @param scale scale applied to translations and scales
+        @param rim how to blend the rotations with the current orientation of the bones
+        */
+        void apply(Skeleton* skel, Real timePos, Real weight,
+                   const AnimationState::BoneBlendMask* blendMask, Real scale,
+                   Animation::RotationInterpolationMode rim) const;
+    private:
+        friend class SkeletonSerializer;
+
+        AnimationClip() : mLength(0), mFrameRate(0), mNumFrames(0), mFrameStride(0) {}
+
+        enum ChannelFlags
+        {
+            CF_TRANSLATE = 1,
+            CF_ROTATE = 2,
+            CF_SCALE = 4,
+            CF_SHORTEST_PATH = 8
+        };
+        /// number of channel types, in the order translate, rotate, scale
+        static const int NUM_CHANNELS = 3;
+
+        struct Track
+        {
+            ushort handle;
+            /// ChannelFlags, set for animated channels
+            ushort flags;
+            /// values of the channels that are not animated
+            Vector3 translate;
+            Quaternion rotate;
+            Vector3 scale;
+            /// number of animated channels of each type in the preceding tracks
+            uint32 firstChannel[NUM_CHANNELS];
+        };
+
+        struct Frame
+        {
+            const uint16* keys[2];
+            float alpha;
+        };
+
+        /// computes the derived per channel data once mTracks is filled in
+        void buildChannels();
+        Frame getFrame(Real timePos) const;
+        /// samples the tracks [first, first + count), count must not exceed BLOCK_SIZE
+        void sampleBlock(const Frame& frame, size_t first, size_t count,
+                         Vector3* translations, Quaternion* rotations, Vector3* scales) const;
+
+        Real mLength;
+        /// frames per second, 0 for clips with a single frame
+        Real mFrameRate;
+        uint32 mNumFrames;
+        std::vector<Track> mTracks;
+
+        /** Frame major keys, every frame holds the translation components followed by
+            the scale and the rotation components of the animated channels */
+        std::vector<uint16> mKeys;
+        /// decoded translation/ scale component = bias + scale * key
+        std::vector<float> mBias;
+        std::vector<float> mScale;
+
+        // derived data
+        size_t mFrameStride;
+        /// index of the track of every animated channel, per channel type
+        std::vector<ushort> mChannelTracks[NUM_CHANNELS];
+    };
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -185,6 +185,9 @@ namespace Ogre {
         /** Set the auto update state
 
             @copydetails BillboardSet::setAutoUpdate
+            @note Auto updated chains regenerate their vertices whenever rendered, so they are
+            written to the transient buffers of HardwareBufferManagerBase instead of a buffer
+            of their own.
         */
         void setAutoUpdate(bool autoUpdate);
 
@@ -329,6 +332,9 @@ namespace Ogre {
 
         /// Chain segment has no elements
         static const size_t SEGMENT_EMPTY;
+
+        /// Update the contents of the vertex buffer
+        virtual void updateVertexBuffer(Camera* cam);
     private:
         /// Used when mFaceCamera == false; determines the billboard's "normal". i.e.
         /// when the orientation is identity, the billboard is perpendicular to this
@@ -347,8 +353,6 @@ namespace Ogre {
         virtual void setupVertexDeclaration(void);
         /// Setup buffers
         virtual void setupBuffers(void);
-        /// Update the contents of the vertex buffer
-        virtual void updateVertexBuffer(Camera* cam);
         /// Update the contents of the index buffer
         virtual void updateIndexBuffer(void);
         virtual void updateBoundingBox(void) const;
@@ -54,6 +54,8 @@ namespace Ogre {
         /// The billboard set that's doing the rendering
         BillboardSet* mBillboardSet;
         Vector2 mStacksSlices;
+        /// Billboards of the current particles, injected as one batch
+        std::vector<Billboard> mBillboards;
     public:
         BillboardParticleRenderer();
         ~BillboardParticleRenderer();
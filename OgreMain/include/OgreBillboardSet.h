@@ -243,6 +243,14 @@ namespace Ogre {
 
         void genPointVertices(const Billboard& pBillboard);
 
+        /** Internal method, injects count billboards with get(i) returning the i-th one.
+
+            Billboards sharing the axes of the set are culled and generated in batches,
+            split across the threads of the WorkQueue. Others fall back to injectBillboard.
+        */
+        template<typename BillboardAccess>
+        void injectBillboardBatch(size_t count, const BillboardAccess& get);
+
         /** Internal method generates vertex offsets.
 
             Takes in parametric offsets as generated from getParametericOffsets, width and height values
@@ -289,6 +297,8 @@ namespace Ogre {
         bool mExternalData;
         /// Tell if vertex buffer should be update automatically.
         bool mAutoUpdate;
+        /// Write vertices to the transient buffers of HardwareBufferManager when auto updating?
+        bool mUseTransientBuffers;
         /// True if the billboard data changed. Will cause vertex buffer update.
         bool mBillboardDataChanged;
 
@@ -517,6 +527,13 @@ namespace Ogre {
         void beginBillboards(size_t numBillboards = 0);
         /** Define a billboard. */
         void injectBillboard(const Billboard& bb);
+        /** Define many billboards, like calling injectBillboard for each of them.
+
+            Unless the billboards are oriented individually, point rendered or use accurate
+            facing, they are generated in batches, large counts split across worker threads
+            writing disjoint ranges of the vertex buffer.
+        */
+        void injectBillboards(const Billboard* billboards, size_t count);
         /** Finish defining billboards. */
         void endBillboards(void);
         /** Set the bounds of the BillboardSet.
@@ -792,6 +809,19 @@ namespace Ogre {
         /** Return the auto update state of this billboard set.*/
         bool getAutoUpdate(void) const { return mAutoUpdate; }
 
+        /** Sets whether auto updated vertices are written to shared transient buffers.
+
+            Instead of discarding a buffer of its own every update, the set then allocates its
+            vertices with HardwareBufferManagerBase::allocateTransientVertices, so they are only
+            valid for the frame they are generated in. Enabled by default for sets managing their
+            own billboards, which regenerate them whenever they are rendered. When using external
+            data, only enable it if beginBillboards is called every frame the set is rendered.
+            Has no effect unless auto update is on.
+        */
+        void setUseTransientBuffers(bool enabled);
+        /// Gets whether auto updated vertices are written to shared transient buffers
+        bool getUseTransientBuffers(void) const { return mUseTransientBuffers; }
+
         /** When billboard set is not auto updating its GPU buffer, the user is responsible to inform it
             about any billboard changes in order to reflect them at the rendering stage.
             Calling this method will cause GPU buffers update in the next render queue update.
@@ -109,6 +109,16 @@ namespace Ogre
         /** Getter for mManuallyControlled Flag */
         bool isManuallyControlled() const;
 
+        /** Sets whether this bone is of minor importance, like finger or facial bones.
+
+            Minor bones keep their pose instead of being animated when the animation
+            level of detail of the Entity asks for it, see Entity::setAnimationLodLevels.
+            The flag is copied to the SkeletonInstance of an Entity when it is created.
+        */
+        void setMinor(bool minor) { mMinor = minor; }
+        /// Whether this bone is of minor importance
+        bool isMinor() const { return mMinor; }
+
         
         /** Gets the transform which takes bone space to current from the binding pose. 
 
@@ -146,6 +156,8 @@ namespace Ogre
         unsigned short mHandle;
         /** Bones set as manuallyControlled are not reseted in Skeleton::reset() */
         bool mManuallyControlled;
+        /// Whether the bone may be frozen by the animation level of detail
+        bool mMinor;
     };
 
     /** @} */
@@ -357,6 +357,11 @@ namespace Ogre {
         /** All techniques are forced to one weight per vertex. */
         IM_FORCEONEWEIGHT = 0x0020,
 
+        /** Sample all skeletal animations into a static vertex texture shared by all batches,
+        so only the per instance data is updated every frame. Implies IM_VTFBONEMATRIXLOOKUP.
+        @see BaseInstanceBatchVTF::setBakedAnimations */
+        IM_VTFBAKEDANIMATIONS = 0x0040,
+
         IM_USEALL       = IM_USE16BIT|IM_VTFBESTFIT|IM_USEONEWEIGHT
     };
     
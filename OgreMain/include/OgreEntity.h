@@ -222,9 +222,55 @@ namespace Ogre {
         /// Records the last frame in which animation was updated.
         unsigned long mFrameAnimationLastUpdated;
 
+        /// LOD values where the skeleton update rate is reduced, see setAnimationLodLevels
+        std::vector<Real> mAnimationLodValues;
+        /// Index into mAnimationLodValues, calculated by _notifyCurrentCamera
+        ushort mAnimationLodIndex;
+        /// First animation LOD index that freezes minor bones
+        ushort mMinorBonesLodIndex;
+        /// Offsets the frames of reduced rate updates, so they are spread between entities
+        uint32 mAnimationLodPhase;
+        /// Records the last frame in which the skeleton was evaluated with animation LOD
+        unsigned long mFrameAnimationLodEvaluated;
+        /// Decomposed bone matrix, so interpolating it neither shrinks nor shears the joint
+        struct LodBoneTransform
+        {
+            Vector3 position;
+            Vector3 scale;
+            Quaternion orientation;
+        };
+        /// Bone transforms of the previous and the latest evaluation, interpolated in between
+        std::vector<LodBoneTransform> mLodBoneTransforms;
+
         /// Perform all the updates required for an animated entity.
         void updateAnimation(void);
 
+        /// What updateAnimation has to do, as decided by beginAnimationUpdate
+        struct AnimationUpdate
+        {
+            bool hwAnimation;
+            bool softwareAnimation;
+            bool blendNormals;
+            bool animationDirty;
+            bool needUpdateHardwareAnim;
+            /// whether vertex buffers and bone matrices need to be updated
+            bool updateBuffers;
+        };
+        /** First part of updateAnimation.
+
+            Applies vertex animation and checks out the temporary buffers for software
+            skinning, leaving only the bones and the blending to do.
+        @param deferUpload keep the skinned buffers from being uploaded, until they are bound
+            again by bindSkelAnimTempCopies
+        */
+        AnimationUpdate beginAnimationUpdate(bool deferUpload);
+        /// Blends the vertices of the shared and the visible dedicated geometry in software
+        void softwareVertexBlend(bool blendNormals);
+        /// Last part of updateAnimation, updates the attached objects and bone world matrices
+        void endAnimationUpdate(const AnimationUpdate& update);
+        /// Checks out and binds the temporary buffers for software skinning
+        void bindSkelAnimTempCopies(bool blendNormals, bool suppressHardwareUpload);
+
         /// Records the last frame in which the bones was updated.
         /// It's a pointer because it can be shared between different entities with
         /// a shared skeleton.
@@ -242,6 +288,13 @@ namespace Ogre {
         */
         bool cacheBoneMatrices(void);
 
+        /** Updates the bone matrices according to the animation LOD, either by evaluating
+            the skeleton or by interpolating the previous evaluations.
+        @return
+            False if the animation LOD is not in use.
+        */
+        bool updateLodBoneMatrices(unsigned long frameNumber);
+
         /** Flag indicating whether hardware animation is supported by this entities materials
             data is saved per scehme number.
         */
@@ -545,6 +598,34 @@ namespace Ogre {
         */
         void setMaterialLodBias(Real factor, ushort maxDetailIndex = 0, ushort minDetailIndex = 99);
 
+        /** Sets the animation level of detail, which reduces the cost of animating
+            distant entities.
+
+            The LOD strategy of the mesh selects the level from the given values, in the
+            same way as Material::setLodLevels. At level n, the skeleton is only evaluated
+            every n + 1'th frame and the bone matrices are interpolated in between, so the
+            animation trails by up to n frames. Entities evaluate in different frames, so
+            the cost is spread evenly over the frames.
+        @par
+            From level minorBonesLodIndex on, bones flagged with Bone::setMinor keep their
+            pose. Entities sharing their skeleton with other entities are evaluated every
+            frame regardless, objects attached to bones follow the evaluated poses.
+        @par
+            The level is calculated in _notifyCurrentCamera from the LOD camera of the
+            notified camera, so shadow cameras use the level of the main camera. The
+            skeleton is updated once per frame, with the level of the camera notified
+            last before that. With several viewports, this is the first one in the frame
+            that renders the entity.
+        @param lodValues
+            The user values of the mesh LOD strategy (e.g. distances) where each level
+            starts, in increasing order of reduction. An empty list disables the animation LOD.
+        @param minorBonesLodIndex
+            The first level that freezes minor bones.
+        */
+        void setAnimationLodLevels(const std::vector<Real>& lodValues, ushort minorBonesLodIndex = 1);
+        /// The animation LOD level, as calculated for the last camera
+        ushort getAnimationLodIndex() const { return mAnimationLodIndex; }
+
         /** Sets whether the polygon mode of this entire entity may be
             overridden by the camera detail settings.
         */
@@ -724,6 +805,16 @@ namespace Ogre {
         */
         void _updateAnimation(void);
 
+        /** Updates the animation of several entities, like _updateAnimation.
+
+            The skeletons are evaluated and the vertices are blended concurrently on the
+            threads of the WorkQueue, while vertex animation and everything touching the
+            GPU is done on the calling thread. Entities with objects attached to bones or
+            sharing their SkeletonInstance are updated on the calling thread as well.
+        @see SceneManager::setParallelAnimationEnabled
+        */
+        static void _updateAnimations(const std::vector<Entity*>& entities);
+
         /** Tests if any animation applied to this entity.
 
             An entity is animated if any animation state is enabled, or any manual bone
@@ -149,6 +149,73 @@ namespace Ogre {
         OGRE_MUTEX(mTempBuffersMutex);
 
         void _forceReleaseBufferCopies(HardwareVertexBuffer* sourceBuffer);
+
+        /// State of a ring of transient buffer space
+        template<typename BufferPtr> struct TransientRing
+        {
+            BufferPtr buffer;
+            /// bytes handed out from buffer since it was last discarded
+            size_t used;
+            /// mTransientFrame of the last allocation
+            size_t frame;
+            TransientRing() : used(0), frame(0) {}
+        };
+        /// Transient vertex rings by vertex size
+        std::map<size_t, TransientRing<HardwareVertexBufferSharedPtr> > mTransientVertexRings;
+        /// Transient index rings by index type
+        TransientRing<HardwareIndexBufferSharedPtr> mTransientIndexRings[2];
+        /// Counts the calls to _releaseBufferCopies, i.e. frames
+        size_t mTransientFrame;
+        /// Minimum size of a transient buffer in bytes
+        size_t mTransientBufferSize;
+        OGRE_MUTEX(mTransientBuffersMutex);
+
+        /** Reserves bytes in ring, creating a new buffer with create(sizeInBytes) if needed
+            @return the byte offset of the reserved space */
+        template<typename BufferPtr, typename CreateFunc>
+        size_t allocateTransient(TransientRing<BufferPtr>& ring, size_t bytes, size_t alignment,
+                                 HardwareBuffer::LockOptions& lockOptions, const CreateFunc& create);
+    public:
+        /** Space in a shared buffer, only valid for the frame it was allocated in.
+
+            @see allocateTransientVertices
+        */
+        template<typename BufferPtr> struct TransientAllocation
+        {
+            /// Buffer to bind, shared with other allocations
+            BufferPtr buffer;
+            /** First vertex or index of the allocation, to be used as VertexData::vertexStart
+                or IndexData::indexStart */
+            size_t start;
+            /** Option to lock the allocated range with.
+
+                Allocations are never written to twice before the buffer is discarded, so most
+                locks do not need to synchronise with the GPU.
+            */
+            HardwareBuffer::LockOptions lockOptions;
+        };
+        typedef TransientAllocation<HardwareVertexBufferSharedPtr> TransientVertices;
+        typedef TransientAllocation<HardwareIndexBufferSharedPtr> TransientIndices;
+
+        /** Allocates vertices for geometry that is regenerated every frame.
+
+            Instead of every dynamic renderable discarding a buffer of its own each frame,
+            allocations are carved out of a large ring buffer per vertex size, 256 byte aligned.
+            The ring is only discarded when it wraps around at the start of a later frame and
+            grows when a single frame needs more than it holds, so the data stays valid until
+            the frame is rendered. Writing the data and binding the buffer is up to the caller.
+            On managers without GPU buffers the rings are plain system memory arenas.
+        @param vertexSize size of a vertex in bytes
+        @param numVerts number of vertices to allocate
+        */
+        TransientVertices allocateTransientVertices(size_t vertexSize, size_t numVerts);
+        /// Allocates indices for geometry that is regenerated every frame, like allocateTransientVertices
+        TransientIndices allocateTransientIndices(HardwareIndexBuffer::IndexType itype, size_t numIndexes);
+
+        /// Sets the minimum size of each transient ring buffer in bytes, 4 MiB by default
+        void setTransientBufferSize(size_t bytes) { mTransientBufferSize = bytes; }
+        /// Gets the minimum size of each transient ring buffer in bytes
+        size_t getTransientBufferSize(void) const { return mTransientBufferSize; }
     public:
         HardwareBufferManagerBase();
         virtual ~HardwareBufferManagerBase();
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreRenderable.h"
 #include "OgreMovableObject.h"
 #include "OgreMesh.h"
+#include <functional>
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre
@@ -138,6 +139,11 @@ namespace Ogre
         /// When true remove the memory of the IndexData we've created because no one else will
         bool mRemoveOwnIndexData;
 
+        /// Bounding spheres of the instanced entities as consecutive x, y, z and radius arrays
+        std::vector<float>  mCullingSpheres;
+        /// Indices into mInstancedEntities of the entities found by findVisibleEntities
+        std::vector<uint32> mVisibleEntities;
+
         virtual void setupVertices( const SubMesh* baseSubMesh ) = 0;
         virtual void setupIndices( const SubMesh* baseSubMesh ) = 0;
         virtual void createAllInstancedEntities(void);
@@ -157,6 +163,23 @@ namespace Ogre
 
         void updateVisibility(void);
 
+        /** Finds the instanced entities visible from a camera. Gives the same result as calling
+            InstancedEntity::findVisible on each of them, but culls many at a time using
+            OptimisedUtil::cullSpheres and splits large batches across the WorkQueue threads.
+            The entity positions are gathered on the calling thread, which also updates the cached
+            transforms of the visible ones, so that they can be read in parallel afterwards
+            (several entities may be attached to the same node).
+        @param camera The camera to cull against, NULL to only skip the entities not in the scene
+        @return Number of visible entities. Their indices are stored at the start of
+            mVisibleEntities, in ascending order.
+        */
+        size_t findVisibleEntities( Camera *camera );
+
+        /** Calls task with consecutive ranges [begin; end) covering [0; count), in parallel on
+            the WorkQueue threads if there are enough of them
+        */
+        static void processRangesParallel( size_t count, const std::function<void(size_t, size_t)>& task );
+
         /** @see _defragmentBatch */
         void defragmentBatchNoCull( InstancedEntityVec &usedEntities, CustomParamsVec &usedParams );
 
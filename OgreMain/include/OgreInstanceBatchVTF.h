@@ -96,6 +96,17 @@ namespace Ogre
         bool mForceOneWeight;
         bool mUseOneWeight;
 
+        /// First bone matrix set and number of frames of an animation in the baked vertex texture
+        struct BakedAnimation
+        {
+            size_t firstFrame;
+            size_t numFrames;
+        };
+        typedef std::map<String, BakedAnimation> BakedAnimationMap;
+        /// Samples per second of the baked animations, 0 when they are not baked
+        Real mBakedAnimationRate;
+        BakedAnimationMap mBakedAnimations;
+
         /** Clones the base material so it can have it's own vertex texture, and also
             clones it's shadow caster materials, if it has any
         */
@@ -116,9 +127,31 @@ namespace Ogre
         /** Setups the material to use a vertex texture */
         void setupMaterialToUseVTF( TextureType textureType, MaterialPtr &material ) const;
 
+        /** Calculates the layout and the size of the vertex texture */
+        void calculateVertexTextureSize( const SubMesh* baseSubMesh, size_t& texWidth, size_t& texHeight );
+
         /** Creates the vertex texture */
         void createVertexTexture( const SubMesh* baseSubMesh );
 
+        /** Assigns a range of bone matrix sets in the vertex texture to every skeletal animation
+            of the mesh. The first set holds the binding pose.
+        @return the total number of bone matrix sets
+        */
+        size_t createBakedAnimationLayout();
+
+        /** Samples all skeletal animations of the mesh in the layout of the vertex texture
+        @param dst PF_FLOAT32_RGBA box with the size of the vertex texture
+        */
+        void bakeAnimations( const PixelBox& dst );
+
+        /** Returns the bone matrix sets to use for an instance with baked animations: the
+            baked frames around the time position of its enabled animation with the highest
+            weight, or twice the binding pose
+        @param frames the frame before and the frame after the time position
+        @param weight how far the time position lies from frames[0] to frames[1]
+        */
+        void getBakedAnimationFrames( const InstancedEntity* entity, size_t frames[2], float& weight ) const;
+
         /** Creates 2 TEXCOORD semantics that will be used to sample the vertex texture */
         virtual void createVertexSemantics( VertexData *thisVertexData, VertexData *baseVertexData,
                                     const HWBoneIdxVec &hwBoneIdx, const HWBoneWgtVec &hwBoneWgt) = 0;
@@ -172,6 +205,34 @@ namespace Ogre
         */
         bool useBoneMatrixLookup() const { return mUseBoneMatrixLookup; }
 
+        /** Sets whether the skeletal animations are baked into the vertex texture
+
+        When turned on, all skeletal animations of the mesh are sampled into a static vertex
+        texture once per InstanceManager, which all its batches share. Every frame only the
+        per instance data is updated: the texture positions of the two baked frames around the
+        time position of the instance, the interpolation weight between them and the world
+        transform. So skeletons are neither evaluated nor uploaded on the CPU.
+
+        The vertex shader interpolates between the two frames when compiled with
+        @c BAKED_ANIMATION, see the Examples/Instancing/VTF/HW/Baked materials. Other bone
+        matrix lookup shaders work too, but show the frame before without interpolating.
+        Each instance plays its enabled animation with the highest weight, blending several
+        animations is not supported.
+
+        Implies bone matrix lookup, but the instances never share transforms and
+        getMaxLookupTableInstances does not apply.
+        Note this feature only works in VTF_HW for now.
+        This value needs to be set before adding any instanced entities
+        @param enable whether to bake the animations
+        @param samplesPerSecond number of frames baked per second of animation
+        */
+        void setBakedAnimations(bool enable, Real samplesPerSecond = 30);
+
+        /** Tells whether skeletal animations are baked into the vertex texture
+        @see setBakedAnimations()
+        */
+        bool useBakedAnimations() const { return mBakedAnimationRate > 0; }
+
         void setBoneDualQuaternions(bool enable) { assert(mInstancedEntities.empty());
             mUseBoneDualQuaternions = enable; mRowLength = (mUseBoneDualQuaternions ? 2 : 3); }
 
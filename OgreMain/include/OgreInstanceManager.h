@@ -114,6 +114,7 @@ namespace Ogre
         SceneManager*           mSceneManager;
 
         size_t                  mMaxLookupTableInstances;
+        Real                    mBakedAnimationRate;
         unsigned char           mNumCustomParams;       //Number of custom params per instance.
 
         /** Finds a batch with at least one free instanced entity we can use.
@@ -176,6 +177,13 @@ namespace Ogre
         */
         void setMaxLookupTableInstances( size_t maxLookupTableInstances );
 
+        /** Sets the number of frames per second sampled into the vertex texture by techniques
+            supporting baked animations (see @ref IM_VTFBAKEDANIMATIONS).
+            Raises an exception if trying to change it after creating the first InstancedEntity.
+        @param samplesPerSecond New sample rate. Default: 30
+        */
+        void setBakedAnimationSampleRate( Real samplesPerSecond );
+
         /** Sets the number of custom parameters per instance. Some techniques (i.e. HWInstancingBasic)
             support this, but not all of them. They also may have limitations to the max number. All
             instancing implementations assume each instance param is a Vector4 (4 floats).
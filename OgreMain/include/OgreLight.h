@@ -501,6 +501,22 @@ namespace Ogre {
             return _deriveShadowFarClipDistance();
         }
 
+        /** Sets whether the shadow textures of this light may be kept from previous frames.
+
+            If enabled, a shadow texture is only rendered again when its shadow camera,
+            the light or any of the casters in its frustum changed since it was last
+            rendered. Casters that change without moving, like animated entities,
+            particle systems, billboards or instanced entities, count as changed every
+            frame - so this mainly pays off for lights illuminating static scene parts.
+        @note
+            Changes to the materials of the casters or to the geometry of a ManualObject
+            or other custom MovableObject that keeps its bounds are not detected, use
+            SceneManager::invalidateShadowTextureCache after modifying them.
+        */
+        void setShadowTextureCaching(bool enabled) { mShadowTextureCaching = enabled; }
+        /// Gets whether the shadow textures of this light may be kept from previous frames
+        bool getShadowTextureCaching() const { return mShadowTextureCaching; }
+
         /// Set the camera which this light should be relative to, for camera-relative rendering
         void _setCameraRelative(Camera* cam);
 
@@ -618,6 +634,7 @@ namespace Ogre {
         Vector2f mSourceSize;
         LightTypes mLightType;
         bool mOwnShadowFarDist;
+        bool mShadowTextureCaching;
     };
     /** @} */
     /** @} */
@@ -0,0 +1,199 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __LightClusters_H__
+#define __LightClusters_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+#include "OgreQuaternion.h"
+#include "OgreVector.h"
+#include "OgreTexture.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** Grid of view space clusters referencing the lights that may affect them.
+
+        The view frustum of a camera is divided into tiles in the image plane and
+        exponentially spaced depth slices. Every cluster holds the indices of the
+        lights whose range overlaps it, so the lights affecting an object can be found
+        by visiting the few clusters its bounding sphere covers instead of testing
+        every light.
+    @par
+        The SceneManager rebuilds the grid for every camera it renders when
+        SceneManager::setLightClusteringEnabled is set and uses it in
+        SceneManager::_populateLightList. Cluster membership is conservative; lights
+        in the clusters of an object still need an exact range test.
+    @par
+        The per cluster lists are stored contiguously, so they can be uploaded as-is
+        to a buffer or texture for shader based light culling: getClusterRanges holds
+        an (offset, count) pair into getLightIndices per cluster, where the cluster at
+        (x, y, z) is stored at x + tilesX * (y + tilesY * z). Slices are spaced so that
+        a view depth d belongs to slice log(d / near) / log(far / near) * slices.
+    @par
+        With setTexturesEnabled, the grid is also uploaded to textures every build, so
+        shaders can look up the lights of a fragment themselves. See TextureContent for
+        their layout and getTileParams, getSliceParams for the shader constants mapping
+        a view space position to its cluster.
+    */
+    class _OgreExport LightClusters : public SceneMgtAlloc
+    {
+    public:
+        typedef std::pair<uint32, uint32> ClusterRange;
+
+        /// Contents of the exported textures, all of them are 2D
+        enum TextureContent
+        {
+            /// getClusterRanges as PF_R32G32_UINT, tilesX * tilesY texels wide and one row per slice
+            TC_RANGES,
+            /// getLightIndices as PF_R32_UINT, filling rows of 1024 texels one after another
+            TC_INDICES,
+            /** 4 PF_FLOAT32_RGBA texels per light, one light per row: world position and
+                attenuation range (0 for directional lights), diffuse colour times power and
+                spot falloff, constant, linear and quadratic attenuation and cos(inner angle / 2),
+                world direction and cos(outer angle / 2). The cosines are -2 for non spot lights.
+            */
+            TC_LIGHTS,
+            TC_COUNT
+        };
+
+        /// @param name prefix of the exported texture names
+        explicit LightClusters(const String& name = BLANKSTRING);
+        ~LightClusters();
+
+        /** Sets the number of clusters along each axis.
+        @param tilesX, tilesY number of tiles in the image plane
+        @param slices number of depth slices
+        */
+        void setDimensions(uint32 tilesX, uint32 tilesY, uint32 slices);
+        uint32 getTilesX() const { return mDims[0]; }
+        uint32 getTilesY() const { return mDims[1]; }
+        uint32 getSlices() const { return mDims[2]; }
+
+        /** Assigns the lights to the clusters of the camera.
+
+            Light indices refer to the position in lights. Directional lights affect
+            all clusters and are listed in getGlobalLightIndices instead.
+            Cameras with orthographic projection are not supported, in which case
+            the grid is left empty and isValid returns false.
+        */
+        void build(const Camera* camera, const LightList& lights);
+        /// Empties the grid
+        void clear();
+        /// Whether the grid holds the lights of the last build
+        bool isValid() const { return mValid; }
+        /// Number of lights passed to the last build
+        size_t getLightCount() const { return mLightCount; }
+
+        /** Collects the lights whose range may overlap a sphere.
+        @param sphere world space sphere
+        @param indices receives the sorted light indices, including the global ones
+        @return false if the sphere covers so many clusters that testing all lights is
+            cheaper, in which case indices is left unchanged
+        */
+        bool findLights(const Sphere& sphere, std::vector<uint32>& indices) const;
+
+        const std::vector<ClusterRange>& getClusterRanges() const { return mClusterRanges; }
+        const std::vector<uint32>& getLightIndices() const { return mLightIndices; }
+        /// Lights affecting every cluster, i.e. directional ones
+        const std::vector<uint32>& getGlobalLightIndices() const { return mGlobalLights; }
+        /// Lights casting shadows, regardless of their type
+        const std::vector<uint32>& getShadowCasterIndices() const { return mShadowCasters; }
+
+        /// View depth where the last slice ends, anything farther is assigned to it
+        Real getFarDistance() const { return mFar; }
+
+        /** Gets the mapping of view space positions to tiles.
+
+            For a view space position v, the tile is ((v.x / -v.z - p.x) * p.z, (v.y / -v.z - p.y) * p.w)
+        */
+        Vector4f getTileParams() const;
+        /** Gets the mapping of view depths to slices and the tile counts.
+
+            A view depth d belongs to slice log(d / p.x) * p.y. The cluster of tile (x, y) in
+            that slice is the texel (x + p.z * y, slice) of the ranges texture.
+        */
+        Vector4f getSliceParams() const;
+
+        /** Packs the grid as the shader textures expect it
+        @param content the texture to pack
+        @param lights the lights passed to build, used for TC_LIGHTS
+        @param dst receives the texture data
+        */
+        void writeImage(TextureContent content, const LightList& lights, Image& dst) const;
+
+        /** Sets whether the grid is uploaded to textures after every build
+
+            The textures are named after the prefix passed on construction, followed by
+            "/LightClusterRanges", "/LightClusterIndices" and "/LightClusterLights" and
+            are created in the RGN_INTERNAL group, so materials can reference them by name.
+        */
+        void setTexturesEnabled(bool enabled);
+        bool getTexturesEnabled() const { return mTexturesEnabled; }
+        /// Gets an exported texture, NULL until the first upload
+        const TexturePtr& getTexture(TextureContent content) const { return mTextures[content]; }
+        /// Uploads the grid of the last build if textures are enabled
+        void _updateTextures(const LightList& lights);
+    private:
+        /// computes the inclusive cluster range covered by a sphere
+        void getClusterBounds(const Vector3& center, Real radius, uint32 min[3], uint32 max[3]) const;
+
+        uint32 mDims[3];
+
+        Quaternion mInvViewOrientation;
+        Vector3 mViewPosition;
+        /// tangents of the frustum sides: left, right, bottom, top
+        Real mTangents[4];
+        Real mNear;
+        Real mFar;
+        Real mSliceScale;
+
+        std::vector<ClusterRange> mClusterRanges;
+        std::vector<uint32> mLightIndices;
+        std::vector<uint32> mGlobalLights;
+        std::vector<uint32> mShadowCasters;
+        size_t mLightCount;
+        bool mValid;
+
+        String mName;
+        bool mTexturesEnabled;
+        TexturePtr mTextures[TC_COUNT];
+    };
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
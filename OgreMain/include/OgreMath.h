@@ -471,7 +471,7 @@ namespace Ogre
             @return
                 A random number in the range from [0,1].
         */
-        static float UnitRandom() { return mRandProvider ? mRandProvider->getRandomUnit() : rand() / float(RAND_MAX); }
+        static float UnitRandom();
 
         /** Generate a random number within the range provided.
             @param fLow
@@ -490,6 +490,17 @@ namespace Ogre
         static float SymmetricRandom() { return 2.0f * UnitRandom() - 1.0f; }
 
         static void SetRandomValueProvider(RandomValueProvider* provider);
+        /// Gets the provider set with SetRandomValueProvider, NULL if none
+        static RandomValueProvider* GetRandomValueProvider() { return mRandProvider; }
+
+        /** Sets a random value provider for the calling thread only.
+
+            It takes precedence over the one set by SetRandomValueProvider, so code running
+            concurrently can draw from independent, reproducible streams.
+        @param provider the provider to use or NULL to use the global one again
+        @return the provider previously set for the calling thread
+        */
+        static RandomValueProvider* SetThreadRandomValueProvider(RandomValueProvider* provider);
        
         /** Tangent function.
             @param fValue
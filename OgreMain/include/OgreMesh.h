@@ -53,6 +53,7 @@ namespace Ogre {
 
     struct MeshLodUsage;
     class LodStrategy;
+    class TriangleBVH;
 
     /** Resource holding data about 3D mesh.
 
@@ -179,6 +180,8 @@ namespace Ogre {
         bool mEdgeListsBuilt;
         bool mAutoBuildEdgeLists;
 
+        std::unique_ptr<TriangleBVH> mTriangleBVH;
+
         /// Storage of morph animations, lookup by name
         AnimationList mAnimationsList;
         /// The vertex animation type associated with the shared vertex data
@@ -734,6 +737,24 @@ namespace Ogre {
         /** Returns whether this mesh has an attached edge list. */
         bool isEdgeListBuilt(void) const { return mEdgeListsBuilt; }
 
+        /** Return the triangle hierarchy of this mesh, building it if required.
+
+            The hierarchy covers the full detail geometry and is used by precise
+            ray scene queries. It reads back the vertex and index buffers, so they
+            should be shadowed or kept in system memory.
+        @see RaySceneQuery::setPrecise
+        */
+        const TriangleBVH* getTriangleBVH(void);
+
+        /** Destroys and frees the triangle hierarchy of this mesh.
+
+            Call this after modifying the geometry of the full detail level.
+        */
+        void freeTriangleBVH(void);
+
+        /** Returns whether this mesh has a triangle hierarchy built. */
+        bool isTriangleBVHBuilt(void) const { return mTriangleBVH != nullptr; }
+
         /** Prepare matrices for software indexed vertex blend.
 
             This function organise bone indexed matrices to blend indexed matrices,
@@ -72,6 +72,14 @@ namespace Ogre {
         */
         static OptimisedUtil* getImplementation(void) { return msImplementation; }
 
+        typedef std::vector<std::pair<String, OptimisedUtil*> > ImplementationList;
+        /** Gets all implementations the current CPU can run, by name.
+
+            The first entry is always the portable "General" one, which the others
+            must match. Meant for testing and profiling, use getImplementation otherwise.
+        */
+        static ImplementationList getAvailableImplementations(void);
+
         /** Performs software vertex skinning.
         @param srcPosPtr Pointer to source position buffer.
         @param destPosPtr Pointer to destination position buffer.
@@ -204,6 +212,25 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) = 0;
+
+        /** Tests bounding spheres against a set of planes, like Frustum::isVisible does.
+        @param planes The planes to test against, e.g. those of a frustum. A sphere is culled
+            when it lies completely on the negative side of any of them.
+        @param numPlanes Number of planes, at most 6.
+        @param centresX, centresY, centresZ, radii The spheres as separate arrays of their
+            components. A sphere with a negative infinite radius is always culled.
+        @param visibleIndices Receives the indices of the spheres that are not culled, in
+            ascending order. Must have room for numSpheres elements.
+        @param numSpheres Number of spheres to test.
+        @return Number of indices written to visibleIndices.
+        */
+        virtual size_t cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const float* centresX, const float* centresY, const float* centresZ,
+            const float* radii,
+            uint32* visibleIndices,
+            size_t numSpheres) = 0;
     };
 
     /** Returns raw offsetted of the given pointer.
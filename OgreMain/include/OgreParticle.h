@@ -106,6 +106,48 @@ namespace Ogre {
 
         const Radian& getRotation(void) const { return mRotation; }
     };
+
+    /** The active particles of a ParticleSystem as separate arrays, for processing many at once.
+
+        Element i of every array belongs to ParticleSystem::_getActiveParticles()[i]. The arrays are
+        aligned to OGRE_SIMD_ALIGNMENT and padded to a multiple of BATCH_SIZE elements, so loops can
+        always process whole batches, which the compiler turns into SIMD code. The padding holds no
+        particles and may be overwritten.
+    @see ParticleAffector::_affectParticleData
+    */
+    struct ParticleData
+    {
+        /// Number of elements the arrays are padded to a multiple of
+        static const size_t BATCH_SIZE = 8;
+
+        /// Number of active particles
+        size_t count;
+        /// Number of elements in each array, count rounded up to a multiple of BATCH_SIZE
+        size_t paddedCount;
+
+        /// @copydoc Particle::mPosition
+        Real* positionX;
+        Real* positionY;
+        Real* positionZ;
+        /// @copydoc Particle::mDirection
+        Real* directionX;
+        Real* directionY;
+        Real* directionZ;
+        /// @copydoc Particle::mWidth
+        Real* width;
+        /// @copydoc Particle::mHeight
+        Real* height;
+        /// @copydoc Particle::mRotation
+        Real* rotation;
+        /// @copydoc Particle::mRotationSpeed
+        Real* rotationSpeed;
+        /// @copydoc Particle::mTimeToLive
+        Real* timeToLive;
+        /// @copydoc Particle::mTotalTimeToLive
+        Real* totalTimeToLive;
+        /// @copydoc Particle::mColour
+        RGBA* colour;
+    };
     /** @} */
     /** @} */
 }
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreString.h"
 #include "OgreStringInterface.h"
+#include "OgreParticle.h"
 #include "OgreHeaderPrefix.h"
 
 
@@ -110,6 +111,29 @@ namespace Ogre {
         */
         virtual void _affectParticles(ParticleSystem* pSystem, Real timeElapsed) = 0;
 
+        /** Whether this affector implements _affectParticleData.
+
+            If so, the particle system calls _affectParticleData instead of _affectParticles.
+        */
+        virtual bool _supportsParticleData(void) const { return false; }
+
+        /** Same as _affectParticles, but on the active particles stored as separate arrays.
+
+            Consecutive affectors supporting this share one copy of the particles, which is only
+            written back to the Particle instances before the next affector not supporting it, or
+            after moving the particles. This makes the affector loops stream through contiguous
+            arrays rather than following pointers.
+        @param
+            particles The active particles of the system.
+        @param
+            timeElapsed The number of seconds which have elapsed since the last call.
+        */
+        virtual void _affectParticleData(ParticleData& particles, Real timeElapsed)
+                {
+                    (void)particles;
+                    (void)timeElapsed;
+                }
+
         /** Returns the name of the type of affector. 
 
             This property is useful for determining the type of affector procedurally so another
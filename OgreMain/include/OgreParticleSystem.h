@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreStringInterface.h"
 #include "OgreMovableObject.h"
 #include "OgreResourceGroupManager.h"
+#include "OgreParticle.h"
 #include "OgreHeaderPrefix.h"
 
 
@@ -266,6 +267,36 @@ namespace Ogre {
         */
         void _update(Real timeElapsed);
 
+        /** Internal method, performs the part of _update that must run on the main thread.
+
+            Decides whether the system is due for an update and makes sure the renderer, the
+            emitted emitters and the transform of the parent node are ready, so _stepParticles
+            only touches data owned by this system.
+        @param timeElapsed the elapsed time, on return scaled by the speed factor
+        @return false if the system is not updated this time
+        */
+        bool _prepareUpdate(Real& timeElapsed);
+
+        /** Internal method, expires, affects, moves and emits particles.
+
+            Does not call _updateBounds, which must run on the main thread afterwards.
+            Systems prepared with _prepareUpdate can be stepped concurrently, random values
+            are drawn from the stream of the system.
+        */
+        void _stepParticles(Real timeElapsed);
+
+        /** Sets the seed of the random number stream used for updating the system.
+
+            Every system draws from its own stream, so its evolution does not depend on other
+            systems or on the order in which systems are updated. The default seed is derived
+            from the name of the system.
+        @note A provider set with Math::SetRandomValueProvider takes precedence, all systems then
+            draw from it and are updated serially.
+        */
+        void setRandomSeed(uint32 seed);
+        /// Gets the seed of the random number stream
+        uint32 getRandomSeed(void) const { return mRandomSeed; }
+
         /** Returns all active particles in this system.
 
             This method is designed to be used by people providing new ParticleAffector subclasses,
@@ -566,8 +597,11 @@ namespace Ogre {
         Real mTimeSinceLastVisible;
         /// Last frame in which known to be visible
         unsigned long mLastVisibleFrame;
-        /// Controller for time update
-        ControllerFloat* mTimeController;
+        /// Registered with ParticleSystemManager for per frame updates?
+        bool mUpdateRegistered;
+        /// Seed and current state of the random number stream
+        uint32 mRandomSeed;
+        uint32 mRandomState;
         /// Indication whether the emitted emitter pool (= pool with particle emitters that are emitted) is initialised
         bool mEmittedEmitterPoolInitialised;
         /// Used to control if the particle system should emit particles or not.
@@ -623,6 +657,26 @@ namespace Ogre {
         */
         ParticlePool mParticlePool;
 
+        /** Storage of the particles in mParticlePool.
+
+                Every increase of the pool allocates one contiguous block, so affectors and
+                renderers walking the active particles mostly touch consecutive memory.
+        */
+        std::vector<std::unique_ptr<Particle[]>> mParticleBlocks;
+
+        /** The active particles as separate arrays, for the affectors supporting them.
+
+                Filled by the first such affector of an update and written back to the particles
+                before the next affector that does not support it and after applying the motion.
+        */
+        ParticleData mParticleData;
+        /// Storage of the Real arrays of mParticleData
+        aligned_vector<Real> mParticleDataReals;
+        /// Storage of the colours of mParticleData
+        aligned_vector<RGBA> mParticleDataColours;
+        /// Whether mParticleData holds changes not yet written back to the particles
+        bool mParticleDataCurrent;
+
         typedef std::list<ParticleEmitter*> FreeEmittedEmitterList;
         typedef std::list<ParticleEmitter*> ActiveEmittedEmitterList;
         typedef std::vector<ParticleEmitter*> EmittedEmitterList;
@@ -699,6 +753,12 @@ namespace Ogre {
         /** Applies the effects of affectors. */
         void _triggerAffectors(Real timeElapsed);
 
+        /** Copies the active particles into mParticleData. */
+        void gatherParticleData(void);
+
+        /** Copies mParticleData back into the active particles. */
+        void scatterParticleData(void);
+
         /** Sort the particles in the system **/
         void _sortParticles(Camera* cam);
 
@@ -96,6 +96,12 @@ namespace Ogre {
         // Factory instance
         ParticleSystemFactory* mFactory;
 
+        /// Systems attached to a node, updated every frame
+        std::vector<ParticleSystem*> mUpdateSystems;
+        /// Controller driving _updateSystems, exists while mUpdateSystems is not empty
+        ControllerFloat* mTimeController;
+        bool mParallelUpdate;
+
         /// Internal implementation of createSystem
         ParticleSystem* createSystemImpl(const String& name, size_t quota, 
             const String& resourceGroup);
@@ -294,6 +300,25 @@ namespace Ogre {
         */
         void _initialise(void);
 
+        /** Sets whether particle systems are updated concurrently.
+
+            When enabled, the systems due for an update in a frame are stepped in parallel on the
+            threads of the WorkQueue. Their emitters, affectors and renderers must then not modify
+            state shared with other systems. Each system draws from its own random number stream,
+            so the results do not depend on this setting. Disabled by default, and ignored while
+            a provider is set with Math::SetRandomValueProvider.
+        */
+        void setParallelUpdateEnabled(bool enabled) { mParallelUpdate = enabled; }
+        /// Gets whether particle systems are updated concurrently
+        bool isParallelUpdateEnabled(void) const { return mParallelUpdate; }
+
+        /// Internal method, registers a system attached to a node for per frame updates
+        void _addUpdateSystem(ParticleSystem* sys);
+        /// Internal method, unregisters a system added by _addUpdateSystem
+        void _removeUpdateSystem(ParticleSystem* sys);
+        /// Internal method, updates all registered systems
+        void _updateSystems(Real timeElapsed);
+
         typedef MapIterator<ParticleAffectorFactoryMap> ParticleAffectorFactoryIterator;
         typedef MapIterator<ParticleEmitterFactoryMap> ParticleEmitterFactoryIterator;
         typedef MapIterator<ParticleSystemRendererFactoryMap> ParticleRendererFactoryIterator;
@@ -118,6 +118,10 @@ namespace Ogre {
             CPU_FEATURE_FPU             = 1 << 12,
             CPU_FEATURE_PRO             = 1 << 13,
             CPU_FEATURE_HTT             = 1 << 14,
+            CPU_FEATURE_AVX             = 1 << 18,
+            CPU_FEATURE_AVX2            = 1 << 19,
+            CPU_FEATURE_FMA             = 1 << 20,
+            CPU_FEATURE_AVX512F         = 1 << 21,
 #elif OGRE_CPU == OGRE_CPU_ARM          
             CPU_FEATURE_VFP             = 1 << 15,
             CPU_FEATURE_NEON            = 1 << 16,
@@ -86,6 +86,7 @@ namespace Ogre {
     class Angle;
     class AnimableValue;
     class Animation;
+    class AnimationClip;
     class AnimationState;
     class AnimationStateSet;
     class AnimationTrack;
@@ -93,6 +93,8 @@ namespace Ogre {
     struct EntityMeshLodChangedEvent;
     struct EntityMaterialLodChangedEvent;
     class ShadowCasterSceneQueryListener;
+    class SceneQueryTree;
+    class LightClusters;
 
     /** Structure collecting together information about the visible objects
     that have been discovered in a scene.
@@ -594,6 +596,10 @@ namespace Ogre {
         LightInfoList mTestLightInfos; // potentially new list
         ulong mLightsDirtyCounter;
 
+        /// Lights of mLightsAffectingFrustum by view space cluster, NULL if disabled
+        std::unique_ptr<LightClusters> mLightClusters;
+        std::vector<uint32> mClusterLightCandidates;
+
         /// Simple structure to hold MovableObject map and a mutex to go with it.
         struct MovableObjectCollection
         {
@@ -665,6 +671,15 @@ namespace Ogre {
         const std::vector<Camera*>& getShadowTextureCameras();
         bool isShadowTextureConfigDirty() const;
 
+        /** Queues the objects of a shadow texture camera culled ahead of time.
+
+            SceneManagers overriding _findVisibleObjects call this first and skip their own
+            traversal if it returns true, see setShadowTextureParallelCulling.
+        @return false if cam was not culled ahead of time
+        */
+        bool findCulledShadowCameraObjects(Camera* cam, VisibleObjectsBoundsInfo* visibleBounds,
+                                           bool onlyShadowCasters);
+
         /// Internal method for firing the queue start event, returns true if queue is to be skipped
         virtual bool fireRenderQueueStarted(uint8 id, const String& cameraName);
         /// Internal method for firing the queue end event, returns true if queue is to be repeated
@@ -722,6 +737,9 @@ namespace Ogre {
         MovableObjectCollectionMap mMovableObjectCollectionMap;
         NameGenerator mMovableNameGenerator;
 
+        /// Acceleration structure for the default scene queries, NULL if disabled
+        std::unique_ptr<SceneQueryTree> mQueryTree;
+
         /// Flag indicating whether SceneNodes will be rendered as a set of 3 axes
         bool mDisplayNodes;
         std::unique_ptr<DebugDrawer> mDebugDrawer;
@@ -822,6 +840,25 @@ namespace Ogre {
             bool mShadowTextureSelfShadow;
             bool mShadowTextureConfigDirty;
             bool mShadowCasterRenderBackFaces;
+            bool mShadowTextureParallelCulling;
+
+            /// Scene nodes holding objects, in the order SceneNode::_findVisibleObjects visits them
+            std::vector<SceneNode*> mCullingNodes;
+            /// Visible nodes per entry of mShadowTextureCameras, see cullShadowTextureCameras
+            std::vector<std::vector<SceneNode*>> mShadowCameraVisibleNodes;
+            /// The shadow camera currently rendered with the nodes culled ahead of time
+            const Camera* mCulledShadowCamera;
+            size_t mCulledShadowCameraIndex;
+
+            /// State a shadow texture was last rendered with, see Light::setShadowTextureCaching
+            struct ShadowTextureCacheEntry
+            {
+                /// NULL if the texture content must not be reused
+                const Light* light;
+                uint32 hash;
+            };
+            /// One entry per shadow texture
+            std::vector<ShadowTextureCacheEntry> mShadowTextureCache;
 
             ShadowTextureConfigList mShadowTextureConfigList;
 
@@ -945,6 +982,28 @@ namespace Ogre {
                 could be affecting the frustum for a given light.
             */
             const ShadowCasterList& findShadowCastersForLight(const Light* light, const Camera* camera);
+            /** Internal method culling the scene nodes for several shadow texture cameras at once.
+
+                The cameras are processed concurrently on the WorkQueue, against one flat
+                snapshot of the scene graph bounds.
+            @param cameraIndices entries of mShadowTextureCameras to cull for
+            */
+            void cullShadowTextureCameras(const std::vector<size_t>& cameraIndices);
+            /** Internal method rendering the shadow texture of a prepared shadow camera.
+            @param culled whether cullShadowTextureCameras already ran for the camera
+            */
+            void updateShadowTexture(Light* light, size_t iteration, size_t index, bool culled);
+            /** Internal method hashing everything a shadow texture depends on.
+            @return false if the casters may change without notice, so the texture must be rendered
+            */
+            bool getShadowTextureHash(const Light* light, size_t index, uint32& hash) const;
+            /// Forces all shadow textures to be rendered again
+            void invalidateShadowTextureCache() { mShadowTextureCache.clear(); }
+            /// Returns the nodes culled ahead of time for cam or NULL if it has to be culled as usual
+            const std::vector<SceneNode*>* getCulledShadowCameraNodes(const Camera* cam) const
+            {
+                return cam == mCulledShadowCamera ? &mShadowCameraVisibleNodes[mCulledShadowCameraIndex] : NULL;
+            }
             /// Internal method for firing the texture shadows updated event
             void fireShadowTexturesUpdated(size_t numberOfShadowTextures);
             /// Internal method for firing the pre caster texture shadows event
@@ -981,6 +1040,12 @@ namespace Ogre {
         uint32 mVisibilityMask;
         bool mFindVisibleObjects;
 
+        bool mParallelAnimation;
+        /// Whether _findVisibleObjects of _renderScene is running, see _queueAnimationUpdate
+        bool mCollectAnimatedEntities;
+        /// Visible entities whose animation is updated after _findVisibleObjects
+        std::vector<Entity*> mAnimatedEntities;
+
         /// The active renderable visitor class - subclasses could override this
         SceneMgrQueuedRenderableVisitor* mActiveQueuedRenderableVisitor;
         /// Storage for default renderable visitor
@@ -1291,6 +1356,52 @@ namespace Ogre {
         {
             _populateLightList(sn->_getDerivedPosition(), radius, destList, lightMask);
         }
+
+        /** Sets whether lights are assigned to view space clusters.
+
+            By default, _populateLightList tests every light affecting the frustum for
+            every object, which gets expensive with hundreds of lights. When enabled,
+            the lights are assigned to a LightClusters grid once per rendered camera, so
+            only the lights of the clusters an object covers need to be tested.
+            The resulting light lists are the same.
+        */
+        void setLightClusteringEnabled(bool enabled);
+        /** Gets whether lights are assigned to view space clusters. */
+        bool isLightClusteringEnabled() const { return mLightClusters != nullptr; }
+        /** Sets whether the animation of visible entities is updated in parallel.
+
+            By default, each animated Entity evaluates its skeleton and blends its
+            vertices in software while it is added to the render queue. If enabled, the
+            visible entities are collected instead and updated together once the scene
+            was culled, with the skeletons and software skinning spread over the threads
+            of the WorkQueue. This pays off for crowds of skinned characters, especially
+            with stencil shadows or a render system without vertex programs.
+        @note
+            SceneManager listeners called before the scene is rendered must not modify the
+            animation state of visible entities.
+        @see Entity::_updateAnimations
+        */
+        void setParallelAnimationEnabled(bool enabled) { mParallelAnimation = enabled; }
+        /** Gets whether the animation of visible entities is updated in parallel. */
+        bool isParallelAnimationEnabled() const { return mParallelAnimation; }
+        /** Internal method deferring the animation update of a visible entity.
+        @return false if the animation has to be updated right away
+        */
+        bool _queueAnimationUpdate(Entity* entity)
+        {
+            if (!mCollectAnimatedEntities)
+                return false;
+            mAnimatedEntities.push_back(entity);
+            return true;
+        }
+        /** Gets the light clusters of the last rendered camera, or NULL if disabled.
+
+            The light indices refer to _getLightsAffectingFrustum. Use
+            LightClusters::setTexturesEnabled to make the grid available to shaders.
+        */
+        LightClusters* getLightClusters() const { return mLightClusters.get(); }
+        /** Internal method assigning the lights affecting the frustum to the clusters of the camera */
+        void _updateLightClusters(const Camera* camera);
         /// @}
 
         /// @name Scene Nodes
@@ -2511,6 +2622,29 @@ namespace Ogre {
 
         /** Destroys a scene query of any type. */
         void destroyQuery(SceneQuery* query);
+
+        /** Sets whether the default scene queries use a bounding volume hierarchy.
+
+            Without scene partitioning, the default queries test every MovableObject
+            of the scene, the intersection query even every pair of them. When enabled,
+            a dynamic AABB tree over all MovableObjects is maintained instead, which is
+            refitted incrementally as objects move. This pays off if many queries are
+            issued per frame.
+        @note
+            The tree is only refitted when objects move or are (de)attached. Objects
+            whose local bounds change otherwise must call MovableObject::_notifyMoved.
+        @note
+            SceneManagers that implement their own queries are not affected.
+        */
+        void setQueryTreeEnabled(bool enabled);
+        /** Gets whether the default scene queries use a bounding volume hierarchy. */
+        bool isQueryTreeEnabled() const { return mQueryTree != nullptr; }
+
+        /** Internal method returning the refitted query tree, or NULL if disabled. */
+        SceneQueryTree* _getQueryTree();
+
+        /** Internal method to notify the query tree that an object moved */
+        void _notifyMovableObjectMoved(MovableObject* obj);
         /// @}
 
         /// @name Shadow Setup
@@ -2889,6 +3023,36 @@ namespace Ogre {
         /// Gets whether or not texture shadows attempt to self-shadow.
         bool getShadowTextureSelfShadow(void) const
         { return mShadowRenderer.mShadowTextureSelfShadow; }
+
+        /** Sets whether the casters of all shadow textures are culled in parallel.
+
+            By default, each shadow texture camera walks the scene graph on its own while
+            its texture is rendered. If enabled, the scene nodes are culled for all shadow
+            textures of a frame at once, distributed over the threads of the WorkQueue,
+            before the textures are rendered in the usual order. This pays off with many
+            shadow textures, e.g. several lights using PSSM.
+        @note
+            Nodes must not be moved from within ShadowTextureListener::shadowTextureCasterPreViewProj.
+            Changes to the shadow camera made there are detected and fall back to regular
+            culling. Only applies while no DebugDrawer is set.
+        @note
+            The culled nodes are used by the generic SceneManager and the OctreeSceneManager.
+            SceneManagers culling by their own visibility structures, like the portals of the
+            PCZSceneManager or the PVS of the BspSceneManager, ignore them and cull every shadow
+            camera as usual, so there the option only adds the cost of the extra culling pass.
+        */
+        void setShadowTextureParallelCulling(bool enabled)
+        { mShadowRenderer.mShadowTextureParallelCulling = enabled; }
+        /// Gets whether the casters of all shadow textures are culled in parallel
+        bool getShadowTextureParallelCulling(void) const
+        { return mShadowRenderer.mShadowTextureParallelCulling; }
+        /** Forces all shadow textures to be rendered again in the next frame.
+
+            Use this after changes that are not detected by Light::setShadowTextureCaching,
+            like modifying the material of a shadow caster.
+        */
+        void invalidateShadowTextureCache(void)
+        { mShadowRenderer.invalidateShadowTextureCache(); }
         /** Sets the default material to use for rendering shadow casters.
 
             By default shadow casters are rendered into the shadow texture using
@@ -3367,6 +3531,7 @@ namespace Ogre {
         ~DefaultRaySceneQuery();
 
         void execute(RaySceneQueryListener* listener) override;
+        void executeBatch(const Ray* rays, size_t count, std::vector<RaySceneQueryResult>& results) override;
     };
     /** Default implementation of SphereSceneQuery. */
     class _OgreExport DefaultSphereSceneQuery : public SphereSceneQuery
@@ -280,6 +280,12 @@ namespace Ogre {
         MovableObject* movable;
         /// Only relevant for the BSP Scene Manager. The world fragment, or NULL if this is not a fragment result
         SceneQuery::WorldFragment* worldFragment;
+        /// Only set by precise queries. The triangle hit, as index into the index data of the SubMesh
+        uint32 triangle = 0;
+        /// Only set by precise queries. The SubMesh the triangle belongs to
+        ushort subMesh = 0;
+        /// Only set by precise queries. Weights of the second and third triangle vertex at the hit
+        Vector2 barycentric = Vector2::ZERO;
         /// Comparison operator for sorting
         bool operator < (const RaySceneQueryResultEntry& rhs) const
         {
@@ -294,8 +300,17 @@ namespace Ogre {
     {
     protected:
         Ray mRay;
+
+        /// sorts and truncates the results as configured by setSortByDistance
+        void sortResults(RaySceneQueryResult& results) const;
+
+        /** Refines a bounding volume hit to the closest triangle, if precise queries are enabled.
+        @return false if the ray misses all triangles and the entry should be discarded
+        */
+        bool refineResult(const Ray& ray, RaySceneQueryResultEntry& entry) const;
     private:
         bool mSortByDistance;
+        bool mPrecise;
         ushort mMaxResults;
         RaySceneQueryResult mResult;
 
@@ -330,6 +345,25 @@ namespace Ogre {
         /** Gets the maximum number of results returned from the query (only relevant if 
         results are being sorted) */
         virtual ushort getMaxResults(void) const;
+        /** Sets whether Entity results are tested against the triangles of their mesh.
+
+            By default, results are based on bounding volumes only (see setSortByDistance).
+            If enabled, Entity results are only reported if the ray hits one of their triangles,
+            the distance is the one to the closest triangle and the triangle, SubMesh and
+            barycentric coordinates of the hit are filled in the RaySceneQueryResultEntry.
+            Other objects are still reported based on their bounding volumes.
+        @par
+            The triangles are looked up using Mesh::getTriangleBVH, so the vertex and index
+            buffers must be readable. Entities using software animation are tested against
+            their animated geometry, while hardware animated ones are not refined and are
+            reported based on their bounding volumes like other objects.
+        @note
+            This only applies to the collection-returning versions of execute, as the
+            listener version reports the results before they are refined.
+        */
+        void setPrecise(bool precise) { mPrecise = precise; }
+        /// Gets whether Entity results are tested against the triangles of their mesh
+        bool getPrecise(void) const { return mPrecise; }
         /** Executes the query, returning the results back in one list.
 
             This method executes the scene query as configured, gathers the results
@@ -349,6 +383,19 @@ namespace Ogre {
         */
         virtual void execute(RaySceneQueryListener* listener) = 0;
 
+        /** Executes the query for a batch of rays.
+
+            This is equivalent to calling setRay and execute for every ray, with the
+            results sorted and limited as configured by setSortByDistance. However,
+            implementations may trace the rays as packets, which is considerably faster
+            when many rays are cast per frame. The ray set by setRay is not changed
+            and the 'last result' value is not updated.
+        @param rays The rays to trace
+        @param count The number of rays
+        @param results Receives one result list per ray
+        */
+        virtual void executeBatch(const Ray* rays, size_t count, std::vector<RaySceneQueryResult>& results);
+
         /** Gets the results of the last query that was run using this object, provided
             the query was executed using the collection-returning version of execute. 
         */
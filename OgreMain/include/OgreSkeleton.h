@@ -296,8 +296,12 @@ namespace Ogre {
         @see Animation::optimise
         @param
             preservingIdentityNodeTracks If true, don't destroy identity node tracks.
+        @param
+            bakeSamplesPerSecond If positive, the node tracks are baked into compact
+            clips afterwards, see Animation::bakeNodeTracks. This is lossy.
         */
-        virtual void optimiseAllAnimations(bool preservingIdentityNodeTracks = false);
+        virtual void optimiseAllAnimations(bool preservingIdentityNodeTracks = false,
+                                           Real bakeSamplesPerSecond = 0);
 
         /** Allows you to use the animations from another Skeleton object to animate
             this skeleton.
@@ -361,6 +365,12 @@ namespace Ogre {
         /// Are there any manually controlled bones?
         virtual bool hasManualBones(void) const { return !mManualBones.empty(); }
 
+        /** Internal method for keeping the bones flagged with Bone::setMinor in their
+            current pose, neither resetting nor animating them */
+        void _setMinorBonesFrozen(bool frozen) { mMinorBonesFrozen = frozen; }
+        /// Whether bones flagged with Bone::setMinor are kept in their current pose
+        bool _getMinorBonesFrozen() const { return mMinorBonesFrozen; }
+
         /// Map to translate bone handle from one skeleton to another skeleton.
         typedef std::vector<ushort> BoneHandleMap;
 
@@ -437,6 +447,8 @@ namespace Ogre {
         SkeletonAnimationBlendMode mBlendState;
         /// Manual bones dirty?
         bool mManualBonesDirty;
+        /// Keep minor bones in their current pose?
+        bool mMinorBonesFrozen;
         /// Storage of bones, indexed by bone handle
         BoneList mBoneList;
 
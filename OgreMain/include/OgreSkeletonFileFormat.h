@@ -101,6 +101,21 @@ namespace Ogre {
                     // Quaternion rotate            : Rotation to apply at this keyframe
                     // Vector3 translate            : Translation to apply at this keyframe
                     // Vector3 scale                : Scale to apply at this keyframe
+
+            SKELETON_ANIMATION_CLIP = 0x4200,
+            // [Optional] node tracks baked into an AnimationClip, since v14.4
+                // unsigned int numFrames       : Number of uniformly spaced frames
+                // float frameRate              : Frames per second, 0 for a single frame
+                // unsigned short numTracks
+                // Repeating section, one per track
+                    // unsigned short boneIndex : Index of bone to apply to
+                    // unsigned short flags     : Animated channels
+                    // Vector3 translate        : Values of the channels that are not animated
+                    // Quaternion rotate
+                    // Vector3 scale
+                // float bias[3 * (animated translations + animated scales)]
+                // float scale[3 * (animated translations + animated scales)]
+                // unsigned short keys[numFrames * 3 * animated channels]
         SKELETON_ANIMATION_LINK         = 0x5000
         // Link to another skeleton, to re-use its animations
 
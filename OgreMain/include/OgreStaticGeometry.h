@@ -409,6 +409,8 @@ namespace Ogre {
             OGRE_DEPRECATED LODIterator getLODIterator(void);
             /// Get an list of the LODs in this region
             const LODBucketList& getLODBuckets() const { return mLodBucketList; }
+            /// Get the LOD level determined from the last camera
+            ushort getCurrentLod() const { return mCurrentLod; }
             const ShadowRenderableList&
             getShadowVolumeRenderableList(const Light* light, const HardwareIndexBufferPtr& indexBuffer,
                                           size_t& indexBufferUsedSize, float extrusionDistance,
@@ -0,0 +1,123 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __TriangleBVH_H__
+#define __TriangleBVH_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreRenderOperation.h"
+#include "OgreVector.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Math
+    *  @{
+    */
+    /** Bounding volume hierarchy over the triangles of a Mesh.
+
+        This allows ray queries that are accurate at triangle level without testing
+        every triangle of the mesh. The hierarchy is built from the full detail geometry
+        in mesh space and is usually obtained through Mesh::getTriangleBVH, which caches
+        it on the mesh.
+    @par
+        Building reads back the vertex and index buffers, so the mesh should either use
+        shadow buffers or buffers in system memory.
+    */
+    class _OgreExport TriangleBVH : public GeometryAllocatedObject
+    {
+    public:
+        /// Describes the triangle closest to the ray origin
+        struct Hit
+        {
+            /// Distance along the ray
+            Real distance;
+            /// Index of the triangle within its index data
+            uint32 triangle;
+            /// Index of the SubMesh the triangle belongs to
+            ushort subMesh;
+            /// Weights of the second and third vertex, the first one is 1 - x - y
+            Vector2 barycentric;
+        };
+
+        /// Builds the hierarchy over the full detail geometry of the mesh
+        explicit TriangleBVH(const Mesh* mesh);
+
+        /** Finds the closest triangle intersected by a ray given in mesh space.
+
+            Both sides of the triangles are considered.
+        */
+        std::pair<bool, Hit> intersects(const Ray& ray) const;
+
+        /** Finds the closest triangle intersected by a ray, testing every triangle.
+
+            This is meant for geometry that changes every frame, like the vertex data of
+            software animated entities, where building a hierarchy does not pay off.
+            The subMesh member of the result is always 0.
+        */
+        static std::pair<bool, Hit> intersects(const Ray& ray, const VertexData* vertexData,
+                                               const IndexData* indexData,
+                                               RenderOperation::OperationType opType);
+
+        /// Number of triangles in the hierarchy
+        size_t getTriangleCount() const { return mTriangles.size(); }
+        /// Number of nodes in the hierarchy
+        size_t getNodeCount() const { return mNodes.size(); }
+    private:
+        struct Triangle
+        {
+            /// indices into mPositions
+            uint32 v[3];
+            uint32 index;
+            ushort subMesh;
+        };
+
+        struct Node
+        {
+            Vector3f min, max;
+            /// first triangle for leaves, first child for inner nodes
+            uint32 start;
+            /// 0 for inner nodes, whose children are stored at start and start + 1
+            uint32 count;
+        };
+
+        void build(uint32 node, uint32 start, uint32 count, std::vector<Vector3f>& centroids);
+
+        std::vector<Vector3f> mPositions;
+        std::vector<Triangle> mTriangles;
+        std::vector<Node> mNodes;
+    };
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
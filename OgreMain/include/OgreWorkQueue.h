@@ -159,6 +159,16 @@ namespace Ogre
 
         /** Add a new task to the queue */
         virtual void addTask(std::function<void()> task) = 0;
+
+        /** Calls task(i) for every i in [0, count) and waits until all calls returned.
+
+            The calls are distributed among the worker threads and the calling thread,
+            which also processes all of them if the queue has no running workers. This is
+            meant for splitting up per frame work, so task must be safe to call
+            concurrently for different indices. Exceptions thrown by task are passed on
+            to the caller once all calls returned.
+        */
+        void processTasksParallel(size_t count, const std::function<void(size_t)>& task);
         
         /** Set whether to pause further processing of any requests. 
         If true, any further requests will simply be queued and not processed until
@@ -27,6 +27,7 @@ THE SOFTWARE.
 */
 #include "OgreStableHeaders.h"
 #include "OgreAnimation.h"
+#include "OgreAnimationClip.h"
 #include "OgreKeyFrame.h"
 
 namespace Ogre {
@@ -330,14 +331,18 @@ namespace Ogre {
         // Calculate time index for fast keyframe search
         TimeIndex timeIndex = _getTimeIndex(timePos);
 
+        bool skipMinorBones = skel->_getMinorBonesFrozen();
         for (auto& t : mNodeTrackList)
         {
             // get bone to apply to
             Bone* b = skel->getBone(t.first);
+            if (skipMinorBones && b->isMinor())
+                continue;
             t.second->applyToNode(b, timeIndex, weight, scale);
         }
 
-
+        if (mClip)
+            mClip->apply(skel, timePos, weight, NULL, scale, mRotationInterpolationMode);
     }
     //---------------------------------------------------------------------
     void Animation::apply(Skeleton* skel, Real timePos, float weight,
@@ -348,11 +353,17 @@ namespace Ogre {
         // Calculate time index for fast keyframe search
         TimeIndex timeIndex = _getTimeIndex(timePos);
 
+        bool skipMinorBones = skel->_getMinorBonesFrozen();
         for (auto& t : mNodeTrackList)
         {
             Bone* b = skel->getBone(t.first);
+            if (skipMinorBones && b->isMinor())
+                continue;
             t.second->applyToNode(b, timeIndex, (*blendMask)[b->getHandle()] * weight, scale);
         }
+
+        if (mClip)
+            mClip->apply(skel, timePos, weight, blendMask, scale, mRotationInterpolationMode);
     }
     //---------------------------------------------------------------------
     void Animation::apply(Entity* entity, Real timePos, Real weight,
@@ -505,6 +516,13 @@ namespace Ogre {
                 tracks.erase(t.first);
             }
         }
+
+        // baked tracks are never identity, or they would have been discarded before
+        if (mClip)
+        {
+            for (size_t i = 0; i < mClip->getNumTracks(); ++i)
+                tracks.erase(mClip->getTrackHandle(i));
+        }
     }
     //-----------------------------------------------------------------------
     void Animation::_destroyNodeTracks(const TrackHandleList& tracks)
@@ -585,11 +603,29 @@ namespace Ogre {
             i.second->_clone(newAnim);
         }
 
+        if (mClip)
+            newAnim->mClip.reset(OGRE_NEW AnimationClip(*mClip));
+
         newAnim->_keyFrameListChanged();
         return newAnim;
 
     }
     //-----------------------------------------------------------------------
+    void Animation::bakeNodeTracks(Real samplesPerSecond)
+    {
+        if (mNodeTrackList.empty())
+            return;
+
+        _applyBaseKeyFrame();
+        mClip.reset(OGRE_NEW AnimationClip(this, samplesPerSecond));
+        destroyAllNodeTracks();
+    }
+    //-----------------------------------------------------------------------
+    void Animation::_setClip(AnimationClip* clip)
+    {
+        mClip.reset(clip);
+    }
+    //-----------------------------------------------------------------------
     TimeIndex Animation::_getTimeIndex(Real timePos) const
     {
         // Uncomment following statement for work as previous
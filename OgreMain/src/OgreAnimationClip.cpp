@@ -0,0 +1,376 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreAnimationClip.h"
+#include "OgreKeyFrame.h"
+
+namespace Ogre {
+
+    namespace {
+        /// number of tracks sampled at once, bounds the scratch memory on the stack
+        const size_t BLOCK_SIZE = 64;
+
+        const uint16 MAX_KEY = 0xFFFF;
+        /// the smallest three components of a unit quaternion are within +-1/sqrt(2)
+        const float ROTATION_RANGE = 0.70710678f;
+        const float ROTATION_STEP = 2 * ROTATION_RANGE / 0x7FFF;
+
+        /// destination of the three stored and the reconstructed component, by largest index
+        const uint8 ROTATION_ORDER[4][4] = {{1, 2, 3, 0}, {0, 2, 3, 1}, {0, 1, 3, 2}, {0, 1, 2, 3}};
+
+        void encodeRotation(const Quaternion& q, uint16* keys)
+        {
+            float c[4] = {float(q.w), float(q.x), float(q.y), float(q.z)};
+            int largest = 0;
+            for (int i = 1; i < 4; ++i)
+            {
+                if (std::abs(c[i]) > std::abs(c[largest]))
+                    largest = i;
+            }
+            // q and -q are the same rotation, so the reconstructed component is always positive
+            float sign = c[largest] < 0 ? -1.0f : 1.0f;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                float v = c[ROTATION_ORDER[largest][i]] * sign;
+                int k = int(std::round((v + ROTATION_RANGE) / ROTATION_STEP));
+                keys[i] = uint16(Math::Clamp(k, 0, 0x7FFF));
+            }
+            keys[0] |= (largest & 1) << 15;
+            keys[1] |= (largest >> 1) << 15;
+        }
+
+        void decodeRotation(const uint16* keys, float* w, float* x, float* y, float* z)
+        {
+            int largest = (keys[0] >> 15) | ((keys[1] >> 15) << 1);
+            float c[4];
+            c[ROTATION_ORDER[largest][0]] = (keys[0] & 0x7FFF) * ROTATION_STEP - ROTATION_RANGE;
+            c[ROTATION_ORDER[largest][1]] = (keys[1] & 0x7FFF) * ROTATION_STEP - ROTATION_RANGE;
+            c[ROTATION_ORDER[largest][2]] = (keys[2] & 0x7FFF) * ROTATION_STEP - ROTATION_RANGE;
+            float a = c[ROTATION_ORDER[largest][0]], b = c[ROTATION_ORDER[largest][1]],
+                  d = c[ROTATION_ORDER[largest][2]];
+            c[largest] = std::sqrt(std::max(0.0f, 1 - a * a - b * b - d * d));
+            *w = c[0];
+            *x = c[1];
+            *y = c[2];
+            *z = c[3];
+        }
+
+        /// decodes and interpolates count quantized components, kept branch free for vectorization
+        void lerpComponents(const uint16* k0, const uint16* k1, const float* bias, const float* scale,
+                            float alpha, size_t count, float* out)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                float v0 = k0[i], v1 = k1[i];
+                out[i] = bias[i] + scale[i] * (v0 + alpha * (v1 - v0));
+            }
+        }
+
+        /// quantizes the given component of all frames, writing every stride'th key
+        template <typename T>
+        void quantize(const std::vector<T>& values, int component, uint16* keys, size_t stride,
+                      float& bias, float& scale)
+        {
+            float lo = float(values[0][component]), hi = lo;
+            for (const auto& v : values)
+            {
+                lo = std::min(lo, float(v[component]));
+                hi = std::max(hi, float(v[component]));
+            }
+            bias = lo;
+            scale = (hi - lo) / MAX_KEY;
+            for (size_t f = 0; f < values.size(); ++f)
+            {
+                float k = scale > 0 ? std::round((float(values[f][component]) - lo) / scale) : 0;
+                keys[f * stride] = uint16(Math::Clamp(k, 0.0f, float(MAX_KEY)));
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    AnimationClip::AnimationClip(const Animation* anim, Real samplesPerSecond)
+        : mLength(anim->getLength()), mFrameRate(0), mNumFrames(1), mFrameStride(0)
+    {
+        OgreAssert(samplesPerSecond > 0, "the sample rate must be positive");
+        if (mLength > 0)
+        {
+            mNumFrames = std::max<uint32>(2, uint32(std::ceil(mLength * samplesPerSecond)) + 1);
+            mFrameRate = (mNumFrames - 1) / mLength;
+        }
+
+        struct Samples
+        {
+            std::vector<Vector3> translate;
+            std::vector<Quaternion> rotate;
+            std::vector<Vector3> scale;
+        };
+        std::vector<Samples> samples;
+
+        for (const auto& it : anim->_getNodeTrackList())
+        {
+            const NodeAnimationTrack* track = it.second;
+            if (!track->getNumKeyFrames())
+                continue;
+
+            Samples s;
+            s.translate.resize(mNumFrames);
+            s.rotate.resize(mNumFrames);
+            s.scale.resize(mNumFrames);
+            for (uint32 f = 0; f < mNumFrames; ++f)
+            {
+                Real t = mNumFrames > 1 ? mLength * f / (mNumFrames - 1) : 0;
+                TransformKeyFrame kf(0, t);
+                track->getInterpolatedKeyFrame(anim->_getTimeIndex(t), &kf);
+                s.translate[f] = kf.getTranslate();
+                s.rotate[f] = kf.getRotation();
+                s.rotate[f].normalise();
+                s.scale[f] = kf.getScale();
+            }
+
+            Track tr = {};
+            tr.handle = it.first;
+            tr.flags = track->getUseShortestRotationPath() ? CF_SHORTEST_PATH : 0;
+            tr.translate = s.translate[0];
+            tr.rotate = s.rotate[0];
+            tr.scale = s.scale[0];
+            for (uint32 f = 1; f < mNumFrames; ++f)
+            {
+                if (!s.translate[f].positionEquals(tr.translate, 1e-5f))
+                    tr.flags |= CF_TRANSLATE;
+                if (!s.rotate[f].orientationEquals(tr.rotate, 1e-7f))
+                    tr.flags |= CF_ROTATE;
+                if (!s.scale[f].positionEquals(tr.scale, 1e-5f))
+                    tr.flags |= CF_SCALE;
+            }
+            mTracks.push_back(tr);
+            samples.push_back(std::move(s));
+        }
+
+        buildChannels();
+
+        size_t numTranslate = mChannelTracks[0].size(), numScale = mChannelTracks[2].size();
+        mKeys.resize(mNumFrames * mFrameStride);
+        mBias.resize(3 * (numTranslate + numScale));
+        mScale.resize(mBias.size());
+
+        for (size_t i = 0; i < mTracks.size(); ++i)
+        {
+            const Track& tr = mTracks[i];
+            size_t t = 3 * tr.firstChannel[0];
+            size_t s = 3 * (numTranslate + tr.firstChannel[2]);
+            size_t r = 3 * (numTranslate + numScale + tr.firstChannel[1]);
+            for (int c = 0; c < 3; ++c)
+            {
+                if (tr.flags & CF_TRANSLATE)
+                    quantize(samples[i].translate, c, &mKeys[t + c], mFrameStride, mBias[t + c], mScale[t + c]);
+                if (tr.flags & CF_SCALE)
+                    quantize(samples[i].scale, c, &mKeys[s + c], mFrameStride, mBias[s + c], mScale[s + c]);
+            }
+            if (tr.flags & CF_ROTATE)
+            {
+                for (uint32 f = 0; f < mNumFrames; ++f)
+                    encodeRotation(samples[i].rotate[f], &mKeys[f * mFrameStride + r]);
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void AnimationClip::buildChannels()
+    {
+        static const ushort channelFlags[NUM_CHANNELS] = {CF_TRANSLATE, CF_ROTATE, CF_SCALE};
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+            mChannelTracks[c].clear();
+
+        for (size_t i = 0; i < mTracks.size(); ++i)
+        {
+            Track& tr = mTracks[i];
+            for (int c = 0; c < NUM_CHANNELS; ++c)
+            {
+                tr.firstChannel[c] = uint32(mChannelTracks[c].size());
+                if (tr.flags & channelFlags[c])
+                    mChannelTracks[c].push_back(ushort(i));
+            }
+        }
+
+        mFrameStride = 3 * (mChannelTracks[0].size() + mChannelTracks[1].size() + mChannelTracks[2].size());
+    }
+    //-----------------------------------------------------------------------
+    size_t AnimationClip::getMemoryUsage() const
+    {
+        size_t size = sizeof(*this) + mTracks.size() * sizeof(Track) + mKeys.size() * sizeof(uint16) +
+                      (mBias.size() + mScale.size()) * sizeof(float);
+        for (const auto& c : mChannelTracks)
+            size += c.size() * sizeof(ushort);
+        return size;
+    }
+    //-----------------------------------------------------------------------
+    AnimationClip::Frame AnimationClip::getFrame(Real timePos) const
+    {
+        if (timePos > mLength && mLength > 0)
+            timePos = std::fmod(timePos, mLength);
+
+        Real pos = Math::Clamp<Real>(timePos * mFrameRate, 0, mNumFrames - 1);
+        uint32 f0 = std::min(uint32(pos), mNumFrames - 1);
+        uint32 f1 = std::min(f0 + 1, mNumFrames - 1);
+
+        Frame frame;
+        frame.keys[0] = mKeys.data() + f0 * mFrameStride;
+        frame.keys[1] = mKeys.data() + f1 * mFrameStride;
+        frame.alpha = float(pos - f0);
+        return frame;
+    }
+    //-----------------------------------------------------------------------
+    void AnimationClip::sampleBlock(const Frame& frame, size_t first, size_t count,
+                                    Vector3* translations, Quaternion* rotations, Vector3* scales) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Track& tr = mTracks[first + i];
+            translations[i] = tr.translate;
+            rotations[i] = tr.rotate;
+            scales[i] = tr.scale;
+        }
+
+        // animated channels of the block, per channel type
+        size_t begin[NUM_CHANNELS], end[NUM_CHANNELS];
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+        {
+            begin[c] = mTracks[first].firstChannel[c];
+            end[c] = first + count < mTracks.size() ? mTracks[first + count].firstChannel[c]
+                                                    : mChannelTracks[c].size();
+        }
+
+        size_t numTranslate = mChannelTracks[0].size(), numScale = mChannelTracks[2].size();
+        float values[3 * BLOCK_SIZE];
+
+        // translations and scales share the decoding, just at different offsets
+        const size_t offsets[2] = {3 * begin[0], 3 * (numTranslate + begin[2])};
+        const int types[2] = {0, 2};
+        Vector3* const outputs[2] = {translations, scales};
+        for (int v = 0; v < 2; ++v)
+        {
+            int c = types[v];
+            size_t num = end[c] - begin[c];
+            if (!num)
+                continue;
+
+            size_t o = offsets[v];
+            lerpComponents(frame.keys[0] + o, frame.keys[1] + o, &mBias[o], &mScale[o], frame.alpha,
+                           3 * num, values);
+            for (size_t i = 0; i < num; ++i)
+                outputs[v][mChannelTracks[c][begin[c] + i] - first] =
+                    Vector3(values[3 * i], values[3 * i + 1], values[3 * i + 2]);
+        }
+
+        size_t num = end[1] - begin[1];
+        if (!num)
+            return;
+
+        // rotations: decode both frames to SoA, then nlerp all of them in one pass
+        float w0[BLOCK_SIZE], x0[BLOCK_SIZE], y0[BLOCK_SIZE], z0[BLOCK_SIZE];
+        float w1[BLOCK_SIZE], x1[BLOCK_SIZE], y1[BLOCK_SIZE], z1[BLOCK_SIZE];
+        size_t o = 3 * (numTranslate + numScale + begin[1]);
+        for (size_t i = 0; i < num; ++i)
+        {
+            decodeRotation(frame.keys[0] + o + 3 * i, &w0[i], &x0[i], &y0[i], &z0[i]);
+            decodeRotation(frame.keys[1] + o + 3 * i, &w1[i], &x1[i], &y1[i], &z1[i]);
+        }
+
+        float alpha = frame.alpha;
+        for (size_t i = 0; i < num; ++i)
+        {
+            float d = w0[i] * w1[i] + x0[i] * x1[i] + y0[i] * y1[i] + z0[i] * z1[i];
+            float b = d < 0 ? -alpha : alpha;
+            float a = 1 - alpha;
+            float w = a * w0[i] + b * w1[i], x = a * x0[i] + b * x1[i];
+            float y = a * y0[i] + b * y1[i], z = a * z0[i] + b * z1[i];
+            float invLen = 1 / std::sqrt(w * w + x * x + y * y + z * z);
+            w0[i] = w * invLen;
+            x0[i] = x * invLen;
+            y0[i] = y * invLen;
+            z0[i] = z * invLen;
+        }
+
+        for (size_t i = 0; i < num; ++i)
+            rotations[mChannelTracks[1][begin[1] + i] - first] = Quaternion(w0[i], x0[i], y0[i], z0[i]);
+    }
+    //-----------------------------------------------------------------------
+    void AnimationClip::sample(Real timePos, Vector3* translations, Quaternion* rotations,
+                               Vector3* scales) const
+    {
+        Frame frame = getFrame(timePos);
+        for (size_t first = 0; first < mTracks.size(); first += BLOCK_SIZE)
+        {
+            size_t count = std::min(BLOCK_SIZE, mTracks.size() - first);
+            sampleBlock(frame, first, count, translations + first, rotations + first, scales + first);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void AnimationClip::apply(Skeleton* skel, Real timePos, Real weight,
+                              const AnimationState::BoneBlendMask* blendMask, Real scl,
+                              Animation::RotationInterpolationMode rim) const
+    {
+        Frame frame = getFrame(timePos);
+        bool skipMinorBones = skel->_getMinorBonesFrozen();
+
+        Vector3 translations[BLOCK_SIZE], scales[BLOCK_SIZE];
+        Quaternion rotations[BLOCK_SIZE];
+        for (size_t first = 0; first < mTracks.size(); first += BLOCK_SIZE)
+        {
+            size_t count = std::min(BLOCK_SIZE, mTracks.size() - first);
+            sampleBlock(frame, first, count, translations, rotations, scales);
+
+            // same blending as NodeAnimationTrack::applyToNode
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Track& tr = mTracks[first + i];
+                Bone* b = skel->getBone(tr.handle);
+                Real w = blendMask ? (*blendMask)[b->getHandle()] * weight : weight;
+                if (!w || (skipMinorBones && b->isMinor()))
+                    continue;
+
+                b->translate(translations[i] * w * scl);
+
+                bool shortestPath = tr.flags & CF_SHORTEST_PATH;
+                if (rim == Animation::RIM_LINEAR)
+                    b->rotate(Quaternion::nlerp(w, Quaternion::IDENTITY, rotations[i], shortestPath));
+                else
+                    b->rotate(Quaternion::Slerp(w, Quaternion::IDENTITY, rotations[i], shortestPath));
+
+                Vector3 scale = scales[i];
+                if (scale != Vector3::UNIT_SCALE)
+                {
+                    if (scl != 1.0f)
+                        scale = Vector3::UNIT_SCALE + (scale - Vector3::UNIT_SCALE) * scl;
+                    else if (w != 1.0f)
+                        scale = Vector3::UNIT_SCALE + (scale - Vector3::UNIT_SCALE) * w;
+                }
+                b->scale(scale);
+            }
+        }
+    }
+}
@@ -59,6 +59,7 @@ namespace Ogre {
         mChainCount(numberOfChains),
         mUseTexCoords(useTextureCoords),
         mUseVertexColour(useColours),
+        mAutoUpdate(true),
         mVertexDeclDirty(true),
         mBuffersNeedRecreating(true),
         mBoundsDirty(true),
@@ -145,16 +146,22 @@ namespace Ogre {
         setupVertexDeclaration();
         if (mBuffersNeedRecreating)
         {
-            // Create the vertex buffer (always dynamic due to the camera adjust)
-            HardwareVertexBufferSharedPtr pBuffer =
-                HardwareBufferManager::getSingleton().createVertexBuffer(
-                mVertexData->vertexDeclaration->getVertexSize(0),
-                mVertexData->vertexCount,
-                HBU_CPU_TO_GPU);
-
-            // (re)Bind the buffer
-            // Any existing buffer will lose its reference count and be destroyed
-            mVertexData->vertexBufferBinding->setBinding(0, pBuffer);
+            // Auto updated vertices are regenerated whenever rendered, updateVertexBuffer
+            // allocates them from the transient buffers of the frame
+            if (!mAutoUpdate)
+            {
+                // Create the vertex buffer (always dynamic due to the camera adjust)
+                HardwareVertexBufferSharedPtr pBuffer =
+                    HardwareBufferManager::getSingleton().createVertexBuffer(
+                    mVertexData->vertexDeclaration->getVertexSize(0),
+                    mVertexData->vertexCount,
+                    HBU_CPU_TO_GPU);
+
+                // (re)Bind the buffer
+                // Any existing buffer will lose its reference count and be destroyed
+                mVertexData->vertexBufferBinding->setBinding(0, pBuffer);
+                mVertexData->vertexStart = 0;
+            }
 
             mIndexData->indexBuffer =
                 HardwareBufferManager::getSingleton().createIndexBuffer(
@@ -210,7 +217,12 @@ namespace Ogre {
     }
     void BillboardChain::setAutoUpdate(bool autoUpdate)
     {
-        mAutoUpdate = autoUpdate;
+        if (autoUpdate != mAutoUpdate)
+        {
+            mAutoUpdate = autoUpdate;
+            // switches between own and transient vertex buffers
+            mBuffersNeedRecreating = mIndexContentDirty = mVertexContentDirty = true;
+        }
     }
     //-----------------------------------------------------------------------
     void BillboardChain::addChainElement(size_t chainIndex,
@@ -429,9 +441,21 @@ namespace Ogre {
         if (!mVertexContentDirty && !mAutoUpdate)
             return;
 
-        HardwareVertexBufferSharedPtr pBuffer =
-            mVertexData->vertexBufferBinding->getBuffer(0);
-        HardwareBufferLockGuard vertexLock(pBuffer, HardwareBuffer::HBL_DISCARD);
+        size_t vertexSize = mVertexData->vertexDeclaration->getVertexSize(0);
+        HardwareBufferLockGuard vertexLock;
+        if (mAutoUpdate)
+        {
+            auto alloc = HardwareBufferManager::getSingleton().allocateTransientVertices(
+                vertexSize, mVertexData->vertexCount);
+            mVertexData->vertexBufferBinding->setBinding(0, alloc.buffer);
+            mVertexData->vertexStart = alloc.start;
+            vertexLock.lock(alloc.buffer.get(), alloc.start * vertexSize, mVertexData->vertexCount * vertexSize,
+                            alloc.lockOptions);
+        }
+        else
+        {
+            vertexLock.lock(mVertexData->vertexBufferBinding->getBuffer(0).get(), HardwareBuffer::HBL_DISCARD);
+        }
 
         const Vector3& camPos = cam->getDerivedPosition();
         Vector3 eyePos = mParentNode->convertWorldToLocalPosition(camPos);
@@ -456,7 +480,7 @@ namespace Ogre {
                     // Determine base pointer to vertex #1
                     float* pFloat = reinterpret_cast<float*>(
                         static_cast<char*>(vertexLock.pData) +
-                            pBuffer->getVertexSize() * baseIdx);
+                            vertexSize * baseIdx);
 
                     // Get index of next item
                     size_t nexte = e + 1;
@@ -34,6 +34,79 @@ THE SOFTWARE.
 #include <memory>
 
 namespace Ogre {
+    namespace {
+        /// billboards generated by one task of a batch
+        const size_t BILLBOARDS_PER_TASK = 2048;
+        /// billboards whose rotations are evaluated together before their quads are written
+        const size_t BILLBOARDS_PER_BLOCK = 64;
+
+        /// everything needed to generate the quads of billboards sharing the axes of the set
+        struct QuadParams
+        {
+            /// axes scaled by the parametric offsets of the origin
+            Vector3 left, right, top, bottom;
+            /// rotation axis crossed with the above, for vertex rotation
+            Vector3 axisLeft, axisRight, axisTop, axisBottom;
+            float defaultWidth, defaultHeight;
+            bool vertexRotation;
+            const FloatRect* texcoords;
+        };
+
+        /** writes the 4 vertices of a billboard, returns the end of the written data
+
+            cosRot and sinRot are those of the billboard rotation, evaluated by the caller. The
+            quad itself is generated one billboard at a time, with scalar arithmetic.
+        */
+        inline float* writeQuad(float* dest, const QuadParams& p, const Billboard& bb, float cosRot,
+                                float sinRot)
+        {
+            float w = bb.hasOwnDimensions() ? bb.getOwnWidth() : p.defaultWidth;
+            float h = bb.hasOwnDimensions() ? bb.getOwnHeight() : p.defaultHeight;
+
+            Vector3 l = p.left * w, r = p.right * w, t = p.top * h, b = p.bottom * h;
+            Vector3 corners[4] = {l + t, r + t, l + b, r + b};
+
+            const FloatRect& rect =
+                bb.isUseTexcoordRect() ? bb.getTexcoordRect() : p.texcoords[bb.getTexcoordIndex()];
+            float u[4] = {rect.left, rect.right, rect.left, rect.right};
+            float v[4] = {rect.top, rect.top, rect.bottom, rect.bottom};
+
+            if (bb.mRotation != Radian(0))
+            {
+                if (p.vertexRotation)
+                {
+                    // offsets are perpendicular to the axis: v' = v cos + (axis x v) sin
+                    Vector3 al = p.axisLeft * w, ar = p.axisRight * w;
+                    Vector3 at = p.axisTop * h, ab = p.axisBottom * h;
+                    Vector3 rotated[4] = {al + at, ar + at, al + ab, ar + ab};
+                    for (int k = 0; k < 4; ++k)
+                        corners[k] = corners[k] * cosRot + rotated[k] * sinRot;
+                }
+                else
+                {
+                    float hw = (rect.right - rect.left) / 2, hh = (rect.bottom - rect.top) / 2;
+                    float midU = rect.left + hw, midV = rect.top + hh;
+                    float cw = cosRot * hw, ch = cosRot * hh, sw = sinRot * hw, sh = sinRot * hh;
+                    u[0] = midU - cw + sh; v[0] = midV - sw - ch;
+                    u[1] = midU + cw + sh; v[1] = midV + sw - ch;
+                    u[2] = midU - cw - sh; v[2] = midV - sw + ch;
+                    u[3] = midU + cw - sh; v[3] = midV + sw + ch;
+                }
+            }
+
+            for (int k = 0; k < 4; ++k)
+            {
+                dest[0] = corners[k].x + bb.mPosition.x;
+                dest[1] = corners[k].y + bb.mPosition.y;
+                dest[2] = corners[k].z + bb.mPosition.z;
+                memcpy(dest + 3, &bb.mColour, sizeof(RGBA));
+                dest[4] = u[k];
+                dest[5] = v[k];
+                dest += 6;
+            }
+            return dest;
+        }
+    }
     //-----------------------------------------------------------------------
     BillboardSet::BillboardSet() :
         mBoundingRadius(0.0f), 
@@ -52,6 +125,7 @@ namespace Ogre {
         mPoolSize(0),
         mExternalData(false),
         mAutoUpdate(true),
+        mUseTransientBuffers(true),
         mBillboardDataChanged(true)
     {
         setDefaultDimensions( 100, 100 );
@@ -84,6 +158,7 @@ namespace Ogre {
         mPoolSize(poolSize),
         mExternalData(externalData),
         mAutoUpdate(true),
+        mUseTransientBuffers(!externalData),
         mBillboardDataChanged(true)
     {
         setDefaultDimensions( 100, 100 );
@@ -312,7 +387,24 @@ namespace Ogre {
         mNumVisibleBillboards = 0;
 
         // Lock the buffer
-        if (numBillboards) // optimal lock
+        if (mAutoUpdate && mUseTransientBuffers)
+        {
+            // space for all billboards if the count is unknown
+            numBillboards = numBillboards ? std::min(mPoolSize, numBillboards) : mPoolSize;
+
+            // just one vertex per billboard (this also excludes texcoords) or 4 corners
+            size_t vertexSize = mVertexData->vertexDeclaration->getVertexSize(0);
+            size_t numVerts = mPointRendering ? numBillboards : numBillboards * 4;
+
+            auto alloc = HardwareBufferManager::getSingleton().allocateTransientVertices(vertexSize, numVerts);
+            mMainBuf = alloc.buffer;
+            mVertexData->vertexBufferBinding->setBinding(0, mMainBuf);
+            mVertexData->vertexStart = alloc.start;
+
+            mLockPtr = static_cast<float*>(
+                mMainBuf->lock(alloc.start * vertexSize, numVerts * vertexSize, alloc.lockOptions));
+        }
+        else if (numBillboards) // optimal lock
         {
             // clamp to max
             numBillboards = std::min(mPoolSize, numBillboards);
@@ -384,6 +476,123 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void BillboardSet::injectBillboards(const Billboard* billboards, size_t count)
+    {
+        injectBillboardBatch(count, [billboards](size_t i) -> const Billboard& { return billboards[i]; });
+    }
+    //-----------------------------------------------------------------------
+    template<typename BillboardAccess>
+    void BillboardSet::injectBillboardBatch(size_t count, const BillboardAccess& get)
+    {
+        if (mPointRendering || mBillboardType == BBT_ORIENTED_SELF ||
+            mBillboardType == BBT_PERPENDICULAR_SELF ||
+            (mAccurateFacing && mBillboardType != BBT_PERPENDICULAR_COMMON))
+        {
+            // axes or layout differ per billboard
+            for (size_t i = 0; i < count; ++i)
+                injectBillboard(get(i));
+            return;
+        }
+
+        QuadParams params;
+        params.left = mCamX * mLeftOff;
+        params.right = mCamX * mRightOff;
+        params.top = mCamY * mTopOff;
+        params.bottom = mCamY * mBottomOff;
+        // the axis genQuadVertices derives from the offsets, which lie in the plane of mCamX and mCamY
+        Vector3 axis = mCamY.crossProduct(mCamX).normalisedCopy();
+        params.axisLeft = axis.crossProduct(params.left);
+        params.axisRight = axis.crossProduct(params.right);
+        params.axisTop = axis.crossProduct(params.top);
+        params.axisBottom = axis.crossProduct(params.bottom);
+        params.defaultWidth = mDefaultWidth;
+        params.defaultHeight = mDefaultHeight;
+        params.vertexRotation = mRotationType == BBR_VERTEX;
+        params.texcoords = mTextureCoords.data();
+
+        size_t capacity = mPoolSize - mNumVisibleBillboards;
+        size_t numChunks = (count + BILLBOARDS_PER_TASK - 1) / BILLBOARDS_PER_TASK;
+        WorkQueue* queue = Root::getSingletonPtr() ? Root::getSingleton().getWorkQueue() : NULL;
+        auto forEachChunk = [queue, numChunks](const std::function<void(size_t)>& task) {
+            if (queue)
+                queue->processTasksParallel(numChunks, task);
+            else
+                for (size_t c = 0; c < numChunks; ++c)
+                    task(c);
+        };
+
+        // first visible billboard written by every chunk, numChunks + 1 entries
+        std::vector<size_t> chunkStarts(numChunks + 1);
+        std::vector<uint8> visible;
+        if (mCullIndividual)
+        {
+            Affine3 xworld = mWorldSpace ? Affine3::IDENTITY : _getParentNodeFullTransform();
+            Camera* cam = mCurrentCamera;
+            // bring the lazily updated frustum planes up to date before going parallel
+            cam->isVisible(Sphere());
+
+            visible.resize(count);
+            forEachChunk([&](size_t c) {
+                size_t end = std::min(count, (c + 1) * BILLBOARDS_PER_TASK), n = 0;
+                for (size_t i = c * BILLBOARDS_PER_TASK; i < end; ++i)
+                {
+                    const Billboard& bb = get(i);
+                    Real radius = bb.mOwnDimensions ? std::max(bb.mWidth, bb.mHeight)
+                                                    : std::max(mDefaultWidth, mDefaultHeight);
+                    visible[i] = cam->isVisible(Sphere(xworld * bb.mPosition, radius));
+                    n += visible[i];
+                }
+                chunkStarts[c + 1] = n;
+            });
+            for (size_t c = 0; c < numChunks; ++c)
+                chunkStarts[c + 1] += chunkStarts[c];
+        }
+        else
+        {
+            for (size_t c = 0; c <= numChunks; ++c)
+                chunkStarts[c] = std::min(count, c * BILLBOARDS_PER_TASK);
+        }
+
+        // 4 vertices of 6 floats: position, colour, texture coordinates
+        float* base = mLockPtr;
+        forEachChunk([&](size_t c) {
+            size_t slot = chunkStarts[c];
+            if (slot >= capacity)
+                return;
+
+            float* dest = base + slot * 24;
+            size_t end = std::min(count, (c + 1) * BILLBOARDS_PER_TASK);
+            const Billboard* block[BILLBOARDS_PER_BLOCK];
+            float cosRot[BILLBOARDS_PER_BLOCK], sinRot[BILLBOARDS_PER_BLOCK];
+            for (size_t i = c * BILLBOARDS_PER_TASK; i < end && slot < capacity;)
+            {
+                // collect the next visible billboards that still fit
+                size_t n = 0;
+                for (; i < end && n < BILLBOARDS_PER_BLOCK && slot + n < capacity; ++i)
+                {
+                    if (visible.empty() || visible[i])
+                        block[n++] = &get(i);
+                }
+
+                // evaluate the rotations up front, keeping cos and sin out of the quad kernel
+                for (size_t k = 0; k < n; ++k)
+                {
+                    float angle = block[k]->mRotation.valueRadians();
+                    cosRot[k] = std::cos(angle);
+                    sinRot[k] = std::sin(angle);
+                }
+
+                for (size_t k = 0; k < n; ++k)
+                    dest = writeQuad(dest, params, *block[k], cosRot[k], sinRot[k]);
+                slot += n;
+            }
+        });
+
+        size_t written = std::min(chunkStarts[numChunks], capacity);
+        mNumVisibleBillboards += static_cast<unsigned short>(written);
+        mLockPtr += written * 24;
+    }
+    //-----------------------------------------------------------------------
     void BillboardSet::endBillboards(void)
     {
         mMainBuf->unlock();
@@ -446,11 +655,8 @@ namespace Ogre {
             }
 
             beginBillboards(mActiveBillboards);
-            auto iend = mBillboardPool.begin() + mActiveBillboards;
-            for (auto it = mBillboardPool.begin(); it != iend; ++it)
-            {
-                injectBillboard(*(*it));
-            }
+            injectBillboardBatch(mActiveBillboards,
+                                 [this](size_t i) -> const Billboard& { return *mBillboardPool[i]; });
             endBillboards();
             mBillboardDataChanged = false;
         }
@@ -482,8 +688,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void BillboardSet::getRenderOperation(RenderOperation& op)
     {
+        // vertexStart is only non-zero for transient buffers
         op.vertexData = mVertexData.get();
-        op.vertexData->vertexStart = 0;
 
         if (mPointRendering)
         {
@@ -585,14 +791,18 @@ namespace Ogre {
             decl->addElement(0, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES, 0);
         }
 
-        mMainBuf =
-            HardwareBufferManager::getSingleton().createVertexBuffer(
-                decl->getVertexSize(0),
-                mVertexData->vertexCount,
-                mAutoUpdate ? HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE : 
-                HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-        // bind position and diffuses
-        binding->setBinding(0, mMainBuf);
+        // transient buffers are allocated and bound by beginBillboards
+        if (!mAutoUpdate || !mUseTransientBuffers)
+        {
+            mMainBuf =
+                HardwareBufferManager::getSingleton().createVertexBuffer(
+                    decl->getVertexSize(0),
+                    mVertexData->vertexCount,
+                    mAutoUpdate ? HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE : 
+                    HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+            // bind position and diffuses
+            binding->setBinding(0, mMainBuf);
+        }
 
         if (!mPointRendering)
         {
@@ -1132,6 +1342,15 @@ namespace Ogre {
         }
     }
 
+    //-----------------------------------------------------------------------
+    void BillboardSet::setUseTransientBuffers(bool enabled)
+    {
+        if (enabled != mUseTransientBuffers)
+        {
+            mUseTransientBuffers = enabled;
+            _destroyBuffers();
+        }
+    }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     const String MOT_BILLBOARD_SET = "BillboardSet";
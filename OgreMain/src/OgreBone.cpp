@@ -31,12 +31,12 @@ namespace Ogre {
 
     //---------------------------------------------------------------------
     Bone::Bone(unsigned short handle, Skeleton* creator) 
-        : Node(), mCreator(creator), mHandle(handle), mManuallyControlled(false)
+        : Node(), mCreator(creator), mHandle(handle), mManuallyControlled(false), mMinor(false)
     {
     }
     //---------------------------------------------------------------------
     Bone::Bone(const String& name, unsigned short handle, Skeleton* creator) 
-        : Node(name), mCreator(creator), mHandle(handle), mManuallyControlled(false)
+        : Node(name), mCreator(creator), mHandle(handle), mManuallyControlled(false), mMinor(false)
     {
     }
     //---------------------------------------------------------------------
@@ -26,8 +26,114 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "OgreStableHeaders.h"
+#include "OgreSceneQueryTree.h"
 
 namespace Ogre {
+    namespace
+    {
+        typedef SceneQueryTree::Node TreeNode;
+
+        /// number of rays traced together through the query tree
+        const int RAY_PACKET_SIZE = 8;
+
+        bool passesMasks(const MovableObject* a, uint32 queryMask, uint32 typeMask)
+        {
+            return (a->getTypeFlags() & typeMask) && (a->getQueryFlags() & queryMask) && a->isInScene();
+        }
+
+        bool overlaps(const TreeNode& n, const AxisAlignedBox& box)
+        {
+            if (box.isInfinite())
+                return true;
+            const Vector3& min = box.getMinimum();
+            const Vector3& max = box.getMaximum();
+            return !box.isNull() && n.min.x <= max.x && n.min.y <= max.y && n.min.z <= max.z &&
+                   min.x <= n.max.x && min.y <= n.max.y && min.z <= n.max.z;
+        }
+
+        bool overlaps(const TreeNode& n, const Sphere& sphere)
+        {
+            Vector3 closest = sphere.getCenter();
+            closest.makeCeil(n.min);
+            closest.makeFloor(n.max);
+            return closest.squaredDistance(sphere.getCenter()) <= Math::Sqr(sphere.getRadius());
+        }
+
+        /** Traces a packet of up to RAY_PACKET_SIZE rays through the query tree.
+
+            The visitor is called as visitor(rayIndex, object, distance) for every bounding
+            box hit and may return false to stop the traversal.
+        */
+        template <typename Visitor>
+        bool traceRayPacket(const SceneQueryTree* tree, const Ray* rays, int count, uint32 queryMask,
+                            uint32 typeMask, Visitor visitor)
+        {
+            // structure of arrays, so the slab test below vectorises over the packet
+            Real ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+            Real ix[RAY_PACKET_SIZE], iy[RAY_PACKET_SIZE], iz[RAY_PACKET_SIZE];
+            for (int i = 0; i < RAY_PACKET_SIZE; ++i)
+            {
+                // unused lanes repeat the last ray
+                const Ray& r = rays[std::min(i, count - 1)];
+                const Vector3& o = r.getOrigin();
+                const Vector3& d = r.getDirection();
+                ox[i] = o.x;
+                oy[i] = o.y;
+                oz[i] = o.z;
+                // avoid 0 * inf for rays parallel to a slab
+                ix[i] = 1 / (d.x == 0 ? std::numeric_limits<Real>::min() : d.x);
+                iy[i] = 1 / (d.y == 0 ? std::numeric_limits<Real>::min() : d.y);
+                iz[i] = 1 / (d.z == 0 ? std::numeric_limits<Real>::min() : d.z);
+            }
+
+            const uint32 used = (1u << count) - 1;
+            uint32 hits = 0;
+
+            auto nodeTest = [&](const TreeNode& n)
+            {
+                uint32 mask = 0;
+                for (int i = 0; i < RAY_PACKET_SIZE; ++i)
+                {
+                    Real tx0 = (n.min.x - ox[i]) * ix[i], tx1 = (n.max.x - ox[i]) * ix[i];
+                    Real ty0 = (n.min.y - oy[i]) * iy[i], ty1 = (n.max.y - oy[i]) * iy[i];
+                    Real tz0 = (n.min.z - oz[i]) * iz[i], tz1 = (n.max.z - oz[i]) * iz[i];
+                    Real tmin = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)),
+                                         std::max(std::min(tz0, tz1), Real(0)));
+                    Real tmax = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::max(tz0, tz1));
+                    mask |= uint32(tmin <= tmax) << i;
+                }
+                hits = mask & used;
+                return hits != 0;
+            };
+
+            auto leafVisitor = [&](int32, MovableObject* a)
+            {
+                if (!passesMasks(a, queryMask, typeMask))
+                    return true;
+
+                for (int i = 0; i < count; ++i)
+                {
+                    if (!(hits & (1u << i)))
+                        continue;
+                    std::pair<bool, Real> result = rays[i].intersects(a->getWorldBoundingBox());
+                    if (result.first && !visitor(i, a, result.second))
+                        return false;
+                }
+                return true;
+            };
+
+            if (!tree->traverse(nodeTest, leafVisitor))
+                return false;
+
+            for (auto a : tree->getUnboundedObjects())
+            {
+                hits = used;
+                if (!leafVisitor(SceneQueryTree::NULL_NODE, a))
+                    return false;
+            }
+            return true;
+        }
+    }
     //---------------------------------------------------------------------
     DefaultIntersectionSceneQuery::DefaultIntersectionSceneQuery(SceneManager* creator)
     : IntersectionSceneQuery(creator)
@@ -40,6 +146,49 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultIntersectionSceneQuery::execute(IntersectionSceneQueryListener* listener)
     {
+        if (const SceneQueryTree* tree = mParentSceneMgr->_getQueryTree())
+        {
+            const auto& unbounded = tree->getUnboundedObjects();
+            auto all = [](const TreeNode&) { return true; };
+
+            // every pair is reported by the object with the lower leaf index
+            bool proceed = tree->traverse(all, [&](int32 leafA, MovableObject* a) {
+                if (!passesMasks(a, mQueryMask, mQueryTypeMask))
+                    return true;
+                const AxisAlignedBox& box1 = a->getWorldBoundingBox();
+                return tree->traverse([&](const TreeNode& n) { return overlaps(n, box1); },
+                                      [&](int32 leafB, MovableObject* b) {
+                                          if (leafB <= leafA || !passesMasks(b, mQueryMask, mQueryTypeMask) ||
+                                              !box1.intersects(b->getWorldBoundingBox()))
+                                              return true;
+                                          return listener->queryResult(a, b);
+                                      });
+            });
+
+            // objects with infinite bounds against everything else
+            for (size_t i = 0; proceed && i < unbounded.size(); ++i)
+            {
+                MovableObject* a = unbounded[i];
+                if (!passesMasks(a, mQueryMask, mQueryTypeMask))
+                    continue;
+
+                for (size_t j = i + 1; proceed && j < unbounded.size(); ++j)
+                {
+                    MovableObject* b = unbounded[j];
+                    if (passesMasks(b, mQueryMask, mQueryTypeMask))
+                        proceed = listener->queryResult(a, b);
+                }
+
+                const AxisAlignedBox& box1 = a->getWorldBoundingBox();
+                proceed = proceed && tree->traverse(all, [&](int32, MovableObject* b) {
+                    if (!passesMasks(b, mQueryMask, mQueryTypeMask) || !box1.intersects(b->getWorldBoundingBox()))
+                        return true;
+                    return listener->queryResult(a, b);
+                });
+            }
+            return;
+        }
+
         // Iterate over all movable types
         const auto& factories = Root::getSingleton().getMovableObjectFactories();
         auto factIt = factories.begin();
@@ -122,6 +271,24 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultAxisAlignedBoxSceneQuery::execute(SceneQueryListener* listener)
     {
+        if (const SceneQueryTree* tree = mParentSceneMgr->_getQueryTree())
+        {
+            auto visitor = [&](int32, MovableObject* a) {
+                if (!passesMasks(a, mQueryMask, mQueryTypeMask) || !mAABB.intersects(a->getWorldBoundingBox()))
+                    return true;
+                return listener->queryResult(a);
+            };
+
+            if (!tree->traverse([&](const TreeNode& n) { return overlaps(n, mAABB); }, visitor))
+                return;
+            for (auto a : tree->getUnboundedObjects())
+            {
+                if (!visitor(SceneQueryTree::NULL_NODE, a))
+                    return;
+            }
+            return;
+        }
+
         // Iterate over all movable types
         for(const auto& factIt : Root::getSingleton().getMovableObjectFactories())
         {
@@ -152,6 +319,14 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultRaySceneQuery::execute(RaySceneQueryListener* listener)
     {
+        if (const SceneQueryTree* tree = mParentSceneMgr->_getQueryTree())
+        {
+            traceRayPacket(tree, &mRay, 1, mQueryMask, mQueryTypeMask,
+                           [listener](int, MovableObject* a, Real distance)
+                           { return listener->queryResult(a, distance); });
+            return;
+        }
+
         // Note that because we have no scene partitioning, we actually
         // perform a complete scene search even if restricted results are
         // requested; smarter scene manager queries can utilise the paritioning 
@@ -183,6 +358,39 @@ namespace Ogre {
 
     }
     //---------------------------------------------------------------------
+    void DefaultRaySceneQuery::executeBatch(const Ray* rays, size_t count,
+                                            std::vector<RaySceneQueryResult>& results)
+    {
+        const SceneQueryTree* tree = mParentSceneMgr->_getQueryTree();
+        if (!tree)
+        {
+            RaySceneQuery::executeBatch(rays, count, results);
+            return;
+        }
+
+        results.resize(count);
+        for (auto& r : results)
+            r.clear();
+
+        for (size_t first = 0; first < count; first += RAY_PACKET_SIZE)
+        {
+            int packetSize = int(std::min<size_t>(RAY_PACKET_SIZE, count - first));
+            RaySceneQueryResult* packetResults = &results[first];
+            const Ray* packetRays = rays + first;
+            traceRayPacket(tree, packetRays, packetSize, mQueryMask, mQueryTypeMask,
+                           [this, packetResults, packetRays](int i, MovableObject* a, Real distance)
+                           {
+                               RaySceneQueryResultEntry dets = {distance, a, NULL};
+                               if (refineResult(packetRays[i], dets))
+                                   packetResults[i].push_back(dets);
+                               return true;
+                           });
+        }
+
+        for (auto& r : results)
+            sortResults(r);
+    }
+    //---------------------------------------------------------------------
     DefaultSphereSceneQuery::
     DefaultSphereSceneQuery(SceneManager* creator) : SphereSceneQuery(creator)
     {
@@ -194,6 +402,24 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultSphereSceneQuery::execute(SceneQueryListener* listener)
     {
+        if (const SceneQueryTree* tree = mParentSceneMgr->_getQueryTree())
+        {
+            auto visitor = [&](int32, MovableObject* a) {
+                if (!passesMasks(a, mQueryMask, mQueryTypeMask) || !mSphere.intersects(a->getWorldBoundingSphere()))
+                    return true;
+                return listener->queryResult(a);
+            };
+
+            if (!tree->traverse([&](const TreeNode& n) { return overlaps(n, mSphere); }, visitor))
+                return;
+            for (auto a : tree->getUnboundedObjects())
+            {
+                if (!visitor(SceneQueryTree::NULL_NODE, a))
+                    return;
+            }
+            return;
+        }
+
         // Iterate over all movable types
         for(const auto& factIt : Root::getSingleton().getMovableObjectFactories())
         {
@@ -228,6 +454,38 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultPlaneBoundedVolumeListSceneQuery::execute(SceneQueryListener* listener)
     {
+        if (const SceneQueryTree* tree = mParentSceneMgr->_getQueryTree())
+        {
+            auto nodeTest = [&](const TreeNode& n) {
+                AxisAlignedBox box(n.min, n.max);
+                for (const auto& vol : mVolumes)
+                {
+                    if (vol.intersects(box))
+                        return true;
+                }
+                return false;
+            };
+            auto visitor = [&](int32, MovableObject* a) {
+                if (!passesMasks(a, mQueryMask, mQueryTypeMask))
+                    return true;
+                for (const auto& vol : mVolumes)
+                {
+                    if (vol.intersects(a->getWorldBoundingBox()))
+                        return listener->queryResult(a);
+                }
+                return true;
+            };
+
+            if (!tree->traverse(nodeTest, visitor))
+                return;
+            for (auto a : tree->getUnboundedObjects())
+            {
+                if (!visitor(SceneQueryTree::NULL_NODE, a))
+                    return;
+            }
+            return;
+        }
+
         // Iterate over all movable types
         for(const auto& factIt : Root::getSingleton().getMovableObjectFactories())
         {
@@ -31,9 +31,141 @@ Copyright (c) 2000-2014 Torus Knot Software Ltd
 #include "OgreOptimisedUtil.h"
 #include "OgreLodStrategy.h"
 #include "OgreLodListener.h"
+#include "OgreAnimation.h"
+#include "OgreKeyFrame.h"
 
 
 namespace Ogre {
+    namespace {
+        /// Vertex blend of one vertex data, prepared for running on a worker thread
+        struct SoftwareSkinningJob
+        {
+            const float* srcPos;
+            float* destPos;
+            const float* srcNorm;
+            float* destNorm;
+            const float* blendWeight;
+            const unsigned char* blendIndex;
+            size_t srcPosStride, destPosStride;
+            size_t srcNormStride, destNormStride;
+            size_t blendWeightStride, blendIndexStride;
+            size_t numWeightsPerVertex;
+            size_t numVertices;
+            /// range of the blend matrices in SoftwareSkinningBatch::blendMatrices
+            size_t firstMatrix;
+        };
+
+        /** Software skinning of several entities.
+
+            Buffers are locked only once, even if shared by many entities, so the blends
+            do not need to touch the buffers themselves.
+        */
+        struct SoftwareSkinningBatch
+        {
+            std::vector<SoftwareSkinningJob> jobs;
+            std::vector<const Affine3*> blendMatrices;
+            std::map<HardwareBuffer*, void*> lockedBuffers;
+
+            ~SoftwareSkinningBatch()
+            {
+                for (auto& l : lockedBuffers)
+                    l.first->unlock();
+            }
+
+            unsigned char* lock(const HardwareVertexBufferSharedPtr& buf, HardwareBuffer::LockOptions options)
+            {
+                auto it = lockedBuffers.find(buf.get());
+                if (it == lockedBuffers.end())
+                    it = lockedBuffers.emplace(buf.get(), buf->lock(options)).first;
+                return static_cast<unsigned char*>(it->second);
+            }
+
+            /// same as Mesh::softwareVertexBlend, except that the blend is done by run
+            void add(const VertexData* sourceVertexData, const VertexData* targetVertexData,
+                     const Affine3* boneMatrices, const Mesh::IndexMap& indexMap, bool blendNormals)
+            {
+                auto decl = sourceVertexData->vertexDeclaration;
+                auto srcElemPos = decl->findElementBySemantic(VES_POSITION);
+                auto srcElemNorm = decl->findElementBySemantic(VES_NORMAL);
+                auto srcElemBlendIndices = decl->findElementBySemantic(VES_BLEND_INDICES);
+                auto srcElemBlendWeights = decl->findElementBySemantic(VES_BLEND_WEIGHTS);
+                OgreAssert(srcElemPos && srcElemBlendIndices && srcElemBlendWeights,
+                           "You must supply at least positions, blend indices and blend weights");
+                auto destElemPos = targetVertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+                auto destElemNorm = targetVertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
+                assert(srcElemBlendIndices->getType() == VET_UBYTE4 && "Blend indices must be VET_UBYTE4");
+
+                const VertexBufferBinding* srcBind = sourceVertexData->vertexBufferBinding;
+                const VertexBufferBinding* destBind = targetVertexData->vertexBufferBinding;
+                SoftwareSkinningJob job = {};
+
+                const auto& srcPosBuf = srcBind->getBuffer(srcElemPos->getSource());
+                srcElemPos->baseVertexPointerToElement(lock(srcPosBuf, HardwareBuffer::HBL_READ_ONLY),
+                                                       &job.srcPos);
+                job.srcPosStride = srcPosBuf->getVertexSize();
+                const auto& destPosBuf = destBind->getBuffer(destElemPos->getSource());
+                destElemPos->baseVertexPointerToElement(lock(destPosBuf, HardwareBuffer::HBL_NORMAL),
+                                                        &job.destPos);
+                job.destPosStride = destPosBuf->getVertexSize();
+
+                if (blendNormals && srcElemNorm && destElemNorm)
+                {
+                    const auto& srcNormBuf = srcBind->getBuffer(srcElemNorm->getSource());
+                    srcElemNorm->baseVertexPointerToElement(lock(srcNormBuf, HardwareBuffer::HBL_READ_ONLY),
+                                                            &job.srcNorm);
+                    job.srcNormStride = srcNormBuf->getVertexSize();
+                    const auto& destNormBuf = destBind->getBuffer(destElemNorm->getSource());
+                    destElemNorm->baseVertexPointerToElement(lock(destNormBuf, HardwareBuffer::HBL_NORMAL),
+                                                             &job.destNorm);
+                    job.destNormStride = destNormBuf->getVertexSize();
+                }
+
+                const auto& srcIdxBuf = srcBind->getBuffer(srcElemBlendIndices->getSource());
+                srcElemBlendIndices->baseVertexPointerToElement(lock(srcIdxBuf, HardwareBuffer::HBL_READ_ONLY),
+                                                                &job.blendIndex);
+                job.blendIndexStride = srcIdxBuf->getVertexSize();
+                const auto& srcWeightBuf = srcBind->getBuffer(srcElemBlendWeights->getSource());
+                srcElemBlendWeights->baseVertexPointerToElement(lock(srcWeightBuf, HardwareBuffer::HBL_READ_ONLY),
+                                                                &job.blendWeight);
+                job.blendWeightStride = srcWeightBuf->getVertexSize();
+                job.numWeightsPerVertex = VertexElement::getTypeCount(srcElemBlendWeights->getType());
+                job.numVertices = targetVertexData->vertexCount;
+
+                // the bone matrices are only pointed to, so they may be updated later
+                job.firstMatrix = blendMatrices.size();
+                blendMatrices.resize(job.firstMatrix + indexMap.size());
+                Mesh::prepareMatricesForVertexBlend(blendMatrices.data() + job.firstMatrix, boneMatrices, indexMap);
+                jobs.push_back(job);
+            }
+
+            void run(size_t first, size_t last) const
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    const SoftwareSkinningJob& job = jobs[i];
+                    OptimisedUtil::getImplementation()->softwareVertexSkinning(
+                        job.srcPos, job.destPos, job.srcNorm, job.destNorm, job.blendWeight, job.blendIndex,
+                        blendMatrices.data() + job.firstMatrix, job.srcPosStride, job.destPosStride,
+                        job.srcNormStride, job.destNormStride, job.blendWeightStride, job.blendIndexStride,
+                        job.numWeightsPerVertex, job.numVertices);
+                }
+            }
+        };
+
+        /// builds the lazily created data of an animation, which must not happen concurrently
+        void prepareAnimation(Animation* anim, Real timePos)
+        {
+            anim->_applyBaseKeyFrame();
+
+            TimeIndex timeIndex = anim->_getTimeIndex(timePos);
+            if (anim->getInterpolationMode() != Animation::IM_SPLINE)
+                return;
+
+            TransformKeyFrame kf(0, 0);
+            for (const auto& t : anim->_getNodeTrackList())
+                t.second->getInterpolatedKeyFrame(timeIndex, &kf);
+        }
+    }
     //-----------------------------------------------------------------------
     Entity::Entity ()
         : mAnimationState(NULL),
@@ -53,6 +185,10 @@ namespace Ogre {
           mBoneWorldMatrices(NULL),
           mBoneMatrices(NULL),
           mFrameAnimationLastUpdated(std::numeric_limits<unsigned long>::max()),
+          mAnimationLodIndex(0),
+          mMinorBonesLodIndex(1),
+          mAnimationLodPhase(0),
+          mFrameAnimationLodEvaluated(0),
           mFrameBonesLastUpdated(NULL),
           mSharedSkeletonEntities(NULL),
         mSoftwareAnimationRequests(0),
@@ -341,6 +477,12 @@ namespace Ogre {
         // Calculate the LOD
         if (mParentNode)
         {
+            if (!mAnimationLodValues.empty())
+            {
+                const LodStrategy* strategy = mMesh->getLodStrategy();
+                mAnimationLodIndex = strategy->getIndex(strategy->getValue(this, cam), mAnimationLodValues);
+            }
+
 #if !OGRE_NO_MESHLOD
             // Get mesh lod strategy
             const LodStrategy *meshStrategy = mMesh->getLodStrategy();
@@ -648,7 +790,9 @@ namespace Ogre {
         // update the animation
         if (displayEntity->hasSkeleton() || displayEntity->hasVertexAnimation())
         {
-            displayEntity->updateAnimation();
+            // without attached objects, nothing needs the result before rendering
+            if (!mChildObjectList.empty() || !mManager || !mManager->_queueAnimationUpdate(displayEntity))
+                displayEntity->updateAnimation();
 
             //--- pass this point,  we are sure that the transformation matrix of each bone and tagPoint have been updated
             for(auto child : mChildObjectList)
@@ -750,9 +894,25 @@ namespace Ogre {
         if (!mInitialised)
             return;
 
+        AnimationUpdate update = beginAnimationUpdate(false);
+        if (update.updateBuffers && hasSkeleton())
+        {
+            cacheBoneMatrices();
+
+            // Software blend?
+            if (update.softwareAnimation)
+                softwareVertexBlend(update.blendNormals);
+        }
+        endAnimationUpdate(update);
+    }
+    //-----------------------------------------------------------------------
+    Entity::AnimationUpdate Entity::beginAnimationUpdate(bool deferUpload)
+    {
+        AnimationUpdate update;
+
         Root& root = Root::getSingleton();
         bool hwAnimation = isHardwareAnimationEnabled();
-        bool isNeedUpdateHardwareAnim = hwAnimation && !mCurrentHWAnimationState;
+        update.needUpdateHardwareAnim = hwAnimation && !mCurrentHWAnimationState;
         bool forcedSwAnimation = getSoftwareAnimationRequests()>0;
         bool forcedNormals = getSoftwareAnimationNormalsRequests()>0;
         bool stencilShadows = false;
@@ -763,109 +923,129 @@ namespace Ogre {
         // since shadows only require positions
         bool blendNormals = !hwAnimation || forcedNormals;
         // Animation dirty if animation state modified or manual bones modified
-        bool animationDirty =
+        update.animationDirty =
             (mFrameAnimationLastUpdated != mAnimationState->getDirtyFrameNumber()) ||
             (hasSkeleton() && getSkeleton()->getManualBonesDirty());
-        
+
+        update.hwAnimation = hwAnimation;
+        update.softwareAnimation = softwareAnimation;
+        update.blendNormals = blendNormals;
+
         //update the current hardware animation state
         mCurrentHWAnimationState = hwAnimation;
 
         // We only do these tasks if animation is dirty
         // Or, if we're using a skeleton and manual bones have been moved
         // Or, if we're using software animation and temp buffers are unbound
-        if (animationDirty ||
+        update.updateBuffers =
+            update.animationDirty ||
             (softwareAnimation && hasVertexAnimation() && !tempVertexAnimBuffersBound()) ||
-            (softwareAnimation && hasSkeleton() && !tempSkelAnimBuffersBound(blendNormals)))
+            (softwareAnimation && hasSkeleton() && !tempSkelAnimBuffersBound(blendNormals));
+        if (!update.updateBuffers)
+            return update;
+
+        if (hasVertexAnimation())
         {
-            if (hasVertexAnimation())
+            if (softwareAnimation)
             {
-                if (softwareAnimation)
+                // grab & bind temporary buffer for positions (& normals if they are included)
+                if (mSoftwareVertexAnimVertexData
+                    && mMesh->getSharedVertexDataAnimationType() != VAT_NONE)
                 {
-                    // grab & bind temporary buffer for positions (& normals if they are included)
-                    if (mSoftwareVertexAnimVertexData
-                        && mMesh->getSharedVertexDataAnimationType() != VAT_NONE)
+                    bool useNormals = mMesh->getSharedVertexDataAnimationIncludesNormals();
+                    mTempVertexAnimInfo.checkoutTempCopies(true, useNormals);
+                    // NB we suppress hardware upload while doing blend if we're
+                    // hardware animation, because the only reason for doing this
+                    // is for shadow, which need only be uploaded then
+                    mTempVertexAnimInfo.bindTempCopies(mSoftwareVertexAnimVertexData.get(),
+                                                       hwAnimation);
+                }
+                for (auto *se : mSubEntityList)
+                {
+                    // Blend dedicated geometry
+                    if (se->isVisible() && se->mSoftwareVertexAnimVertexData
+                        && se->getSubMesh()->getVertexAnimationType() != VAT_NONE)
                     {
-                        bool useNormals = mMesh->getSharedVertexDataAnimationIncludesNormals();
-                        mTempVertexAnimInfo.checkoutTempCopies(true, useNormals);
-                        // NB we suppress hardware upload while doing blend if we're
-                        // hardware animation, because the only reason for doing this
-                        // is for shadow, which need only be uploaded then
-                        mTempVertexAnimInfo.bindTempCopies(mSoftwareVertexAnimVertexData.get(),
-                                                           hwAnimation);
-                    }
-                    for (auto *se : mSubEntityList)
-                    {
-                        // Blend dedicated geometry
-                        if (se->isVisible() && se->mSoftwareVertexAnimVertexData
-                            && se->getSubMesh()->getVertexAnimationType() != VAT_NONE)
-                        {
-                            bool useNormals = se->getSubMesh()->getVertexAnimationIncludesNormals();
-                            se->mTempVertexAnimInfo.checkoutTempCopies(true, useNormals);
-                            se->mTempVertexAnimInfo.bindTempCopies(se->mSoftwareVertexAnimVertexData.get(),
-                                                                   hwAnimation);
-                        }
+                        bool useNormals = se->getSubMesh()->getVertexAnimationIncludesNormals();
+                        se->mTempVertexAnimInfo.checkoutTempCopies(true, useNormals);
+                        se->mTempVertexAnimInfo.bindTempCopies(se->mSoftwareVertexAnimVertexData.get(),
+                                                               hwAnimation);
                     }
                 }
-                applyVertexAnimation(hwAnimation, stencilShadows);
             }
+            applyVertexAnimation(hwAnimation, stencilShadows);
+        }
 
-            if (hasSkeleton())
-            {
-                cacheBoneMatrices();
-
-                // Software blend?
-                if (softwareAnimation)
-                {
-                    const Affine3* blendMatrices[OGRE_MAX_NUM_BONES];
+        // Firstly, check out working vertex buffers for the software blend
+        // NB we suppress hardware upload while doing blend if we're
+        // hardware animation, because the only reason for doing this
+        // is for shadow, which need only be uploaded then
+        if (hasSkeleton() && softwareAnimation)
+            bindSkelAnimTempCopies(blendNormals, hwAnimation || deferUpload);
 
-                    // Ok, we need to do a software blend
-                    // Firstly, check out working vertex buffers
-                    if (mSkelAnimVertexData)
-                    {
-                        // Blend shared geometry
-                        // NB we suppress hardware upload while doing blend if we're
-                        // hardware animation, because the only reason for doing this
-                        // is for shadow, which need only be uploaded then
-                        mTempSkelAnimInfo.checkoutTempCopies(true, blendNormals);
-                        mTempSkelAnimInfo.bindTempCopies(mSkelAnimVertexData.get(),
-                                                         hwAnimation);
-                        // Prepare blend matrices, TODO: Move out of here
-                        Mesh::prepareMatricesForVertexBlend(blendMatrices,
-                                                            mBoneMatrices, mMesh->sharedBlendIndexToBoneIndexMap);
-                        // Blend, taking source from either mesh data or morph data
-                        Mesh::softwareVertexBlend(
-                            (mMesh->getSharedVertexDataAnimationType() != VAT_NONE) ?
-                            mSoftwareVertexAnimVertexData.get() : mMesh->sharedVertexData,
-                            mSkelAnimVertexData.get(),
-                            blendMatrices, mMesh->sharedBlendIndexToBoneIndexMap.size(),
-                            blendNormals);
-                    }
+        return update;
+    }
+    //-----------------------------------------------------------------------
+    void Entity::bindSkelAnimTempCopies(bool blendNormals, bool suppressHardwareUpload)
+    {
+        if (mSkelAnimVertexData)
+        {
+            mTempSkelAnimInfo.checkoutTempCopies(true, blendNormals);
+            mTempSkelAnimInfo.bindTempCopies(mSkelAnimVertexData.get(), suppressHardwareUpload);
+        }
 
-                    for (auto *se : mSubEntityList)
-                    {
-                        // Blend dedicated geometry
-                        if (se->isVisible() && se->mSkelAnimVertexData)
-                        {
-                            se->mTempSkelAnimInfo.checkoutTempCopies(true, blendNormals);
-                            se->mTempSkelAnimInfo.bindTempCopies(se->mSkelAnimVertexData.get(),
-                                                                 hwAnimation);
-                            // Prepare blend matrices, TODO: Move out of here
-                            Mesh::prepareMatricesForVertexBlend(blendMatrices,
-                                                                mBoneMatrices, se->mSubMesh->blendIndexToBoneIndexMap);
-                            // Blend, taking source from either mesh data or morph data
-                            Mesh::softwareVertexBlend(
-                                (se->getSubMesh()->getVertexAnimationType() != VAT_NONE)?
-                                se->mSoftwareVertexAnimVertexData.get() : se->mSubMesh->vertexData,
-                                se->mSkelAnimVertexData.get(),
-                                blendMatrices, se->mSubMesh->blendIndexToBoneIndexMap.size(),
-                                blendNormals);
-                        }
+        for (auto *se : mSubEntityList)
+        {
+            if (se->isVisible() && se->mSkelAnimVertexData)
+            {
+                se->mTempSkelAnimInfo.checkoutTempCopies(true, blendNormals);
+                se->mTempSkelAnimInfo.bindTempCopies(se->mSkelAnimVertexData.get(), suppressHardwareUpload);
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void Entity::softwareVertexBlend(bool blendNormals)
+    {
+        const Affine3* blendMatrices[OGRE_MAX_NUM_BONES];
 
-                    }
+        if (mSkelAnimVertexData)
+        {
+            // Blend shared geometry
+            // Prepare blend matrices, TODO: Move out of here
+            Mesh::prepareMatricesForVertexBlend(blendMatrices,
+                                                mBoneMatrices, mMesh->sharedBlendIndexToBoneIndexMap);
+            // Blend, taking source from either mesh data or morph data
+            Mesh::softwareVertexBlend(
+                (mMesh->getSharedVertexDataAnimationType() != VAT_NONE) ?
+                mSoftwareVertexAnimVertexData.get() : mMesh->sharedVertexData,
+                mSkelAnimVertexData.get(),
+                blendMatrices, mMesh->sharedBlendIndexToBoneIndexMap.size(),
+                blendNormals);
+        }
 
-                }
+        for (auto *se : mSubEntityList)
+        {
+            // Blend dedicated geometry
+            if (se->isVisible() && se->mSkelAnimVertexData)
+            {
+                // Prepare blend matrices, TODO: Move out of here
+                Mesh::prepareMatricesForVertexBlend(blendMatrices,
+                                                    mBoneMatrices, se->mSubMesh->blendIndexToBoneIndexMap);
+                // Blend, taking source from either mesh data or morph data
+                Mesh::softwareVertexBlend(
+                    (se->getSubMesh()->getVertexAnimationType() != VAT_NONE)?
+                    se->mSoftwareVertexAnimVertexData.get() : se->mSubMesh->vertexData,
+                    se->mSkelAnimVertexData.get(),
+                    blendMatrices, se->mSubMesh->blendIndexToBoneIndexMap.size(),
+                    blendNormals);
             }
-
+        }
+    }
+    //-----------------------------------------------------------------------
+    void Entity::endAnimationUpdate(const AnimationUpdate& update)
+    {
+        if (update.updateBuffers)
+        {
             // Trigger update of bounding box if necessary
             if (!mChildObjectList.empty())
                 mParentNode->needUpdate();
@@ -876,8 +1056,8 @@ namespace Ogre {
         // Need to update the child object's transforms when animation dirty
         // or parent node transform has altered.
         if (hasSkeleton() && 
-            (isNeedUpdateHardwareAnim || 
-             animationDirty || mLastParentXform != _getParentNodeFullTransform()))
+            (update.needUpdateHardwareAnim ||
+             update.animationDirty || mLastParentXform != _getParentNodeFullTransform()))
         {
             // Cache last parent transform for next frame use too.
             mLastParentXform = _getParentNodeFullTransform();
@@ -890,7 +1070,7 @@ namespace Ogre {
 
             // Also calculate bone world matrices, since are used as replacement world matrices,
             // but only if it's used (when using hardware animation and skeleton animated).
-            if (hwAnimation && _isSkeletonAnimated() && !MeshManager::getBonesUseObjectSpace())
+            if (update.hwAnimation && _isSkeletonAnimated() && !MeshManager::getBonesUseObjectSpace())
             {
                 // Allocate bone world matrices on demand, for better memory footprint
                 // when using software animation.
@@ -1269,6 +1449,99 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Entity::_updateAnimations(const std::vector<Entity*>& entities)
+    {
+        struct SkeletalUpdate
+        {
+            Entity* entity;
+            AnimationUpdate update;
+            /// range of the entity in SoftwareSkinningBatch::jobs
+            size_t firstJob, lastJob;
+        };
+        std::vector<SkeletalUpdate> skeletal;
+        std::set<Animation*> preparedAnimations;
+
+        {
+            SoftwareSkinningBatch skinning;
+
+            // Everything that may touch the GPU or state shared between entities happens here
+            for (auto e : entities)
+            {
+                if (!e->mInitialised || !(e->hasSkeleton() || e->hasVertexAnimation()))
+                    continue;
+
+                if (!e->hasSkeleton() || !e->mChildObjectList.empty() || e->sharesSkeletonInstance())
+                {
+                    // attached objects notify the scene graph when the bones move
+                    e->updateAnimation();
+                    continue;
+                }
+
+                SkeletalUpdate s = {e, e->beginAnimationUpdate(true), 0, 0};
+                if (!s.update.updateBuffers)
+                {
+                    e->endAnimationUpdate(s.update);
+                    continue;
+                }
+
+                if (!e->mSkipAnimStateUpdates)
+                {
+                    for (const auto* state : e->mAnimationState->getEnabledAnimationStates())
+                    {
+                        Animation* anim = e->mSkeletonInstance->getAnimation(state->getAnimationName());
+                        if (anim && preparedAnimations.insert(anim).second)
+                            prepareAnimation(anim, state->getTimePosition());
+                    }
+                }
+
+                s.firstJob = skinning.jobs.size();
+                if (s.update.softwareAnimation)
+                {
+                    const MeshPtr& mesh = e->mMesh;
+                    if (e->mSkelAnimVertexData)
+                    {
+                        skinning.add((mesh->getSharedVertexDataAnimationType() != VAT_NONE)
+                                         ? e->mSoftwareVertexAnimVertexData.get()
+                                         : mesh->sharedVertexData,
+                                     e->mSkelAnimVertexData.get(), e->mBoneMatrices,
+                                     mesh->sharedBlendIndexToBoneIndexMap, s.update.blendNormals);
+                    }
+                    for (auto* se : e->mSubEntityList)
+                    {
+                        if (se->isVisible() && se->mSkelAnimVertexData)
+                        {
+                            skinning.add((se->getSubMesh()->getVertexAnimationType() != VAT_NONE)
+                                             ? se->mSoftwareVertexAnimVertexData.get()
+                                             : se->mSubMesh->vertexData,
+                                         se->mSkelAnimVertexData.get(), e->mBoneMatrices,
+                                         se->mSubMesh->blendIndexToBoneIndexMap, s.update.blendNormals);
+                        }
+                    }
+                }
+                s.lastJob = skinning.jobs.size();
+                skeletal.push_back(s);
+            }
+
+            // Evaluate the skeletons and blend the vertices
+            Root::getSingleton().getWorkQueue()->processTasksParallel(
+                skeletal.size(),
+                [&skeletal, &skinning](size_t i)
+                {
+                    const SkeletalUpdate& s = skeletal[i];
+                    s.entity->cacheBoneMatrices();
+                    skinning.run(s.firstJob, s.lastJob);
+                });
+        } // buffers are unlocked here
+
+        for (const auto& s : skeletal)
+        {
+            // upload the blended vertices, unless needed for shadows only
+            if (s.update.softwareAnimation)
+                s.entity->bindSkelAnimTempCopies(s.update.blendNormals, s.update.hwAnimation);
+            s.entity->endAnimationUpdate(s.update);
+        }
+    }
+    //-----------------------------------------------------------------------
     bool Entity::_isAnimated(void) const
     {
         return (mAnimationState && mAnimationState->hasEnabledAnimationState()) ||
@@ -1306,16 +1579,93 @@ namespace Ogre {
         if ((*mFrameBonesLastUpdated != currentFrameNumber) ||
             (hasSkeleton() && getSkeleton()->getManualBonesDirty()))
         {
-            if ((!mSkipAnimStateUpdates) && (*mFrameBonesLastUpdated != currentFrameNumber))
+            bool newFrame = *mFrameBonesLastUpdated != currentFrameNumber;
+            *mFrameBonesLastUpdated  = currentFrameNumber;
+            if (newFrame && !getSkeleton()->getManualBonesDirty() && updateLodBoneMatrices(currentFrameNumber))
+                return true;
+
+            if ((!mSkipAnimStateUpdates) && newFrame)
                 mSkeletonInstance->setAnimationState(*mAnimationState);
             mSkeletonInstance->_getBoneMatrices(mBoneMatrices);
-            *mFrameBonesLastUpdated  = currentFrameNumber;
 
             return true;
         }
         return false;
     }
     //-----------------------------------------------------------------------
+    bool Entity::updateLodBoneMatrices(unsigned long frameNumber)
+    {
+        if (mAnimationLodValues.empty() || mSkipAnimStateUpdates || mSharedSkeletonEntities)
+            return false;
+
+        if (mAnimationLodIndex == 0)
+        {
+            // full detail, evaluate every frame the normal way. The next higher level then
+            // starts from a fresh evaluation, as mFrameAnimationLodEvaluated is outdated
+            mSkeletonInstance->_setMinorBonesFrozen(false);
+            return false;
+        }
+
+        size_t numBones = mNumBoneMatrices;
+        unsigned long interval = mAnimationLodIndex + 1;
+        unsigned long sinceEvaluated = frameNumber - mFrameAnimationLodEvaluated;
+        if (mLodBoneTransforms.empty() || sinceEvaluated >= interval || (frameNumber + mAnimationLodPhase) % interval == 0)
+        {
+            mSkeletonInstance->_setMinorBonesFrozen(mAnimationLodIndex >= mMinorBonesLodIndex);
+            mSkeletonInstance->setAnimationState(*mAnimationState);
+
+            // continue from the pose shown so far, so changing the level does not pop
+            bool first = mLodBoneTransforms.empty();
+            mLodBoneTransforms.resize(2 * numBones);
+            LodBoneTransform* prev = &mLodBoneTransforms[0];
+            LodBoneTransform* next = &mLodBoneTransforms[numBones];
+            if (!first)
+            {
+                for (size_t i = 0; i < numBones; ++i)
+                    mBoneMatrices[i].decomposition(prev[i].position, prev[i].scale, prev[i].orientation);
+            }
+            mSkeletonInstance->_getBoneMatrices(mBoneMatrices);
+            for (size_t i = 0; i < numBones; ++i)
+                mBoneMatrices[i].decomposition(next[i].position, next[i].scale, next[i].orientation);
+            if (first)
+                std::copy(next, next + numBones, prev);
+
+            mFrameAnimationLodEvaluated = frameNumber;
+            sinceEvaluated = 0;
+        }
+
+        // reach the latest evaluation just before the next one. Blending the matrices
+        // element-wise would shrink and shear rotating joints, so blend the components
+        Real t = std::min(Real(1), Real(sinceEvaluated + 1) / interval);
+        const LodBoneTransform* prev = &mLodBoneTransforms[0];
+        const LodBoneTransform* next = &mLodBoneTransforms[numBones];
+        for (size_t i = 0; i < numBones; ++i)
+        {
+            mBoneMatrices[i].makeTransform(prev[i].position + (next[i].position - prev[i].position) * t,
+                                           prev[i].scale + (next[i].scale - prev[i].scale) * t,
+                                           Quaternion::nlerp(t, prev[i].orientation, next[i].orientation, true));
+        }
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void Entity::setAnimationLodLevels(const std::vector<Real>& lodValues, ushort minorBonesLodIndex)
+    {
+        mAnimationLodValues.clear();
+        mAnimationLodIndex = 0;
+        mMinorBonesLodIndex = minorBonesLodIndex;
+        mLodBoneTransforms.clear();
+        if (mSkeletonInstance)
+            mSkeletonInstance->_setMinorBonesFrozen(false);
+        if (lodValues.empty())
+            return;
+
+        const LodStrategy* strategy = mMesh->getLodStrategy();
+        mAnimationLodValues.push_back(strategy->getBaseValue());
+        for (auto v : lodValues)
+            mAnimationLodValues.push_back(strategy->transformUserValue(v));
+        mAnimationLodPhase = FastHash(mName.c_str(), mName.size());
+    }
+    //-----------------------------------------------------------------------
     void Entity::setDisplaySkeleton(bool display)
     {
         mDisplaySkeleton = display;
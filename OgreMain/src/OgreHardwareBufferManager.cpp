@@ -55,7 +55,7 @@ namespace Ogre {
     const size_t HardwareBufferManagerBase::EXPIRED_DELAY_FRAME_THRESHOLD = 5;
     //-----------------------------------------------------------------------
     HardwareBufferManagerBase::HardwareBufferManagerBase()
-        : mUnderUsedFrameCount(0)
+        : mUnderUsedFrameCount(0), mTransientFrame(0), mTransientBufferSize(4 << 20)
     {
     }
     //-----------------------------------------------------------------------
@@ -249,8 +249,93 @@ namespace Ogre {
         LogManager::getSingleton().logMessage(str.str(), LML_TRIVIAL);
     }
     //-----------------------------------------------------------------------
+    template<typename BufferPtr, typename CreateFunc>
+    size_t HardwareBufferManagerBase::allocateTransient(TransientRing<BufferPtr>& ring, size_t bytes,
+                                                        size_t alignment,
+                                                        HardwareBuffer::LockOptions& lockOptions,
+                                                        const CreateFunc& create)
+    {
+        size_t capacity = ring.buffer ? ring.buffer->getSizeInBytes() : 0;
+        size_t offset = (ring.used + alignment - 1) / alignment * alignment;
+
+        if (offset + bytes <= capacity)
+        {
+            // untouched since the last discard, no need to wait for the GPU
+            lockOptions = HardwareBuffer::HBL_NO_OVERWRITE;
+        }
+        else if (ring.frame != mTransientFrame && bytes <= capacity)
+        {
+            // all allocations in the buffer are from earlier frames, wrap around
+            offset = 0;
+            lockOptions = HardwareBuffer::HBL_DISCARD;
+        }
+        else
+        {
+            // earlier allocations of this frame keep referencing the old buffer
+            size_t size = std::max(std::max(mTransientBufferSize, 2 * capacity), 2 * bytes);
+            ring.buffer = create((size + alignment - 1) / alignment * alignment);
+            offset = 0;
+            lockOptions = HardwareBuffer::HBL_DISCARD;
+        }
+
+        ring.used = offset + bytes;
+        ring.frame = mTransientFrame;
+        return offset;
+    }
+    //-----------------------------------------------------------------------
+    HardwareBufferManagerBase::TransientVertices
+    HardwareBufferManagerBase::allocateTransientVertices(size_t vertexSize, size_t numVerts)
+    {
+        OGRE_LOCK_MUTEX(mTransientBuffersMutex);
+        // whole vertices, so the allocation is addressable by vertexStart
+        size_t gcd = vertexSize, b = 256;
+        while (b)
+        {
+            size_t t = gcd % b;
+            gcd = b;
+            b = t;
+        }
+        size_t alignment = vertexSize / gcd * 256;
+
+        TransientVertices ret;
+        auto& ring = mTransientVertexRings[vertexSize];
+        size_t offset = allocateTransient(ring, vertexSize * numVerts, alignment, ret.lockOptions,
+                                          [this, vertexSize](size_t bytes) {
+                                              return createVertexBuffer(vertexSize, bytes / vertexSize,
+                                                                        HBU_CPU_TO_GPU);
+                                          });
+        ret.buffer = ring.buffer;
+        ret.start = offset / vertexSize;
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    HardwareBufferManagerBase::TransientIndices
+    HardwareBufferManagerBase::allocateTransientIndices(HardwareIndexBuffer::IndexType itype,
+                                                        size_t numIndexes)
+    {
+        OGRE_LOCK_MUTEX(mTransientBuffersMutex);
+        size_t indexSize = HardwareIndexBuffer::indexSize(itype);
+
+        TransientIndices ret;
+        auto& ring = mTransientIndexRings[itype == HardwareIndexBuffer::IT_32BIT];
+        size_t offset = allocateTransient(ring, indexSize * numIndexes, 256, ret.lockOptions,
+                                          [this, itype, indexSize](size_t bytes) {
+                                              return createIndexBuffer(itype, bytes / indexSize,
+                                                                       HBU_CPU_TO_GPU);
+                                          });
+        ret.buffer = ring.buffer;
+        ret.start = offset / indexSize;
+        return ret;
+    }
+    //-----------------------------------------------------------------------
     void HardwareBufferManagerBase::_releaseBufferCopies(bool forceFreeUnused)
     {
+        {
+            OGRE_LOCK_MUTEX(mTransientBuffersMutex);
+            // transient allocations of this frame are no longer referenced after it
+            ++mTransientFrame;
+        }
+
         OGRE_LOCK_MUTEX(mTempBuffersMutex);
         size_t numUnused = mFreeTempVertexBufferMap.size();
         size_t numUsed = mTempVertexBufferLicenses.size();
@@ -31,11 +31,16 @@ THE SOFTWARE.
 #include "OgreInstancedEntity.h"
 #include "OgreRenderQueue.h"
 #include "OgreLodListener.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreWorkQueue.h"
 
 namespace Ogre
 {
     const String MOT_INSTANCE_BATCH = "InstanceBatch";
 
+    //Size of the ranges of processRangesParallel, smaller ones are not worth the synchronisation
+    static const size_t c_entitiesPerTask = 4096;
+
     InstanceBatch::InstanceBatch( InstanceManager *creator, MeshPtr &meshReference,
                                     const MaterialPtr &material, size_t instancesPerBatch,
                                     const Mesh::IndexMap *indexToBoneMap, const String &batchName ) :
@@ -217,6 +222,111 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------
+    void InstanceBatch::processRangesParallel( size_t count, const std::function<void(size_t, size_t)>& task )
+    {
+        const size_t numRanges = (count + c_entitiesPerTask - 1) / c_entitiesPerTask;
+        if( numRanges <= 1 )
+        {
+            if( count )
+                task( 0, count );
+            return;
+        }
+
+        Root::getSingleton().getWorkQueue()->processTasksParallel( numRanges, [&]( size_t range ) {
+            const size_t begin = range * c_entitiesPerTask;
+            task( begin, std::min( begin + c_entitiesPerTask, count ) );
+        } );
+    }
+    //-----------------------------------------------------------------------
+    size_t InstanceBatch::findVisibleEntities( Camera *camera )
+    {
+        const size_t count = mInstancedEntities.size();
+        mVisibleEntities.resize( count );
+
+        //Subclasses may override Camera::isVisible, only plain frustums are culled against their planes
+        const Frustum *frustum = camera && camera->getCullingFrustum() ? camera->getCullingFrustum() : camera;
+        if( !camera || typeid(*camera) != typeid(Camera) ||
+            (frustum != camera && typeid(*frustum) != typeid(Frustum)) )
+        {
+            size_t numVisible = 0;
+            for( size_t i = 0; i < count; ++i )
+            {
+                if( mInstancedEntities[i]->findVisible( camera ) )
+                {
+                    //Update the cached transform here, see below
+                    mInstancedEntities[i]->_getParentNodeFullTransform();
+                    mVisibleEntities[numVisible++] = uint32(i);
+                }
+            }
+            return numVisible;
+        }
+
+        Plane planes[6];
+        size_t numPlanes = 0;
+        for( int i = 0; i < 6; ++i )
+        {
+            //Skip far plane if infinite view frustum, like Frustum::isVisible does
+            if( i != FRUSTUM_PLANE_FAR || frustum->getFarClipDistance() != 0 )
+                planes[numPlanes++] = frustum->getFrustumPlanes()[i];
+        }
+
+        mCullingSpheres.resize( count * 4 );
+        float *centresX = mCullingSpheres.data();
+        float *centresY = centresX + count;
+        float *centresZ = centresY + count;
+        float *radii    = centresZ + count;
+
+        //Gathered serially, as entities may share a node, whose derived transform is updated
+        //lazily on first access. This also leaves the transforms cached for the parallel buffer
+        //updates, which call getTransforms3x4 on the visible entities
+        for( size_t i = 0; i < count; ++i )
+        {
+            const InstancedEntity *entity = mInstancedEntities[i];
+            if( entity->isInScene() && entity->isVisible() )
+            {
+                entity->_getParentNodeFullTransform();
+                const Vector3 &pos = entity->_getDerivedPosition();
+                centresX[i] = float( pos.x );
+                centresY[i] = float( pos.y );
+                centresZ[i] = float( pos.z );
+                radii[i] = float( entity->getBoundingRadius() * entity->getMaxScaleCoef() );
+            }
+            else
+            {
+                //Always culled
+                centresX[i] = centresY[i] = centresZ[i] = 0;
+                radii[i] = -std::numeric_limits<float>::infinity();
+            }
+        }
+
+        //Every range is compacted in place first, then moved next to the preceding ones
+        std::vector<size_t> rangeCounts( (count + c_entitiesPerTask - 1) / c_entitiesPerTask );
+
+        processRangesParallel( count, [&]( size_t begin, size_t end ) {
+            uint32 *visible = mVisibleEntities.data() + begin;
+            const size_t numVisible = OptimisedUtil::getImplementation()->cullSpheres(
+                planes, numPlanes, centresX + begin, centresY + begin, centresZ + begin, radii + begin,
+                visible, end - begin );
+            for( size_t i = 0; i < numVisible; ++i )
+                visible[i] += uint32(begin);
+
+            rangeCounts[begin / c_entitiesPerTask] = numVisible;
+        } );
+
+        size_t numVisible = 0;
+        for( size_t r = 0; r < rangeCounts.size(); ++r )
+        {
+            const size_t begin = r * c_entitiesPerTask;
+            if( begin != numVisible )
+            {
+                std::copy( mVisibleEntities.begin() + begin, mVisibleEntities.begin() + begin + rangeCounts[r],
+                           mVisibleEntities.begin() + numVisible );
+            }
+            numVisible += rangeCounts[r];
+        }
+        return numVisible;
+    }
+    //-----------------------------------------------------------------------
     RenderOperation InstanceBatch::build( const SubMesh* baseSubMesh )
     {
         if( checkSubMeshCompatibility( baseSubMesh ) )
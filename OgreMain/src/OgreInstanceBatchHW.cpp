@@ -142,7 +142,9 @@ namespace Ogre
     //-----------------------------------------------------------------------
     size_t InstanceBatchHW::updateVertexBuffer( Camera *currentCamera )
     {
-        size_t retVal = 0;
+        //Cull on an individual basis, the less entities are visible, the less instances we draw.
+        //No need to use null matrices at all!
+        const size_t numVisible = findVisibleEntities( currentCamera );
 
         //Now lock the vertex buffer and copy the 4x3 matrices, only those who need it!
         VertexBufferBinding* binding = mRenderOperation.vertexData->vertexBufferBinding; 
@@ -150,33 +152,34 @@ namespace Ogre
         HardwareBufferLockGuard vertexLock(binding->getBuffer(bufferIdx), HardwareBuffer::HBL_DISCARD);
         float *pDest = static_cast<float*>(vertexLock.pData);
         unsigned char numCustomParams           = mCreator->getNumCustomParams();
-        size_t customParamIdx                   = 0;
 
-        for (auto *e : mInstancedEntities)
-        {
-            //Cull on an individual basis, the less entities are visible, the less instances we draw.
-            //No need to use null matrices at all!
-            if (e->findVisible(currentCamera ))
-            {
-                const size_t floatsWritten = e->getTransforms3x4( (Matrix3x4f*)pDest);
+        //No skeletal animation, so every instance takes one matrix and its custom parameters
+        const size_t floatsPerInstance = 12 + numCustomParams * 4;
+        const bool cameraRelative = mManager->getCameraRelativeRendering();
+        const Vector3f cameraPosition( cameraRelative ? mCurrentCamera->getDerivedPosition() : Vector3::ZERO );
 
-                if( mManager->getCameraRelativeRendering() )
-                    makeMatrixCameraRelative3x4((Matrix3x4f*)pDest, floatsWritten / 12);
+        //The visible instances are stream compacted, so each range writes its own part of the buffer
+        processRangesParallel( numVisible, [&]( size_t begin, size_t end ) {
+            float *pInstance = pDest + begin * floatsPerInstance;
+            for( size_t i = begin; i < end; ++i )
+            {
+                const size_t entityIdx = mVisibleEntities[i];
+                Matrix3x4f *transform = reinterpret_cast<Matrix3x4f*>(pInstance);
+                pInstance += mInstancedEntities[entityIdx]->getTransforms3x4( transform );
 
-                pDest += floatsWritten;
+                if( cameraRelative )
+                    transform->setTrans( transform->getTrans() - cameraPosition );
 
                 //Write custom parameters, if any
-                for (unsigned char i = 0; i < numCustomParams; ++i)
+                for (unsigned char j = 0; j < numCustomParams; ++j)
                 {
-                    memcpy(pDest, mCustomParams[customParamIdx+i].ptr(), sizeof(Vector4f));
-                    pDest += 4;
+                    memcpy(pInstance, mCustomParams[entityIdx * numCustomParams + j].ptr(), sizeof(Vector4f));
+                    pInstance += 4;
                 }
-                ++retVal;
             }
-            customParamIdx += numCustomParams;
-        }
+        } );
 
-        return retVal;
+        return numVisible;
     }
     //-----------------------------------------------------------------------
     void InstanceBatchHW::_boundsDirty(void)
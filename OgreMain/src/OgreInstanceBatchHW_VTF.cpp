@@ -228,11 +228,17 @@ namespace Ogre
                 thisVertexData->vertexDeclaration->getNextFreeTextureCoordinate() ).getSize();
             offset += thisVertexData->vertexDeclaration->addElement( newSource, offset, VET_FLOAT4, VES_TEXTURE_COORDINATES,
                 thisVertexData->vertexDeclaration->getNextFreeTextureCoordinate() ).getSize();
-            thisVertexData->vertexDeclaration->addElement( newSource, offset, VET_FLOAT4, VES_TEXTURE_COORDINATES,
+            offset += thisVertexData->vertexDeclaration->addElement( newSource, offset, VET_FLOAT4, VES_TEXTURE_COORDINATES,
                 thisVertexData->vertexDeclaration->getNextFreeTextureCoordinate() ).getSize();
             //Add two floats of padding here? or earlier?
             //If not using bone matrix lookup, is it ok that it is 8 bytes since divides evenly into 16
 
+            //Baked animations add the UV offset of the next frame and the weight to interpolate with
+            if (useBakedAnimations())
+            {
+                thisVertexData->vertexDeclaration->addElement( newSource, offset, VET_FLOAT4, VES_TEXTURE_COORDINATES,
+                    thisVertexData->vertexDeclaration->getNextFreeTextureCoordinate() );
+            }
         }
 
         //Create our own vertex buffer
@@ -269,24 +275,33 @@ namespace Ogre
             texelOffsets.x = /*renderSystem->getHorizontalTexelOffset()*/ -0.5f / texWidth;
             texelOffsets.y = /*renderSystem->getHorizontalTexelOffset()*/ -0.5f / texHeight;
 
+            //Update all instances if we are not using a lookup bone matrix method, in this case the
+            //function will be called only once. Otherwise only those in the visible range of the camera
+            //(for look up bone matrix method and static mode).
+            visibleEntityCount = useMatrixLookup ? findVisibleEntities(currentCamera) : mInstancesPerBatch;
+
             HardwareBufferLockGuard instanceVertexLock(mInstanceVertexBuffer, HardwareBuffer::HBL_DISCARD);
-            float *thisVec = static_cast<float*>(instanceVertexLock.pData);
+            float *pDest = static_cast<float*>(instanceVertexLock.pData);
 
             const size_t maxPixelsPerLine = std::min( static_cast<size_t>(mMatrixTexture->getWidth()), mMaxFloatsPerLine >> 2 );
-
-            //Calculate UV offsets, which change per instance
-            for( size_t i=0; i<mInstancesPerBatch; ++i )
-            {
-                InstancedEntity* entity = useMatrixLookup ? mInstancedEntities[i] : NULL;
-                if  //Update if we are not using a lookup bone matrix method. In this case the function will 
-                    //be called only once
-                    (!useMatrixLookup || 
-                    //Update if we are in the visible range of the camera (for look up bone matrix method
-                    //and static mode).
-                    (entity->findVisible(currentCamera)))
+            const size_t floatsPerInstance = useBakedAnimations() ? 18 : useMatrixLookup ? 14 : 2;
+            const bool cameraRelative = currentCamera && mManager->getCameraRelativeRendering();
+            const Vector3 cameraRelativePosition = cameraRelative ? currentCamera->getDerivedPosition() : Vector3::ZERO;
+
+            //Calculate UV offsets, which change per instance. The visible instances are stream
+            //compacted, so each range writes its own part of the buffer
+            processRangesParallel( visibleEntityCount, [&]( size_t begin, size_t end ) {
+                float *thisVec = pDest + begin * floatsPerInstance;
+                for( size_t i = begin; i < end; ++i )
                 {
-                    size_t matrixIndex = useMatrixLookup ? entity->mTransformLookupNumber : i;
-                    size_t instanceIdx = matrixIndex * mMatricesPerInstance * mRowLength;
+                    InstancedEntity* entity = useMatrixLookup ? mInstancedEntities[mVisibleEntities[i]] : NULL;
+                    size_t frames[2] = {i, i};
+                    float frameWeight = 0;
+                    if (useBakedAnimations())
+                        getBakedAnimationFrames(entity, frames, frameWeight);
+                    else if (useMatrixLookup)
+                        frames[0] = entity->mTransformLookupNumber;
+                    size_t instanceIdx = frames[0] * mMatricesPerInstance * mRowLength;
                     *thisVec = ((instanceIdx % maxPixelsPerLine) / texWidth) - (float)(texelOffsets.x);
                     *(thisVec + 1) = ((instanceIdx / maxPixelsPerLine) / texHeight) - (float)(texelOffsets.y);
                     thisVec += 2;
@@ -306,18 +321,26 @@ namespace Ogre
                         *(thisVec + 9) = static_cast<float>( mat[2][1] );
                         *(thisVec + 10)= static_cast<float>( mat[2][2] );
                         *(thisVec + 11)= static_cast<float>( mat[2][3] );
-                        if(currentCamera && mManager->getCameraRelativeRendering()) // && useMatrixLookup
+                        if(cameraRelative) // && useMatrixLookup
                         {
-                            const Vector3 &cameraRelativePosition = currentCamera->getDerivedPosition();
                             *(thisVec + 3) -= static_cast<float>( cameraRelativePosition.x );
                             *(thisVec + 7) -= static_cast<float>( cameraRelativePosition.y );
                             *(thisVec + 11) -=  static_cast<float>( cameraRelativePosition.z );
                         }
                         thisVec += 12;
                     }
-                    ++visibleEntityCount;
+
+                    if (useBakedAnimations())
+                    {
+                        instanceIdx = frames[1] * mMatricesPerInstance * mRowLength;
+                        *thisVec = ((instanceIdx % maxPixelsPerLine) / texWidth) - (float)(texelOffsets.x);
+                        *(thisVec + 1) = ((instanceIdx / maxPixelsPerLine) / texHeight) - (float)(texelOffsets.y);
+                        *(thisVec + 2) = frameWeight;
+                        *(thisVec + 3) = 0;
+                        thisVec += 4;
+                    }
                 }
-            }
+            } );
         }
         else
         {
@@ -369,7 +392,8 @@ namespace Ogre
             //See InstanceBatchHW::calculateMaxNumInstances for the 65535
             retVal = std::min<size_t>( 65535, maxUsableWidth * c_maxTexHeightHW / mRowLength / numBones );
 
-            if( flags & IM_VTFBESTFIT )
+            //Baked animations don't depend on the number of instances, nothing to fit
+            if( (flags & IM_VTFBESTFIT) && !(flags & IM_VTFBAKEDANIMATIONS) )
             {
                 size_t numUsedSkeletons = mInstancesPerBatch;
                 if (flags & IM_VTFBONEMATRIXLOOKUP)
@@ -404,8 +428,17 @@ namespace Ogre
             //updateInstanceDataBuffer() function, not from this function.
             renderedInstances = updateInstanceDataBuffer(false, currentCamera);
         }
+        else
+        {
+            //Cull on an individual basis, the less entities are visible, the less instances we draw.
+            //No need to use null matrices at all!
+            renderedInstances = findVisibleEntities(currentCamera);
+        }
+
+        //Baked animations are already in the texture, the instance data is all that changes
+        if (useBakedAnimations())
+            return renderedInstances;
 
-        
         mDirtyAnimation = false;
 
         //Now lock the texture and copy the 4x3 matrices!
@@ -414,15 +447,10 @@ namespace Ogre
 
         float *pSource = reinterpret_cast<float*>(pixelBox.data);
         
-        InstancedEntityVec::const_iterator itor = mInstancedEntities.begin();
-        
         std::vector<bool> writtenPositions(getMaxLookupTableInstances(), false);
 
         size_t floatPerEntity = mMatricesPerInstance * mRowLength * 4;
         size_t entitiesPerPadding = (size_t)(mMaxFloatsPerLine / floatPerEntity);
-        
-        size_t instanceCount = mInstancedEntities.size();
-        size_t updatedInstances = 0;
 
         Matrix3x4f* transforms = NULL;
         //If using dual quaternions, write 3x4 matrices to a temporary buffer, then convert to dual quaternions
@@ -431,20 +459,18 @@ namespace Ogre
             transforms = (Matrix3x4f*)mTempTransformsArray3x4;
         }
         
-        for(size_t i = 0 ; i < instanceCount ; ++i)
+        //Both paths above left the visible entities in mVisibleEntities
+        for(size_t i = 0 ; i < renderedInstances ; ++i)
         {
-            InstancedEntity* entity = mInstancedEntities[i];
-            size_t textureLookupPosition = updatedInstances;
+            InstancedEntity* entity = mInstancedEntities[mVisibleEntities[i]];
+            size_t textureLookupPosition = i;
             if (useMatrixLookup)
             {
                 textureLookupPosition = entity->mTransformLookupNumber;
             }
             //Check that we are not using a lookup matrix or that we have not already written
             //The bone data
-            if (((!useMatrixLookup) || !writtenPositions[entity->mTransformLookupNumber]) &&
-                //Cull on an individual basis, the less entities are visible, the less instances we draw.
-                //No need to use null matrices at all!
-                (entity->findVisible( currentCamera )))
+            if ((!useMatrixLookup) || !writtenPositions[entity->mTransformLookupNumber])
             {
                 float* pDest = pSource + floatPerEntity * textureLookupPosition + 
                     (size_t)(textureLookupPosition / entitiesPerPadding) * mWidthFloatsPadding;
@@ -471,18 +497,7 @@ namespace Ogre
                 {
                     writtenPositions[entity->mTransformLookupNumber] = true;
                 }
-                else
-                {
-                    ++updatedInstances;
-                }
             }
-
-            ++itor;
-        }
-
-        if (!useMatrixLookup)
-        {
-            renderedInstances = updatedInstances;
         }
 
         return renderedInstances;
@@ -28,9 +28,12 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreInstanceBatchVTF.h"
 #include "OgreHardwarePixelBuffer.h"
+#include "OgreImage.h"
 #include "OgreInstancedEntity.h"
+#include "OgreInstanceManager.h"
 #include "OgreMaterial.h"
 #include "OgreDualQuaternion.h"
+#include "OgreSkeletonInstance.h"
 
 namespace Ogre
 {
@@ -53,7 +56,8 @@ namespace Ogre
                 mMaxLookupTableInstances(16),
                 mUseBoneDualQuaternions(false),
                 mForceOneWeight(false),
-                mUseOneWeight(false)
+                mUseOneWeight(false),
+                mBakedAnimationRate(0)
     {
         cloneMaterial( mMaterial );
     }
@@ -73,8 +77,8 @@ namespace Ogre
         //Remove cloned material
         MaterialManager::getSingleton().remove( mMaterial );
 
-        //Remove the VTF texture
-        if( mMatrixTexture )
+        //Remove the VTF texture, the shared one with baked animations belongs to the InstanceManager
+        if( mMatrixTexture && !useBakedAnimations() )
             TextureManager::getSingleton().remove( mMatrixTexture );
 
         delete[] mTempTransformsArray3x4;
@@ -223,7 +227,8 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------
-    void BaseInstanceBatchVTF::createVertexTexture( const SubMesh* baseSubMesh )
+    void BaseInstanceBatchVTF::calculateVertexTextureSize( const SubMesh* baseSubMesh, size_t& texWidth,
+                                                           size_t& texHeight )
     {
         /*
         TODO: Find a way to retrieve max texture resolution,
@@ -232,7 +237,11 @@ namespace Ogre
         Currently assuming it's 4096x4096, which is a safe bet for any hardware with decent VTF*/
         
         size_t uniqueAnimations = mInstancesPerBatch;
-        if (useBoneMatrixLookup())
+        if (useBakedAnimations())
+        {
+            uniqueAnimations = createBakedAnimationLayout();
+        }
+        else if (useBoneMatrixLookup())
         {
             uniqueAnimations = std::min<size_t>(getMaxLookupTableInstances(), uniqueAnimations);
         }
@@ -248,7 +257,7 @@ namespace Ogre
         //Calculate the width & height required to hold all the matrices. Start by filling the width
         //first (i.e. 4096x1 4096x2 4096x3, etc)
         
-        size_t texWidth         = std::min<size_t>( mNumWorldMatrices * mRowLength, c_maxTexWidth );
+        texWidth                = std::min<size_t>( mNumWorldMatrices * mRowLength, c_maxTexWidth );
         size_t maxUsableWidth   = texWidth;
         if( matricesTogetherPerRow() )
         {
@@ -268,24 +277,185 @@ namespace Ogre
             }
         }
 
-        size_t texHeight = mNumWorldMatrices * mRowLength / maxUsableWidth;
+        texHeight = mNumWorldMatrices * mRowLength / maxUsableWidth;
 
         if( (mNumWorldMatrices * mRowLength) % maxUsableWidth )
             texHeight += 1;
 
+        //The number of baked frames is not limited by calculateMaxNumInstances
+        OgreAssert(!useBakedAnimations() || texHeight <= c_maxTexHeight,
+                   "too many baked frames for the vertex texture, lower the sample rate");
+    }
+    //-----------------------------------------------------------------------
+    void BaseInstanceBatchVTF::createVertexTexture( const SubMesh* baseSubMesh )
+    {
+        size_t texWidth, texHeight;
+        calculateVertexTextureSize( baseSubMesh, texWidth, texHeight );
+
         //Don't use 1D textures, as OGL goes crazy because the shader should be calling texture1D()...
         TextureType texType = TEX_TYPE_2D;
 
-        mMatrixTexture = TextureManager::getSingleton().createManual(
-                                        mName + "/VTF", mMeshReference->getGroup(), texType,
-                                        (uint)texWidth, (uint)texHeight,
-                                        0, PF_FLOAT32_RGBA, TU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
+        if( useBakedAnimations() )
+        {
+            //The baked animations are the same for all batches of the manager, bake them
+            //once and share the texture. The InstanceManager removes it
+            const String texName = (mCreator ? mCreator->getName() : mName) + "/BakedVTF";
+            mMatrixTexture = TextureManager::getSingleton().getByName( texName, mMeshReference->getGroup() );
+            if( !mMatrixTexture )
+            {
+                mMatrixTexture = TextureManager::getSingleton().createManual(
+                                                texName, mMeshReference->getGroup(), texType,
+                                                (uint)texWidth, (uint)texHeight,
+                                                0, PF_FLOAT32_RGBA, TU_STATIC_WRITE_ONLY );
+                OgreAssert(mMatrixTexture->getFormat() == PF_FLOAT32_RGBA, "float texture support required");
+
+                Image baked( PF_FLOAT32_RGBA, (uint32)texWidth, (uint32)texHeight );
+                bakeAnimations( baked.getPixelBox() );
+                mMatrixTexture->getBuffer()->blitFromMemory( baked.getPixelBox() );
+            }
+        }
+        else
+        {
+            mMatrixTexture = TextureManager::getSingleton().createManual(
+                                            mName + "/VTF", mMeshReference->getGroup(), texType,
+                                            (uint)texWidth, (uint)texHeight,
+                                            0, PF_FLOAT32_RGBA, TU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
+        }
 
         OgreAssert(mMatrixTexture->getFormat() == PF_FLOAT32_RGBA, "float texture support required");
         //Set our cloned material to use this custom texture!
         setupMaterialToUseVTF( texType, mMaterial );
     }
+    //-----------------------------------------------------------------------
+    void BaseInstanceBatchVTF::setBakedAnimations(bool enable, Real samplesPerSecond)
+    {
+        assert(mInstancedEntities.empty());
+        OgreAssert(!enable || samplesPerSecond > 0, "sample rate must be positive");
+        mBakedAnimationRate = enable ? samplesPerSecond : 0;
+        if( enable )
+            mUseBoneMatrixLookup = true;
+    }
+    //-----------------------------------------------------------------------
+    size_t BaseInstanceBatchVTF::createBakedAnimationLayout()
+    {
+        mBakedAnimations.clear();
+
+        //Set 0 is the binding pose, used by instances without an enabled animation
+        size_t numFrames = 1;
+        if( !mMeshReference->hasSkeleton() || !mMeshReference->getSkeleton() )
+            return numFrames;
+
+        AnimationStateSet states;
+        mMeshReference->getSkeleton()->_initAnimationState( &states );
+        for( const auto& it : states.getAnimationStates() )
+        {
+            BakedAnimation baked;
+            baked.firstFrame = numFrames;
+            baked.numFrames = static_cast<size_t>( it.second->getLength() * mBakedAnimationRate ) + 1;
+            mBakedAnimations[it.first] = baked;
+            numFrames += baked.numFrames;
+        }
+
+        return numFrames;
+    }
+    //-----------------------------------------------------------------------
+    void BaseInstanceBatchVTF::bakeAnimations( const PixelBox& dst )
+    {
+        assert( dst.format == PF_FLOAT32_RGBA && dst.isConsecutive() );
+        float *pSource = reinterpret_cast<float*>( dst.getTopLeftFrontPixelPtr() );
+
+        //Same layout as used by InstanceBatchHW_VTF::updateVertexTexture
+        const size_t floatPerEntity = mMatricesPerInstance * mRowLength * 4;
+        const size_t entitiesPerPadding = (size_t)(mMaxFloatsPerLine / floatPerEntity);
+
+        std::vector<Matrix3x4f> transforms( mMatricesPerInstance, Matrix3x4f(Affine3::IDENTITY[0]) );
+
+        auto writeFrame = [&]( size_t frame )
+        {
+            float* pDest = pSource + floatPerEntity * frame + (frame / entitiesPerPadding) * mWidthFloatsPadding;
+            if( mUseBoneDualQuaternions )
+                convert3x4MatricesToDualQuaternions( transforms.data(), transforms.size(), pDest );
+            else
+                memcpy( pDest, transforms.data(), transforms.size() * sizeof(Matrix3x4f) );
+        };
+
+        writeFrame( 0 );
+        if( mBakedAnimations.empty() )
+            return;
+
+        //Pose a private skeleton exactly like InstancedEntity::_updateAnimation would
+        SkeletonInstance skeleton( mMeshReference->getSkeleton() );
+        skeleton.load();
+
+        AnimationStateSet states;
+        skeleton._initAnimationState( &states );
+
+        std::vector<Affine3> boneMatrices( skeleton.getNumBones() );
+        for( const auto& it : mBakedAnimations )
+        {
+            AnimationState* state = states.getAnimationState( it.first );
+            state->setEnabled( true );
+            state->setLoop( false );
+
+            for( size_t i = 0; i < it.second.numFrames; ++i )
+            {
+                state->setTimePosition( std::min( i / mBakedAnimationRate, state->getLength() ) );
+                skeleton.setAnimationState( states );
+                skeleton._getBoneMatrices( boneMatrices.data() );
+
+                size_t j = 0;
+                for( auto boneIdx : *mIndexToBoneMap )
+                    transforms[j++] = Matrix3x4f( boneMatrices[boneIdx][0] );
+
+                writeFrame( it.second.firstFrame + i );
+            }
+
+            state->setEnabled( false );
+        }
+    }
+    //-----------------------------------------------------------------------
+    void BaseInstanceBatchVTF::getBakedAnimationFrames( const InstancedEntity* entity, size_t frames[2],
+                                                        float& weight ) const
+    {
+        frames[0] = frames[1] = 0;
+        weight = 0;
 
+        const AnimationStateSet* states = entity->getAllAnimationStates();
+        if( !states )
+            return;
+
+        const AnimationState* current = 0;
+        for( const auto* state : states->getEnabledAnimationStates() )
+        {
+            if( !current || state->getWeight() > current->getWeight() )
+                current = state;
+        }
+        if( !current )
+            return;
+
+        BakedAnimationMap::const_iterator it = mBakedAnimations.find( current->getAnimationName() );
+        if( it == mBakedAnimations.end() )
+            return;
+
+        const BakedAnimation& baked = it->second;
+        const Real position = current->getTimePosition() * mBakedAnimationRate;
+        const size_t frame = std::min( static_cast<size_t>( position ), baked.numFrames - 1 );
+
+        //The last frame is followed by the first one when looping, and usually closer than a
+        //whole sample interval, as the last sample is taken at the end of the animation
+        size_t next = frame + 1;
+        Real interval = 1;
+        if( next == baked.numFrames )
+        {
+            next = current->getLoop() ? 0 : frame;
+            interval = current->getLength() * mBakedAnimationRate - frame;
+        }
+
+        frames[0] = baked.firstFrame + frame;
+        frames[1] = baked.firstFrame + next;
+        if( interval > 0 && next != frame )
+            weight = static_cast<float>( std::min<Real>( 1, (position - frame) / interval ) );
+    }
     //-----------------------------------------------------------------------
     size_t BaseInstanceBatchVTF::convert3x4MatricesToDualQuaternions(Matrix3x4f* matrices, size_t numOfMatrices, float* outDualQuaternions)
     {
@@ -359,7 +529,8 @@ namespace Ogre
     {
         if (mTransformSharingDirty)
         {
-            if (useBoneMatrixLookup())
+            //With baked animations the texture position depends on the animation state instead
+            if (useBoneMatrixLookup() && !useBakedAnimations())
             {
                 //In each entity update the "transform lookup number" so that:
                 // 1. All entities sharing the same transformation will share the same unique number
@@ -402,7 +573,7 @@ namespace Ogre
     InstancedEntity* BaseInstanceBatchVTF::generateInstancedEntity(size_t num)
     {
         InstancedEntity* sharedTransformEntity = NULL;
-        if ((useBoneMatrixLookup()) && (num >= getMaxLookupTableInstances()))
+        if (useBoneMatrixLookup() && !useBakedAnimations() && (num >= getMaxLookupTableInstances()))
         {
             sharedTransformEntity = mInstancedEntities[num % getMaxLookupTableInstances()];
             if (sharedTransformEntity->mSharedTransformEntity)
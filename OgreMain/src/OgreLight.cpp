@@ -56,7 +56,8 @@ namespace Ogre {
         mPowerScale(1.0f),
         mSourceSize(0, 0),
         mLightType(LT_POINT),
-        mOwnShadowFarDist(false)
+        mOwnShadowFarDist(false),
+        mShadowTextureCaching(false)
     {
         //mMinPixelSize should always be zero for lights otherwise lights will disapear
         mMinPixelSize = 0;
@@ -0,0 +1,368 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreLightClusters.h"
+#include "OgreHardwarePixelBuffer.h"
+
+namespace Ogre {
+
+    namespace {
+        /// beyond this, testing all lights of the frustum is cheaper than merging cluster lists
+        const size_t MAX_CLUSTERS_PER_QUERY = 64;
+        /// light ranges are enlarged by this factor, so rounding never drops a light
+        const Real RANGE_TOLERANCE = 1.001f;
+        /// below this, the build is not worth distributing among the worker threads
+        const size_t PARALLEL_LIGHT_COUNT = 256;
+        const size_t MAX_TASKS = 8;
+        /// width of the index texture, its rows are filled one after another
+        const uint32 INDEX_TEXTURE_WIDTH = 1024;
+
+        struct LightBounds
+        {
+            uint32 light;
+            uint32 min[3];
+            uint32 max[3];
+        };
+    }
+    //-----------------------------------------------------------------------
+    LightClusters::LightClusters(const String& name)
+        : mNear(0), mFar(0), mSliceScale(0), mLightCount(0), mValid(false), mName(name), mTexturesEnabled(false)
+    {
+        mDims[0] = 16;
+        mDims[1] = 8;
+        mDims[2] = 24;
+        mTangents[0] = mTangents[1] = mTangents[2] = mTangents[3] = 0;
+    }
+    //-----------------------------------------------------------------------
+    LightClusters::~LightClusters()
+    {
+        setTexturesEnabled(false);
+    }
+    //-----------------------------------------------------------------------
+    void LightClusters::setDimensions(uint32 tilesX, uint32 tilesY, uint32 slices)
+    {
+        OgreAssert(tilesX && tilesY && slices, "cluster dimensions must not be zero");
+        mDims[0] = tilesX;
+        mDims[1] = tilesY;
+        mDims[2] = slices;
+        clear();
+    }
+    //-----------------------------------------------------------------------
+    void LightClusters::clear()
+    {
+        mClusterRanges.clear();
+        mLightIndices.clear();
+        mGlobalLights.clear();
+        mShadowCasters.clear();
+        mLightCount = 0;
+        mValid = false;
+    }
+    //-----------------------------------------------------------------------
+    void LightClusters::getClusterBounds(const Vector3& center, Real radius, uint32 min[3],
+                                         uint32 max[3]) const
+    {
+        Vector3 v = mInvViewOrientation * (center - mViewPosition);
+        Real dmin = -v.z - radius;
+        Real dmax = -v.z + radius;
+
+        // all mappings below are monotonic and clamped, so two overlapping spheres always
+        // share a cluster - even if they lie outside of the frustum
+        for (int a = 0; a < 2; ++a)
+        {
+            if (dmin <= 0)
+            {
+                // reaches behind the camera, where tangents are meaningless
+                min[a] = 0;
+                max[a] = mDims[a] - 1;
+                continue;
+            }
+
+            Real lo = v[a] - radius, hi = v[a] + radius;
+            Real tlo = lo / (lo < 0 ? dmin : dmax);
+            Real thi = hi / (hi > 0 ? dmin : dmax);
+
+            Real scale = mDims[a] / (mTangents[2 * a + 1] - mTangents[2 * a]);
+            Real flo = (tlo - mTangents[2 * a]) * scale;
+            Real fhi = (thi - mTangents[2 * a]) * scale;
+            min[a] = flo > 0 ? std::min(uint32(flo), mDims[a] - 1) : 0;
+            max[a] = fhi > 0 ? std::min(uint32(fhi), mDims[a] - 1) : 0;
+        }
+
+        Real slo = dmin > mNear ? std::log(dmin / mNear) * mSliceScale : 0;
+        Real shi = dmax > mNear ? std::log(dmax / mNear) * mSliceScale : 0;
+        min[2] = std::min(uint32(slo), mDims[2] - 1);
+        max[2] = std::min(uint32(shi), mDims[2] - 1);
+    }
+    //-----------------------------------------------------------------------
+    void LightClusters::build(const Camera* camera, const LightList& lights)
+    {
+        clear();
+        mLightCount = lights.size();
+
+        if (camera->getProjectionType() != PT_PERSPECTIVE)
+            return;
+
+        mNear = camera->getNearClipDistance();
+        RealRect extents = camera->getFrustumExtents();
+        mTangents[0] = extents.left / mNear;
+        mTangents[1] = extents.right / mNear;
+        mTangents[2] = extents.bottom / mNear;
+        mTangents[3] = extents.top / mNear;
+        if (!(mTangents[1] > mTangents[0]) || !(mTangents[3] > mTangents[2]))
+            return;
+
+        mViewPosition = camera->getDerivedPosition();
+        mInvViewOrientation = camera->getDerivedOrientation().Inverse();
+
+        // let the slices end where the farthest light ends
+        mFar = 0;
+        for (uint32 i = 0; i < lights.size(); ++i)
+        {
+            const Light* l = lights[i];
+            if (l->getCastShadows())
+                mShadowCasters.push_back(i);
+
+            if (l->getType() == Light::LT_DIRECTIONAL)
+            {
+                mGlobalLights.push_back(i);
+                continue;
+            }
+            Vector3 v = mInvViewOrientation * (l->getDerivedPosition() - mViewPosition);
+            mFar = std::max(mFar, -v.z + l->getAttenuationRange());
+        }
+        if (camera->getFarClipDistance() > 0)
+            mFar = std::min(mFar, camera->getFarClipDistance());
+        mFar = std::max(mFar, 2 * mNear);
+        mSliceScale = mDims[2] / std::log(mFar / mNear);
+
+        // the bounds of every light are independent, as are the slices of the grid
+        const size_t numTasks = lights.size() < PARALLEL_LIGHT_COUNT ? 1 : std::min<size_t>(mDims[2], MAX_TASKS);
+        std::vector<LightBounds> bounds(lights.size() - mGlobalLights.size());
+        auto forEachTask = [numTasks](size_t count, const std::function<void(size_t, size_t)>& task)
+        {
+            if (numTasks == 1)
+                return task(0, count);
+            Root::getSingleton().getWorkQueue()->processTasksParallel(
+                numTasks, [&](size_t t) { task(count * t / numTasks, count * (t + 1) / numTasks); });
+        };
+
+        for (uint32 i = 0, b = 0; i < lights.size(); ++i)
+            if (lights[i]->getType() != Light::LT_DIRECTIONAL)
+                bounds[b++].light = i;
+        forEachTask(bounds.size(), [&](size_t begin, size_t end)
+        {
+            // positions were derived above, so this only reads the lights
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Light* l = lights[bounds[i].light];
+                getClusterBounds(l->getDerivedPosition(), l->getAttenuationRange() * RANGE_TOLERANCE,
+                                 bounds[i].min, bounds[i].max);
+            }
+        });
+
+        // first pass: count the lights of every cluster
+        mClusterRanges.resize(size_t(mDims[0]) * mDims[1] * mDims[2], ClusterRange(0, 0));
+        forEachTask(mDims[2], [&](size_t sliceBegin, size_t sliceEnd)
+        {
+            for (const auto& b : bounds)
+            {
+                for (uint32 z = std::max<uint32>(b.min[2], sliceBegin); z <= b.max[2] && z < sliceEnd; ++z)
+                    for (uint32 y = b.min[1]; y <= b.max[1]; ++y)
+                        for (uint32 x = b.min[0]; x <= b.max[0]; ++x)
+                            mClusterRanges[x + mDims[0] * (y + mDims[1] * z)].second++;
+            }
+        });
+
+        uint32 offset = 0;
+        for (auto& r : mClusterRanges)
+        {
+            r.first = offset;
+            offset += r.second;
+            r.second = 0;
+        }
+
+        // second pass: fill in the indices, in ascending order per cluster
+        mLightIndices.resize(offset);
+        forEachTask(mDims[2], [&](size_t sliceBegin, size_t sliceEnd)
+        {
+            for (const auto& b : bounds)
+            {
+                for (uint32 z = std::max<uint32>(b.min[2], sliceBegin); z <= b.max[2] && z < sliceEnd; ++z)
+                    for (uint32 y = b.min[1]; y <= b.max[1]; ++y)
+                        for (uint32 x = b.min[0]; x <= b.max[0]; ++x)
+                        {
+                            ClusterRange& r = mClusterRanges[x + mDims[0] * (y + mDims[1] * z)];
+                            mLightIndices[r.first + r.second++] = b.light;
+                        }
+            }
+        });
+
+        mValid = true;
+    }
+    //-----------------------------------------------------------------------
+    bool LightClusters::findLights(const Sphere& sphere, std::vector<uint32>& indices) const
+    {
+        if (!mValid)
+            return false;
+
+        uint32 min[3], max[3];
+        getClusterBounds(sphere.getCenter(), sphere.getRadius(), min, max);
+
+        size_t numClusters = size_t(max[0] - min[0] + 1) * (max[1] - min[1] + 1) * (max[2] - min[2] + 1);
+        if (numClusters > MAX_CLUSTERS_PER_QUERY)
+            return false;
+
+        indices.assign(mGlobalLights.begin(), mGlobalLights.end());
+        for (uint32 z = min[2]; z <= max[2]; ++z)
+            for (uint32 y = min[1]; y <= max[1]; ++y)
+                for (uint32 x = min[0]; x <= max[0]; ++x)
+                {
+                    const ClusterRange& r = mClusterRanges[x + mDims[0] * (y + mDims[1] * z)];
+                    indices.insert(indices.end(), mLightIndices.begin() + r.first,
+                                   mLightIndices.begin() + r.first + r.second);
+                }
+
+        if (numClusters > 1 || !mGlobalLights.empty())
+        {
+            std::sort(indices.begin(), indices.end());
+            indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        }
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    Vector4f LightClusters::getTileParams() const
+    {
+        return Vector4f(mTangents[0], mTangents[2], mDims[0] / (mTangents[1] - mTangents[0]),
+                        mDims[1] / (mTangents[3] - mTangents[2]));
+    }
+    //-----------------------------------------------------------------------
+    Vector4f LightClusters::getSliceParams() const
+    {
+        return Vector4f(mNear, mSliceScale, mDims[0], mDims[1]);
+    }
+    //-----------------------------------------------------------------------
+    void LightClusters::writeImage(TextureContent content, const LightList& lights, Image& dst) const
+    {
+        switch (content)
+        {
+        case TC_RANGES:
+        {
+            dst.create(PF_R32G32_UINT, mDims[0] * mDims[1], mDims[2]);
+            uint32* texel = dst.getData<uint32>();
+            if (mClusterRanges.empty())
+                std::fill_n(texel, size_t(mDims[0]) * mDims[1] * mDims[2] * 2, 0);
+            for (const auto& r : mClusterRanges)
+            {
+                *texel++ = r.first;
+                *texel++ = r.second;
+            }
+            break;
+        }
+        case TC_INDICES:
+        {
+            uint32 height = std::max<uint32>(1, (mLightIndices.size() + INDEX_TEXTURE_WIDTH - 1) / INDEX_TEXTURE_WIDTH);
+            dst.create(PF_R32_UINT, INDEX_TEXTURE_WIDTH, height);
+            std::fill_n(dst.getData<uint32>(), size_t(INDEX_TEXTURE_WIDTH) * height, 0);
+            std::copy(mLightIndices.begin(), mLightIndices.end(), dst.getData<uint32>());
+            break;
+        }
+        case TC_LIGHTS:
+        {
+            dst.create(PF_FLOAT32_RGBA, 4, std::max<uint32>(1, lights.size()));
+            dst.setTo(ColourValue::ZERO);
+            for (uint32 i = 0; i < lights.size(); ++i)
+            {
+                const Light* l = lights[i];
+                bool directional = l->getType() == Light::LT_DIRECTIONAL;
+                bool spot = l->getType() == Light::LT_SPOTLIGHT;
+                float* texel = dst.getData<float>(0, i);
+
+                Vector3 pos = directional ? Vector3::ZERO : l->getDerivedPosition();
+                Vector3 dir = l->getDerivedDirection();
+                ColourValue diffuse = l->getDiffuseColour() * l->getPowerScale();
+                float data[16] = {
+                    float(pos.x), float(pos.y), float(pos.z), directional ? 0.0f : float(l->getAttenuationRange()),
+                    diffuse.r, diffuse.g, diffuse.b, spot ? float(l->getSpotlightFalloff()) : 0.0f,
+                    l->getAttenuationConstant(), l->getAttenuationLinear(), l->getAttenuationQuadric(),
+                    spot ? float(Math::Cos(l->getSpotlightInnerAngle() * 0.5)) : -2.0f,
+                    float(dir.x), float(dir.y), float(dir.z),
+                    spot ? float(Math::Cos(l->getSpotlightOuterAngle() * 0.5)) : -2.0f};
+                std::copy(data, data + 16, texel);
+            }
+            break;
+        }
+        case TC_COUNT:
+            break;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void LightClusters::setTexturesEnabled(bool enabled)
+    {
+        if (enabled == mTexturesEnabled)
+            return;
+        mTexturesEnabled = enabled;
+        if (enabled)
+            return;
+
+        for (auto& tex : mTextures)
+        {
+            if (tex && TextureManager::getSingletonPtr())
+                TextureManager::getSingleton().remove(tex);
+            tex.reset();
+        }
+    }
+    //-----------------------------------------------------------------------
+    void LightClusters::_updateTextures(const LightList& lights)
+    {
+        if (!mTexturesEnabled)
+            return;
+
+        static const char* suffixes[TC_COUNT] = {"/LightClusterRanges", "/LightClusterIndices", "/LightClusterLights"};
+        Image img;
+        for (int i = 0; i < TC_COUNT; ++i)
+        {
+            writeImage(TextureContent(i), lights, img);
+
+            TexturePtr& tex = mTextures[i];
+            if (tex && (tex->getWidth() != img.getWidth() || tex->getHeight() < img.getHeight()))
+            {
+                TextureManager::getSingleton().remove(tex);
+                tex.reset();
+            }
+            if (!tex)
+            {
+                // the index list grows with the lights, so leave room for more rows
+                uint32 height = i == TC_INDICES ? Bitwise::firstPO2From(img.getHeight()) : img.getHeight();
+                tex = TextureManager::getSingleton().createManual(
+                    mName + suffixes[i], RGN_INTERNAL, TEX_TYPE_2D, img.getWidth(), height, 0,
+                    img.getFormat(), TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+            }
+            tex->getBuffer()->blitFromMemory(img.getPixelBox(), Box(0, 0, img.getWidth(), img.getHeight()));
+        }
+    }
+}
@@ -47,6 +47,8 @@ namespace Ogre
     float *Math::mTanTable = NULL;
 
     Math::RandomValueProvider* Math::mRandProvider = NULL;
+    /// overrides Math::mRandProvider on the calling thread
+    static thread_local Math::RandomValueProvider* tlsRandProvider = NULL;
 
     //-----------------------------------------------------------------------
     Math::Math( unsigned int trigTableSize )
@@ -142,6 +144,19 @@ namespace Ogre
     {
         mRandProvider = provider;
     }
+    //-----------------------------------------------------------------------
+    Math::RandomValueProvider* Math::SetThreadRandomValueProvider(RandomValueProvider* provider)
+    {
+        std::swap(tlsRandProvider, provider);
+        return provider;
+    }
+    //-----------------------------------------------------------------------
+    float Math::UnitRandom()
+    {
+        if (tlsRandProvider)
+            return tlsRandProvider->getRandomUnit();
+        return mRandProvider ? mRandProvider->getRandomUnit() : rand() / float(RAND_MAX);
+    }
 
    //-----------------------------------------------------------------------
     void Math::setAngleUnit(Math::AngleUnit unit)
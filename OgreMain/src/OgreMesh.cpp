@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "OgreSkeletonManager.h"
 #include "OgreEdgeListBuilder.h"
+#include "OgreTriangleBVH.h"
 #include "OgreAnimation.h"
 #include "OgreAnimationState.h"
 #include "OgreAnimationTrack.h"
@@ -256,6 +257,7 @@ namespace Ogre {
         mSubMeshNameMap.clear();
 
         freeEdgeList();
+        freeTriangleBVH();
 #if !OGRE_NO_MESHLOD
         // Removes all LOD data
         removeLodLevels();
@@ -1736,6 +1738,18 @@ namespace Ogre {
         mEdgeListsBuilt = false;
     }
     //---------------------------------------------------------------------
+    const TriangleBVH* Mesh::getTriangleBVH(void)
+    {
+        if (!mTriangleBVH)
+            mTriangleBVH.reset(new TriangleBVH(this));
+        return mTriangleBVH.get();
+    }
+    //---------------------------------------------------------------------
+    void Mesh::freeTriangleBVH(void)
+    {
+        mTriangleBVH.reset();
+    }
+    //---------------------------------------------------------------------
     void Mesh::prepareForShadowVolume(void)
     {
         if (mPreparedForShadowVolumes)
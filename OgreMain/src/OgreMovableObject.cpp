@@ -91,6 +91,9 @@ namespace Ogre {
         // counter by one for minimise overhead
         --mLightListUpdated;
 
+        if (mManager)
+            mManager->_notifyMovableObjectMoved(this);
+
         // Call listener (note, only called if there's something to do)
         if (mListener && different)
         {
@@ -158,6 +161,9 @@ namespace Ogre {
         // counter by one for minimise overhead
         --mLightListUpdated;
 
+        if (mManager)
+            mManager->_notifyMovableObjectMoved(this);
+
         // Notify listener if exists
         if (mListener)
         {
@@ -30,6 +30,10 @@ THE SOFTWARE.
 
 //#define __DO_PROFILE__
 
+// The native NEON implementation is only covered by the parity tests against "General" yet,
+// so AArch64 keeps running the SSE one through SSE2NEON unless this is defined
+//#define __PREFER_NEON__
+
 namespace Ogre {
 
     //---------------------------------------------------------------------
@@ -38,6 +42,13 @@ namespace Ogre {
 #if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
     extern OptimisedUtil* _getOptimisedUtilSSE(void);
 #endif
+#if __OGRE_HAVE_SSE
+    extern OptimisedUtil* _getOptimisedUtilAVX2(void);
+    extern OptimisedUtil* _getOptimisedUtilAVX512(void);
+#endif
+#if __OGRE_HAVE_NEON && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
+    extern OptimisedUtil* _getOptimisedUtilNEON(void);
+#endif
 
 #ifdef __DO_PROFILE__
     //---------------------------------------------------------------------
@@ -50,6 +61,13 @@ namespace Ogre {
             IMPL_DEFAULT,
 #if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
             IMPL_SSE,
+#endif
+#if __OGRE_HAVE_SSE
+            IMPL_AVX2,
+            IMPL_AVX512,
+#endif
+#if __OGRE_HAVE_NEON && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
+            IMPL_NEON,
 #endif
             IMPL_COUNT
         };
@@ -91,13 +109,8 @@ namespace Ogre {
     public:
         OptimisedUtilProfiler(void)
         {
-            mOptimisedUtils.push_back(_getOptimisedUtilGeneral());
-#if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
-            //if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
-            {
-                mOptimisedUtils.push_back(_getOptimisedUtilSSE());
-            }
-#endif
+            for (const auto& impl : getAvailableImplementations())
+                mOptimisedUtils.push_back(impl.second);
         }
 
         virtual void softwareVertexSkinning(
@@ -315,6 +328,39 @@ namespace Ogre {
             ++index;    // So we can put break point here even if in release build
         }
 
+        virtual size_t cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const float* centresX, const float* centresY, const float* centresZ,
+            const float* radii,
+            uint32* visibleIndices,
+            size_t numSpheres)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            size_t numVisible = impl->cullSpheres(
+                planes,
+                numPlanes,
+                centresX, centresY, centresZ,
+                radii,
+                visibleIndices,
+                numSpheres);
+            profile.end();
+
+            LogManager::getSingleton().logMessage(StringUtil::format(
+                "OptimisedUtilProfiler: %s - impl %zu = %u avg ticks\n", __FUNCTION__, index, profile.mAvgTicks));
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+            return numVisible;
+        }
+
     };
 #endif // __DO_PROFILE__
 
@@ -369,7 +415,15 @@ namespace Ogre {
 #else   // !__DO_PROFILE__
 
 #if __OGRE_HAVE_SSE
-        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+        uint32 features = PlatformInformation::getCpuFeatures();
+        if ((features & PlatformInformation::CPU_FEATURE_AVX2) && (features & PlatformInformation::CPU_FEATURE_FMA))
+        {
+            // the AVX-512 kernels cover the same functions with twice the width
+            if (features & PlatformInformation::CPU_FEATURE_AVX512F)
+                return _getOptimisedUtilAVX512();
+            return _getOptimisedUtilAVX2();
+        }
+        else if (features & PlatformInformation::CPU_FEATURE_SSE)
         {
             return _getOptimisedUtilSSE();
         }
@@ -377,7 +431,11 @@ namespace Ogre {
 #elif __OGRE_HAVE_NEON
         if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_NEON)
         {
+#if defined(__PREFER_NEON__) && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
+            return _getOptimisedUtilNEON();
+#else
             return _getOptimisedUtilSSE();
+#endif
         }
         else
 #endif  // __OGRE_HAVE_SSE
@@ -387,5 +445,34 @@ namespace Ogre {
 
 #endif  // __DO_PROFILE__
     }
+    //---------------------------------------------------------------------
+    OptimisedUtil::ImplementationList OptimisedUtil::getAvailableImplementations(void)
+    {
+        ImplementationList impls;
+        impls.push_back({"General", _getOptimisedUtilGeneral()});
+#if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
+        uint32 features = PlatformInformation::getCpuFeatures();
+#endif
+#if __OGRE_HAVE_SSE
+        if (features & PlatformInformation::CPU_FEATURE_SSE)
+            impls.push_back({"SSE", _getOptimisedUtilSSE()});
+        if ((features & PlatformInformation::CPU_FEATURE_AVX2) && (features & PlatformInformation::CPU_FEATURE_FMA))
+        {
+            impls.push_back({"AVX2", _getOptimisedUtilAVX2()});
+            if (features & PlatformInformation::CPU_FEATURE_AVX512F)
+                impls.push_back({"AVX512", _getOptimisedUtilAVX512()});
+        }
+#elif __OGRE_HAVE_NEON
+        if (features & PlatformInformation::CPU_FEATURE_NEON)
+        {
+            // the SSE version runs through SSE2NEON
+            impls.push_back({"SSE", _getOptimisedUtilSSE()});
+#if OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
+            impls.push_back({"NEON", _getOptimisedUtilNEON()});
+#endif
+        }
+#endif
+        return impls;
+    }
 
 }
@@ -0,0 +1,940 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreOptimisedUtil.h"
+#include "OgrePlane.h"
+
+#if __OGRE_HAVE_SSE
+
+#include <immintrin.h>
+
+//-------------------------------------------------------------------------
+//
+// Unlike the SSE routines, this file is compiled for the baseline instruction
+// set. Only the kernels below are allowed to use AVX, through the target
+// attribute, so inline functions of the engine headers instantiated here can
+// never end up with AVX instructions that run on older CPUs.
+//
+// Positions are deinterleaved into one register per component for the
+// kernels that work on many vertices, as three floats never line up with
+// the register width.
+//
+//-------------------------------------------------------------------------
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define OGRE_TARGET_AVX2     __attribute__((target("avx2,fma")))
+#   define OGRE_TARGET_AVX512   __attribute__((target("avx512f,avx2,fma")))
+#else
+#   define OGRE_TARGET_AVX2
+#   define OGRE_TARGET_AVX512
+#endif
+
+namespace Ogre {
+
+//-------------------------------------------------------------------------
+// Local classes
+//-------------------------------------------------------------------------
+
+    /** AVX2 and FMA implementation of OptimisedUtil.
+    @note
+        Don't use this class directly, use OptimisedUtil instead.
+    */
+    class _OgrePrivate OptimisedUtilAVX2 : public OptimisedUtil
+    {
+    public:
+        /// @copydoc OptimisedUtil::softwareVertexSkinning
+        void softwareVertexSkinning(
+            const float *srcPosPtr, float *destPosPtr,
+            const float *srcNormPtr, float *destNormPtr,
+            const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+            const Affine3* const* blendMatrices,
+            size_t srcPosStride, size_t destPosStride,
+            size_t srcNormStride, size_t destNormStride,
+            size_t blendWeightStride, size_t blendIndexStride,
+            size_t numWeightsPerVertex,
+            size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::softwareVertexMorph
+        void softwareVertexMorph(
+            float t,
+            const float *srcPos1, const float *srcPos2,
+            float *dstPos,
+            size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+            size_t numVertices,
+            bool morphNormals) override;
+
+        /// @copydoc OptimisedUtil::concatenateAffineMatrices
+        void concatenateAffineMatrices(
+            const Affine3& baseMatrix,
+            const Affine3* srcMatrices,
+            Affine3* dstMatrices,
+            size_t numMatrices) override;
+
+        /// @copydoc OptimisedUtil::calculateFaceNormals
+        void calculateFaceNormals(
+            const float *positions,
+            const EdgeData::Triangle *triangles,
+            Vector4 *faceNormals,
+            size_t numTriangles) override;
+
+        /// @copydoc OptimisedUtil::calculateLightFacing
+        void calculateLightFacing(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            char* lightFacings,
+            size_t numFaces) override;
+
+        /// @copydoc OptimisedUtil::extrudeVertices
+        void extrudeVertices(
+            const Vector4& lightPos,
+            Real extrudeDist,
+            const float* srcPositions,
+            float* destPositions,
+            size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::cullSpheres
+        size_t cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const float* centresX, const float* centresY, const float* centresZ,
+            const float* radii,
+            uint32* visibleIndices,
+            size_t numSpheres) override;
+    };
+
+    /** AVX-512 implementation of OptimisedUtil.
+
+        Skinning and morphing work on one vertex at a time, where the wider
+        registers do not help, so these are inherited from the AVX2 version.
+    @note
+        Don't use this class directly, use OptimisedUtil instead.
+    */
+    class _OgrePrivate OptimisedUtilAVX512 : public OptimisedUtilAVX2
+    {
+    public:
+        /// @copydoc OptimisedUtil::concatenateAffineMatrices
+        void concatenateAffineMatrices(
+            const Affine3& baseMatrix,
+            const Affine3* srcMatrices,
+            Affine3* dstMatrices,
+            size_t numMatrices) override;
+
+        /// @copydoc OptimisedUtil::calculateFaceNormals
+        void calculateFaceNormals(
+            const float *positions,
+            const EdgeData::Triangle *triangles,
+            Vector4 *faceNormals,
+            size_t numTriangles) override;
+
+        /// @copydoc OptimisedUtil::calculateLightFacing
+        void calculateLightFacing(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            char* lightFacings,
+            size_t numFaces) override;
+
+        /// @copydoc OptimisedUtil::extrudeVertices
+        void extrudeVertices(
+            const Vector4& lightPos,
+            Real extrudeDist,
+            const float* srcPositions,
+            float* destPositions,
+            size_t numVertices) override;
+    };
+
+//-------------------------------------------------------------------------
+// Helpers
+//-------------------------------------------------------------------------
+
+    /// Loads x, y, z without touching memory past them, w is zero
+    static OGRE_FORCE_INLINE OGRE_TARGET_AVX2 __m128 loadXYZ(const float* p)
+    {
+        __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p)));
+        return _mm_movelh_ps(xy, _mm_load_ss(p + 2));
+    }
+    //---------------------------------------------------------------------
+    /// Stores x, y, z without touching memory past them
+    static OGRE_FORCE_INLINE OGRE_TARGET_AVX2 void storeXYZ(float* p, __m128 v)
+    {
+        _mm_store_sd(reinterpret_cast<double*>(p), _mm_castps_pd(v));
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+    //---------------------------------------------------------------------
+    /// Same as Vector3::normalise, zero vectors are left alone
+    static OGRE_FORCE_INLINE OGRE_TARGET_AVX2 __m128 normaliseXYZ(__m128 v)
+    {
+        __m128 len = _mm_sqrt_ps(_mm_dp_ps(v, v, 0x7F));
+        return _mm_blendv_ps(v, _mm_div_ps(v, len), _mm_cmpgt_ps(len, _mm_setzero_ps()));
+    }
+    //---------------------------------------------------------------------
+    /// Sums the elements of a, b and c into the first three elements of the result
+    static OGRE_FORCE_INLINE OGRE_TARGET_AVX2 __m128 horizontalSum3(__m128 a, __m128 b, __m128 c)
+    {
+        return _mm_hadd_ps(_mm_hadd_ps(a, b), _mm_hadd_ps(c, c));
+    }
+    //---------------------------------------------------------------------
+    /// Copies v into both halves of the result
+    static OGRE_FORCE_INLINE OGRE_TARGET_AVX2 __m256 duplicate(__m128 v)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+    }
+    //---------------------------------------------------------------------
+    /// Deinterleaves the positions of eight packed xyz vertices
+    static OGRE_FORCE_INLINE OGRE_TARGET_AVX2 void loadPositions8(const float* p, __m256& x, __m256& y, __m256& z)
+    {
+        // a0 = x0 y0 z0 x1 y1 z1 x2 y2, a1 = z2 x3 y3 z3 x4 y4 z4 x5, a2 = y5 z5 x6 y6 z6 x7 y7 z7
+        __m256 a0 = _mm256_loadu_ps(p);
+        __m256 a1 = _mm256_loadu_ps(p + 8);
+        __m256 a2 = _mm256_loadu_ps(p + 16);
+
+        // gather each component, then sort it
+        __m256 bx = _mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x92), a2, 0x24);
+        __m256 by = _mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x24), a2, 0x49);
+        __m256 bz = _mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x49), a2, 0x92);
+        x = _mm256_permutevar8x32_ps(bx, _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+        y = _mm256_permutevar8x32_ps(by, _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6));
+        z = _mm256_permutevar8x32_ps(bz, _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+    }
+    //---------------------------------------------------------------------
+    /// Interleaves eight positions into packed xyz vertices
+    static OGRE_FORCE_INLINE OGRE_TARGET_AVX2 void storePositions8(float* p, __m256 x, __m256 y, __m256 z)
+    {
+        // spread the components to the positions they take in each output, then merge
+        const __m256i i0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+        const __m256i i1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+        const __m256i i2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+        __m256 o0 = _mm256_blend_ps(_mm256_blend_ps(_mm256_permutevar8x32_ps(x, i0),
+                                                    _mm256_permutevar8x32_ps(y, i0), 0x92),
+                                    _mm256_permutevar8x32_ps(z, i0), 0x24);
+        __m256 o1 = _mm256_blend_ps(_mm256_blend_ps(_mm256_permutevar8x32_ps(z, i1),
+                                                    _mm256_permutevar8x32_ps(x, i1), 0x92),
+                                    _mm256_permutevar8x32_ps(y, i1), 0x24);
+        __m256 o2 = _mm256_blend_ps(_mm256_blend_ps(_mm256_permutevar8x32_ps(y, i2),
+                                                    _mm256_permutevar8x32_ps(z, i2), 0x92),
+                                    _mm256_permutevar8x32_ps(x, i2), 0x24);
+        _mm256_storeu_ps(p, o0);
+        _mm256_storeu_ps(p + 8, o1);
+        _mm256_storeu_ps(p + 16, o2);
+    }
+    //---------------------------------------------------------------------
+    /// Scalar version of a single vertex of extrudeVertices, for the remainder
+    static void extrudeVertex(const Vector4& lightPos, Real extrudeDist, const float* pSrcPos, float* pDestPos)
+    {
+        Vector3 extrusionDir(pSrcPos[0] - lightPos.x, pSrcPos[1] - lightPos.y, pSrcPos[2] - lightPos.z);
+        extrusionDir.normalise();
+        extrusionDir *= extrudeDist;
+
+        pDestPos[0] = pSrcPos[0] + extrusionDir.x;
+        pDestPos[1] = pSrcPos[1] + extrusionDir.y;
+        pDestPos[2] = pSrcPos[2] + extrusionDir.z;
+    }
+    //---------------------------------------------------------------------
+    /// Scalar version of a single face of calculateFaceNormals, for the remainder
+    static Vector4 faceNormal(const float* positions, const EdgeData::Triangle& t)
+    {
+        const float* v1 = positions + t.vertIndex[0] * 3;
+        const float* v2 = positions + t.vertIndex[1] * 3;
+        const float* v3 = positions + t.vertIndex[2] * 3;
+        return Math::calculateFaceNormalWithoutNormalize(
+            Vector3(v1[0], v1[1], v1[2]), Vector3(v2[0], v2[1], v2[2]), Vector3(v3[0], v3[1], v3[2]));
+    }
+    //---------------------------------------------------------------------
+    /// Directional extrusion offset as in OptimisedUtilGeneral::extrudeVertices
+    static Vector3 directionalExtrusion(const Vector4& lightPos, Real extrudeDist)
+    {
+        Vector3 extrusionDir(-lightPos.x, -lightPos.y, -lightPos.z);
+        extrusionDir.normalise();
+        return extrusionDir * extrudeDist;
+    }
+
+    //---------------------------------------------------------------------
+    /// Scalar version of a single sphere of cullSpheres, for the remainder
+    static bool sphereVisible(const Plane* planes, size_t numPlanes, float x, float y, float z, float radius)
+    {
+        for (size_t p = 0; p < numPlanes; ++p)
+        {
+            float dist = float(planes[p].normal.x) * x + float(planes[p].normal.y) * y +
+                         float(planes[p].normal.z) * z + float(planes[p].d);
+            if (dist < -radius)
+                return false;
+        }
+        return true;
+    }
+
+//-------------------------------------------------------------------------
+// AVX2 kernels
+//-------------------------------------------------------------------------
+
+    static OGRE_TARGET_AVX2 void softwareVertexSkinning_AVX2(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Affine3* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        const __m128 unitW = _mm_set_ps(1, 0, 0, 0);
+
+        for (size_t vertIdx = 0; vertIdx < numVertices; ++vertIdx)
+        {
+            // Blend the matrices first, rows 0 and 1 share a register
+            __m256 m01 = _mm256_setzero_ps();
+            __m128 m2 = _mm_setzero_ps();
+            for (size_t blendIdx = 0; blendIdx < numWeightsPerVertex; ++blendIdx)
+            {
+                float weight = pBlendWeight[blendIdx];
+                if (weight)
+                {
+                    const float* mat = (*blendMatrices[pBlendIndex[blendIdx]])[0];
+                    m01 = _mm256_fmadd_ps(_mm256_set1_ps(weight), _mm256_loadu_ps(mat), m01);
+                    m2 = _mm_fmadd_ps(_mm_set1_ps(weight), _mm_loadu_ps(mat + 8), m2);
+                }
+            }
+
+            // Transform position, w = 1 picks up the translation
+            __m128 pos = _mm_or_ps(loadXYZ(pSrcPos), unitW);
+            __m256 p01 = _mm256_mul_ps(m01, duplicate(pos));
+            storeXYZ(pDestPos, horizontalSum3(_mm256_castps256_ps128(p01), _mm256_extractf128_ps(p01, 1),
+                                              _mm_mul_ps(m2, pos)));
+
+            if (pSrcNorm)
+            {
+                // Transform normal, w = 0 drops the translation. As in the general version, the
+                // 3x3 part is assumed to be orthogonal, so we don't need the inverse transpose.
+                __m128 norm = loadXYZ(pSrcNorm);
+                __m256 n01 = _mm256_mul_ps(m01, duplicate(norm));
+                norm = horizontalSum3(_mm256_castps256_ps128(n01), _mm256_extractf128_ps(n01, 1),
+                                      _mm_mul_ps(m2, norm));
+                storeXYZ(pDestNorm, normaliseXYZ(norm));
+
+                advanceRawPointer(pSrcNorm, srcNormStride);
+                advanceRawPointer(pDestNorm, destNormStride);
+            }
+
+            advanceRawPointer(pSrcPos, srcPosStride);
+            advanceRawPointer(pDestPos, destPosStride);
+            advanceRawPointer(pBlendWeight, blendWeightStride);
+            advanceRawPointer(pBlendIndex, blendIndexStride);
+        }
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX2 void softwareVertexMorph_AVX2(
+        float t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+        size_t numVertices,
+        bool morphNormals)
+    {
+        const size_t packedSize = (morphNormals ? 6 : 3) * sizeof(float);
+        if (!morphNormals && pos1VSize == packedSize && pos2VSize == packedSize && dstVSize == packedSize)
+        {
+            // Packed positions, interpolate as a plain float array
+            const __m256 vt = _mm256_set1_ps(t);
+            size_t count = numVertices * 3;
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 a = _mm256_loadu_ps(pSrc1 + i);
+                __m256 b = _mm256_loadu_ps(pSrc2 + i);
+                _mm256_storeu_ps(pDst + i, _mm256_fmadd_ps(vt, _mm256_sub_ps(b, a), a));
+            }
+            for (; i < count; ++i)
+                pDst[i] = pSrc1[i] + t * (pSrc2[i] - pSrc1[i]);
+            return;
+        }
+
+        const __m128 vt = _mm_set1_ps(t);
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            __m128 a = loadXYZ(pSrc1);
+            __m128 b = loadXYZ(pSrc2);
+            storeXYZ(pDst, _mm_fmadd_ps(vt, _mm_sub_ps(b, a), a));
+
+            if (morphNormals)
+            {
+                // normals must be in the same buffer as pos, perform an nlerp
+                a = loadXYZ(pSrc1 + 3);
+                b = loadXYZ(pSrc2 + 3);
+                storeXYZ(pDst + 3, normaliseXYZ(_mm_fmadd_ps(vt, _mm_sub_ps(b, a), a)));
+            }
+
+            advanceRawPointer(pSrc1, pos1VSize);
+            advanceRawPointer(pSrc2, pos2VSize);
+            advanceRawPointer(pDst, dstVSize);
+        }
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX2 void concatenateAffineMatrices_AVX2(
+        const Affine3& baseMatrix,
+        const Affine3* pSrcMat,
+        Affine3* pDstMat,
+        size_t numMatrices)
+    {
+        // Row i of the result is the sum of base[i][k] * row k of the source, where the
+        // implicit last source row is (0, 0, 0, 1). Rows 0 and 1 share a register.
+        const float* base = baseMatrix[0];
+        __m256 c01[4];
+        __m128 c2[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            c01[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(base[k])),
+                                          _mm_set1_ps(base[4 + k]), 1);
+            c2[k] = _mm_set1_ps(base[8 + k]);
+        }
+        const __m128 unitW = _mm_set_ps(1, 0, 0, 0);
+        const __m256 t01 = _mm256_mul_ps(c01[3], duplicate(unitW));
+        const __m128 t2 = _mm_mul_ps(c2[3], unitW);
+
+        for (size_t i = 0; i < numMatrices; ++i)
+        {
+            const float* src = pSrcMat[i][0];
+            __m128 r0 = _mm_loadu_ps(src);
+            __m128 r1 = _mm_loadu_ps(src + 4);
+            __m128 r2 = _mm_loadu_ps(src + 8);
+
+            __m256 d01 = _mm256_fmadd_ps(c01[0], duplicate(r0),
+                         _mm256_fmadd_ps(c01[1], duplicate(r1),
+                         _mm256_fmadd_ps(c01[2], duplicate(r2), t01)));
+            __m128 d2 = _mm_fmadd_ps(c2[0], r0, _mm_fmadd_ps(c2[1], r1, _mm_fmadd_ps(c2[2], r2, t2)));
+
+            float* dst = pDstMat[i][0];
+            _mm256_storeu_ps(dst, d01);
+            _mm_storeu_ps(dst + 8, d2);
+        }
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX2 void calculateFaceNormals_AVX2(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        float* dst = faceNormals[0].ptr();
+        size_t i = 0;
+        for (; i + 8 <= numTriangles; i += 8, dst += 32)
+        {
+            // Gather the corners of eight triangles, one register per component
+            __m256 v[3][3];
+            for (int c = 0; c < 3; ++c)
+            {
+                const EdgeData::Triangle* t = triangles + i;
+                __m256i idx = _mm256_setr_epi32(
+                    int(t[0].vertIndex[c] * 3), int(t[1].vertIndex[c] * 3), int(t[2].vertIndex[c] * 3),
+                    int(t[3].vertIndex[c] * 3), int(t[4].vertIndex[c] * 3), int(t[5].vertIndex[c] * 3),
+                    int(t[6].vertIndex[c] * 3), int(t[7].vertIndex[c] * 3));
+                v[c][0] = _mm256_i32gather_ps(positions, idx, 4);
+                v[c][1] = _mm256_i32gather_ps(positions + 1, idx, 4);
+                v[c][2] = _mm256_i32gather_ps(positions + 2, idx, 4);
+            }
+
+            // Same as Math::calculateFaceNormalWithoutNormalize
+            __m256 ax = _mm256_sub_ps(v[1][0], v[0][0]), bx = _mm256_sub_ps(v[2][0], v[0][0]);
+            __m256 ay = _mm256_sub_ps(v[1][1], v[0][1]), by = _mm256_sub_ps(v[2][1], v[0][1]);
+            __m256 az = _mm256_sub_ps(v[1][2], v[0][2]), bz = _mm256_sub_ps(v[2][2], v[0][2]);
+            __m256 nx = _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by));
+            __m256 ny = _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz));
+            __m256 nz = _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx));
+            __m256 nw = _mm256_fnmsub_ps(nx, v[0][0], _mm256_fmadd_ps(ny, v[0][1], _mm256_mul_ps(nz, v[0][2])));
+
+            // Transpose to one Vector4 per face
+            __m256 t0 = _mm256_unpacklo_ps(nx, ny);
+            __m256 t1 = _mm256_unpackhi_ps(nx, ny);
+            __m256 t2 = _mm256_unpacklo_ps(nz, nw);
+            __m256 t3 = _mm256_unpackhi_ps(nz, nw);
+            __m256 f04 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 f15 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 f26 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 f37 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            _mm256_storeu_ps(dst, _mm256_permute2f128_ps(f04, f15, 0x20));
+            _mm256_storeu_ps(dst + 8, _mm256_permute2f128_ps(f26, f37, 0x20));
+            _mm256_storeu_ps(dst + 16, _mm256_permute2f128_ps(f04, f15, 0x31));
+            _mm256_storeu_ps(dst + 24, _mm256_permute2f128_ps(f26, f37, 0x31));
+        }
+
+        for (; i < numTriangles; ++i)
+            faceNormals[i] = faceNormal(positions, triangles[i]);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX2 void calculateLightFacing_AVX2(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        const __m256 lp = duplicate(_mm_loadu_ps(lightPos.ptr()));
+        const float* n = faceNormals[0].ptr();
+        size_t i = 0;
+        for (; i + 8 <= numFaces; i += 8, n += 32)
+        {
+            // Two faces per register, so the dot products come out as
+            // faces 0, 2, 4, 6 in the low and 1, 3, 5, 7 in the high half
+            __m256 p01 = _mm256_mul_ps(_mm256_loadu_ps(n), lp);
+            __m256 p23 = _mm256_mul_ps(_mm256_loadu_ps(n + 8), lp);
+            __m256 p45 = _mm256_mul_ps(_mm256_loadu_ps(n + 16), lp);
+            __m256 p67 = _mm256_mul_ps(_mm256_loadu_ps(n + 24), lp);
+            __m256 dots = _mm256_hadd_ps(_mm256_hadd_ps(p01, p23), _mm256_hadd_ps(p45, p67));
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(dots, _mm256_setzero_ps(), _CMP_GT_OQ));
+
+            for (int k = 0; k < 8; ++k)
+                lightFacings[i + 2 * (k & 3) + (k >> 2)] = (mask >> k) & 1;
+        }
+
+        for (; i < numFaces; ++i)
+            lightFacings[i] = lightPos.dotProduct(faceNormals[i]) > 0;
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX2 void extrudeVertices_AVX2(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        size_t vert = 0;
+        if (lightPos.w == 0.0f)
+        {
+            // Directional light, the offset pattern repeats every eight vertices
+            Vector3 d = directionalExtrusion(lightPos, extrudeDist);
+            const __m256 o0 = _mm256_setr_ps(d.x, d.y, d.z, d.x, d.y, d.z, d.x, d.y);
+            const __m256 o1 = _mm256_setr_ps(d.z, d.x, d.y, d.z, d.x, d.y, d.z, d.x);
+            const __m256 o2 = _mm256_setr_ps(d.y, d.z, d.x, d.y, d.z, d.x, d.y, d.z);
+            for (; vert + 8 <= numVertices; vert += 8, pSrcPos += 24, pDestPos += 24)
+            {
+                _mm256_storeu_ps(pDestPos, _mm256_add_ps(_mm256_loadu_ps(pSrcPos), o0));
+                _mm256_storeu_ps(pDestPos + 8, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 8), o1));
+                _mm256_storeu_ps(pDestPos + 16, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 16), o2));
+            }
+            for (; vert < numVertices; ++vert, pSrcPos += 3, pDestPos += 3)
+            {
+                pDestPos[0] = pSrcPos[0] + d.x;
+                pDestPos[1] = pSrcPos[1] + d.y;
+                pDestPos[2] = pSrcPos[2] + d.z;
+            }
+            return;
+        }
+
+        // Point light, calculate extrusionDir for every vertex
+        assert(lightPos.w == 1.0f);
+        const __m256 lx = _mm256_set1_ps(lightPos.x);
+        const __m256 ly = _mm256_set1_ps(lightPos.y);
+        const __m256 lz = _mm256_set1_ps(lightPos.z);
+        const __m256 dist = _mm256_set1_ps(extrudeDist);
+        for (; vert + 8 <= numVertices; vert += 8, pSrcPos += 24, pDestPos += 24)
+        {
+            __m256 x, y, z;
+            loadPositions8(pSrcPos, x, y, z);
+            __m256 dx = _mm256_sub_ps(x, lx);
+            __m256 dy = _mm256_sub_ps(y, ly);
+            __m256 dz = _mm256_sub_ps(z, lz);
+            __m256 len = _mm256_sqrt_ps(_mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz))));
+            // zero length directions stay zero, like Vector3::normalise does
+            __m256 scale = _mm256_and_ps(_mm256_div_ps(dist, len),
+                                         _mm256_cmp_ps(len, _mm256_setzero_ps(), _CMP_GT_OQ));
+            storePositions8(pDestPos, _mm256_fmadd_ps(dx, scale, x), _mm256_fmadd_ps(dy, scale, y),
+                            _mm256_fmadd_ps(dz, scale, z));
+        }
+        for (; vert < numVertices; ++vert, pSrcPos += 3, pDestPos += 3)
+            extrudeVertex(lightPos, extrudeDist, pSrcPos, pDestPos);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX2 size_t cullSpheres_AVX2(
+        const Plane* planes,
+        size_t numPlanes,
+        const float* centresX, const float* centresY, const float* centresZ,
+        const float* radii,
+        uint32* visibleIndices,
+        size_t numSpheres)
+    {
+        assert(numPlanes <= 6);
+
+        __m256 nx[6], ny[6], nz[6], d[6];
+        for (size_t p = 0; p < numPlanes; ++p)
+        {
+            nx[p] = _mm256_set1_ps(float(planes[p].normal.x));
+            ny[p] = _mm256_set1_ps(float(planes[p].normal.y));
+            nz[p] = _mm256_set1_ps(float(planes[p].normal.z));
+            d[p] = _mm256_set1_ps(float(planes[p].d));
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+        size_t numVisible = 0;
+        size_t i = 0;
+        for (; i + 8 <= numSpheres; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(centresX + i);
+            __m256 y = _mm256_loadu_ps(centresY + i);
+            __m256 z = _mm256_loadu_ps(centresZ + i);
+            __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(radii + i));
+
+            __m256 culled = zero;
+            for (size_t p = 0; p < numPlanes; ++p)
+            {
+                __m256 dist = _mm256_fmadd_ps(nx[p], x, _mm256_fmadd_ps(ny[p], y, _mm256_fmadd_ps(nz[p], z, d[p])));
+                culled = _mm256_or_ps(culled, _mm256_cmp_ps(dist, negRadius, _CMP_LT_OQ));
+            }
+
+            // stream compact the indices of the visible ones
+            int mask = _mm256_movemask_ps(culled);
+            for (int k = 0; k < 8; ++k)
+            {
+                if (!(mask & (1 << k)))
+                    visibleIndices[numVisible++] = uint32(i + k);
+            }
+        }
+
+        for (; i < numSpheres; ++i)
+        {
+            if (sphereVisible(planes, numPlanes, centresX[i], centresY[i], centresZ[i], radii[i]))
+                visibleIndices[numVisible++] = uint32(i);
+        }
+        return numVisible;
+    }
+
+//-------------------------------------------------------------------------
+// AVX-512 kernels
+//-------------------------------------------------------------------------
+
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC
+// the AVX-512 intrinsics of GCC pass a deliberately undefined register as
+// the unused merge source, which -Wmaybe-uninitialized reports
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wuninitialized"
+#   pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    static OGRE_TARGET_AVX512 void concatenateAffineMatrices_AVX512(
+        const Affine3& baseMatrix,
+        const Affine3* pSrcMat,
+        Affine3* pDstMat,
+        size_t numMatrices)
+    {
+        // All three rows fit into one register, see concatenateAffineMatrices_AVX2
+        const float* base = baseMatrix[0];
+        float coef[4][16] = {};
+        for (int k = 0; k < 4; ++k)
+            for (int row = 0; row < 3; ++row)
+                for (int j = 0; j < 4; ++j)
+                    coef[k][row * 4 + j] = base[row * 4 + k];
+        const __m512 c0 = _mm512_loadu_ps(coef[0]);
+        const __m512 c1 = _mm512_loadu_ps(coef[1]);
+        const __m512 c2 = _mm512_loadu_ps(coef[2]);
+        // translation of the base, only in the w lanes
+        const __m512 t = _mm512_maskz_loadu_ps(0x0888, coef[3]);
+
+        for (size_t i = 0; i < numMatrices; ++i)
+        {
+            const float* src = pSrcMat[i][0];
+            __m512 d = _mm512_fmadd_ps(c0, _mm512_broadcast_f32x4(_mm_loadu_ps(src)),
+                       _mm512_fmadd_ps(c1, _mm512_broadcast_f32x4(_mm_loadu_ps(src + 4)),
+                       _mm512_fmadd_ps(c2, _mm512_broadcast_f32x4(_mm_loadu_ps(src + 8)), t)));
+            _mm512_mask_storeu_ps(pDstMat[i][0], 0x0FFF, d);
+        }
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX512 void calculateFaceNormals_AVX512(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        // offsets of the components of sixteen Vector4
+        const __m512i out = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                                               _mm512_set1_epi32(4));
+        float* dst = faceNormals[0].ptr();
+        size_t i = 0;
+        for (; i + 16 <= numTriangles; i += 16, dst += 64)
+        {
+            __m512 v[3][3];
+            for (int c = 0; c < 3; ++c)
+            {
+                alignas(64) int32 offsets[16];
+                for (int k = 0; k < 16; ++k)
+                    offsets[k] = int32(triangles[i + k].vertIndex[c] * 3);
+                __m512i idx = _mm512_load_si512(offsets);
+                v[c][0] = _mm512_i32gather_ps(idx, positions, 4);
+                v[c][1] = _mm512_i32gather_ps(idx, positions + 1, 4);
+                v[c][2] = _mm512_i32gather_ps(idx, positions + 2, 4);
+            }
+
+            // Same as Math::calculateFaceNormalWithoutNormalize
+            __m512 ax = _mm512_sub_ps(v[1][0], v[0][0]), bx = _mm512_sub_ps(v[2][0], v[0][0]);
+            __m512 ay = _mm512_sub_ps(v[1][1], v[0][1]), by = _mm512_sub_ps(v[2][1], v[0][1]);
+            __m512 az = _mm512_sub_ps(v[1][2], v[0][2]), bz = _mm512_sub_ps(v[2][2], v[0][2]);
+            __m512 nx = _mm512_fmsub_ps(ay, bz, _mm512_mul_ps(az, by));
+            __m512 ny = _mm512_fmsub_ps(az, bx, _mm512_mul_ps(ax, bz));
+            __m512 nz = _mm512_fmsub_ps(ax, by, _mm512_mul_ps(ay, bx));
+            __m512 nw = _mm512_fnmsub_ps(nx, v[0][0], _mm512_fmadd_ps(ny, v[0][1], _mm512_mul_ps(nz, v[0][2])));
+
+            _mm512_i32scatter_ps(dst, out, nx, 4);
+            _mm512_i32scatter_ps(dst + 1, out, ny, 4);
+            _mm512_i32scatter_ps(dst + 2, out, nz, 4);
+            _mm512_i32scatter_ps(dst + 3, out, nw, 4);
+        }
+
+        for (; i < numTriangles; ++i)
+            faceNormals[i] = faceNormal(positions, triangles[i]);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX512 void calculateLightFacing_AVX512(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        const __m512 lp = _mm512_broadcast_f32x4(_mm_loadu_ps(lightPos.ptr()));
+        const float* n = faceNormals[0].ptr();
+        size_t i = 0;
+        for (; i + 4 <= numFaces; i += 4, n += 16)
+        {
+            // four faces per register, sum each group of four products
+            __m512 p = _mm512_mul_ps(_mm512_loadu_ps(n), lp);
+            p = _mm512_add_ps(p, _mm512_permute_ps(p, _MM_SHUFFLE(2, 3, 0, 1)));
+            p = _mm512_add_ps(p, _mm512_permute_ps(p, _MM_SHUFFLE(1, 0, 3, 2)));
+            __mmask16 mask = _mm512_cmp_ps_mask(p, _mm512_setzero_ps(), _CMP_GT_OQ);
+
+            lightFacings[i] = mask & 1;
+            lightFacings[i + 1] = (mask >> 4) & 1;
+            lightFacings[i + 2] = (mask >> 8) & 1;
+            lightFacings[i + 3] = (mask >> 12) & 1;
+        }
+
+        for (; i < numFaces; ++i)
+            lightFacings[i] = lightPos.dotProduct(faceNormals[i]) > 0;
+    }
+    //---------------------------------------------------------------------
+    static OGRE_TARGET_AVX512 void extrudeVertices_AVX512(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        size_t vert = 0;
+        if (lightPos.w == 0.0f)
+        {
+            // Directional light, the offset pattern repeats every sixteen vertices
+            Vector3 d = directionalExtrusion(lightPos, extrudeDist);
+            float pattern[48];
+            for (int k = 0; k < 48; k += 3)
+            {
+                pattern[k] = d.x;
+                pattern[k + 1] = d.y;
+                pattern[k + 2] = d.z;
+            }
+            const __m512 o0 = _mm512_loadu_ps(pattern);
+            const __m512 o1 = _mm512_loadu_ps(pattern + 16);
+            const __m512 o2 = _mm512_loadu_ps(pattern + 32);
+            for (; vert + 16 <= numVertices; vert += 16, pSrcPos += 48, pDestPos += 48)
+            {
+                _mm512_storeu_ps(pDestPos, _mm512_add_ps(_mm512_loadu_ps(pSrcPos), o0));
+                _mm512_storeu_ps(pDestPos + 16, _mm512_add_ps(_mm512_loadu_ps(pSrcPos + 16), o1));
+                _mm512_storeu_ps(pDestPos + 32, _mm512_add_ps(_mm512_loadu_ps(pSrcPos + 32), o2));
+            }
+            for (; vert < numVertices; ++vert, pSrcPos += 3, pDestPos += 3)
+            {
+                pDestPos[0] = pSrcPos[0] + d.x;
+                pDestPos[1] = pSrcPos[1] + d.y;
+                pDestPos[2] = pSrcPos[2] + d.z;
+            }
+            return;
+        }
+
+        // Point light, calculate extrusionDir for every vertex
+        assert(lightPos.w == 1.0f);
+        const __m512i idx = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                                               _mm512_set1_epi32(3));
+        const __m512 lx = _mm512_set1_ps(lightPos.x);
+        const __m512 ly = _mm512_set1_ps(lightPos.y);
+        const __m512 lz = _mm512_set1_ps(lightPos.z);
+        const __m512 dist = _mm512_set1_ps(extrudeDist);
+        for (; vert + 16 <= numVertices; vert += 16, pSrcPos += 48, pDestPos += 48)
+        {
+            __m512 x = _mm512_i32gather_ps(idx, pSrcPos, 4);
+            __m512 y = _mm512_i32gather_ps(idx, pSrcPos + 1, 4);
+            __m512 z = _mm512_i32gather_ps(idx, pSrcPos + 2, 4);
+            __m512 dx = _mm512_sub_ps(x, lx);
+            __m512 dy = _mm512_sub_ps(y, ly);
+            __m512 dz = _mm512_sub_ps(z, lz);
+            __m512 len = _mm512_sqrt_ps(_mm512_fmadd_ps(dx, dx, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dz, dz))));
+            // zero length directions stay zero, like Vector3::normalise does
+            __mmask16 valid = _mm512_cmp_ps_mask(len, _mm512_setzero_ps(), _CMP_GT_OQ);
+            __m512 scale = _mm512_maskz_div_ps(valid, dist, len);
+            _mm512_i32scatter_ps(pDestPos, idx, _mm512_fmadd_ps(dx, scale, x), 4);
+            _mm512_i32scatter_ps(pDestPos + 1, idx, _mm512_fmadd_ps(dy, scale, y), 4);
+            _mm512_i32scatter_ps(pDestPos + 2, idx, _mm512_fmadd_ps(dz, scale, z), 4);
+        }
+        for (; vert < numVertices; ++vert, pSrcPos += 3, pDestPos += 3)
+            extrudeVertex(lightPos, extrudeDist, pSrcPos, pDestPos);
+    }
+
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC
+#   pragma GCC diagnostic pop
+#endif
+
+//-------------------------------------------------------------------------
+// Class methods
+//-------------------------------------------------------------------------
+
+    void OptimisedUtilAVX2::softwareVertexSkinning(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Affine3* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        softwareVertexSkinning_AVX2(
+            pSrcPos, pDestPos, pSrcNorm, pDestNorm, pBlendWeight, pBlendIndex, blendMatrices,
+            srcPosStride, destPosStride, srcNormStride, destNormStride, blendWeightStride,
+            blendIndexStride, numWeightsPerVertex, numVertices);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::softwareVertexMorph(
+        float t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+        size_t numVertices,
+        bool morphNormals)
+    {
+        softwareVertexMorph_AVX2(t, pSrc1, pSrc2, pDst, pos1VSize, pos2VSize, dstVSize, numVertices,
+                                 morphNormals);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::concatenateAffineMatrices(
+        const Affine3& baseMatrix,
+        const Affine3* pSrcMat,
+        Affine3* pDstMat,
+        size_t numMatrices)
+    {
+        concatenateAffineMatrices_AVX2(baseMatrix, pSrcMat, pDstMat, numMatrices);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::calculateFaceNormals(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        calculateFaceNormals_AVX2(positions, triangles, faceNormals, numTriangles);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::calculateLightFacing(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        calculateLightFacing_AVX2(lightPos, faceNormals, lightFacings, numFaces);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX2::extrudeVertices(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        extrudeVertices_AVX2(lightPos, extrudeDist, pSrcPos, pDestPos, numVertices);
+    }
+    //---------------------------------------------------------------------
+    size_t OptimisedUtilAVX2::cullSpheres(
+        const Plane* planes,
+        size_t numPlanes,
+        const float* centresX, const float* centresY, const float* centresZ,
+        const float* radii,
+        uint32* visibleIndices,
+        size_t numSpheres)
+    {
+        return cullSpheres_AVX2(planes, numPlanes, centresX, centresY, centresZ, radii, visibleIndices,
+                                numSpheres);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX512::concatenateAffineMatrices(
+        const Affine3& baseMatrix,
+        const Affine3* pSrcMat,
+        Affine3* pDstMat,
+        size_t numMatrices)
+    {
+        concatenateAffineMatrices_AVX512(baseMatrix, pSrcMat, pDstMat, numMatrices);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX512::calculateFaceNormals(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        calculateFaceNormals_AVX512(positions, triangles, faceNormals, numTriangles);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX512::calculateLightFacing(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        calculateLightFacing_AVX512(lightPos, faceNormals, lightFacings, numFaces);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX512::extrudeVertices(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        extrudeVertices_AVX512(lightPos, extrudeDist, pSrcPos, pDestPos, numVertices);
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    extern OptimisedUtil* _getOptimisedUtilAVX2(void);
+    extern OptimisedUtil* _getOptimisedUtilAVX2(void)
+    {
+        static OptimisedUtilAVX2 msOptimisedUtilAVX2;
+        return &msOptimisedUtilAVX2;
+    }
+    //---------------------------------------------------------------------
+    extern OptimisedUtil* _getOptimisedUtilAVX512(void);
+    extern OptimisedUtil* _getOptimisedUtilAVX512(void)
+    {
+        static OptimisedUtilAVX512 msOptimisedUtilAVX512;
+        return &msOptimisedUtilAVX512;
+    }
+
+}
+
+#endif // __OGRE_HAVE_SSE
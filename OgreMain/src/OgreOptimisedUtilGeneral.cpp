@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 
 #include "OgreOptimisedUtil.h"
+#include "OgrePlane.h"
 
 namespace Ogre {
 
@@ -91,6 +92,15 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::cullSpheres
+        size_t cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const float* centresX, const float* centresY, const float* centresZ,
+            const float* radii,
+            uint32* visibleIndices,
+            size_t numSpheres) override;
     };
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -364,6 +374,32 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    size_t OptimisedUtilGeneral::cullSpheres(
+        const Plane* planes,
+        size_t numPlanes,
+        const float* centresX, const float* centresY, const float* centresZ,
+        const float* radii,
+        uint32* visibleIndices,
+        size_t numSpheres)
+    {
+        size_t numVisible = 0;
+        for (size_t i = 0; i < numSpheres; ++i)
+        {
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes && visible; ++p)
+            {
+                const Plane& plane = planes[p];
+                float dist = float(plane.normal.x) * centresX[i] + float(plane.normal.y) * centresY[i] +
+                             float(plane.normal.z) * centresZ[i] + float(plane.d);
+                visible = !(dist < -radii[i]);
+            }
+
+            if (visible)
+                visibleIndices[numVisible++] = uint32(i);
+        }
+        return numVisible;
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilGeneral(void);
@@ -0,0 +1,486 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreOptimisedUtil.h"
+#include "OgrePlane.h"
+
+// ARMv7 lacks the vector division, square root and horizontal adds used below,
+// it keeps running the SSE implementation through SSE2NEON
+#if __OGRE_HAVE_NEON && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
+
+#include <arm_neon.h>
+
+//-------------------------------------------------------------------------
+//
+// Native AArch64 NEON implementation. Unlike x86, NEON can load and store
+// interleaved xyz and xyzw data directly, deinterleaving it into one register
+// per component (vld3q/vld4q), so all kernels working on many vertices or faces
+// process four of them at a time in that layout.
+//
+//-------------------------------------------------------------------------
+
+namespace Ogre {
+
+//-------------------------------------------------------------------------
+// Local classes
+//-------------------------------------------------------------------------
+
+    /** NEON implementation of OptimisedUtil.
+    @note
+        Don't use this class directly, use OptimisedUtil instead.
+    */
+    class _OgrePrivate OptimisedUtilNEON : public OptimisedUtil
+    {
+    public:
+        /// @copydoc OptimisedUtil::softwareVertexSkinning
+        void softwareVertexSkinning(
+            const float *srcPosPtr, float *destPosPtr,
+            const float *srcNormPtr, float *destNormPtr,
+            const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+            const Affine3* const* blendMatrices,
+            size_t srcPosStride, size_t destPosStride,
+            size_t srcNormStride, size_t destNormStride,
+            size_t blendWeightStride, size_t blendIndexStride,
+            size_t numWeightsPerVertex,
+            size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::softwareVertexMorph
+        void softwareVertexMorph(
+            float t,
+            const float *srcPos1, const float *srcPos2,
+            float *dstPos,
+            size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+            size_t numVertices,
+            bool morphNormals) override;
+
+        /// @copydoc OptimisedUtil::concatenateAffineMatrices
+        void concatenateAffineMatrices(
+            const Affine3& baseMatrix,
+            const Affine3* srcMatrices,
+            Affine3* dstMatrices,
+            size_t numMatrices) override;
+
+        /// @copydoc OptimisedUtil::calculateFaceNormals
+        void calculateFaceNormals(
+            const float *positions,
+            const EdgeData::Triangle *triangles,
+            Vector4 *faceNormals,
+            size_t numTriangles) override;
+
+        /// @copydoc OptimisedUtil::calculateLightFacing
+        void calculateLightFacing(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            char* lightFacings,
+            size_t numFaces) override;
+
+        /// @copydoc OptimisedUtil::extrudeVertices
+        void extrudeVertices(
+            const Vector4& lightPos,
+            Real extrudeDist,
+            const float* srcPositions,
+            float* destPositions,
+            size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::cullSpheres
+        size_t cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const float* centresX, const float* centresY, const float* centresZ,
+            const float* radii,
+            uint32* visibleIndices,
+            size_t numSpheres) override;
+    };
+
+//-------------------------------------------------------------------------
+// Helpers
+//-------------------------------------------------------------------------
+
+    /// Loads x, y, z without touching memory past them, w is zero
+    static OGRE_FORCE_INLINE float32x4_t loadXYZ(const float* p)
+    {
+        return vcombine_f32(vld1_f32(p), vld1_lane_f32(p + 2, vdup_n_f32(0), 0));
+    }
+    //---------------------------------------------------------------------
+    /// Stores x, y, z without touching memory past them
+    static OGRE_FORCE_INLINE void storeXYZ(float* p, float32x4_t v)
+    {
+        vst1_f32(p, vget_low_f32(v));
+        vst1q_lane_f32(p + 2, v, 2);
+    }
+    //---------------------------------------------------------------------
+    /// Same as Vector3::normalise for a vector with w = 0, zero vectors are left alone
+    static OGRE_FORCE_INLINE float32x4_t normaliseXYZ(float32x4_t v)
+    {
+        float len = std::sqrt(vaddvq_f32(vmulq_f32(v, v)));
+        return len > 0 ? vmulq_n_f32(v, 1.0f / len) : v;
+    }
+    //---------------------------------------------------------------------
+    /// Transforms (x, y, z, w) by the three rows of an affine matrix, w of the result is zero
+    static OGRE_FORCE_INLINE float32x4_t transform(float32x4_t r0, float32x4_t r1, float32x4_t r2, float32x4_t v)
+    {
+        float32x4_t ret = vdupq_n_f32(0);
+        ret = vsetq_lane_f32(vaddvq_f32(vmulq_f32(r0, v)), ret, 0);
+        ret = vsetq_lane_f32(vaddvq_f32(vmulq_f32(r1, v)), ret, 1);
+        return vsetq_lane_f32(vaddvq_f32(vmulq_f32(r2, v)), ret, 2);
+    }
+
+//-------------------------------------------------------------------------
+// Class methods
+//-------------------------------------------------------------------------
+
+    void OptimisedUtilNEON::softwareVertexSkinning(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Affine3* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        const float32x4_t unitW = vsetq_lane_f32(1, vdupq_n_f32(0), 3);
+
+        for (size_t vertIdx = 0; vertIdx < numVertices; ++vertIdx)
+        {
+            // Blend the matrices first
+            float32x4_t m0 = vdupq_n_f32(0), m1 = m0, m2 = m0;
+            for (size_t blendIdx = 0; blendIdx < numWeightsPerVertex; ++blendIdx)
+            {
+                float weight = pBlendWeight[blendIdx];
+                if (weight)
+                {
+                    const float* mat = (*blendMatrices[pBlendIndex[blendIdx]])[0];
+                    m0 = vfmaq_n_f32(m0, vld1q_f32(mat), weight);
+                    m1 = vfmaq_n_f32(m1, vld1q_f32(mat + 4), weight);
+                    m2 = vfmaq_n_f32(m2, vld1q_f32(mat + 8), weight);
+                }
+            }
+
+            // Transform position, w = 1 picks up the translation
+            storeXYZ(pDestPos, transform(m0, m1, m2, vaddq_f32(loadXYZ(pSrcPos), unitW)));
+
+            if (pSrcNorm)
+            {
+                // Transform normal, w = 0 drops the translation. As in the general version, the
+                // 3x3 part is assumed to be orthogonal, so we don't need the inverse transpose.
+                storeXYZ(pDestNorm, normaliseXYZ(transform(m0, m1, m2, loadXYZ(pSrcNorm))));
+
+                advanceRawPointer(pSrcNorm, srcNormStride);
+                advanceRawPointer(pDestNorm, destNormStride);
+            }
+
+            advanceRawPointer(pSrcPos, srcPosStride);
+            advanceRawPointer(pDestPos, destPosStride);
+            advanceRawPointer(pBlendWeight, blendWeightStride);
+            advanceRawPointer(pBlendIndex, blendIndexStride);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilNEON::softwareVertexMorph(
+        float t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+        size_t numVertices,
+        bool morphNormals)
+    {
+        const size_t packedSize = (morphNormals ? 6 : 3) * sizeof(float);
+        if (!morphNormals && pos1VSize == packedSize && pos2VSize == packedSize && dstVSize == packedSize)
+        {
+            // Packed positions, interpolate as a plain float array
+            size_t count = numVertices * 3;
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t a = vld1q_f32(pSrc1 + i);
+                float32x4_t b = vld1q_f32(pSrc2 + i);
+                vst1q_f32(pDst + i, vfmaq_n_f32(a, vsubq_f32(b, a), t));
+            }
+            for (; i < count; ++i)
+                pDst[i] = pSrc1[i] + t * (pSrc2[i] - pSrc1[i]);
+            return;
+        }
+
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            float32x4_t a = loadXYZ(pSrc1);
+            float32x4_t b = loadXYZ(pSrc2);
+            storeXYZ(pDst, vfmaq_n_f32(a, vsubq_f32(b, a), t));
+
+            if (morphNormals)
+            {
+                // normals must be in the same buffer as pos, perform an nlerp
+                a = loadXYZ(pSrc1 + 3);
+                b = loadXYZ(pSrc2 + 3);
+                storeXYZ(pDst + 3, normaliseXYZ(vfmaq_n_f32(a, vsubq_f32(b, a), t)));
+            }
+
+            advanceRawPointer(pSrc1, pos1VSize);
+            advanceRawPointer(pSrc2, pos2VSize);
+            advanceRawPointer(pDst, dstVSize);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilNEON::concatenateAffineMatrices(
+        const Affine3& baseMatrix,
+        const Affine3* pSrcMat,
+        Affine3* pDstMat,
+        size_t numMatrices)
+    {
+        // Row i of the result is the sum of base[i][k] * row k of the source, where the
+        // implicit last source row is (0, 0, 0, 1)
+        const float* base = baseMatrix[0];
+        float32x4_t translate[3];
+        for (int r = 0; r < 3; ++r)
+            translate[r] = vsetq_lane_f32(base[r * 4 + 3], vdupq_n_f32(0), 3);
+
+        for (size_t i = 0; i < numMatrices; ++i)
+        {
+            const float* src = pSrcMat[i][0];
+            float32x4_t s0 = vld1q_f32(src);
+            float32x4_t s1 = vld1q_f32(src + 4);
+            float32x4_t s2 = vld1q_f32(src + 8);
+
+            float* dst = pDstMat[i][0];
+            for (int r = 0; r < 3; ++r)
+            {
+                const float* b = base + r * 4;
+                float32x4_t d = vfmaq_n_f32(translate[r], s0, b[0]);
+                d = vfmaq_n_f32(d, s1, b[1]);
+                vst1q_f32(dst + r * 4, vfmaq_n_f32(d, s2, b[2]));
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilNEON::calculateFaceNormals(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        float* dst = faceNormals[0].ptr();
+        size_t i = 0;
+        for (; i + 4 <= numTriangles; i += 4, dst += 16)
+        {
+            // Gather the corners of four triangles, one register per component
+            float32x4_t v[3][3];
+            for (int c = 0; c < 3; ++c)
+            {
+                float corners[3][4];
+                for (int k = 0; k < 4; ++k)
+                {
+                    const float* p = positions + triangles[i + k].vertIndex[c] * 3;
+                    corners[0][k] = p[0];
+                    corners[1][k] = p[1];
+                    corners[2][k] = p[2];
+                }
+                v[c][0] = vld1q_f32(corners[0]);
+                v[c][1] = vld1q_f32(corners[1]);
+                v[c][2] = vld1q_f32(corners[2]);
+            }
+
+            // Same as Math::calculateFaceNormalWithoutNormalize
+            float32x4_t ax = vsubq_f32(v[1][0], v[0][0]), bx = vsubq_f32(v[2][0], v[0][0]);
+            float32x4_t ay = vsubq_f32(v[1][1], v[0][1]), by = vsubq_f32(v[2][1], v[0][1]);
+            float32x4_t az = vsubq_f32(v[1][2], v[0][2]), bz = vsubq_f32(v[2][2], v[0][2]);
+            float32x4x4_t n;
+            n.val[0] = vfmsq_f32(vmulq_f32(ay, bz), az, by);
+            n.val[1] = vfmsq_f32(vmulq_f32(az, bx), ax, bz);
+            n.val[2] = vfmsq_f32(vmulq_f32(ax, by), ay, bx);
+            n.val[3] = vnegq_f32(vfmaq_f32(vfmaq_f32(vmulq_f32(n.val[2], v[0][2]), n.val[1], v[0][1]),
+                                           n.val[0], v[0][0]));
+
+            // Interleaves back to one Vector4 per face
+            vst4q_f32(dst, n);
+        }
+
+        for (; i < numTriangles; ++i)
+        {
+            const EdgeData::Triangle& t = triangles[i];
+            const float* v1 = positions + t.vertIndex[0] * 3;
+            const float* v2 = positions + t.vertIndex[1] * 3;
+            const float* v3 = positions + t.vertIndex[2] * 3;
+            faceNormals[i] = Math::calculateFaceNormalWithoutNormalize(
+                Vector3(v1[0], v1[1], v1[2]), Vector3(v2[0], v2[1], v2[2]), Vector3(v3[0], v3[1], v3[2]));
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilNEON::calculateLightFacing(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        const float* n = faceNormals[0].ptr();
+        size_t i = 0;
+        for (; i + 4 <= numFaces; i += 4, n += 16)
+        {
+            // one register per component of four faces
+            float32x4x4_t f = vld4q_f32(n);
+            float32x4_t dot = vmulq_n_f32(f.val[0], lightPos.x);
+            dot = vfmaq_n_f32(dot, f.val[1], lightPos.y);
+            dot = vfmaq_n_f32(dot, f.val[2], lightPos.z);
+            dot = vfmaq_n_f32(dot, f.val[3], lightPos.w);
+
+            uint32 facing[4];
+            vst1q_u32(facing, vcgtq_f32(dot, vdupq_n_f32(0)));
+            for (int k = 0; k < 4; ++k)
+                lightFacings[i + k] = facing[k] & 1;
+        }
+
+        for (; i < numFaces; ++i)
+            lightFacings[i] = lightPos.dotProduct(faceNormals[i]) > 0;
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilNEON::extrudeVertices(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        size_t vert = 0;
+        if (lightPos.w == 0.0f)
+        {
+            // Directional light, extrusion is along light direction
+            Vector3 extrusionDir(-lightPos.x, -lightPos.y, -lightPos.z);
+            extrusionDir.normalise();
+            extrusionDir *= extrudeDist;
+
+            for (; vert + 4 <= numVertices; vert += 4, pSrcPos += 12, pDestPos += 12)
+            {
+                float32x4x3_t p = vld3q_f32(pSrcPos);
+                p.val[0] = vaddq_f32(p.val[0], vdupq_n_f32(extrusionDir.x));
+                p.val[1] = vaddq_f32(p.val[1], vdupq_n_f32(extrusionDir.y));
+                p.val[2] = vaddq_f32(p.val[2], vdupq_n_f32(extrusionDir.z));
+                vst3q_f32(pDestPos, p);
+            }
+            for (; vert < numVertices; ++vert, pSrcPos += 3, pDestPos += 3)
+            {
+                pDestPos[0] = pSrcPos[0] + extrusionDir.x;
+                pDestPos[1] = pSrcPos[1] + extrusionDir.y;
+                pDestPos[2] = pSrcPos[2] + extrusionDir.z;
+            }
+            return;
+        }
+
+        // Point light, calculate extrusionDir for every vertex
+        assert(lightPos.w == 1.0f);
+        const float32x4_t zero = vdupq_n_f32(0);
+        const float32x4_t dist = vdupq_n_f32(extrudeDist);
+        for (; vert + 4 <= numVertices; vert += 4, pSrcPos += 12, pDestPos += 12)
+        {
+            float32x4x3_t p = vld3q_f32(pSrcPos);
+            float32x4_t dx = vsubq_f32(p.val[0], vdupq_n_f32(lightPos.x));
+            float32x4_t dy = vsubq_f32(p.val[1], vdupq_n_f32(lightPos.y));
+            float32x4_t dz = vsubq_f32(p.val[2], vdupq_n_f32(lightPos.z));
+            float32x4_t len = vsqrtq_f32(vfmaq_f32(vfmaq_f32(vmulq_f32(dz, dz), dy, dy), dx, dx));
+            // zero length directions stay zero, like Vector3::normalise does
+            float32x4_t scale = vbslq_f32(vcgtq_f32(len, zero), vdivq_f32(dist, len), zero);
+            p.val[0] = vfmaq_f32(p.val[0], dx, scale);
+            p.val[1] = vfmaq_f32(p.val[1], dy, scale);
+            p.val[2] = vfmaq_f32(p.val[2], dz, scale);
+            vst3q_f32(pDestPos, p);
+        }
+        for (; vert < numVertices; ++vert, pSrcPos += 3, pDestPos += 3)
+        {
+            Vector3 extrusionDir(pSrcPos[0] - lightPos.x, pSrcPos[1] - lightPos.y, pSrcPos[2] - lightPos.z);
+            extrusionDir.normalise();
+            extrusionDir *= extrudeDist;
+
+            pDestPos[0] = pSrcPos[0] + extrusionDir.x;
+            pDestPos[1] = pSrcPos[1] + extrusionDir.y;
+            pDestPos[2] = pSrcPos[2] + extrusionDir.z;
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t OptimisedUtilNEON::cullSpheres(
+        const Plane* planes,
+        size_t numPlanes,
+        const float* centresX, const float* centresY, const float* centresZ,
+        const float* radii,
+        uint32* visibleIndices,
+        size_t numSpheres)
+    {
+        size_t numVisible = 0;
+        size_t i = 0;
+        for (; i + 4 <= numSpheres; i += 4)
+        {
+            float32x4_t x = vld1q_f32(centresX + i);
+            float32x4_t y = vld1q_f32(centresY + i);
+            float32x4_t z = vld1q_f32(centresZ + i);
+            float32x4_t negRadius = vnegq_f32(vld1q_f32(radii + i));
+
+            uint32x4_t culled = vdupq_n_u32(0);
+            for (size_t p = 0; p < numPlanes; ++p)
+            {
+                float32x4_t dist = vfmaq_n_f32(vdupq_n_f32(float(planes[p].d)), x, float(planes[p].normal.x));
+                dist = vfmaq_n_f32(dist, y, float(planes[p].normal.y));
+                dist = vfmaq_n_f32(dist, z, float(planes[p].normal.z));
+                culled = vorrq_u32(culled, vcltq_f32(dist, negRadius));
+            }
+
+            // stream compact the indices of the visible ones
+            uint32 mask[4];
+            vst1q_u32(mask, culled);
+            for (int k = 0; k < 4; ++k)
+            {
+                if (!mask[k])
+                    visibleIndices[numVisible++] = uint32(i + k);
+            }
+        }
+
+        for (; i < numSpheres; ++i)
+        {
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes && visible; ++p)
+            {
+                float dist = float(planes[p].normal.x) * centresX[i] + float(planes[p].normal.y) * centresY[i] +
+                             float(planes[p].normal.z) * centresZ[i] + float(planes[p].d);
+                visible = !(dist < -radii[i]);
+            }
+            if (visible)
+                visibleIndices[numVisible++] = uint32(i);
+        }
+        return numVisible;
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    extern OptimisedUtil* _getOptimisedUtilNEON(void);
+    extern OptimisedUtil* _getOptimisedUtilNEON(void)
+    {
+        static OptimisedUtilNEON msOptimisedUtilNEON;
+        return &msOptimisedUtilNEON;
+    }
+
+}
+
+#endif // __OGRE_HAVE_NEON && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
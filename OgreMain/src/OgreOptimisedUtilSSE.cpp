@@ -27,6 +27,7 @@ THE SOFTWARE.
 */
 #include "OgreStableHeaders.h"
 #include "OgreOptimisedUtil.h"
+#include "OgrePlane.h"
 
 
 #if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
@@ -129,6 +130,15 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::cullSpheres
+        size_t __OGRE_SIMD_ALIGN_ATTRIBUTE cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const float* centresX, const float* centresY, const float* centresZ,
+            const float* radii,
+            uint32* visibleIndices,
+            size_t numSpheres) override;
     };
 
 #if defined(__OGRE_SIMD_ALIGN_STACK)
@@ -268,6 +278,26 @@ namespace Ogre {
                 destPositions,
                 numVertices);
         }
+
+        /// @copydoc OptimisedUtil::cullSpheres
+        virtual size_t cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const float* centresX, const float* centresY, const float* centresZ,
+            const float* radii,
+            uint32* visibleIndices,
+            size_t numSpheres)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            return mImpl->cullSpheres(
+                planes,
+                numPlanes,
+                centresX, centresY, centresZ,
+                radii,
+                visibleIndices,
+                numSpheres);
+        }
     };
 #endif  // !defined(__OGRE_SIMD_ALIGN_STACK)
 
@@ -1501,14 +1531,13 @@ namespace Ogre {
                 __m128 tmp = _mm_mul_ps(norm, norm);
                 // Add - for this we want this effect:
                 // orig   3 | 2 | 1 | 0
-                // add1   0 | 0 | 0 | 2
-                // add2   2 | 3 | 0 | 3
-                // This way elements 0, 2 and 3 have the sum of all entries (except 1 which is unused)
+                // add1   2 | 3 | 0 | 1
+                // add2   1 | 0 | 3 | 2
+                // This way all elements have the sum of all entries (1 is zero)
                 
-                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(0,0,0,2)));
+                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(2,3,0,1)));
                 // Add final combination & sqrt 
-                // bottom 3 elements of l will have length, we don't care about 4
-                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(2,3,0,3)));
+                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(1,0,3,2)));
                 // Then divide to normalise
                 norm = _mm_div_ps(norm, _mm_sqrt_ps(tmp));
                 
@@ -2134,6 +2163,73 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    size_t OptimisedUtilSSE::cullSpheres(
+        const Plane* planes,
+        size_t numPlanes,
+        const float* centresX, const float* centresY, const float* centresZ,
+        const float* radii,
+        uint32* visibleIndices,
+        size_t numSpheres)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(numPlanes <= 6);
+
+        // Splat the planes once, they stay in registers for all spheres
+        __m128 nx[6], ny[6], nz[6], d[6];
+        for (size_t p = 0; p < numPlanes; ++p)
+        {
+            nx[p] = _mm_set1_ps(float(planes[p].normal.x));
+            ny[p] = _mm_set1_ps(float(planes[p].normal.y));
+            nz[p] = _mm_set1_ps(float(planes[p].normal.z));
+            d[p] = _mm_set1_ps(float(planes[p].d));
+        }
+
+        __m128 zero = _mm_setzero_ps();
+        size_t numVisible = 0;
+        size_t i = 0;
+
+        // Four spheres per-iteration, one per component of the registers
+        for (; i + 4 <= numSpheres; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(centresX + i);
+            __m128 y = _mm_loadu_ps(centresY + i);
+            __m128 z = _mm_loadu_ps(centresZ + i);
+            __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(radii + i));
+
+            __m128 culled = zero;
+            for (size_t p = 0; p < numPlanes; ++p)
+            {
+                __m128 dist = __MM_DOT4x3_PS(nx[p], ny[p], nz[p], d[p], x, y, z);
+                culled = _mm_or_ps(culled, _mm_cmplt_ps(dist, negRadius));
+            }
+            int bitmask = _mm_movemask_ps(culled);
+
+            // Stream compact the indices of the visible ones
+            for (int k = 0; k < 4; ++k)
+            {
+                if (!(bitmask & (1 << k)))
+                    visibleIndices[numVisible++] = uint32(i + k);
+            }
+        }
+
+        // Remaining spheres one by one
+        for (; i < numSpheres; ++i)
+        {
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes && visible; ++p)
+            {
+                float dist = float(planes[p].normal.x) * centresX[i] + float(planes[p].normal.y) * centresY[i] +
+                             float(planes[p].normal.z) * centresZ[i] + float(planes[p].d);
+                visible = !(dist < -radii[i]);
+            }
+            if (visible)
+                visibleIndices[numVisible++] = uint32(i);
+        }
+
+        return numVisible;
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilSSE(void);
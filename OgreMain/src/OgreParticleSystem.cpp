@@ -34,7 +34,6 @@ THE SOFTWARE.
 #include "OgreParticle.h"
 #include "OgreParticleAffectorFactory.h"
 #include "OgreParticleSystemRenderer.h"
-#include "OgreControllerManager.h"
 
 namespace Ogre {
     /** Command object for quota (see ParamCommand).*/
@@ -132,18 +131,36 @@ namespace Ogre {
 
     //-----------------------------------------------------------------------
     // Local class for updating based on time
-    class ParticleSystemUpdateValue : public ControllerValue<float>
-    {
-    protected:
-        ParticleSystem* mTarget;
-    public:
-        ParticleSystemUpdateValue(ParticleSystem* target) : mTarget(target) {}
-
-        float getValue(void) const override { return 0; } // N/A
-
-        void setValue(float value) override { mTarget->_update(value); }
+    namespace {
+        /// xorshift stream of a particle system, installed for the calling thread unless the
+        /// application set its own provider with Math::SetRandomValueProvider
+        class ParticleRandom : public Math::RandomValueProvider
+        {
+            uint32& mState;
+            Math::RandomValueProvider* mPrevious;
+            bool mInstalled;
+        public:
+            ParticleRandom(uint32& state)
+                : mState(state), mPrevious(NULL), mInstalled(!Math::GetRandomValueProvider())
+            {
+                if (mInstalled)
+                    mPrevious = Math::SetThreadRandomValueProvider(this);
+            }
+            ~ParticleRandom()
+            {
+                if (mInstalled)
+                    Math::SetThreadRandomValueProvider(mPrevious);
+            }
 
-    };
+            Real getRandomUnit() override
+            {
+                mState ^= mState << 13;
+                mState ^= mState >> 17;
+                mState ^= mState << 5;
+                return (mState >> 8) * (1.0f / 0xFFFFFF);
+            }
+        };
+    }
     //-----------------------------------------------------------------------
     ParticleSystem::ParticleSystem() 
       : mAABB(),
@@ -162,14 +179,19 @@ namespace Ogre {
         mNonvisibleTimeoutSet(false),
         mTimeSinceLastVisible(0),
         mLastVisibleFrame(0),
-        mTimeController(0),
+        mUpdateRegistered(false),
+        mRandomSeed(0),
+        mRandomState(0),
         mEmittedEmitterPoolInitialised(false),
         mIsEmitting(true),
+        mParticleData(),
+        mParticleDataCurrent(false),
         mRenderer(0),
         mCullIndividual(false),
         mPoolSize(0),
         mEmittedEmitterPoolSize(0)
     {
+        setRandomSeed(0);
         initParameters();
 
         // Default to billboard renderer
@@ -195,9 +217,13 @@ namespace Ogre {
         mNonvisibleTimeoutSet(false),
         mTimeSinceLastVisible(0),
         mLastVisibleFrame(Root::getSingleton().getNextFrameNumber()),
-        mTimeController(0),
+        mUpdateRegistered(false),
+        mRandomSeed(0),
+        mRandomState(0),
         mEmittedEmitterPoolInitialised(false),
         mIsEmitting(true),
+        mParticleData(),
+        mParticleDataCurrent(false),
         mRenderer(0), 
         mCullIndividual(false),
         mPoolSize(0),
@@ -208,6 +234,7 @@ namespace Ogre {
         // Default to 10 particles, expect app to specify (will only be increased, not decreased)
         setParticleQuota( 10 );
         setEmittedEmitterQuota( 3 );
+        setRandomSeed(FastHash(name.data(), name.size()));
         initParameters();
 
         // Default to billboard renderer
@@ -217,11 +244,10 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     ParticleSystem::~ParticleSystem()
     {
-        if (mTimeController)
+        if (mUpdateRegistered)
         {
-            // Destroy controller
-            ControllerManager::getSingleton().destroyController(mTimeController);
-            mTimeController = 0;
+            ParticleSystemManager::getSingleton()._removeUpdateSystem(this);
+            mUpdateRegistered = false;
         }
 
         // Arrange for the deletion of emitters & affectors
@@ -230,10 +256,8 @@ namespace Ogre {
         removeAllAffectors();
 
         // Free pool items
-        for (auto p : mParticlePool)
-        {
-            OGRE_DELETE p;
-        }
+        mParticlePool.clear();
+        mParticleBlocks.clear();
 
         if (mRenderer)
         {
@@ -429,9 +453,18 @@ namespace Ogre {
     void ParticleSystem::_update(Real timeElapsed)
     {
         OgreProfile("ParticleSystem");
+        if (!_prepareUpdate(timeElapsed))
+            return;
+
+        _stepParticles(timeElapsed);
+        _updateBounds();
+    }
+    //-----------------------------------------------------------------------
+    bool ParticleSystem::_prepareUpdate(Real& timeElapsed)
+    {
         // Only update if attached to a node
         if (!mParentNode)
-            return;
+            return false;
 
         Real nonvisibleTimeout = mNonvisibleTimeoutSet ?
             mNonvisibleTimeout : msDefaultNonvisibleTimeout;
@@ -447,7 +480,7 @@ namespace Ogre {
                 if (mTimeSinceLastVisible >= nonvisibleTimeout)
                 {
                     // No update
-                    return;
+                    return false;
                 }
             }
         }
@@ -461,6 +494,15 @@ namespace Ogre {
         // Initialise emitted emitters list if not done already
         initialiseEmittedEmitters();
 
+        // Emitters read the derived transform, bring it up to date while nothing runs concurrently
+        mParentNode->_getFullTransform();
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_stepParticles(Real timeElapsed)
+    {
+        ParticleRandom random(mRandomState);
+
         Real iterationInterval = mIterationIntervalSet ? 
             mIterationInterval : msDefaultIterationInterval;
         if (iterationInterval > 0)
@@ -499,8 +541,13 @@ namespace Ogre {
 
         if (!mBoundsAutoUpdate && mBoundsUpdateTime > 0.0f)
             mBoundsUpdateTime -= timeElapsed; // count down 
-        _updateBounds();
-
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::setRandomSeed(uint32 seed)
+    {
+        mRandomSeed = seed;
+        // xorshift must not start from 0
+        mRandomState = seed ? seed : 0x9E3779B9;
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_expire(Real timeElapsed)
@@ -552,9 +599,9 @@ namespace Ogre {
     void ParticleSystem::_triggerEmitters(Real timeElapsed)
     {
         OgreProfile("_triggerEmitters");
-        // Add up requests for emission
-        static std::vector<unsigned> requested;
-        static std::vector<unsigned> emittedRequested;
+        // Add up requests for emission, per thread as systems may be stepped concurrently
+        static thread_local std::vector<unsigned> requested;
+        static thread_local std::vector<unsigned> emittedRequested;
 
         if( requested.size() != mEmitters.size() )
             requested.resize( mEmitters.size() );
@@ -675,9 +722,36 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ParticleSystem::_applyMotion(Real timeElapsed)
     {
-        for (auto pParticle : mActiveParticles)
+        if (mParticleDataCurrent)
+        {
+            // Still in the separate arrays, move there and write everything back once
+            const size_t n = ParticleData::BATCH_SIZE;
+            ParticleData& data = mParticleData;
+            for (size_t i = 0; i < data.paddedCount; i += n)
+            {
+                // Loaded before any store, so the compiler knows they do not alias and uses SIMD
+                Real dx[n], dy[n], dz[n];
+                for (size_t j = 0; j < n; ++j)
+                {
+                    dx[j] = data.directionX[i + j] * timeElapsed;
+                    dy[j] = data.directionY[i + j] * timeElapsed;
+                    dz[j] = data.directionZ[i + j] * timeElapsed;
+                }
+                for (size_t j = 0; j < n; ++j)
+                {
+                    data.positionX[i + j] += dx[j];
+                    data.positionY[i + j] += dy[j];
+                    data.positionZ[i + j] += dz[j];
+                }
+            }
+            scatterParticleData();
+        }
+        else
         {
-            pParticle->mPosition += (pParticle->mDirection * timeElapsed);
+            for (auto pParticle : mActiveParticles)
+            {
+                pParticle->mPosition += (pParticle->mDirection * timeElapsed);
+            }
         }
 
         // Notify renderer
@@ -689,21 +763,97 @@ namespace Ogre {
         OgreProfile("_triggerAffectors");
         for (auto a : mAffectors)
         {
-            a->_affectParticles(this, timeElapsed);
+            if (a->_supportsParticleData())
+            {
+                if (!mParticleDataCurrent)
+                    gatherParticleData();
+                a->_affectParticleData(mParticleData, timeElapsed);
+            }
+            else
+            {
+                if (mParticleDataCurrent)
+                    scatterParticleData();
+                a->_affectParticles(this, timeElapsed);
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::gatherParticleData(void)
+    {
+        ParticleData& data = mParticleData;
+        data.count = mActiveParticles.size();
+        data.paddedCount = (data.count + ParticleData::BATCH_SIZE - 1) & ~(ParticleData::BATCH_SIZE - 1);
+
+        // 12 Real arrays, only ever grown so the pointers rarely change
+        if (mParticleDataReals.size() < data.paddedCount * 12)
+        {
+            mParticleDataReals.resize(data.paddedCount * 12);
+            mParticleDataColours.resize(data.paddedCount);
+        }
+        const size_t stride = mParticleDataColours.size();
+        Real* reals = mParticleDataReals.data();
+        Real** arrays[] = {&data.positionX, &data.positionY, &data.positionZ, &data.directionX,
+                           &data.directionY, &data.directionZ, &data.width, &data.height,
+                           &data.rotation, &data.rotationSpeed, &data.timeToLive, &data.totalTimeToLive};
+        for (size_t a = 0; a < 12; ++a)
+            *arrays[a] = reals + a * stride;
+        data.colour = mParticleDataColours.data();
+
+        for (size_t i = 0; i < data.count; ++i)
+        {
+            const Particle* p = mActiveParticles[i];
+            data.positionX[i] = p->mPosition.x;
+            data.positionY[i] = p->mPosition.y;
+            data.positionZ[i] = p->mPosition.z;
+            data.directionX[i] = p->mDirection.x;
+            data.directionY[i] = p->mDirection.y;
+            data.directionZ[i] = p->mDirection.z;
+            data.width[i] = p->mWidth;
+            data.height[i] = p->mHeight;
+            data.rotation[i] = p->mRotation.valueRadians();
+            data.rotationSpeed[i] = p->mRotationSpeed.valueRadians();
+            data.timeToLive[i] = p->mTimeToLive;
+            data.totalTimeToLive[i] = p->mTotalTimeToLive;
+            data.colour[i] = p->mColour;
+        }
+        mParticleDataCurrent = true;
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::scatterParticleData(void)
+    {
+        const ParticleData& data = mParticleData;
+        for (size_t i = 0; i < data.count; ++i)
+        {
+            Particle* p = mActiveParticles[i];
+            p->mPosition = Vector3(data.positionX[i], data.positionY[i], data.positionZ[i]);
+            p->mDirection = Vector3(data.directionX[i], data.directionY[i], data.directionZ[i]);
+            p->mWidth = float(data.width[i]);
+            p->mHeight = float(data.height[i]);
+            p->mRotation = Radian(data.rotation[i]);
+            p->mRotationSpeed = Radian(data.rotationSpeed[i]);
+            p->mTimeToLive = float(data.timeToLive[i]);
+            p->mTotalTimeToLive = float(data.totalTimeToLive[i]);
+            p->mColour = data.colour[i];
         }
+        mParticleDataCurrent = false;
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::increasePool(size_t size)
     {
         size_t oldSize = mParticlePool.size();
 
+        if (size <= oldSize)
+            return;
+
+        // Create new particles in one block
+        mParticleBlocks.emplace_back(new Particle[size - oldSize]);
+        Particle* block = mParticleBlocks.back().get();
+
         // Increase size
         mParticlePool.resize(size);
-
-        // Create new particles
         for( size_t i = oldSize; i < size; i++ )
         {
-            mParticlePool[i] = OGRE_NEW Particle();
+            mParticlePool[i] = block + (i - oldSize);
         }
     }
     //-----------------------------------------------------------------------
@@ -1002,22 +1152,20 @@ namespace Ogre {
             mRenderer->_notifyAttached(parent, isTagPoint);
         }
 
-        if (parent && !mTimeController)
+        if (parent && !mUpdateRegistered)
         {
             // Assume visible
             mTimeSinceLastVisible = 0;
             mLastVisibleFrame = Root::getSingleton().getNextFrameNumber();
 
-            // Create time controller when attached
-            ControllerManager& mgr = ControllerManager::getSingleton(); 
-            ControllerValueRealPtr updValue(OGRE_NEW ParticleSystemUpdateValue(this));
-            mTimeController = mgr.createFrameTimePassthroughController(updValue);
+            // Get updated every frame when attached
+            ParticleSystemManager::getSingleton()._addUpdateSystem(this);
+            mUpdateRegistered = true;
         }
-        else if (!parent && mTimeController)
+        else if (!parent && mUpdateRegistered)
         {
-            // Destroy controller
-            ControllerManager::getSingleton().destroyController(mTimeController);
-            mTimeController = 0;
+            ParticleSystemManager::getSingleton()._removeUpdateSystem(this);
+            mUpdateRegistered = false;
         }
     }
     //-----------------------------------------------------------------------
@@ -1052,7 +1200,8 @@ namespace Ogre {
         // reset active and free lists
         mActiveParticles.clear();
         mFreeParticles.clear();
-        mFreeParticles.insert(mFreeParticles.end(), mParticlePool.begin(), mParticlePool.end());
+        // reversed, so createParticle hands them out in memory order
+        mFreeParticles.insert(mFreeParticles.end(), mParticlePool.rbegin(), mParticlePool.rend());
 
         // Add active emitted emitters to free list
         addActiveEmittedEmittersToFreeList();
@@ -1089,9 +1238,9 @@ namespace Ogre {
         {
             this->increasePool(size);
 
-            // Add new items to the queue
-            mFreeParticles.insert(mFreeParticles.end(), mParticlePool.begin() + currSize,
-                                  mParticlePool.end());
+            // Add new items to the queue, reversed so they are handed out in memory order
+            mFreeParticles.insert(mFreeParticles.begin(), mParticlePool.rbegin(),
+                                  mParticlePool.rend() - currSize);
 
             // Tell the renderer, if already configured
             if (mRenderer && mIsRendererConfigured)
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreParticleSystemRenderer.h"
 #include "OgreBillboardParticleRenderer.h"
 #include "OgreParticleSystem.h"
+#include "OgreControllerManager.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------
@@ -48,7 +49,20 @@ namespace Ogre {
         assert( msSingleton );  return ( *msSingleton );  
     }
     //-----------------------------------------------------------------------
-    ParticleSystemManager::ParticleSystemManager()
+    namespace {
+        class ParticleSystemManagerUpdateValue : public ControllerValue<float>
+        {
+            ParticleSystemManager* mTarget;
+        public:
+            ParticleSystemManagerUpdateValue(ParticleSystemManager* target) : mTarget(target) {}
+
+            float getValue(void) const override { return 0; } // N/A
+
+            void setValue(float value) override { mTarget->_updateSystems(value); }
+        };
+    }
+    //-----------------------------------------------------------------------
+    ParticleSystemManager::ParticleSystemManager() : mTimeController(0), mParallelUpdate(false)
     {
         OGRE_LOCK_AUTO_MUTEX;
         mFactory = OGRE_NEW ParticleSystemFactory();
@@ -331,6 +345,62 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void ParticleSystemManager::_addUpdateSystem(ParticleSystem* sys)
+    {
+        if (!mTimeController)
+        {
+            ControllerValueRealPtr updValue(OGRE_NEW ParticleSystemManagerUpdateValue(this));
+            mTimeController = ControllerManager::getSingleton().createFrameTimePassthroughController(updValue);
+        }
+        mUpdateSystems.push_back(sys);
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::_removeUpdateSystem(ParticleSystem* sys)
+    {
+        auto it = std::find(mUpdateSystems.begin(), mUpdateSystems.end(), sys);
+        if (it == mUpdateSystems.end())
+            return;
+
+        // update order does not matter
+        *it = mUpdateSystems.back();
+        mUpdateSystems.pop_back();
+
+        if (mUpdateSystems.empty() && mTimeController)
+        {
+            if (auto mgr = ControllerManager::getSingletonPtr())
+                mgr->destroyController(mTimeController);
+            mTimeController = 0;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::_updateSystems(Real timeElapsed)
+    {
+        WorkQueue* queue = Root::getSingleton().getWorkQueue();
+        // an application provided random generator is shared by all systems, so update serially
+        if (!mParallelUpdate || !queue || mUpdateSystems.size() < 2 || Math::GetRandomValueProvider())
+        {
+            for (size_t i = 0; i < mUpdateSystems.size(); ++i)
+                mUpdateSystems[i]->_update(timeElapsed);
+            return;
+        }
+
+        OgreProfile("ParticleSystems");
+        // node transforms, renderer setup and bounds touch shared state, only stepping is concurrent
+        std::vector<std::pair<ParticleSystem*, Real> > due;
+        due.reserve(mUpdateSystems.size());
+        for (auto sys : mUpdateSystems)
+        {
+            Real t = timeElapsed;
+            if (sys->_prepareUpdate(t))
+                due.emplace_back(sys, t);
+        }
+
+        queue->processTasksParallel(due.size(), [&due](size_t i) { due[i].first->_stepParticles(due[i].second); });
+
+        for (const auto& d : due)
+            d.first->_updateBounds();
+    }
+    //-----------------------------------------------------------------------
     ParticleSystemManager::ParticleAffectorFactoryIterator 
     ParticleSystemManager::getAffectorFactoryIterator(void)
     {
@@ -146,12 +146,12 @@ namespace Ogre {
     }
 
     //---------------------------------------------------------------------
-    // Performs CPUID instruction with 'query', fill the results, and return value of eax.
-    static uint _performCpuid(int query, CpuidResult& result)
+    // Performs CPUID instruction with 'query' and 'subQuery', fill the results, and return value of eax.
+    static uint _performCpuid(int query, CpuidResult& result, int subQuery = 0)
     {
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
         int CPUInfo[4];
-        __cpuid(CPUInfo, query);
+        __cpuidex(CPUInfo, query, subQuery);
         result._eax = CPUInfo[0];
         result._ebx = CPUInfo[1];
         result._ecx = CPUInfo[2];
@@ -161,7 +161,7 @@ namespace Ogre {
         #if OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
         __asm__
         (
-            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query)
+            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query), "c" (subQuery)
         );
         #else
         __asm__
@@ -171,7 +171,7 @@ namespace Ogre {
             "movl   %%ebx, %%edi    \n\t"
             "popl   %%ebx           \n\t"
             : "=a" (result._eax), "=D" (result._ebx), "=c" (result._ecx), "=d" (result._edx)
-            : "a" (query)
+            : "a" (query), "c" (subQuery)
         );
        #endif // OGRE_ARCHITECTURE_64
         return result._eax;
@@ -182,6 +182,23 @@ namespace Ogre {
 #endif
     }
 
+    //---------------------------------------------------------------------
+    // Reads XCR0, which tells the register states saved by the OS on context switches.
+    static uint64 _getExtendedControlRegister(void)
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        return _xgetbv(0);
+#elif (OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG) && OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        uint eax, edx;
+        __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+        return (uint64(edx) << 32) | eax;
+#else
+        // without xgetbv we can't tell whether the OS saves the AVX registers, so report
+        // none, which keeps AVX code disabled
+        return 0;
+#endif
+    }
+
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 #pragma warning(pop)
 #endif
@@ -267,6 +284,7 @@ namespace Ogre {
 
 #define CPUID_FUNC_VENDOR_ID                 0x0
 #define CPUID_FUNC_STANDARD_FEATURES         0x1
+#define CPUID_FUNC_STRUCTURED_FEATURES       0x7
 #define CPUID_FUNC_EXTENSION_QUERY           0x80000000
 #define CPUID_FUNC_EXTENDED_FEATURES         0x80000001
 #define CPUID_FUNC_ADVANCED_POWER_MANAGEMENT 0x80000007
@@ -282,6 +300,15 @@ namespace Ogre {
 #define CPUID_STD_SSE3              (1<<0)      // ECX[0]  - Bit 0 of standard function 1 indicate SSE3 supported
 #define CPUID_STD_SSE41             (1<<19)     // ECX[19] - Bit 0 of standard function 1 indicate SSE41 supported
 #define CPUID_STD_SSE42             (1<<20)     // ECX[20] - Bit 0 of standard function 1 indicate SSE42 supported
+#define CPUID_STD_FMA               (1<<12)     // ECX[12] - Bit 12 of standard function 1 indicate FMA3 supported
+#define CPUID_STD_OSXSAVE           (1<<27)     // ECX[27] - Bit 27 of standard function 1 indicate XGETBV is enabled by the OS
+#define CPUID_STD_AVX               (1<<28)     // ECX[28] - Bit 28 of standard function 1 indicate AVX supported
+
+#define CPUID_STRUCT_AVX2           (1<<5)      // EBX[5]  - Bit 5 of structured function 7 indicate AVX2 supported
+#define CPUID_STRUCT_AVX512F        (1<<16)     // EBX[16] - Bit 16 of structured function 7 indicate AVX512F supported
+
+#define XCR0_AVX_STATE              0x06        // XMM and YMM registers are saved by the OS
+#define XCR0_AVX512_STATE           0xE6        // additionally opmask and ZMM registers are saved by the OS
 
 #define CPUID_FAMILY_ID_MASK        0x0F00      // EAX[11:8] - Bit 11 thru 8 contains family  processor id
 #define CPUID_EXT_FAMILY_ID_MASK    0x0F00000   // EAX[23:20] - Bit 23 thru 20 contains extended family processor id
@@ -302,7 +329,8 @@ namespace Ogre {
             CpuidResult result;
 
             // Has standard feature ?
-            if (_performCpuid(CPUID_FUNC_VENDOR_ID, result))
+            const uint maxStandardFunctionSupport = _performCpuid(CPUID_FUNC_VENDOR_ID, result);
+            if (maxStandardFunctionSupport)
             {
                 // Check vendor strings
                 if (memcmp(&result._ebx, "GenuineIntel", 12) == 0)
@@ -398,6 +426,29 @@ namespace Ogre {
                             features |= PlatformInformation::CPU_FEATURE_INVARIANT_TSC;
                     }
                 }
+
+                // AVX is vendor independent, but needs the OS to save the wider registers
+                _performCpuid(CPUID_FUNC_STANDARD_FEATURES, result);
+                if ((result._ecx & CPUID_STD_OSXSAVE) && (result._ecx & CPUID_STD_AVX))
+                {
+                    const uint64 xcr0 = _getExtendedControlRegister();
+                    if ((xcr0 & XCR0_AVX_STATE) == XCR0_AVX_STATE)
+                    {
+                        features |= PlatformInformation::CPU_FEATURE_AVX;
+                        if (result._ecx & CPUID_STD_FMA)
+                            features |= PlatformInformation::CPU_FEATURE_FMA;
+
+                        if (maxStandardFunctionSupport >= CPUID_FUNC_STRUCTURED_FEATURES)
+                        {
+                            _performCpuid(CPUID_FUNC_STRUCTURED_FEATURES, result);
+
+                            if (result._ebx & CPUID_STRUCT_AVX2)
+                                features |= PlatformInformation::CPU_FEATURE_AVX2;
+                            if ((result._ebx & CPUID_STRUCT_AVX512F) && (xcr0 & XCR0_AVX512_STATE) == XCR0_AVX512_STATE)
+                                features |= PlatformInformation::CPU_FEATURE_AVX512F;
+                        }
+                    }
+                }
             }
         }
 
@@ -413,7 +464,11 @@ namespace Ogre {
             | PlatformInformation::CPU_FEATURE_SSE2
             | PlatformInformation::CPU_FEATURE_SSE3
             | PlatformInformation::CPU_FEATURE_SSE41
-            | PlatformInformation::CPU_FEATURE_SSE42;
+            | PlatformInformation::CPU_FEATURE_SSE42
+            | PlatformInformation::CPU_FEATURE_AVX
+            | PlatformInformation::CPU_FEATURE_AVX2
+            | PlatformInformation::CPU_FEATURE_FMA
+            | PlatformInformation::CPU_FEATURE_AVX512F;
 
         if ((features & sse_features) && !_checkOperatingSystemSupportSSE())
         {
@@ -687,6 +742,14 @@ namespace Ogre {
                 " *        SSE41: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_SSE41), true));
             pLog->logMessage(
                 " *        SSE42: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_SSE42), true));
+            pLog->logMessage(
+                " *          AVX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX), true));
+            pLog->logMessage(
+                " *         AVX2: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX2), true));
+            pLog->logMessage(
+                " *          FMA: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_FMA), true));
+            pLog->logMessage(
+                " *      AVX512F: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX512F), true));
             pLog->logMessage(
                 " *          MMX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_MMX), true));
             pLog->logMessage(
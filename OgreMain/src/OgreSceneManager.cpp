@@ -43,6 +43,8 @@ THE SOFTWARE.
 #include "OgreRenderTexture.h"
 #include "OgreLodListener.h"
 #include "OgreDefaultDebugDrawer.h"
+#include "OgreSceneQueryTree.h"
+#include "OgreLightClusters.h"
 
 // This class implements the most basic scene manager
 
@@ -78,6 +80,8 @@ mShadowRenderer(this),
 mLightClippingInfoMapFrameNumber(999),
 mVisibilityMask(0xFFFFFFFF),
 mFindVisibleObjects(true),
+mParallelAnimation(false),
+mCollectAnimatedEntities(false),
 mCameraRelativeRendering(false),
 mLastLightHash(0),
 mGpuParamsDirty((uint16)GPV_ALL)
@@ -303,27 +307,64 @@ void SceneManager::_populateLightList(const Vector3& position, Real radius, Ligh
     size_t numShadowTextures = isShadowTechniqueTextureBased() ? getShadowTextureConfigList().size() : 0;
     size_t numShadowCastingLights = 0;
 
-    // Pick up the lights that affecting frustum only, which should has been
-    // cached, so better than take all lights in the scene into account.
-    // this is partitioned as: | shadow casting lights | other lights |
-    // NOTE: no shadow casting lights might be in frustum, so we cannot rely on numShadowTextures
-    for (Light* lt : mLightsAffectingFrustum)
+    if (mLightClusters && mLightClusters->isValid() &&
+        mLightClusters->getLightCount() == mLightsAffectingFrustum.size() &&
+        mLightClusters->findLights(Sphere(position, radius), mClusterLightCandidates))
     {
-        // check whether or not this light is suppose to be taken into consideration for the current light mask set for this operation
-        if(!(lt->getLightMask() & lightMask))
-            continue; //skip this light
+        // the first lights are kept for texture shadows regardless of their range,
+        // so process them as below
+        size_t prefixEnd = 0;
+        for (; prefixEnd < mLightsAffectingFrustum.size() && lightIndex < numShadowTextures; ++prefixEnd)
+        {
+            Light* lt = mLightsAffectingFrustum[prefixEnd];
+            if (!(lt->getLightMask() & lightMask))
+                continue;
 
-        // Calc squared distance
-        lt->_calcTempSquareDist(position);
+            lt->_calcTempSquareDist(position);
+            if (lt->getCastShadows() || lt->isInLightRange(Sphere(position, radius)))
+                destList.push_back(lt);
+            lightIndex++;
+        }
 
-        // only add in-range lights, but ensure texture shadow casters are there
-        if ((lt->getCastShadows() && lightIndex < numShadowTextures) || lt->isInLightRange(Sphere(position, radius)))
+        // the others can only be in range if they share a cluster
+        for (uint32 i : mClusterLightCandidates)
         {
-            destList.push_back(lt);
+            Light* lt = mLightsAffectingFrustum[i];
+            if (i < prefixEnd || !(lt->getLightMask() & lightMask))
+                continue;
+
+            lt->_calcTempSquareDist(position);
+            if (lt->isInLightRange(Sphere(position, radius)))
+                destList.push_back(lt);
         }
 
-        numShadowCastingLights += int(lt->getCastShadows());
-        lightIndex++;
+        for (uint32 i : mLightClusters->getShadowCasterIndices())
+            numShadowCastingLights += (mLightsAffectingFrustum[i]->getLightMask() & lightMask) != 0;
+    }
+    else
+    {
+        // Pick up the lights that affecting frustum only, which should has been
+        // cached, so better than take all lights in the scene into account.
+        // this is partitioned as: | shadow casting lights | other lights |
+        // NOTE: no shadow casting lights might be in frustum, so we cannot rely on numShadowTextures
+        for (Light* lt : mLightsAffectingFrustum)
+        {
+            // check whether or not this light is suppose to be taken into consideration for the current light mask set for this operation
+            if(!(lt->getLightMask() & lightMask))
+                continue; //skip this light
+
+            // Calc squared distance
+            lt->_calcTempSquareDist(position);
+
+            // only add in-range lights, but ensure texture shadow casters are there
+            if ((lt->getCastShadows() && lightIndex < numShadowTextures) || lt->isInLightRange(Sphere(position, radius)))
+            {
+                destList.push_back(lt);
+            }
+
+            numShadowCastingLights += int(lt->getCastShadows());
+            lightIndex++;
+        }
     }
 
     auto start = destList.begin();
@@ -980,6 +1021,7 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
         {
             // Locate any lights which could be affecting the frustum
             findLightsAffectingFrustum(camera);
+            _updateLightClusters(camera);
 
             // Prepare shadow textures if texture shadow based shadowing
             // technique in use
@@ -1046,8 +1088,17 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 
             // Parse the scene and tag visibles
             firePreFindVisibleObjects(vp);
+            mAnimatedEntities.clear();
+            mCollectAnimatedEntities = mParallelAnimation;
             _findVisibleObjects(camera, &(camVisObjIt->second),
                 mIlluminationStage == IRS_RENDER_TO_TEXTURE? true : false);
+            mCollectAnimatedEntities = false;
+            if (!mAnimatedEntities.empty())
+            {
+                OgreProfileGroup("_updateAnimations", OGREPROF_GENERAL);
+                Entity::_updateAnimations(mAnimatedEntities);
+                mAnimatedEntities.clear();
+            }
             firePostFindVisibleObjects(vp);
 
             mAutoParamDataSource->setMainCamBoundsInfo(&(camVisObjIt->second));
@@ -1259,12 +1310,30 @@ void SceneManager::_updateSceneGraph(Camera* cam)
 void SceneManager::_findVisibleObjects(
     Camera* cam, VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
 {
+    if (findCulledShadowCameraObjects(cam, visibleBounds, onlyShadowCasters))
+        return;
+
     // Tell nodes to find, cascade down all nodes
     getRootSceneNode()->_findVisibleObjects(cam, getRenderQueue(), visibleBounds, true, 
         mDisplayNodes, onlyShadowCasters);
 
 }
 //-----------------------------------------------------------------------
+bool SceneManager::findCulledShadowCameraObjects(Camera* cam, VisibleObjectsBoundsInfo* visibleBounds,
+                                                 bool onlyShadowCasters)
+{
+    const auto* nodes = mShadowRenderer.getCulledShadowCameraNodes(cam);
+    if (!nodes)
+        return false;
+
+    for (SceneNode* node : *nodes)
+    {
+        for (auto* o : node->getAttachedObjects())
+            getRenderQueue()->processVisibleObject(o, cam, onlyShadowCasters, visibleBounds);
+    }
+    return true;
+}
+//-----------------------------------------------------------------------
 void SceneManager::_renderVisibleObjects(void)
 {
     firePreRenderQueues();
@@ -2504,6 +2573,10 @@ void SceneManager::updateCachedLightInfos(const Camera* camera)
         // Use swap instead of copy operator for efficiently
         mCachedLightInfos.swap(mTestLightInfos);
 
+        // the cluster light indices refer to the old list
+        if (mLightClusters)
+            mLightClusters->clear();
+
         // notify light dirty, so all movable objects will re-populate
         // their light list next time
         _notifyLightsDirty();
@@ -3180,6 +3253,64 @@ void SceneManager::destroyQuery(SceneQuery* query)
     OGRE_DELETE query;
 }
 //---------------------------------------------------------------------
+void SceneManager::setLightClusteringEnabled(bool enabled)
+{
+    if (enabled == isLightClusteringEnabled())
+        return;
+
+    // built on the next _renderScene
+    mLightClusters.reset(enabled ? new LightClusters(mName) : NULL);
+}
+//---------------------------------------------------------------------
+void SceneManager::_updateLightClusters(const Camera* camera)
+{
+    if (!mLightClusters)
+        return;
+
+    OgreProfileGroup("_updateLightClusters", OGREPROF_GENERAL);
+    mLightClusters->build(camera, mLightsAffectingFrustum);
+    mLightClusters->_updateTextures(mLightsAffectingFrustum);
+}
+//---------------------------------------------------------------------
+void SceneManager::setQueryTreeEnabled(bool enabled)
+{
+    if (enabled == isQueryTreeEnabled())
+        return;
+
+    if (!enabled)
+    {
+        mQueryTree.reset();
+        return;
+    }
+
+    mQueryTree = std::make_unique<SceneQueryTree>();
+
+    // only objects the linear queries would visit
+    OGRE_LOCK_MUTEX(mMovableObjectCollectionMapMutex);
+    for (const auto& c : mMovableObjectCollectionMap)
+    {
+        if (!Root::getSingleton().hasMovableObjectFactory(c.first))
+            continue;
+
+        OGRE_LOCK_MUTEX(c.second->mutex);
+        for (const auto& o : c.second->map)
+            mQueryTree->addObject(o.second);
+    }
+}
+//---------------------------------------------------------------------
+SceneQueryTree* SceneManager::_getQueryTree()
+{
+    if (mQueryTree)
+        mQueryTree->update();
+    return mQueryTree.get();
+}
+//---------------------------------------------------------------------
+void SceneManager::_notifyMovableObjectMoved(MovableObject* obj)
+{
+    if (mQueryTree)
+        mQueryTree->notifyMoved(obj);
+}
+//---------------------------------------------------------------------
 SceneManager::MovableObjectCollection* 
 SceneManager::getMovableObjectCollection(const String& typeName)
 {
@@ -3247,6 +3378,8 @@ MovableObject* SceneManager::createMovableObject(const String& name,
 
         MovableObject* newObj = factory->createInstance(name, this, params);
         objectMap->map[name] = newObj;
+        if (mQueryTree)
+            mQueryTree->addObject(newObj);
         return newObj;
     }
 
@@ -3276,6 +3409,8 @@ void SceneManager::destroyMovableObject(const String& name, const String& typeNa
         MovableObjectMap::iterator mi = objectMap->map.find(name);
         if (mi != objectMap->map.end())
         {
+            if (mQueryTree)
+                mQueryTree->removeObject(mi->second);
             factory->destroyInstance(mi->second);
             objectMap->map.erase(mi);
         }
@@ -3298,6 +3433,8 @@ void SceneManager::destroyAllMovableObjectsByType(const String& typeName)
         OGRE_LOCK_MUTEX(objectMap->mutex);
         for (auto& m : objectMap->map)
         {
+            if (mQueryTree)
+                mQueryTree->removeObject(m.second);
             // Only destroy our own
             if (m.second->_getManager() == this)
             {
@@ -3310,6 +3447,9 @@ void SceneManager::destroyAllMovableObjectsByType(const String& typeName)
 //---------------------------------------------------------------------
 void SceneManager::destroyAllMovableObjects(void)
 {
+    if (mQueryTree)
+        mQueryTree->clear();
+
     // Lock collection mutex
     OGRE_LOCK_MUTEX(mMovableObjectCollectionMapMutex);
     for(auto& c : mMovableObjectCollectionMap)
@@ -3408,6 +3548,8 @@ void SceneManager::injectMovableObject(MovableObject* m)
             OGRE_LOCK_MUTEX(objectMap->mutex);
 
         objectMap->map[m->getName()] = m;
+        if (mQueryTree && Root::getSingleton().hasMovableObjectFactory(m->getMovableType()))
+            mQueryTree->addObject(m);
     }
 }
 //---------------------------------------------------------------------
@@ -3419,6 +3561,8 @@ void SceneManager::extractMovableObject(const String& name, const String& typeNa
         MovableObjectMap::iterator mi = objectMap->map.find(name);
         if (mi != objectMap->map.end())
         {
+            if (mQueryTree)
+                mQueryTree->removeObject(mi->second);
             // no delete
             objectMap->map.erase(mi);
         }
@@ -3436,6 +3580,11 @@ void SceneManager::extractAllMovableObjectsByType(const String& typeName)
     MovableObjectCollection* objectMap = getMovableObjectCollection(typeName);
     {
             OGRE_LOCK_MUTEX(objectMap->mutex);
+        if (mQueryTree)
+        {
+            for (auto& m : objectMap->map)
+                mQueryTree->removeObject(m.second);
+        }
         // no deletion
         objectMap->map.clear();
     }
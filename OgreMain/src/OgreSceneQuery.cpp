@@ -27,6 +27,9 @@ THE SOFTWARE.
 */
 #include "OgreStableHeaders.h"
 #include "OgreSceneQuery.h"
+#include "OgreEntity.h"
+#include "OgreSubEntity.h"
+#include "OgreTriangleBVH.h"
 
 namespace Ogre {
 
@@ -174,6 +177,7 @@ namespace Ogre {
     {
         mSortByDistance = false;
         mMaxResults = 0;
+        mPrecise = false;
     }
     //-----------------------------------------------------------------------
     RaySceneQuery::~RaySceneQuery()
@@ -214,22 +218,97 @@ namespace Ogre {
         // Call callback version with self as listener
         this->execute(this);
 
-        if (mSortByDistance)
+        sortResults(mResult);
+
+        return mResult;
+    }
+    //-----------------------------------------------------------------------
+    void RaySceneQuery::sortResults(RaySceneQueryResult& results) const
+    {
+        if (!mSortByDistance)
+            return;
+
+        if (mMaxResults != 0 && mMaxResults < results.size())
         {
-            if (mMaxResults != 0 && mMaxResults < mResult.size())
-            {
-                // Partially sort the N smallest elements, discard others
-                std::partial_sort(mResult.begin(), mResult.begin()+mMaxResults, mResult.end());
-                mResult.resize(mMaxResults);
-            }
-            else
+            // Partially sort the N smallest elements, discard others
+            std::partial_sort(results.begin(), results.begin()+mMaxResults, results.end());
+            results.resize(mMaxResults);
+        }
+        else
+        {
+            // Sort entire result array
+            std::sort(results.begin(), results.end());
+        }
+    }
+    //-----------------------------------------------------------------------
+    bool RaySceneQuery::refineResult(const Ray& ray, RaySceneQueryResultEntry& entry) const
+    {
+        if (!mPrecise || !entry.movable || entry.movable->getMovableType() != MOT_ENTITY)
+            return true;
+
+        Entity* entity = static_cast<Entity*>(entry.movable);
+        // the direction is not normalised, so distances along the ray are preserved
+        Affine3 toLocal = entity->_getParentNodeFullTransform().inverse();
+        Ray localRay(toLocal * ray.getOrigin(), toLocal.linear() * ray.getDirection());
+
+        std::pair<bool, TriangleBVH::Hit> hit(false, TriangleBVH::Hit());
+        if (entity->_isAnimated() && entity->isHardwareAnimationEnabled())
+        {
+            // the deformed geometry only exists on the GPU and the bind pose might miss it,
+            // so keep the bounding volume hit
+            return true;
+        }
+        else if (entity->_isAnimated())
+        {
+            // the software animated geometry changes every frame, so test it exhaustively
+            for (size_t i = 0; i < entity->getNumSubEntities(); ++i)
             {
-                // Sort entire result array
-                std::sort(mResult.begin(), mResult.end());
+                SubEntity* se = entity->getSubEntity(i);
+                auto subHit = TriangleBVH::intersects(localRay, se->getVertexDataForBinding(),
+                                                      se->getSubMesh()->indexData,
+                                                      se->getSubMesh()->operationType);
+                if (subHit.first && (!hit.first || subHit.second.distance < hit.second.distance))
+                {
+                    hit = subHit;
+                    hit.second.subMesh = ushort(i);
+                }
             }
         }
+        else
+        {
+            hit = entity->getMesh()->getTriangleBVH()->intersects(localRay);
+        }
 
-        return mResult;
+        if (!hit.first)
+            return false;
+
+        entry.distance = hit.second.distance;
+        entry.triangle = hit.second.triangle;
+        entry.subMesh = hit.second.subMesh;
+        entry.barycentric = hit.second.barycentric;
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void RaySceneQuery::executeBatch(const Ray* rays, size_t count, std::vector<RaySceneQueryResult>& results)
+    {
+        Ray ray = mRay;
+        // keep the last result of the single ray variant
+        RaySceneQueryResult lastResult;
+        lastResult.swap(mResult);
+
+        results.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            mRay = rays[i];
+            mResult.swap(results[i]);
+            mResult.clear();
+            execute(this);
+            sortResults(mResult);
+            mResult.swap(results[i]);
+        }
+
+        mResult.swap(lastResult);
+        mRay = ray;
     }
     //-----------------------------------------------------------------------
     const RaySceneQueryResult& RaySceneQuery::getLastResults(void) const
@@ -250,7 +329,8 @@ namespace Ogre {
         dets.distance = distance;
         dets.movable = obj;
         dets.worldFragment = NULL;
-        mResult.push_back(dets);
+        if (refineResult(mRay, dets))
+            mResult.push_back(dets);
         // Continue
         return true;
     }
@@ -0,0 +1,390 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreSceneQueryTree.h"
+
+namespace Ogre {
+    namespace
+    {
+        /// fraction of the object size the leaf bounds are enlarged by
+        const Real FAT_MARGIN = 0.1;
+
+        Real surfaceArea(const Vector3& min, const Vector3& max)
+        {
+            Vector3 d = max - min;
+            return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        bool contains(const SceneQueryTree::Node& n, const Vector3& min, const Vector3& max)
+        {
+            return n.min.x <= min.x && n.min.y <= min.y && n.min.z <= min.z &&
+                   max.x <= n.max.x && max.y <= n.max.y && max.z <= n.max.z;
+        }
+    }
+    //-----------------------------------------------------------------------
+    SceneQueryTree::SceneQueryTree() : mRoot(NULL_NODE), mFreeList(NULL_NODE), mLeafCount(0) {}
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::addObject(MovableObject* obj)
+    {
+        Proxy& proxy = mProxies.emplace(obj, Proxy{NULL_NODE, false}).first->second;
+        if (!proxy.dirty)
+        {
+            proxy.dirty = true;
+            mDirty.push_back(obj);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::removeObject(MovableObject* obj)
+    {
+        auto it = mProxies.find(obj);
+        if (it == mProxies.end())
+            return;
+
+        detach(obj, it->second);
+        // a stale entry in mDirty is skipped by update(), as the lookup fails
+        mProxies.erase(it);
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::notifyMoved(MovableObject* obj)
+    {
+        auto it = mProxies.find(obj);
+        if (it == mProxies.end() || it->second.dirty)
+            return;
+
+        it->second.dirty = true;
+        mDirty.push_back(obj);
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::clear()
+    {
+        mProxies.clear();
+        mDirty.clear();
+        mUnbounded.clear();
+        mNodes.clear();
+        mRoot = NULL_NODE;
+        mFreeList = NULL_NODE;
+        mLeafCount = 0;
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::update()
+    {
+        for (auto obj : mDirty)
+        {
+            auto it = mProxies.find(obj);
+            if (it == mProxies.end() || !it->second.dirty)
+                continue;
+
+            Proxy& proxy = it->second;
+            proxy.dirty = false;
+
+            if (!obj->isInScene())
+            {
+                detach(obj, proxy);
+                continue;
+            }
+
+            AxisAlignedBox box = obj->getWorldBoundingBox();
+            if (box.isInfinite())
+            {
+                if (proxy.leaf != UNBOUNDED)
+                {
+                    detach(obj, proxy);
+                    mUnbounded.push_back(obj);
+                    proxy.leaf = UNBOUNDED;
+                }
+                continue;
+            }
+
+            // leaves must also enclose the bounding sphere used by sphere queries. That is the one cached
+            // by the last render, which is refreshed to the current one without notifying us, so take both
+            const Sphere& cached = obj->getWorldBoundingSphere();
+            Sphere current(obj->getParentNode()->_getDerivedPosition(), obj->getBoundingRadiusScaled());
+            for (const Sphere& sphere : {cached, current})
+            {
+                Vector3 radius(sphere.getRadius());
+                box.merge(AxisAlignedBox(sphere.getCenter() - radius, sphere.getCenter() + radius));
+            }
+
+            if (proxy.leaf >= 0)
+            {
+                if (contains(mNodes[proxy.leaf], box.getMinimum(), box.getMaximum()))
+                    continue;
+                removeLeaf(proxy.leaf);
+            }
+            else
+            {
+                if (proxy.leaf == UNBOUNDED)
+                    detach(obj, proxy);
+
+                proxy.leaf = allocateNode();
+                mNodes[proxy.leaf].object = obj;
+                mLeafCount++;
+            }
+
+            Vector3 margin = box.getSize() * FAT_MARGIN;
+            Node& leaf = mNodes[proxy.leaf];
+            leaf.min = box.getMinimum() - margin;
+            leaf.max = box.getMaximum() + margin;
+            insertLeaf(proxy.leaf);
+        }
+        mDirty.clear();
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::detach(MovableObject* obj, Proxy& proxy)
+    {
+        if (proxy.leaf >= 0)
+        {
+            removeLeaf(proxy.leaf);
+            freeNode(proxy.leaf);
+            mLeafCount--;
+        }
+        else if (proxy.leaf == UNBOUNDED)
+        {
+            mUnbounded.erase(std::find(mUnbounded.begin(), mUnbounded.end(), obj));
+        }
+        proxy.leaf = NULL_NODE;
+    }
+    //-----------------------------------------------------------------------
+    int32 SceneQueryTree::allocateNode()
+    {
+        int32 index = mFreeList;
+        if (index == NULL_NODE)
+        {
+            index = int32(mNodes.size());
+            mNodes.emplace_back();
+        }
+        else
+        {
+            mFreeList = mNodes[index].parent;
+        }
+
+        Node& n = mNodes[index];
+        n.object = NULL;
+        n.parent = NULL_NODE;
+        n.child[0] = n.child[1] = NULL_NODE;
+        n.height = 0;
+        return index;
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::freeNode(int32 index)
+    {
+        Node& n = mNodes[index];
+        n.object = NULL;
+        n.height = -1;
+        n.parent = mFreeList;
+        mFreeList = index;
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::refitParent(int32 index)
+    {
+        // walk back up the tree fixing heights and bounds
+        while (index != NULL_NODE)
+        {
+            index = balance(index);
+
+            Node& n = mNodes[index];
+            const Node& c0 = mNodes[n.child[0]];
+            const Node& c1 = mNodes[n.child[1]];
+            n.height = 1 + std::max(c0.height, c1.height);
+            n.min = c0.min;
+            n.min.makeFloor(c1.min);
+            n.max = c0.max;
+            n.max.makeCeil(c1.max);
+
+            index = n.parent;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::insertLeaf(int32 leaf)
+    {
+        if (mRoot == NULL_NODE)
+        {
+            mRoot = leaf;
+            mNodes[leaf].parent = NULL_NODE;
+            return;
+        }
+
+        // find the best sibling using the surface area heuristic
+        Vector3 lmin = mNodes[leaf].min, lmax = mNodes[leaf].max;
+        int32 index = mRoot;
+        while (!mNodes[index].isLeaf())
+        {
+            const Node& n = mNodes[index];
+
+            Vector3 cmin = n.min, cmax = n.max;
+            cmin.makeFloor(lmin);
+            cmax.makeCeil(lmax);
+            Real area = surfaceArea(n.min, n.max);
+            Real combinedArea = surfaceArea(cmin, cmax);
+
+            // cost of creating a new parent for this node and the new leaf
+            Real cost = 2 * combinedArea;
+            // minimum cost of pushing the leaf further down the tree
+            Real inheritanceCost = 2 * (combinedArea - area);
+
+            Real childCost[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                const Node& c = mNodes[n.child[i]];
+                Vector3 mmin = c.min, mmax = c.max;
+                mmin.makeFloor(lmin);
+                mmax.makeCeil(lmax);
+                childCost[i] = surfaceArea(mmin, mmax) + inheritanceCost;
+                if (!c.isLeaf())
+                    childCost[i] -= surfaceArea(c.min, c.max);
+            }
+
+            if (cost < childCost[0] && cost < childCost[1])
+                break;
+
+            index = childCost[0] < childCost[1] ? n.child[0] : n.child[1];
+        }
+
+        int32 sibling = index;
+        int32 oldParent = mNodes[sibling].parent;
+        int32 newParent = allocateNode();
+
+        Node& p = mNodes[newParent];
+        p.parent = oldParent;
+        p.min = lmin;
+        p.min.makeFloor(mNodes[sibling].min);
+        p.max = lmax;
+        p.max.makeCeil(mNodes[sibling].max);
+        p.height = mNodes[sibling].height + 1;
+        p.child[0] = sibling;
+        p.child[1] = leaf;
+
+        if (oldParent != NULL_NODE)
+        {
+            Node& op = mNodes[oldParent];
+            op.child[op.child[0] == sibling ? 0 : 1] = newParent;
+        }
+        else
+        {
+            mRoot = newParent;
+        }
+        mNodes[sibling].parent = newParent;
+        mNodes[leaf].parent = newParent;
+
+        refitParent(mNodes[leaf].parent);
+    }
+    //-----------------------------------------------------------------------
+    void SceneQueryTree::removeLeaf(int32 leaf)
+    {
+        if (leaf == mRoot)
+        {
+            mRoot = NULL_NODE;
+            return;
+        }
+
+        int32 parent = mNodes[leaf].parent;
+        int32 grandParent = mNodes[parent].parent;
+        int32 sibling = mNodes[parent].child[mNodes[parent].child[0] == leaf ? 1 : 0];
+
+        freeNode(parent);
+        if (grandParent != NULL_NODE)
+        {
+            // connect sibling to grand parent
+            Node& gp = mNodes[grandParent];
+            gp.child[gp.child[0] == parent ? 0 : 1] = sibling;
+            mNodes[sibling].parent = grandParent;
+            refitParent(grandParent);
+        }
+        else
+        {
+            mRoot = sibling;
+            mNodes[sibling].parent = NULL_NODE;
+        }
+    }
+    //-----------------------------------------------------------------------
+    int32 SceneQueryTree::balance(int32 iA)
+    {
+        Node& A = mNodes[iA];
+        if (A.isLeaf() || A.height < 2)
+            return iA;
+
+        // rotate the higher child up, if the subtrees differ by more than one level
+        int32 iB = A.child[0];
+        int32 iC = A.child[1];
+        int32 diff = mNodes[iC].height - mNodes[iB].height;
+        if (diff >= -1 && diff <= 1)
+            return iA;
+
+        // 'up' replaces A, 'other' stays a child of A
+        int up = diff > 1 ? 1 : 0;
+        int32 iUp = A.child[up];
+        int32 iOther = A.child[1 - up];
+        Node& U = mNodes[iUp];
+        const Node& O = mNodes[iOther];
+
+        int32 iF = U.child[0];
+        int32 iG = U.child[1];
+        Node& F = mNodes[iF];
+        Node& G = mNodes[iG];
+
+        // swap A and the child
+        U.child[0] = iA;
+        U.parent = A.parent;
+        A.parent = iUp;
+
+        if (U.parent != NULL_NODE)
+        {
+            Node& p = mNodes[U.parent];
+            p.child[p.child[0] == iA ? 0 : 1] = iUp;
+        }
+        else
+        {
+            mRoot = iUp;
+        }
+
+        // the higher grandchild stays with the rotated node, the other one moves to A
+        bool keepF = F.height > G.height;
+        int32 iKeep = keepF ? iF : iG;
+        int32 iMove = keepF ? iG : iF;
+        Node& K = mNodes[iKeep];
+        Node& M = mNodes[iMove];
+
+        U.child[1] = iKeep;
+        A.child[up] = iMove;
+        M.parent = iA;
+
+        A.min = O.min;
+        A.min.makeFloor(M.min);
+        A.max = O.max;
+        A.max.makeCeil(M.max);
+        A.height = 1 + std::max(O.height, M.height);
+
+        U.min = A.min;
+        U.min.makeFloor(K.min);
+        U.max = A.max;
+        U.max.makeCeil(K.max);
+        U.height = 1 + std::max(A.height, K.height);
+
+        return iUp;
+    }
+}
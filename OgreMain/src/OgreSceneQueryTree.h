@@ -0,0 +1,171 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __SceneQueryTree_H__
+#define __SceneQueryTree_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreAxisAlignedBox.h"
+#include "OgreException.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** Dynamic AABB tree over the MovableObjects of a SceneManager.
+
+        This is the acceleration structure used by the default scene queries when
+        SceneManager::setQueryTreeEnabled is set. Every leaf holds one MovableObject
+        with a slightly enlarged ('fat') copy of its world bounds, so that small
+        movements only need a containment check instead of a reinsertion. Inner
+        nodes are kept height balanced by rotations.
+    @par
+        Objects are registered when they enter the movable object collections of
+        the SceneManager and flagged dirty on MovableObject::_notifyMoved and
+        MovableObject::_notifyAttached. Dirty objects are refitted lazily by update(),
+        which reads the bounds cached during the last scene graph update - i.e. the
+        same bounds the linear queries use.
+    @par
+        Objects with infinite bounds cannot be placed in the tree and are kept in a
+        separate list, which queries have to test exhaustively.
+    */
+    class SceneQueryTree : public SceneMgtAlloc
+    {
+    public:
+        enum { NULL_NODE = -1 };
+
+        struct Node
+        {
+            /// fat bounds of the subtree
+            Vector3 min, max;
+            /// only set for leaves
+            MovableObject* object;
+            /// parent index for used nodes, next free node for free ones
+            int32 parent;
+            int32 child[2];
+            /// 0 for leaves, -1 for free nodes
+            int32 height;
+
+            bool isLeaf() const { return child[0] == NULL_NODE; }
+        };
+
+        SceneQueryTree();
+
+        /// Registers an object; it enters the tree on the next update()
+        void addObject(MovableObject* obj);
+        /// Unregisters an object, so it is never referenced again
+        void removeObject(MovableObject* obj);
+        /// Flags a registered object for refitting, unknown objects are ignored
+        void notifyMoved(MovableObject* obj);
+        /// Removes all objects
+        void clear();
+
+        /// Refits all dirty objects
+        void update();
+
+        int32 getRoot() const { return mRoot; }
+        const Node& getNode(int32 index) const { return mNodes[index]; }
+        /// Objects with infinite bounds, which are not part of the hierarchy
+        const std::vector<MovableObject*>& getUnboundedObjects() const { return mUnbounded; }
+        /// Number of objects currently referenced by leaves
+        size_t getLeafCount() const { return mLeafCount; }
+        /// Height of the hierarchy, 0 if it is empty or a single leaf
+        int32 getHeight() const { return mRoot == NULL_NODE ? 0 : mNodes[mRoot].height; }
+
+        /** Depth first traversal of the hierarchy.
+        @param nodeTest called with (const Node&) for every visited node,
+            the subtree is skipped if it returns false
+        @param visitor called with (int32 leafIndex, MovableObject*) for every leaf
+            passing nodeTest, the traversal stops if it returns false
+        @return false if the traversal was stopped by the visitor
+        */
+        template <typename NodeTest, typename LeafVisitor>
+        bool traverse(NodeTest nodeTest, LeafVisitor visitor) const
+        {
+            if (mRoot == NULL_NODE)
+                return true;
+
+            // balanced trees stay well below this even for millions of objects
+            int32 stack[TRAVERSAL_STACK_SIZE];
+            int top = 0;
+            stack[top++] = mRoot;
+
+            while (top)
+            {
+                const Node& n = mNodes[stack[--top]];
+                if (!nodeTest(n))
+                    continue;
+
+                if (n.isLeaf())
+                {
+                    if (!visitor(int32(&n - mNodes.data()), n.object))
+                        return false;
+                    continue;
+                }
+
+                OgreAssertDbg(top + 2 <= TRAVERSAL_STACK_SIZE, "SceneQueryTree too deep");
+                stack[top++] = n.child[1];
+                stack[top++] = n.child[0];
+            }
+            return true;
+        }
+    private:
+        enum { TRAVERSAL_STACK_SIZE = 128, UNBOUNDED = -2 };
+
+        struct Proxy
+        {
+            /// leaf node index, NULL_NODE if not in the tree or UNBOUNDED
+            int32 leaf;
+            bool dirty;
+        };
+
+        int32 allocateNode();
+        void freeNode(int32 index);
+        void insertLeaf(int32 leaf);
+        void removeLeaf(int32 leaf);
+        int32 balance(int32 index);
+        void refitParent(int32 index);
+        void detach(MovableObject* obj, Proxy& proxy);
+
+        std::unordered_map<MovableObject*, Proxy> mProxies;
+        std::vector<MovableObject*> mDirty;
+        std::vector<MovableObject*> mUnbounded;
+
+        std::vector<Node> mNodes;
+        int32 mRoot;
+        int32 mFreeList;
+        size_t mLeafCount;
+    };
+    /** @} */
+    /** @} */
+}
+
+#endif
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreRectangle2D.h"
 #include "OgreShadowCameraSetup.h"
 #include "OgreShadowVolumeExtrudeProgram.h"
+#include "OgreStaticGeometry.h"
 #include "OgreHighLevelGpuProgram.h"
 
 namespace Ogre {
@@ -99,7 +100,10 @@ mShadowTextureFadeStart(0.7),
 mShadowTextureFadeEnd(0.9),
 mShadowTextureSelfShadow(false),
 mShadowTextureConfigDirty(true),
-mShadowCasterRenderBackFaces(true)
+mShadowCasterRenderBackFaces(true),
+mShadowTextureParallelCulling(false),
+mCulledShadowCamera(NULL),
+mCulledShadowCameraIndex(0)
 {
     mShadowCasterQueryListener = std::make_unique<ShadowCasterSceneQueryListener>(mSceneManager);
 
@@ -721,6 +725,7 @@ void SceneManager::ShadowRenderer::destroyShadowTextures(void)
     }
     mShadowTextures.clear();
     mShadowTextureCameras.clear();
+    mShadowTextureCache.clear();
 
     // set by render*TextureShadowedQueueGroupObjects
     mSceneManager->mAutoParamDataSource->setTextureProjector(NULL, 0);
@@ -774,6 +779,16 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
     mShadowTextureIndexLightList.clear();
     size_t shadowTextureIndex = 0;
 
+    // with parallel culling, all cameras are set up first and rendered afterwards
+    struct ShadowTextureUpdate
+    {
+        Light* light;
+        size_t iteration;
+        size_t cameraIndex;
+    };
+    std::vector<ShadowTextureUpdate> updates;
+    bool parallelCulling = mShadowTextureParallelCulling && !mSceneManager->getDebugDrawer();
+
     for (i = lightList->begin(), si = mShadowTextures.begin(); i != iend && si != siend; ++i)
     {
         Light* light = *i;
@@ -782,8 +797,6 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
         if (!light->getCastShadows())
             continue;
 
-        mDestRenderSystem->_setDepthClamp(light->getType() == Light::LT_DIRECTIONAL);
-
         // texture iteration per light.
         size_t textureCountPerLight = mShadowTextureCountPerType[light->getType()];
         for (size_t j = 0; j < textureCountPerLight && si != siend; ++j)
@@ -792,7 +805,10 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
             RenderTarget *shadowRTT = shadowTex->getBuffer()->getRenderTarget();
             Viewport *shadowView = shadowRTT->getViewport(0);
             Camera *texCam = *ci;
+            size_t cameraIndex = ci - mShadowTextureCameras.begin();
             // rebind camera, incase another SM in use which has switched to its cam
+            if (shadowView->getCamera() != texCam && cameraIndex < mShadowTextureCache.size())
+                mShadowTextureCache[cameraIndex].light = NULL; // and rendered to the texture
             shadowView->setCamera(texCam);
 
             // Associate main view camera as LOD camera
@@ -834,29 +850,161 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
             // Setup background colour
             shadowView->setBackgroundColour(ColourValue::White);
 
-            // Fire shadow caster update, callee can alter camera settings
-            fireShadowTexturesPreCaster(light, texCam, j);
-
-            // Update target
-            shadowRTT->update();
+            if (parallelCulling)
+            {
+                ShadowTextureUpdate update = {light, j, cameraIndex};
+                updates.push_back(update);
+            }
+            else
+            {
+                updateShadowTexture(light, j, cameraIndex, false);
+            }
 
             ++si; // next shadow texture
             ++ci; // next camera
         }
 
-        mDestRenderSystem->_setDepthClamp(false);
-
         // set the first shadow texture index for this light.
         mShadowTextureIndexLightList.push_back(shadowTextureIndex);
         shadowTextureIndex += textureCountPerLight;
     }
 
+    if (!updates.empty())
+    {
+        std::vector<size_t> cameraIndices;
+        for (const auto& u : updates)
+            cameraIndices.push_back(u.cameraIndex);
+        cullShadowTextureCameras(cameraIndices);
+
+        for (const auto& u : updates)
+            updateShadowTexture(u.light, u.iteration, u.cameraIndex, true);
+    }
+
     fireShadowTexturesUpdated(std::min(lightList->size(), mShadowTextures.size()));
 
     ShadowTextureManager::getSingleton().clearUnused();
 
 }
 //---------------------------------------------------------------------
+void SceneManager::ShadowRenderer::updateShadowTexture(Light* light, size_t iteration, size_t index, bool culled)
+{
+    Camera* texCam = mShadowTextureCameras[index];
+    const Frustum* cullFrustum = texCam->getCullingFrustum() ? texCam->getCullingFrustum() : texCam;
+    Plane planes[6];
+    std::copy(cullFrustum->getFrustumPlanes(), cullFrustum->getFrustumPlanes() + 6, planes);
+
+    mDestRenderSystem->_setDepthClamp(light->getType() == Light::LT_DIRECTIONAL);
+
+    // Fire shadow caster update, callee can alter camera settings
+    fireShadowTexturesPreCaster(light, texCam, iteration);
+
+    // the culled nodes are only valid if the listeners left the frustum alone
+    culled = culled && std::equal(planes, planes + 6, cullFrustum->getFrustumPlanes());
+
+    if (light->getShadowTextureCaching())
+    {
+        // the casters are needed to tell whether the texture is still valid
+        if (!culled)
+            cullShadowTextureCameras(std::vector<size_t>(1, index));
+        culled = true;
+
+        ShadowTextureCacheEntry invalid = {NULL, 0};
+        mShadowTextureCache.resize(mShadowTextures.size(), invalid);
+        ShadowTextureCacheEntry& entry = mShadowTextureCache[index];
+
+        uint32 hash = 0;
+        bool cacheable = getShadowTextureHash(light, index, hash);
+        if (cacheable && entry.light == light && entry.hash == hash)
+        {
+            // the texture still holds what we would render
+            mDestRenderSystem->_setDepthClamp(false);
+            return;
+        }
+        entry.light = cacheable ? light : NULL;
+        entry.hash = hash;
+    }
+    else if (index < mShadowTextureCache.size())
+    {
+        mShadowTextureCache[index].light = NULL;
+    }
+
+    // DebugDrawer hooks into the regular traversal
+    if (culled && !mSceneManager->getDebugDrawer())
+    {
+        mCulledShadowCamera = texCam;
+        mCulledShadowCameraIndex = index;
+    }
+
+    // Update target
+    mShadowTextures[index]->getBuffer()->getRenderTarget()->update();
+
+    mCulledShadowCamera = NULL;
+    mDestRenderSystem->_setDepthClamp(false);
+}
+//---------------------------------------------------------------------
+bool SceneManager::ShadowRenderer::getShadowTextureHash(const Light* light, size_t index, uint32& hash) const
+{
+    const Camera* texCam = mShadowTextureCameras[index];
+    const Frustum* cullFrustum = texCam->getCullingFrustum() ? texCam->getCullingFrustum() : texCam;
+    const Viewport* shadowView = mShadowTextures[index]->getBuffer()->getRenderTarget()->getViewport(0);
+
+    hash = HashCombine(0, texCam->getViewMatrix());
+    hash = HashCombine(hash, texCam->getProjectionMatrix());
+    for (int i = 0; i < 6; ++i)
+        hash = HashCombine(hash, cullFrustum->getFrustumPlanes()[i]);
+
+    // for shadow caster materials using light parameters
+    hash = HashCombine(hash, light->getType());
+    hash = HashCombine(hash, light->getDerivedPosition());
+    hash = HashCombine(hash, light->getDerivedDirection());
+    hash = HashCombine(hash, light->getAttenuationRange());
+
+    hash = HashCombine(hash, shadowView->getVisibilityMask());
+    const String& scheme = shadowView->getMaterialScheme();
+    hash = FastHash(scheme.c_str(), scheme.size(), hash);
+
+    for (auto node : mShadowCameraVisibleNodes[index])
+    {
+        hash = HashCombine(hash, node->_getFullTransform());
+        for (auto obj : node->getAttachedObjects())
+        {
+            const String& type = obj->getMovableType();
+            // objects without geometry never end up in the shadow texture
+            bool geometry = type != MOT_LIGHT && type != MOT_CAMERA && type != MOT_FRUSTUM &&
+                            type != MOT_MOVABLE_PLANE;
+            bool casting = geometry && obj->getVisible() && obj->getCastShadows();
+            hash = HashCombine(hash, obj);
+            hash = HashCombine(hash, casting);
+            if (!casting)
+                continue;
+
+            hash = HashCombine(hash, obj->getVisibilityFlags());
+            hash = HashCombine(hash, obj->getRenderQueueGroup());
+            hash = HashCombine(hash, obj->getBoundingBox());
+
+            if (type == MOT_ENTITY)
+            {
+                auto ent = static_cast<Entity*>(obj);
+                // deformed or carrying objects that move on their own
+                if (ent->_isAnimated() || !ent->getAttachedObjects().empty())
+                    return false;
+                hash = HashCombine(hash, ent->getCurrentLodIndex());
+            }
+            else if (type == MOT_STATIC_GEOMETRY)
+            {
+                hash = HashCombine(hash, static_cast<StaticGeometry::Region*>(obj)->getCurrentLod());
+            }
+            else if (type == MOT_PARTICLE_SYSTEM || type == MOT_BILLBOARD_SET || type == MOT_BILLBOARD_CHAIN ||
+                     type == MOT_RIBBON_TRAIL || type == MOT_INSTANCE_BATCH)
+            {
+                // geometry that is rebuilt every frame
+                return false;
+            }
+        }
+    }
+    return true;
+}
+//---------------------------------------------------------------------
 void SceneManager::ShadowRenderer::renderShadowVolumesToStencil(const Light* light,
     const Camera* camera, bool calcScissor)
 {
@@ -1845,6 +1993,85 @@ SceneManager::ShadowRenderer::findShadowCastersForLight(const Light* light, cons
     return mShadowCasterList;
 }
 //---------------------------------------------------------------------
+static void collectCullingNodes(SceneNode* node, std::vector<SceneNode*>& nodes)
+{
+    if (node->numAttachedObjects())
+        nodes.push_back(node);
+    for (auto child : node->getChildren())
+        collectCullingNodes(static_cast<SceneNode*>(child), nodes);
+}
+//---------------------------------------------------------------------
+void SceneManager::ShadowRenderer::cullShadowTextureCameras(const std::vector<size_t>& cameraIndices)
+{
+    OgreProfileGroup("cullShadowTextureCameras", OGREPROF_CULLING);
+
+    // A node box is contained in the boxes of all its parents, so testing every node on
+    // its own gives the same result as the hierarchical traversal
+    mCullingNodes.clear();
+    collectCullingNodes(mSceneManager->getRootSceneNode(), mCullingNodes);
+
+    struct CullingFrustum
+    {
+        Plane planes[6];
+        bool infiniteFar;
+    };
+    std::vector<CullingFrustum> frustums(cameraIndices.size());
+    for (size_t c = 0; c < cameraIndices.size(); ++c)
+    {
+        // Frustum updates its planes lazily, so do it here instead of on the workers
+        const Camera* cam = mShadowTextureCameras[cameraIndices[c]];
+        const Frustum* f = cam->getCullingFrustum() ? cam->getCullingFrustum() : cam;
+        std::copy(f->getFrustumPlanes(), f->getFrustumPlanes() + 6, frustums[c].planes);
+        frustums[c].infiniteFar = f->getFarClipDistance() == 0;
+    }
+
+    const size_t CHUNK_SIZE = 1024;
+    size_t numChunks = (mCullingNodes.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<std::vector<SceneNode*>> chunkResults(cameraIndices.size() * numChunks);
+
+    Root::getSingleton().getWorkQueue()->processTasksParallel(
+        chunkResults.size(), [&](size_t task)
+        {
+            const CullingFrustum& f = frustums[task / numChunks];
+            size_t begin = (task % numChunks) * CHUNK_SIZE;
+            size_t end = std::min(begin + CHUNK_SIZE, mCullingNodes.size());
+            for (size_t n = begin; n < end; ++n)
+            {
+                // same as Frustum::isVisible
+                const AxisAlignedBox& box = mCullingNodes[n]->_getWorldAABB();
+                if (box.isNull())
+                    continue;
+
+                bool visible = true;
+                if (!box.isInfinite())
+                {
+                    Vector3 centre = box.getCenter();
+                    Vector3 halfSize = box.getHalfSize();
+                    for (int plane = 0; plane < 6 && visible; ++plane)
+                    {
+                        if (plane == FRUSTUM_PLANE_FAR && f.infiniteFar)
+                            continue;
+                        visible = f.planes[plane].getSide(centre, halfSize) != Plane::NEGATIVE_SIDE;
+                    }
+                }
+                if (visible)
+                    chunkResults[task].push_back(mCullingNodes[n]);
+            }
+        });
+
+    mShadowCameraVisibleNodes.resize(mShadowTextureCameras.size());
+    for (size_t c = 0; c < cameraIndices.size(); ++c)
+    {
+        auto& nodes = mShadowCameraVisibleNodes[cameraIndices[c]];
+        nodes.clear();
+        for (size_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            const auto& r = chunkResults[c * numChunks + chunk];
+            nodes.insert(nodes.end(), r.begin(), r.end());
+        }
+    }
+}
+//---------------------------------------------------------------------
 void SceneManager::ShadowRenderer::fireShadowTexturesUpdated(size_t numberOfShadowTextures)
 {
     ListenerList listenersCopy = mListeners;
@@ -41,14 +41,15 @@ namespace Ogre {
         : Resource(),
         mNextAutoHandle(0),
         mBlendState(ANIMBLEND_AVERAGE),
-        mManualBonesDirty(false)
+        mManualBonesDirty(false),
+        mMinorBonesFrozen(false)
     {
     }
     //---------------------------------------------------------------------
     Skeleton::Skeleton(ResourceManager* creator, const String& name, ResourceHandle handle,
         const String& group, bool isManual, ManualResourceLoader* loader) 
         : Resource(creator, name, handle, group, isManual, loader), 
-        mNextAutoHandle(0), mBlendState(ANIMBLEND_AVERAGE)
+        mNextAutoHandle(0), mBlendState(ANIMBLEND_AVERAGE), mMinorBonesFrozen(false)
         // set animation blending to weighted, not cumulative
     {
         if (createParamDictionary("Skeleton"))
@@ -254,7 +255,8 @@ namespace Ogre {
     {
         for (auto *b : mBoneList)
         {
-            if(!b->isManuallyControlled() || resetManualBones)
+            bool frozen = mMinorBonesFrozen && b->isMinor();
+            if((!b->isManuallyControlled() && !frozen) || resetManualBones)
                 b->reset();
         }
     }
@@ -594,7 +596,7 @@ namespace Ogre {
         mManualBonesDirty = false;
     }
     //---------------------------------------------------------------------
-    void Skeleton::optimiseAllAnimations(bool preservingIdentityNodeTracks)
+    void Skeleton::optimiseAllAnimations(bool preservingIdentityNodeTracks, Real bakeSamplesPerSecond)
     {
         if (!preservingIdentityNodeTracks)
         {
@@ -625,6 +627,15 @@ namespace Ogre {
             // Don't discard identity node tracks here
             a.second->optimise(false);
         }
+
+        if (bakeSamplesPerSecond > 0)
+        {
+            // Rebase all animations first, as they may refer to the tracks of each other
+            for (auto& a : mAnimationsList)
+                a.second->_applyBaseKeyFrame();
+            for (auto& a : mAnimationsList)
+                a.second->bakeNodeTracks(bakeSamplesPerSecond);
+        }
     }
     //---------------------------------------------------------------------
     void Skeleton::addLinkedSkeletonAnimationSource(const String& skelName, 
@@ -863,6 +874,8 @@ namespace Ogre {
                 }
             }
 
+            OgreAssert(!srcAnimation->getClip(), "baked animations can not be merged");
+
             // Create target animation
             Animation* dstAnimation = this->createAnimation(srcAnimation->getName(), srcAnimation->getLength());
 
@@ -136,6 +136,7 @@ namespace Ogre {
         newBone->setOrientation(source->getOrientation());
         newBone->setPosition(source->getPosition());
         newBone->setScale(source->getScale());
+        newBone->setMinor(source->isMinor());
 
         // Process children
         for (auto c : source->getChildren())
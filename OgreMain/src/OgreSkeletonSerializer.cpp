@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreSkeletonFileFormat.h"
 #include "OgreSkeletonSerializer.h"
 #include "OgreAnimation.h"
+#include "OgreAnimationClip.h"
 #include "OgreAnimationTrack.h"
 #include "OgreKeyFrame.h"
 
@@ -118,7 +119,8 @@ namespace Ogre {
         // Read version
         String ver = readString(stream);
         if ((ver != "[Serializer_v1.10]") &&
-            (ver != "[Serializer_v1.80]"))
+            (ver != "[Serializer_v1.80]") &&
+            (ver != "[Serializer_v14.40]"))
         {
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
                 "Invalid file: version incompatible, file reports " + String(ver),
@@ -170,7 +172,9 @@ namespace Ogre {
     {
         if (ver == SKELETON_VERSION_1_0)
             mVersion = "[Serializer_v1.10]";
-        else mVersion = "[Serializer_v1.80]";
+        else if (ver == SKELETON_VERSION_1_8)
+            mVersion = "[Serializer_v1.80]";
+        else mVersion = "[Serializer_v14.40]";
     }
     //---------------------------------------------------------------------
     void SkeletonSerializer::writeSkeleton(const Skeleton* pSkel, SkeletonVersion ver)
@@ -279,6 +283,12 @@ namespace Ogre {
         {
             writeAnimationTrack(pSkel, it.second);
         }
+
+        if (const AnimationClip* clip = anim->getClip())
+        {
+            OgreAssert((int)ver > (int)SKELETON_VERSION_1_8, "baked animations require SKELETON_VERSION_14_4");
+            writeAnimationClip(clip);
+        }
         }
         popInnerChunk(mStream);
 
@@ -322,6 +332,29 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void SkeletonSerializer::writeAnimationClip(const AnimationClip* clip)
+    {
+        writeChunkHeader(SKELETON_ANIMATION_CLIP, calcAnimationClipSize(clip));
+
+        uint32 numFrames = clip->mNumFrames;
+        writeInts(&numFrames, 1);
+        float frameRate = clip->mFrameRate;
+        writeFloats(&frameRate, 1);
+        uint16 numTracks = uint16(clip->mTracks.size());
+        writeShorts(&numTracks, 1);
+        for (const auto& track : clip->mTracks)
+        {
+            writeShorts(&track.handle, 1);
+            writeShorts(&track.flags, 1);
+            writeObject(track.translate);
+            writeObject(track.rotate);
+            writeObject(track.scale);
+        }
+        writeFloats(clip->mBias.data(), clip->mBias.size());
+        writeFloats(clip->mScale.data(), clip->mScale.size());
+        writeShorts(clip->mKeys.data(), clip->mKeys.size());
+    }
+    //---------------------------------------------------------------------
     size_t SkeletonSerializer::calcBoneSize(const Skeleton* pSkel, 
         const Bone* pBone)
     {
@@ -397,6 +430,11 @@ namespace Ogre {
             size += calcAnimationTrackSize(pSkel, it.second);
         }
 
+        if (const AnimationClip* clip = pAnim->getClip())
+        {
+            size += calcAnimationClipSize(clip);
+        }
+
         return size;
     }
     //---------------------------------------------------------------------
@@ -417,6 +455,21 @@ namespace Ogre {
         return size;
     }
     //---------------------------------------------------------------------
+    size_t SkeletonSerializer::calcAnimationClipSize(const AnimationClip* clip)
+    {
+        size_t size = SSTREAM_OVERHEAD_SIZE;
+
+        // unsigned int numFrames, float frameRate, unsigned short numTracks
+        size += sizeof(uint32) + sizeof(float) + sizeof(uint16);
+        // handle, flags and the constant translate, rotate, scale per track
+        size += clip->mTracks.size() * (sizeof(uint16) * 2 + sizeof(float) * 10);
+        // bias, scale and keys
+        size += (clip->mBias.size() + clip->mScale.size()) * sizeof(float);
+        size += clip->mKeys.size() * sizeof(uint16);
+
+        return size;
+    }
+    //---------------------------------------------------------------------
     size_t SkeletonSerializer::calcKeyFrameSize(const Skeleton* pSkel, 
         const TransformKeyFrame* pKey)
     {
@@ -535,9 +588,13 @@ namespace Ogre {
                 }
             }
             
-            while(streamID == SKELETON_ANIMATION_TRACK && !stream->eof())
+            while((streamID == SKELETON_ANIMATION_TRACK || streamID == SKELETON_ANIMATION_CLIP) &&
+                  !stream->eof())
             {
-                readAnimationTrack(stream, pAnim, pSkel);
+                if (streamID == SKELETON_ANIMATION_CLIP)
+                    readAnimationClip(stream, pAnim, pSkel);
+                else
+                    readAnimationTrack(stream, pAnim, pSkel);
 
                 if (!stream->eof())
                 {
@@ -619,6 +676,44 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void SkeletonSerializer::readAnimationClip(DataStreamPtr& stream, Animation* anim, Skeleton* pSkel)
+    {
+        std::unique_ptr<AnimationClip> clip(OGRE_NEW AnimationClip());
+        clip->mLength = anim->getLength();
+
+        uint32 numFrames;
+        readInts(stream, &numFrames, 1);
+        float frameRate;
+        readFloats(stream, &frameRate, 1);
+        clip->mNumFrames = numFrames;
+        clip->mFrameRate = frameRate;
+
+        uint16 numTracks;
+        readShorts(stream, &numTracks, 1);
+        clip->mTracks.resize(numTracks);
+        for (auto& track : clip->mTracks)
+        {
+            readShorts(stream, &track.handle, 1);
+            readShorts(stream, &track.flags, 1);
+            readObject(stream, track.translate);
+            readObject(stream, track.rotate);
+            readObject(stream, track.scale);
+
+            // Validate the bone
+            pSkel->getBone(track.handle);
+        }
+
+        clip->buildChannels();
+        clip->mBias.resize(3 * (clip->mChannelTracks[0].size() + clip->mChannelTracks[2].size()));
+        clip->mScale.resize(clip->mBias.size());
+        clip->mKeys.resize(size_t(numFrames) * clip->mFrameStride);
+        readFloats(stream, clip->mBias.data(), clip->mBias.size());
+        readFloats(stream, clip->mScale.data(), clip->mScale.size());
+        readShorts(stream, clip->mKeys.data(), clip->mKeys.size());
+
+        anim->_setClip(clip.release());
+    }
+    //---------------------------------------------------------------------
     void SkeletonSerializer::writeSkeletonAnimationLink(const Skeleton* pSkel, 
         const LinkedSkeletonAnimationSource& link)
     {
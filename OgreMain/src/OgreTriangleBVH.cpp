@@ -0,0 +1,360 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreTriangleBVH.h"
+#include "OgreSubMesh.h"
+
+namespace Ogre {
+
+    namespace {
+        /// leaves hold at most this many triangles
+        const uint32 MAX_LEAF_SIZE = 4;
+        /// enough for any hierarchy built by median splits over 2^32 triangles
+        const int TRAVERSAL_STACK_SIZE = 64;
+
+        /// appends the positions of vertexData, returns the index of the first one
+        uint32 readPositions(const VertexData* vertexData, std::vector<Vector3f>& positions)
+        {
+            uint32 base = uint32(positions.size());
+            const VertexElement* posElem =
+                vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+            if (!posElem || !vertexData->vertexCount)
+                return base;
+
+            HardwareVertexBufferSharedPtr vbuf =
+                vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+            HardwareBufferLockGuard vertexLock(vbuf, vertexData->vertexStart * vbuf->getVertexSize(),
+                                               vertexData->vertexCount * vbuf->getVertexSize(),
+                                               HardwareBuffer::HBL_READ_ONLY);
+            unsigned char* pVertex = static_cast<unsigned char*>(vertexLock.pData);
+
+            positions.reserve(base + vertexData->vertexCount);
+            for (size_t i = 0; i < vertexData->vertexCount; ++i, pVertex += vbuf->getVertexSize())
+            {
+                float* pFloat;
+                posElem->baseVertexPointerToElement(pVertex, &pFloat);
+                positions.push_back(Vector3f(pFloat));
+            }
+            return base;
+        }
+
+        /** Calls visitor(index, v0, v1, v2) for every triangle, with vertex indices
+            relative to vertexData->vertexStart.
+        */
+        template <typename Visitor>
+        void forEachTriangle(const VertexData* vertexData, const IndexData* indexData,
+                             RenderOperation::OperationType opType, Visitor visitor)
+        {
+            bool indexed = indexData && indexData->indexBuffer && indexData->indexCount;
+            size_t count = indexed ? indexData->indexCount : vertexData->vertexCount;
+
+            size_t iterations;
+            switch (opType)
+            {
+            case RenderOperation::OT_TRIANGLE_LIST:
+                iterations = count / 3;
+                break;
+            case RenderOperation::OT_TRIANGLE_FAN:
+            case RenderOperation::OT_TRIANGLE_STRIP:
+                iterations = count < 3 ? 0 : count - 2;
+                break;
+            default:
+                return;
+            }
+
+            HardwareBufferLockGuard indexLock;
+            const uint16* p16Idx = NULL;
+            const uint32* p32Idx = NULL;
+            if (indexed)
+            {
+                indexLock.lock(indexData->indexBuffer, HardwareBuffer::HBL_READ_ONLY);
+                if (indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT)
+                    p32Idx = static_cast<const uint32*>(indexLock.pData) + indexData->indexStart;
+                else
+                    p16Idx = static_cast<const uint16*>(indexLock.pData) + indexData->indexStart;
+            }
+
+            // indices are relative to vertexStart already, as the render systems draw with it as base vertex
+            auto index = [&](size_t i) -> uint32 {
+                if (p32Idx)
+                    return p32Idx[i];
+                if (p16Idx)
+                    return p16Idx[i];
+                return uint32(i);
+            };
+
+            const uint32 vertexCount = uint32(vertexData->vertexCount);
+            for (size_t t = 0; t < iterations; ++t)
+            {
+                uint32 v[3];
+                switch (opType)
+                {
+                case RenderOperation::OT_TRIANGLE_LIST:
+                    v[0] = index(t * 3); v[1] = index(t * 3 + 1); v[2] = index(t * 3 + 2);
+                    break;
+                case RenderOperation::OT_TRIANGLE_STRIP:
+                    v[0] = index(t); v[1] = index(t + 1); v[2] = index(t + 2);
+                    break;
+                default:
+                    v[0] = index(0); v[1] = index(t + 1); v[2] = index(t + 2);
+                    break;
+                }
+                // skip broken index data rather than reading past the vertices
+                if (v[0] < vertexCount && v[1] < vertexCount && v[2] < vertexCount)
+                    visitor(uint32(t), v[0], v[1], v[2]);
+            }
+        }
+
+        /// Moeller-Trumbore, accepting both sides
+        bool intersectTriangle(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c,
+                               Real maxDistance, Real& t, Real& u, Real& v)
+        {
+            Vector3 e1 = b - a;
+            Vector3 e2 = c - a;
+            Vector3 p = ray.getDirection().crossProduct(e2);
+            Real det = e1.dotProduct(p);
+            if (std::abs(det) <= std::numeric_limits<Real>::epsilon() * e1.squaredLength())
+                return false;
+
+            Real invDet = 1 / det;
+            Vector3 s = ray.getOrigin() - a;
+            u = s.dotProduct(p) * invDet;
+            if (u < 0 || u > 1)
+                return false;
+
+            Vector3 q = s.crossProduct(e1);
+            v = ray.getDirection().dotProduct(q) * invDet;
+            if (v < 0 || u + v > 1)
+                return false;
+
+            t = e2.dotProduct(q) * invDet;
+            return t >= 0 && t < maxDistance;
+        }
+
+        /// slab test, returns the entry distance or a negative value on a miss
+        Real intersectBox(const Vector3& origin, const Vector3& invDir, const Vector3f& min,
+                          const Vector3f& max, Real maxDistance)
+        {
+            Real tmin = 0, tmax = maxDistance;
+            for (int i = 0; i < 3; ++i)
+            {
+                Real t0 = (min[i] - origin[i]) * invDir[i];
+                Real t1 = (max[i] - origin[i]) * invDir[i];
+                if (t0 > t1)
+                    std::swap(t0, t1);
+                tmin = std::max(tmin, t0);
+                tmax = std::min(tmax, t1);
+                // the negated comparison also rejects NaN from 0 * inf
+                if (!(tmin <= tmax))
+                    return -1;
+            }
+            return tmin;
+        }
+    }
+    //-----------------------------------------------------------------------
+    TriangleBVH::TriangleBVH(const Mesh* mesh)
+    {
+        uint32 sharedBase = 0;
+        if (mesh->sharedVertexData)
+            sharedBase = readPositions(mesh->sharedVertexData, mPositions);
+
+        for (ushort s = 0; s < mesh->getNumSubMeshes(); ++s)
+        {
+            const SubMesh* sm = mesh->getSubMesh(s);
+            const VertexData* vertexData = sm->useSharedVertices ? mesh->sharedVertexData : sm->vertexData;
+            if (!vertexData || !vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION))
+                continue;
+
+            uint32 base = sm->useSharedVertices ? sharedBase : readPositions(vertexData, mPositions);
+            forEachTriangle(vertexData, sm->indexData, sm->operationType,
+                            [&](uint32 index, uint32 v0, uint32 v1, uint32 v2) {
+                                Triangle tri = {{base + v0, base + v1, base + v2}, index, s};
+                                mTriangles.push_back(tri);
+                            });
+        }
+
+        if (mTriangles.empty())
+            return;
+
+        std::vector<Vector3f> centroids;
+        centroids.reserve(mTriangles.size());
+        for (const auto& tri : mTriangles)
+            centroids.push_back((mPositions[tri.v[0]] + mPositions[tri.v[1]] + mPositions[tri.v[2]]) / 3);
+
+        mNodes.reserve(2 * mTriangles.size() / MAX_LEAF_SIZE + 1);
+        mNodes.push_back(Node());
+        build(0, 0, uint32(mTriangles.size()), centroids);
+    }
+    //-----------------------------------------------------------------------
+    void TriangleBVH::build(uint32 node, uint32 start, uint32 count, std::vector<Vector3f>& centroids)
+    {
+        Vector3f min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+        Vector3f cmin = min, cmax = max;
+        for (uint32 i = start; i < start + count; ++i)
+        {
+            for (uint32 v : mTriangles[i].v)
+            {
+                min.makeFloor(mPositions[v]);
+                max.makeCeil(mPositions[v]);
+            }
+            cmin.makeFloor(centroids[i]);
+            cmax.makeCeil(centroids[i]);
+        }
+        mNodes[node].min = min;
+        mNodes[node].max = max;
+
+        Vector3f extent = cmax - cmin;
+        int axis = extent[0] > extent[1] ? 0 : 1;
+        axis = extent[2] > extent[axis] ? 2 : axis;
+
+        if (count <= MAX_LEAF_SIZE || extent[axis] <= 0)
+        {
+            mNodes[node].start = start;
+            mNodes[node].count = count;
+            return;
+        }
+
+        // median split along the longest centroid axis; sort an index permutation so
+        // triangles and centroids stay in sync
+        std::vector<uint32> order(count);
+        for (uint32 i = 0; i < count; ++i)
+            order[i] = start + i;
+        uint32 half = count / 2;
+        std::nth_element(order.begin(), order.begin() + half, order.end(),
+                         [&](uint32 a, uint32 b) { return centroids[a][axis] < centroids[b][axis]; });
+
+        std::vector<Triangle> tris(count);
+        std::vector<Vector3f> cents(count);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            tris[i] = mTriangles[order[i]];
+            cents[i] = centroids[order[i]];
+        }
+        std::copy(tris.begin(), tris.end(), mTriangles.begin() + start);
+        std::copy(cents.begin(), cents.end(), centroids.begin() + start);
+
+        uint32 children = uint32(mNodes.size());
+        mNodes[node].start = children;
+        mNodes[node].count = 0;
+        mNodes.resize(children + 2);
+
+        build(children, start, half, centroids);
+        build(children + 1, start + half, count - half, centroids);
+    }
+    //-----------------------------------------------------------------------
+    std::pair<bool, TriangleBVH::Hit> TriangleBVH::intersects(const Ray& ray) const
+    {
+        Hit hit = {std::numeric_limits<Real>::infinity(), 0, 0, Vector2::ZERO};
+        if (mNodes.empty())
+            return std::make_pair(false, hit);
+
+        const Vector3& origin = ray.getOrigin();
+        Vector3 invDir;
+        for (int i = 0; i < 3; ++i)
+        {
+            Real d = ray.getDirection()[i];
+            invDir[i] = d == 0 ? std::numeric_limits<Real>::infinity() : 1 / d;
+        }
+
+        if (intersectBox(origin, invDir, mNodes[0].min, mNodes[0].max, hit.distance) < 0)
+            return std::make_pair(false, hit);
+
+        uint32 stack[TRAVERSAL_STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+        bool found = false;
+
+        while (top)
+        {
+            const Node& n = mNodes[stack[--top]];
+            if (n.count)
+            {
+                for (uint32 i = n.start; i < n.start + n.count; ++i)
+                {
+                    const Triangle& tri = mTriangles[i];
+                    Real t, u, v;
+                    if (intersectTriangle(ray, Vector3(mPositions[tri.v[0]]), Vector3(mPositions[tri.v[1]]),
+                                          Vector3(mPositions[tri.v[2]]), hit.distance, t, u, v))
+                    {
+                        hit.distance = t;
+                        hit.triangle = tri.index;
+                        hit.subMesh = tri.subMesh;
+                        hit.barycentric = Vector2(u, v);
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            // visit the nearer child first, so farther subtrees are culled by the closer hit
+            Real t0 = intersectBox(origin, invDir, mNodes[n.start].min, mNodes[n.start].max, hit.distance);
+            Real t1 = intersectBox(origin, invDir, mNodes[n.start + 1].min, mNodes[n.start + 1].max,
+                                   hit.distance);
+            uint32 first = n.start, second = n.start + 1;
+            if (t1 >= 0 && (t0 < 0 || t1 < t0))
+            {
+                std::swap(first, second);
+                std::swap(t0, t1);
+            }
+
+            OgreAssertDbg(top + 2 <= TRAVERSAL_STACK_SIZE, "TriangleBVH too deep");
+            if (t1 >= 0)
+                stack[top++] = second;
+            if (t0 >= 0)
+                stack[top++] = first;
+        }
+
+        return std::make_pair(found, hit);
+    }
+    //-----------------------------------------------------------------------
+    std::pair<bool, TriangleBVH::Hit> TriangleBVH::intersects(const Ray& ray, const VertexData* vertexData,
+                                                              const IndexData* indexData,
+                                                              RenderOperation::OperationType opType)
+    {
+        Hit hit = {std::numeric_limits<Real>::infinity(), 0, 0, Vector2::ZERO};
+        std::vector<Vector3f> positions;
+        readPositions(vertexData, positions);
+        if (positions.empty())
+            return std::make_pair(false, hit);
+
+        bool found = false;
+        forEachTriangle(vertexData, indexData, opType, [&](uint32 index, uint32 v0, uint32 v1, uint32 v2) {
+            Real t, u, v;
+            if (intersectTriangle(ray, Vector3(positions[v0]), Vector3(positions[v1]), Vector3(positions[v2]),
+                                  hit.distance, t, u, v))
+            {
+                hit.distance = t;
+                hit.triangle = index;
+                hit.barycentric = Vector2(u, v);
+                found = true;
+            }
+        });
+
+        return std::make_pair(found, hit);
+    }
+}
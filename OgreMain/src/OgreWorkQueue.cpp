@@ -29,6 +29,12 @@ THE SOFTWARE.
 #include "OgreWorkQueue.h"
 #include "OgreTimer.h"
 
+#if OGRE_THREAD_SUPPORT
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#endif
+
 namespace Ogre {
     void WorkQueue::processMainThreadTasks()
     {
@@ -37,6 +43,72 @@ namespace Ogre {
         OGRE_IGNORE_DEPRECATED_END
     }
     //---------------------------------------------------------------------
+    void WorkQueue::processTasksParallel(size_t count, const std::function<void(size_t)>& task)
+    {
+#if OGRE_THREAD_SUPPORT
+        size_t numWorkers = std::min(getWorkerThreadCount(), count ? count - 1 : 0);
+        if (numWorkers && !isPaused() && getRequestsAccepted())
+        {
+            // shared with the queued tasks, which might only run after we returned
+            struct ParallelJob
+            {
+                std::atomic<size_t> next;
+                std::atomic<size_t> done;
+                size_t count;
+                const std::function<void(size_t)>* task;
+                std::mutex mutex;
+                std::condition_variable finished;
+                std::exception_ptr error;
+            };
+            auto job = std::make_shared<ParallelJob>();
+            job->next = 0;
+            job->done = 0;
+            job->count = count;
+            job->task = &task;
+
+            auto run = [](ParallelJob& j) {
+                size_t i;
+                // task is only dereferenced while the caller is still waiting for i
+                while ((i = j.next++) < j.count)
+                {
+                    try
+                    {
+                        (*j.task)(i);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(j.mutex);
+                        if (!j.error)
+                            j.error = std::current_exception();
+                    }
+                    if (++j.done == j.count)
+                    {
+                        // lock so the notification cannot slip in between the caller's check and wait
+                        std::lock_guard<std::mutex> lock(j.mutex);
+                        j.finished.notify_all();
+                    }
+                }
+            };
+
+            for (size_t w = 0; w < numWorkers; ++w)
+                addTask([job, run]() { run(*job); });
+
+            run(*job);
+            {
+                // nothing left to pick up, so sleep until the workers finished their tasks
+                std::unique_lock<std::mutex> lock(job->mutex);
+                job->finished.wait(lock, [&job]() { return job->done == job->count; });
+            }
+
+            if (job->error)
+                std::rethrow_exception(job->error);
+            return;
+        }
+#endif
+        for (size_t i = 0; i < count; ++i)
+            task(i);
+    }
+    //---------------------------------------------------------------------
     WorkQueue::Request::Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid)
         : mChannel(channel), mType(rtype), mData(rData), mRetryCount(retry), mID(rid), mAborted(false)
     {
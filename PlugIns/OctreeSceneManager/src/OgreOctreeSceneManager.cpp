@@ -538,6 +538,11 @@ void OctreeSceneManager::_findVisibleObjects(Camera * cam,
 
     mNumObjects = 0;
 
+    // node bounds only enclose their own objects here, so frustum culling them one by one
+    // finds the same nodes as walking the octree
+    if (findCulledShadowCameraObjects(cam, visibleBounds, onlyShadowCasters))
+        return;
+
     //walk the octree, adding all visible Octreenodes nodes to the render queue.
     walkOctree( static_cast < OctreeCamera * > ( cam ), getRenderQueue(), mOctree, 
                 visibleBounds, false, onlyShadowCasters );
@@ -121,6 +121,8 @@ namespace Ogre {
         ColourFaderAffector2(ParticleSystem* psys);
 
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed) override;
+        bool _supportsParticleData(void) const override { return true; }
+        void _affectParticleData(ParticleData& particles, Real timeElapsed) override;
 
         /** Sets the colour adjustment to be made per second to particles. 
         @param red, green, blue, alpha
@@ -0,0 +1,68 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ColourFade_H__
+#define __ColourFade_H__
+
+#include "OgreParticleFXPrerequisites.h"
+#include "OgreParticle.h"
+
+namespace Ogre {
+
+    /// adds delta, given in units of 1/255, to the bytes of a colour
+    inline void fadeColour(RGBA& colour, const float* delta)
+    {
+        uchar* bytes = reinterpret_cast<uchar*>(&colour);
+        for (int i = 0; i < 4; ++i)
+        {
+            bytes[i] = static_cast<uchar>(Math::Clamp(bytes[i] + delta[i], 0.0f, 255.0f));
+        }
+    }
+
+    /** fadeColour for a batch of ParticleData::BATCH_SIZE colours
+
+        The fixed size lets the compiler turn the loops into SIMD code.
+    @param colours first colour of the batch
+    @param delta 4 values per colour, in the byte order of RGBA
+    */
+    inline void fadeColours(RGBA* colours, const float* delta)
+    {
+        const size_t n = ParticleData::BATCH_SIZE * 4;
+        uchar* bytes = reinterpret_cast<uchar*>(colours);
+        float faded[n];
+        for (size_t i = 0; i < n; ++i)
+        {
+            faded[i] = Math::Clamp(bytes[i] + delta[i], 0.0f, 255.0f);
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            bytes[i] = static_cast<uchar>(faded[i]);
+        }
+    }
+}
+
+#endif
@@ -29,10 +29,11 @@ THE SOFTWARE.
 #include "OgreParticleSystem.h"
 #include "OgreStringConverter.h"
 #include "OgreParticle.h"
+#include "OgreColourFade.h"
 
 
 namespace Ogre {
-    
+
     // init statics
     ColourFaderAffector::CmdRedAdjust ColourFaderAffector::msRedCmd;
     ColourFaderAffector::CmdGreenAdjust ColourFaderAffector::msGreenCmd;
@@ -69,12 +70,28 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ColourFaderAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        // Scale adjustments by time
-        auto dc = ColourValue(mRedAdj, mGreenAdj, mBlueAdj, mAlphaAdj) * timeElapsed;
+        // Scale adjustments by time, fading in byte space saves converting every particle
+        auto dc = ColourValue(mRedAdj, mGreenAdj, mBlueAdj, mAlphaAdj) * (timeElapsed * 255);
 
         for (auto p : pSystem->_getActiveParticles())
         {
-            p->mColour = (ColourValue((uchar*)&p->mColour) + dc).saturateCopy().getAsBYTE();
+            fadeColour(p->mColour, dc.ptr());
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ColourFaderAffector::_affectParticleData(ParticleData& particles, Real timeElapsed)
+    {
+        auto dc = ColourValue(mRedAdj, mGreenAdj, mBlueAdj, mAlphaAdj) * (timeElapsed * 255);
+
+        float delta[ParticleData::BATCH_SIZE * 4];
+        for (size_t i = 0; i < ParticleData::BATCH_SIZE * 4; ++i)
+        {
+            delta[i] = dc[i % 4];
+        }
+
+        for (size_t i = 0; i < particles.paddedCount; i += ParticleData::BATCH_SIZE)
+        {
+            fadeColours(particles.colour + i, delta);
         }
     }
     //-----------------------------------------------------------------------
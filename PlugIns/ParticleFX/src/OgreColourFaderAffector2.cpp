@@ -29,10 +29,11 @@ THE SOFTWARE.
 #include "OgreParticleSystem.h"
 #include "OgreStringConverter.h"
 #include "OgreParticle.h"
+#include "OgreColourFade.h"
 
 
 namespace Ogre {
-    
+
     // init statics
     // Phase 1
     ColourFaderAffector2::CmdRedAdjust1 ColourFaderAffector2::msRedCmd1;
@@ -100,15 +101,29 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ColourFaderAffector2::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        // Scale adjustments by time
-        auto dc1 = ColourValue(mRedAdj1, mGreenAdj1, mBlueAdj1, mAlphaAdj1) * timeElapsed;
-        auto dc2 = ColourValue(mRedAdj2, mGreenAdj2, mBlueAdj2, mAlphaAdj2) * timeElapsed;
+        // Scale adjustments by time, fading in byte space saves converting every particle
+        auto dc1 = ColourValue(mRedAdj1, mGreenAdj1, mBlueAdj1, mAlphaAdj1) * (timeElapsed * 255);
+        auto dc2 = ColourValue(mRedAdj2, mGreenAdj2, mBlueAdj2, mAlphaAdj2) * (timeElapsed * 255);
 
         for (auto p : pSystem->_getActiveParticles())
         {
-            p->mColour = (ColourValue((uchar*)&p->mColour) + (p->mTimeToLive > StateChangeVal ? dc1 : dc2))
-                             .saturateCopy()
-                             .getAsBYTE();
+            fadeColour(p->mColour, p->mTimeToLive > StateChangeVal ? dc1.ptr() : dc2.ptr());
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ColourFaderAffector2::_affectParticleData(ParticleData& particles, Real timeElapsed)
+    {
+        auto dc1 = ColourValue(mRedAdj1, mGreenAdj1, mBlueAdj1, mAlphaAdj1) * (timeElapsed * 255);
+        auto dc2 = ColourValue(mRedAdj2, mGreenAdj2, mBlueAdj2, mAlphaAdj2) * (timeElapsed * 255);
+
+        float delta[ParticleData::BATCH_SIZE * 4];
+        for (size_t i = 0; i < particles.paddedCount; i += ParticleData::BATCH_SIZE)
+        {
+            for (size_t j = 0; j < ParticleData::BATCH_SIZE * 4; ++j)
+            {
+                delta[j] = particles.timeToLive[i + j / 4] > StateChangeVal ? dc1[j % 4] : dc2[j % 4];
+            }
+            fadeColours(particles.colour + i, delta);
         }
     }
     //-----------------------------------------------------------------------
@@ -68,27 +68,56 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void LinearForceAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        Vector3 scaledVector = Vector3::ZERO;
-
-        // Precalc scaled force for optimisation
+        // Branch once, so the loops only touch the particle directions
         if (mForceApplication == FA_ADD)
         {
             // Scale force by time
-            scaledVector = mForceVector * timeElapsed;
+            Vector3 scaledVector = mForceVector * timeElapsed;
+            for (auto p : pSystem->_getActiveParticles())
+            {
+                p->mDirection += scaledVector;
+            }
         }
-
-        for (auto p : pSystem->_getActiveParticles())
+        else // FA_AVERAGE
         {
+            Vector3 halfForce = mForceVector * 0.5f;
+            for (auto p : pSystem->_getActiveParticles())
+            {
+                p->mDirection = p->mDirection * 0.5f + halfForce;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void LinearForceAffector::_affectParticleData(ParticleData& particles, Real timeElapsed)
+    {
+        // Same as above, the direction components are independent arrays
+        Real* directions[] = {particles.directionX, particles.directionY, particles.directionZ};
+        for (int c = 0; c < 3; ++c)
+        {
+            Real* direction = directions[c];
             if (mForceApplication == FA_ADD)
             {
-                p->mDirection += scaledVector;
+                Real scaledForce = mForceVector[c] * timeElapsed;
+                for (size_t i = 0; i < particles.paddedCount; i += ParticleData::BATCH_SIZE)
+                {
+                    for (size_t j = i; j < i + ParticleData::BATCH_SIZE; ++j)
+                    {
+                        direction[j] += scaledForce;
+                    }
+                }
             }
             else // FA_AVERAGE
             {
-                p->mDirection = (p->mDirection + mForceVector) / 2;
+                Real halfForce = mForceVector[c] * 0.5f;
+                for (size_t i = 0; i < particles.paddedCount; i += ParticleData::BATCH_SIZE)
+                {
+                    for (size_t j = i; j < i + ParticleData::BATCH_SIZE; ++j)
+                    {
+                        direction[j] = direction[j] * 0.5f + halfForce;
+                    }
+                }
             }
         }
-        
     }
     //-----------------------------------------------------------------------
     void LinearForceAffector::setForceVector(const Vector3& force)
@@ -88,19 +88,29 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void RotationAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        Real ds;
-
         // Rotation adjustments by time
-        ds = timeElapsed;
-
-        Radian NewRotation;
-
         for (auto p : pSystem->_getActiveParticles())
         {
-            NewRotation = p->mRotation + (ds * p->mRotationSpeed);
-            p->setRotation( NewRotation );
+            p->mRotation += timeElapsed * p->mRotationSpeed;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void RotationAffector::_affectParticleData(ParticleData& particles, Real timeElapsed)
+    {
+        const size_t n = ParticleData::BATCH_SIZE;
+        for (size_t i = 0; i < particles.paddedCount; i += n)
+        {
+            // Loaded before any store, so the compiler knows they do not alias and uses SIMD
+            Real delta[n];
+            for (size_t j = 0; j < n; ++j)
+            {
+                delta[j] = timeElapsed * particles.rotationSpeed[i + j];
+            }
+            for (size_t j = 0; j < n; ++j)
+            {
+                particles.rotation[i + j] += delta[j];
+            }
         }
-
     }
     //-----------------------------------------------------------------------
     const Radian& RotationAffector::getRotationSpeedRangeStart(void) const
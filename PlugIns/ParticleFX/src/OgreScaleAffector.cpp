@@ -78,6 +78,22 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void ScaleAffector::_affectParticleData(ParticleData& particles, Real timeElapsed)
+    {
+        Real ds = mScaleAdj * timeElapsed;
+        Real* dimensions[] = {particles.width, particles.height};
+        for (Real* dimension : dimensions)
+        {
+            for (size_t i = 0; i < particles.paddedCount; i += ParticleData::BATCH_SIZE)
+            {
+                for (size_t j = i; j < i + ParticleData::BATCH_SIZE; ++j)
+                {
+                    dimension[j] = std::max(Real(0), dimension[j] + ds);
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
     void ScaleAffector::setAdjust( Real rate )
     {
         mScaleAdj = rate;
@@ -24,6 +24,11 @@ in vec4 uv2;
 	in vec4 uv5;
 #endif
 
+#ifdef BAKED_ANIMATION
+	//xy: offset of the next baked frame, z: weight of the next frame
+	in vec4 uv6;
+#endif
+
 in vec3 tangent;
 
 //Parameters
@@ -64,22 +69,16 @@ vec3 calculateBlendNormal(vec3 normal, mat2x4 blendDQ)
 	return normal + 2.0*cross(blendDQ[0].yzw, cross(blendDQ[0].yzw, normal) + blendDQ[0].x*normal);
 }
 
-//---------------------------------------------
-//Main Vertex Shader
-//---------------------------------------------
-void main(void)
-{
-	vec4 worldPos;
-	vec3 worldNorm;
-
 #ifdef ST_DUAL_QUATERNION
-	mat2x4 blendDQ;	
-	blendDQ[0] = texture( matrixTexture, vec2(uv1.x, 0.0) + uv2.xy );
-	blendDQ[1] = texture( matrixTexture, vec2(uv1.y, 0.0) + uv2.xy );
+mat2x4 blendDualQuaternions(vec2 offset)
+{
+	mat2x4 blendDQ;
+	blendDQ[0] = texture( matrixTexture, vec2(uv1.x, 0.0) + offset );
+	blendDQ[1] = texture( matrixTexture, vec2(uv1.y, 0.0) + offset );
 #ifdef BONE_TWO_WEIGHTS
 	mat2x4 blendDQ2;
-	blendDQ2[0] = texture( matrixTexture, vec2(uv1.z, 0.0) + uv2.xy );
-	blendDQ2[1] = texture( matrixTexture, vec2(uv1.w, 0.0) + uv2.xy );
+	blendDQ2[0] = texture( matrixTexture, vec2(uv1.z, 0.0) + offset );
+	blendDQ2[1] = texture( matrixTexture, vec2(uv1.w, 0.0) + offset );
 
 	//Accurate antipodality handling. For speed increase, remove the following line
 	if (dot(blendDQ[0], blendDQ2[0]) < 0.0) blendDQ2 *= -1.0;
@@ -87,6 +86,28 @@ void main(void)
 	//Blend the dual quaternions based on the weights
 	blendDQ *= blendWeights.x;
 	blendDQ += blendWeights.y*blendDQ2;
+#endif
+	return blendDQ;
+}
+#endif
+
+//---------------------------------------------
+//Main Vertex Shader
+//---------------------------------------------
+void main(void)
+{
+	vec4 worldPos;
+	vec3 worldNorm;
+
+#ifdef ST_DUAL_QUATERNION
+	mat2x4 blendDQ = blendDualQuaternions(uv2.xy);
+#ifdef BAKED_ANIMATION
+	//Interpolate towards the next baked frame
+	mat2x4 nextDQ = blendDualQuaternions(uv6.xy);
+	if (dot(blendDQ[0], nextDQ[0]) < 0.0) nextDQ *= -1.0;
+	blendDQ += uv6.z*(nextDQ - blendDQ);
+#endif
+#if defined(BONE_TWO_WEIGHTS) || defined(BAKED_ANIMATION)
 	//Normalize the resultant dual quaternion
 	blendDQ /= length(blendDQ[0]);
 #endif
@@ -98,6 +119,15 @@ void main(void)
 	worldMatrix[1] = texture( matrixTexture, uv1.yw + uv2.xy );
 	worldMatrix[2] = texture( matrixTexture, uv1.zw + uv2.xy );
 	worldMatrix[3] = vec4( 0, 0, 0, 1 );
+#ifdef BAKED_ANIMATION
+	//Interpolate towards the next baked frame
+	mat4 nextMatrix;
+	nextMatrix[0] = texture( matrixTexture, uv1.xw + uv6.xy );
+	nextMatrix[1] = texture( matrixTexture, uv1.yw + uv6.xy );
+	nextMatrix[2] = texture( matrixTexture, uv1.zw + uv6.xy );
+	nextMatrix[3] = vec4( 0, 0, 0, 1 );
+	worldMatrix += uv6.z*(nextMatrix - worldMatrix);
+#endif
 
 	worldPos		= vertex * worldMatrix;
 	worldNorm		= normal * mat3(worldMatrix);
@@ -34,6 +34,7 @@ public:
     void blockedWaitForLodGeneration(const MeshPtr& mesh);
     void addProfile(LodConfig& config);
     void setTestLodConfig(LodConfig& config);
+    uint32 getLodIndexChecksum(const MeshPtr& mesh);
 };
 
 //--------------------------------------------------------------------------
@@ -188,6 +189,97 @@ TEST_F(MeshLodTests,QuadricError)
     gen.generateLodLevels(config, LodCollapseCostPtr(new LodCollapseCostQuadric()));
 }
 //--------------------------------------------------------------------------
+uint32 MeshLodTests::getLodIndexChecksum(const MeshPtr& mesh)
+{
+    uint32 hash = 0;
+    for (auto* submesh : mesh->getSubMeshes())
+    {
+        for (auto* indexData : submesh->mLodFaceList)
+        {
+            HardwareBufferLockGuard lock(indexData->indexBuffer, HardwareBuffer::HBL_READ_ONLY);
+            size_t indexSize = indexData->indexBuffer->getIndexSize();
+            hash = FastHash((const char*)lock.pData + indexData->indexStart * indexSize,
+                            indexData->indexCount * indexSize, hash);
+        }
+    }
+    return hash;
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshLodTests,DeterministicOutput)
+{
+    // The collapse order must not change with the implementation of the cost heap
+    // or the parallel cost computation, the checksums are those of the original generator.
+    MeshLodGenerator& gen = MeshLodGenerator::getSingleton();
+    LodConfig config;
+    setTestLodConfig(config);
+    gen.generateLodLevels(config);
+    ASSERT_EQ(config.levels.size(), 3u);
+    EXPECT_EQ(config.levels[0].outUniqueVertexCount, 3798u);
+    EXPECT_EQ(config.levels[1].outUniqueVertexCount, 3376u);
+    EXPECT_EQ(config.levels[2].outUniqueVertexCount, 2954u);
+    EXPECT_EQ(getLodIndexChecksum(mMesh), 0x7b5dd53u);
+
+    config.mesh->removeLodLevels();
+    gen.generateLodLevels(config, LodCollapseCostPtr(new LodCollapseCostQuadric()));
+    EXPECT_EQ(getLodIndexChecksum(mMesh), 0x50558522u);
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshLodTests,BatchLodLevels)
+{
+    MeshLodGenerator& gen = MeshLodGenerator::getSingleton();
+    MeshPtr clone = mMesh->clone("SinbadBatchClone");
+
+    for (size_t memoryBudget : {size_t(0), size_t(1)})
+    {
+        // A budget of one byte runs the meshes one after another.
+        std::vector<LodConfig> configs(2);
+        setTestLodConfig(configs[0]);
+        setTestLodConfig(configs[1]);
+        configs[1].mesh = clone;
+        mMesh->removeLodLevels();
+        clone->removeLodLevels();
+
+        gen.generateBatchLodLevels(configs, memoryBudget);
+        for (auto& config : configs)
+        {
+            EXPECT_EQ(config.mesh->getNumLodLevels(), 4u);
+            ASSERT_EQ(config.levels.size(), 3u);
+            EXPECT_EQ(config.levels[0].outUniqueVertexCount, 3798u);
+            EXPECT_EQ(config.levels[1].outUniqueVertexCount, 3376u);
+            EXPECT_EQ(config.levels[2].outUniqueVertexCount, 2954u);
+        }
+        EXPECT_EQ(getLodIndexChecksum(mMesh), getLodIndexChecksum(clone));
+    }
+
+    // meshes handed over one by one are only requested when they can be started
+    MeshPtr meshes[] = {mMesh, clone};
+    mMesh->removeLodLevels();
+    clone->removeLodLevels();
+    size_t requested = 0;
+    std::vector<size_t> finished;
+    gen.generateBatchLodLevels(
+        [&](LodConfig& config) {
+            if (requested == 2)
+                return false;
+            // a budget of one byte keeps a single mesh in flight, plus the one waiting for it
+            EXPECT_LE(requested, finished.size() + 1);
+            setTestLodConfig(config);
+            config.mesh = meshes[requested++];
+            return true;
+        },
+        [&](size_t index, LodConfig& config) {
+            EXPECT_EQ(config.mesh, meshes[index]);
+            ASSERT_EQ(config.levels.size(), 3u);
+            EXPECT_EQ(config.levels[2].outUniqueVertexCount, 2954u);
+            finished.push_back(index);
+        },
+        1);
+    EXPECT_EQ(finished, std::vector<size_t>({0, 1}));
+    EXPECT_EQ(getLodIndexChecksum(mMesh), getLodIndexChecksum(clone));
+
+    MeshManager::getSingleton().remove(clone);
+}
+//--------------------------------------------------------------------------
 void MeshLodTests::setTestLodConfig(LodConfig& config)
 {
     config.mesh = mMesh;
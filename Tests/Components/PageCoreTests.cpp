@@ -102,3 +102,36 @@ TEST_F(PageCoreTests,SimpleCreateSaveLoadWorld)
 }
 //--------------------------------------------------------------------------
 
+TEST_F(PageCoreTests,PrioritisedPageRequests)
+{
+    PagedWorld* world = mPageManager->createWorld("MyWorld");
+    PagedWorldSection* section = world->createSection("Grid2D", mSceneMgr, "Section1");
+
+    mPageManager->setMaxPageRequestsPerFrame(2);
+    section->requestPage(10, 3);
+    section->requestPage(11, 1);
+    section->requestPage(12, 2);
+    section->requestPage(13, 0);
+    section->requestPage(11, 1);
+    section->frameEnd(0);
+
+    // the two most urgent pages are requested, the others are dropped
+    EXPECT_TRUE(section->getPage(11) != 0);
+    EXPECT_TRUE(section->getPage(13) != 0);
+    EXPECT_TRUE(section->getPage(10) == 0);
+    EXPECT_TRUE(section->getPage(12) == 0);
+    section->frameEnd(0);
+    EXPECT_TRUE(section->getPage(12) == 0);
+
+    // the work queue is not running, so both pages are still in flight
+    mPageManager->setMaxPageRequestsPerFrame(0);
+    mPageManager->setMaxPagesInFlight(3);
+    section->requestPage(10, 3);
+    section->requestPage(12, 2);
+    section->frameEnd(0);
+    EXPECT_TRUE(section->getPage(12) != 0);
+    EXPECT_TRUE(section->getPage(10) == 0);
+
+    mPageManager->destroyWorld(world);
+}
+//--------------------------------------------------------------------------
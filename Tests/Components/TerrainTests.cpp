@@ -29,6 +29,10 @@ THE SOFTWARE.
 
 #include "OgreRoot.h"
 #include "OgreTerrain.h"
+#include "OgreTerrainGroup.h"
+#include "OgreTerrainQuadTreeNode.h"
+#include "OgreTerrainMaterialGeneratorA.h"
+#include "OgreTerrainLayerBlendMap.h"
 #include "OgreFileSystemLayer.h"
 
 #include "OgreBuildSettings.h"
@@ -39,6 +43,11 @@ THE SOFTWARE.
 #include "OgreSTBICodec.h"
 #include "OgreStreamSerialiser.h"
 #include "OgreDefaultHardwareBufferManager.h"
+#include "OgreHardwarePixelBuffer.h"
+#include "OgreMaterialManager.h"
+#include "OgreTextureManager.h"
+
+#include <random>
 
 using namespace Ogre;
 
@@ -125,3 +134,665 @@ TEST_F(TerrainTests, create)
     FileSystemLayer::removeFile("TerrainTest.dat");
 }
 //--------------------------------------------------------------------------
+TEST_F(TerrainTests, quantisedHeightData)
+{
+    const uint16 size = 129;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+        for (uint16 x = 0; x < size; ++x)
+            heights[y * size + x] = 100 * std::sin(x * 0.05f) * std::cos(y * 0.07f) + 0.01f * ((x * 7 + y * 13) % 17);
+    auto range = std::minmax_element(heights.begin(), heights.end());
+    float tolerance = (*range.second - *range.first) / 65535;
+
+    Terrain::ImportData imp;
+    imp.inputFloat = heights.data();
+    imp.terrainSize = size;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 33;
+    imp.maxBatchSize = 65;
+
+    size_t fileSize[2];
+    for (int quantised = 0; quantised < 2; ++quantised)
+    {
+        mTerrainOpts->setUseQuantisedHeightData(quantised != 0);
+        Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+        ASSERT_TRUE(t->prepare(imp));
+        {
+            DefaultHardwareBufferManager hbm;
+            StreamSerialiser ser(Root::createFileStream("TerrainTest.dat"));
+            t->save(ser);
+            OGRE_DELETE t;
+        }
+
+        DataStreamPtr stream = Root::openFileStream("TerrainTest.dat");
+        fileSize[quantised] = stream->size();
+        t = OGRE_NEW Terrain(mSceneMgr);
+        ASSERT_TRUE(t->prepare(stream));
+
+        // heights are streamed in per LOD level, read all of them
+        stream->seek(0);
+        {
+            TerrainLodManager lodManager(t, stream);
+            lodManager.readLodData(t->getNumLodLevels() - 1, 0);
+        }
+        for (uint16 y = 0; y < size; ++y)
+            for (uint16 x = 0; x < size; ++x)
+                ASSERT_NEAR(*t->getHeightData(x, y), heights[y * size + x], quantised ? tolerance : 0);
+
+        OGRE_DELETE t;
+        stream.reset();
+        FileSystemLayer::removeFile("TerrainTest.dat");
+    }
+    EXPECT_LT(fileSize[1], fileSize[0]);
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, lightmapSweep)
+{
+    // rolling hills with a wall casting a long shadow
+    const uint16 size = 129;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+        for (uint16 x = 0; x < size; ++x)
+            heights[y * size + x] = 40 * std::sin(x * 0.15f) * std::cos(y * 0.1f) + (x > 60 && x < 64 ? 150 : 0);
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    mTerrainOpts->setLightMapSize(256);
+    mTerrainOpts->setLightMapDirection(Vector3(1, -0.4, 0.3).normalisedCopy());
+
+    Terrain::ImportData imp;
+    imp.inputFloat = heights.data();
+    imp.terrainSize = size;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 33;
+    imp.maxBatchSize = 65;
+    ASSERT_TRUE(t->prepare(imp));
+
+    auto calculate = [&](bool rayCast) {
+        mTerrainOpts->setUseRayCastLightmap(rayCast);
+        Rect finalRect;
+        PixelBox* box = t->calculateLightmap(Rect(0, 0, size, size), Rect(), finalRect);
+        EXPECT_EQ(finalRect, Rect(0, 0, 256, 256));
+        std::vector<uint8> texels(box->data, box->data + finalRect.width() * finalRect.height());
+        OGRE_FREE(box->data, MEMCATEGORY_GENERAL);
+        OGRE_DELETE box;
+        return texels;
+    };
+
+    auto rayCast = calculate(true);
+    auto sweep = calculate(false);
+    ASSERT_EQ(rayCast.size(), sweep.size());
+
+    size_t shadowed = 0, mismatches = 0;
+    for (size_t i = 0; i < rayCast.size(); ++i)
+    {
+        shadowed += rayCast[i] == 0;
+        mismatches += rayCast[i] != sweep[i];
+    }
+    EXPECT_GT(shadowed, rayCast.size() / 20);
+    // the methods may only disagree at the shadow boundaries
+    EXPECT_LT(mismatches, rayCast.size() / 50);
+
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, rayIntersects)
+{
+    const uint16 size = 129;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+        for (uint16 x = 0; x < size; ++x)
+            heights[y * size + x] = 40 * std::sin(x * 0.15f) * std::cos(y * 0.1f);
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Terrain::ImportData imp;
+    imp.inputFloat = heights.data();
+    imp.terrainSize = size;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 33;
+    imp.maxBatchSize = 65;
+    ASSERT_TRUE(t->prepare(imp));
+
+    // slanted rays hit where the terrain is
+    for (int i = 0; i < 50; ++i)
+    {
+        Vector3 target(-450 + i * 18, 0, 400 - i * 15);
+        target.y = t->getHeightAtWorldPosition(target);
+        Vector3 dir = Vector3(0.3, -1, 0.2).normalisedCopy();
+        auto hit = t->rayIntersects(Ray(target - dir * 300, dir));
+        ASSERT_TRUE(hit.first);
+        EXPECT_NEAR(hit.second.distance(target), 0, 1);
+    }
+
+    // a ray grazing above the hills misses, until they are raised
+    Ray ray(Vector3(-600, 45, 0), Vector3::UNIT_X);
+    EXPECT_FALSE(t->rayIntersects(ray).first);
+
+    long x = 76, y = size / 2;
+    *t->getHeightData(x, y) = 60;
+    t->dirtyRect(Rect(x, y, x + 1, y + 1));
+    auto hit = t->rayIntersects(ray);
+    ASSERT_TRUE(hit.first);
+    // on the slope towards the raised point
+    EXPECT_NEAR(hit.second.x, x * 1000.0f / (size - 1) - 500, 2 * 1000.0f / (size - 1));
+
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, groupRayIntersects)
+{
+    const uint16 size = 65;
+    const Real worldSize = 500;
+    TerrainGroup group(mSceneMgr, Terrain::ALIGN_X_Z, size, worldSize);
+    group.setOrigin(Vector3(100, 0, -50));
+
+    // 2x2 slots of hills, heights continuous in world space
+    std::vector<float> heights(size * size);
+    for (long sy = 0; sy < 2; ++sy)
+    {
+        for (long sx = 0; sx < 2; ++sx)
+        {
+            Vector3 centre;
+            group.convertTerrainSlotToWorldPosition(sx, sy, &centre);
+            for (uint16 y = 0; y < size; ++y)
+            {
+                for (uint16 x = 0; x < size; ++x)
+                {
+                    Real wx = centre.x + (Real(x) / (size - 1) - 0.5f) * worldSize;
+                    Real wz = centre.z - (Real(y) / (size - 1) - 0.5f) * worldSize;
+                    heights[y * size + x] = 30 * std::sin(wx * 0.02f) * std::cos(wz * 0.015f);
+                }
+            }
+            group.defineTerrain(sx, sy, heights.data());
+        }
+    }
+
+    // prepare the slots like the group loader does, leaving out the GPU resources
+    for (const auto& s : group.getTerrainSlots())
+    {
+        TerrainGroup::TerrainSlot* slot = s.second;
+        slot->instance = OGRE_NEW Terrain(mSceneMgr);
+        ASSERT_TRUE(slot->instance->prepare(*slot->def.importData));
+        Vector3 pos;
+        group.convertTerrainSlotToWorldPosition(slot->x, slot->y, &pos);
+        slot->instance->setPosition(pos);
+    }
+
+    // slanted rays over and beside the group, some looking up and missing
+    std::minstd_rand rng(3);
+    std::uniform_real_distribution<Real> coord(-500, 800), slant(-0.6, 0.6);
+    std::vector<Ray> rays(1000);
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        Vector3 dir(slant(rng), i % 10 ? -1 : 1, slant(rng));
+        rays[i] = Ray(Vector3(coord(rng), 200, coord(rng) - 500), dir.normalisedCopy());
+    }
+
+    mRoot->getWorkQueue()->startup();
+    for (Real distanceLimit : {Real(0), Real(300)})
+    {
+        TerrainGroup::RayResultList results;
+        group.rayIntersects(rays, results, distanceLimit);
+        ASSERT_EQ(results.size(), rays.size());
+
+        size_t hits = 0;
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            TerrainGroup::RayResult expected = group.rayIntersects(rays[i], distanceLimit);
+            EXPECT_EQ(results[i].hit, expected.hit) << i;
+            EXPECT_EQ(results[i].terrain, expected.terrain) << i;
+            EXPECT_EQ(results[i].position, expected.position) << i;
+            hits += expected.hit;
+        }
+        EXPECT_GT(hits, 0u);
+        EXPECT_LT(hits, rays.size());
+    }
+    mRoot->getWorkQueue()->shutdown();
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, interiorNormals)
+{
+    const uint16 size = 65;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+        for (uint16 x = 0; x < size; ++x)
+            heights[y * size + x] = 40 * std::sin(x * 0.3f) * std::cos(y * 0.2f) + x;
+
+    for (auto align : {Terrain::ALIGN_X_Z, Terrain::ALIGN_X_Y, Terrain::ALIGN_Y_Z})
+    {
+        Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+        Terrain::ImportData imp;
+        imp.terrainAlign = align;
+        imp.inputFloat = heights.data();
+        imp.terrainSize = size;
+        imp.worldSize = 500;
+        imp.minBatchSize = 17;
+        imp.maxBatchSize = 33;
+        ASSERT_TRUE(t->prepare(imp));
+
+        Rect finalRect;
+        PixelBox* box = t->calculateNormals(Rect(0, 0, size, size), finalRect);
+        ASSERT_EQ(finalRect, Rect(0, 0, size, size));
+
+        // the direct kernel used for the interior agrees with the neighbour aware path
+        for (uint16 y = 1; y < size - 1; ++y)
+        {
+            for (uint16 x = 1; x < size - 1; ++x)
+            {
+                Vector3 p, n = Vector3::ZERO, adjacent[8];
+                const int offsets[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+                t->getPoint(x, y, &p);
+                for (int i = 0; i < 8; ++i)
+                    t->getPoint(x + offsets[i][0], y + offsets[i][1], &adjacent[i]);
+                for (int i = 0; i < 8; ++i)
+                    n += Math::calculateBasicFaceNormal(p, adjacent[i], adjacent[(i + 1) % 8]);
+                n.normalise();
+
+                const uint8* stored = box->data + ((size - y - 1) * size + x) * 3;
+                for (int c = 0; c < 3; ++c)
+                    EXPECT_NEAR(stored[c], (n[c] + 1.0f) * 0.5f * 255.0f, 1.0f);
+            }
+        }
+        OGRE_FREE(box->data, MEMCATEGORY_GENERAL);
+        OGRE_DELETE box;
+        OGRE_DELETE t;
+    }
+}
+//--------------------------------------------------------------------------
+static void expectSameHeightDeltas(TerrainQuadTreeNode* node, TerrainQuadTreeNode* reference)
+{
+    ASSERT_EQ(node->getLodCount(), reference->getLodCount());
+    for (uint16 lod = 0; lod < node->getLodCount(); ++lod)
+        EXPECT_NEAR(node->getLodLevel(lod)->maxHeightDelta, reference->getLodLevel(lod)->maxHeightDelta, 1e-3f)
+            << node->getXOffset() << ", " << node->getYOffset() << " lod " << node->getBaseLod() + lod;
+    if (!node->isLeaf())
+        for (unsigned short i = 0; i < 4; ++i)
+            expectSameHeightDeltas(node->getChild(i), reference->getChild(i));
+}
+
+TEST_F(TerrainTests, heightDeltas)
+{
+    const uint16 size = 129;
+    const Real worldSize = 1000;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+        for (uint16 x = 0; x < size; ++x)
+            heights[y * size + x] = 60 * std::sin(x * 0.11f) * std::cos(y * 0.07f) + 5.0f * ((x * 7 + y * 13) % 5);
+
+    Terrain::ImportData imp;
+    imp.inputFloat = heights.data();
+    imp.terrainSize = size;
+    imp.worldSize = worldSize;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+
+    // the bands of tile rows run in parallel
+    mRoot->getWorkQueue()->startup();
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    ASSERT_TRUE(t->prepare(imp));
+    mRoot->getWorkQueue()->shutdown();
+
+    // the quadtree of the reference is fed by the per vertex algorithm below
+    Terrain* reference = OGRE_NEW Terrain(mSceneMgr);
+    ASSERT_TRUE(reference->prepare(imp));
+    Rect rect(0, 0, size, size);
+    reference->getQuadTree()->preDeltaCalculation(rect);
+
+    // planes through the points of the lower detail tris, as ALIGN_X_Y points
+    Real scale = worldSize / (size - 1), base = worldSize / 2;
+    auto point = [&](int x, int y) {
+        return Vector3(x * scale - base, y * scale - base, heights[y * size + x]);
+    };
+    std::vector<float> deltas(size * size, 0);
+    for (int targetLevel = 1; targetLevel < t->getNumLodLevels(); ++targetLevel)
+    {
+        int sourceLevel = targetLevel - 1;
+        int step = 1 << targetLevel;
+        int bound = (size + step - 1) / step * step - step;
+        for (int j = 0; j < bound; j += step)
+        {
+            for (int i = 0; i < bound; i += step)
+            {
+                Vector3 v0 = point(i, j), v1 = point(i + step, j);
+                Vector3 v2 = point(i, j + step), v3 = point(i + step, j + step);
+                bool backwardTri = (j / step) % 2 != 0;
+                Vector4 t1 = backwardTri ? Math::calculateFaceNormalWithoutNormalize(v1, v3, v2)
+                                         : Math::calculateFaceNormalWithoutNormalize(v0, v1, v3);
+                Vector4 t2 = backwardTri ? Math::calculateFaceNormalWithoutNormalize(v0, v1, v2)
+                                         : Math::calculateFaceNormalWithoutNormalize(v0, v3, v2);
+
+                int yubound = j == size - step ? step : step - 1;
+                int xubound = i == size - step ? step : step - 1;
+                for (int y = 0; y <= yubound; ++y)
+                {
+                    for (int x = 0; x <= xubound; ++x)
+                    {
+                        int fx = i + x, fy = j + y;
+                        if (fx % step == 0 && fy % step == 0)
+                            continue;
+
+                        Real ypct = Real(y) / step, xpct = Real(x) / step;
+                        Vector3 actual = point(fx, fy);
+                        const Vector4& plane =
+                            (xpct > ypct && !backwardTri) || (xpct > 1 - ypct && backwardTri) ? t1 : t2;
+                        Real delta = (-plane.x * actual.x - plane.y * actual.y - plane.w) / plane.z - actual.z;
+
+                        reference->getQuadTree()->notifyDelta(fx, fy, sourceLevel, delta);
+
+                        int halfStep = step / 2;
+                        if ((fx % step == halfStep && fy % halfStep == 0) ||
+                            (fy % step == halfStep && fx % halfStep == 0))
+                            deltas[fy * size + fx] = delta;
+                    }
+                }
+            }
+        }
+    }
+    reference->getQuadTree()->postDeltaCalculation(rect);
+    reference->getQuadTree()->finaliseDeltaValues(rect);
+
+    for (uint16 y = 0; y < size; ++y)
+        for (uint16 x = 0; x < size; ++x)
+            ASSERT_NEAR(*t->getDeltaData(x, y), deltas[y * size + x], 1e-3f) << x << ", " << y;
+    expectSameHeightDeltas(t->getQuadTree(), reference->getQuadTree());
+
+    OGRE_DELETE reference;
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, cpuCompositeMap)
+{
+    // a checkered base layer and a second layer that has no blend weights yet
+    Image checker(PF_BYTE_RGBA, 8, 8);
+    for (uint32 y = 0; y < 8; ++y)
+        for (uint32 x = 0; x < 8; ++x)
+            checker.setColourAt((x + y) % 2 ? ColourValue(1, 0, 0, 0.5) : ColourValue(0, 1, 0, 0.5), x, y, 0);
+    checker.save("TerrainTestLayer0.png");
+    Image blue(PF_BYTE_RGBA, 4, 4);
+    blue.setTo(ColourValue::Blue);
+    blue.save("TerrainTestLayer1.png");
+    ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem", "TerrainTests");
+
+    // a ramp rising by one point spacing per point in x, lit from straight above
+    const uint16 size = 65;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+        for (uint16 x = 0; x < size; ++x)
+            heights[y * size + x] = x * 10.0f;
+
+    mTerrainOpts->setCompositeMapSize(160);
+    mTerrainOpts->setLightMapDirection(Vector3::NEGATIVE_UNIT_Y);
+    mTerrainOpts->setCompositeMapAmbient(ColourValue(0.25, 0.25, 0.25));
+    mTerrainOpts->setCompositeMapDiffuse(ColourValue(0.75, 0.75, 0.75));
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Terrain::ImportData imp;
+    imp.inputFloat = heights.data();
+    imp.terrainSize = size;
+    imp.worldSize = 640;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+    imp.layerList.resize(2);
+    imp.layerList[0].worldSize = 160;
+    imp.layerList[0].textureNames = {"TerrainTestLayer0.png", ""};
+    imp.layerList[1].worldSize = 160;
+    imp.layerList[1].textureNames = {"TerrainTestLayer1.png", ""};
+    ASSERT_TRUE(t->prepare(imp));
+
+    TerrainMaterialGeneratorA gen;
+    Image full(PF_BYTE_RGBA, 160, 160);
+    gen.bakeCompositeMap(t, Rect(0, 0, 160, 160), full.getPixelBox());
+
+    // the texture repeats every 40 texels, so each checker square covers 5x5 texels
+    float lit = 0.25f + 0.75f * Math::Sqrt(0.5f);
+    ColourValue c = full.getColourAt(2, 2, 0);
+    EXPECT_NEAR(c.r, 0, 1.0f / 255);
+    EXPECT_NEAR(c.g, lit, 1.0f / 255);
+    EXPECT_NEAR(c.b, 0, 1.0f / 255);
+    EXPECT_NEAR(c.a, 0.5f, 1.0f / 255);
+    c = full.getColourAt(7, 2, 0);
+    EXPECT_NEAR(c.r, lit, 1.0f / 255);
+    EXPECT_NEAR(c.g, 0, 1.0f / 255);
+
+    // incremental updates only touch the dirty region and match the full bake there,
+    // no matter how the tiles are laid out
+    Image partial(PF_BYTE_RGBA, 160, 160);
+    partial.setTo(ColourValue::ZERO);
+    Rect dirty(50, 30, 150, 100);
+    gen.bakeCompositeMap(t, dirty, partial.getPixelBox().getSubVolume(Box(dirty)));
+    for (uint32 y = 0; y < 160; ++y)
+    {
+        for (uint32 x = 0; x < 160; ++x)
+        {
+            bool inside = int32(x) >= dirty.left && int32(x) < dirty.right && int32(y) >= dirty.top && int32(y) < dirty.bottom;
+            const uint8* expected = inside ? full.getData(x, y) : NULL;
+            const uint8* actual = partial.getData(x, y);
+            for (int i = 0; i < 4; ++i)
+                ASSERT_EQ(actual[i], inside ? expected[i] : 0) << x << ", " << y;
+        }
+    }
+
+    // the same with a buffer of just the region, like updateCompositeMap uses
+    Image region(PF_BYTE_RGBA, dirty.width(), dirty.height());
+    gen.bakeCompositeMap(t, dirty, region.getPixelBox());
+    for (uint32 y = 0; y < region.getHeight(); ++y)
+        for (uint32 x = 0; x < region.getWidth(); ++x)
+            ASSERT_EQ(memcmp(region.getData(x, y), full.getData(x + dirty.left, y + dirty.top), 4), 0) << x << ", " << y;
+
+    OGRE_DELETE t;
+    ResourceGroupManager::getSingleton().destroyResourceGroup("TerrainTests");
+    FileSystemLayer::removeFile("TerrainTestLayer0.png");
+    FileSystemLayer::removeFile("TerrainTestLayer1.png");
+}
+//--------------------------------------------------------------------------
+namespace
+{
+/// Textures in system memory, so terrains can be loaded without a render system
+class MemoryTextureManager : public DefaultTextureManager
+{
+    class MemoryPixelBuffer : public HardwarePixelBuffer
+    {
+        PixelBox mBuffer;
+    public:
+        MemoryPixelBuffer(const PixelBox& data)
+            : HardwarePixelBuffer(data.getWidth(), data.getHeight(), 1, data.format, HBU_CPU_ONLY, false),
+              mBuffer(data)
+        {
+        }
+        PixelBox lockImpl(const Box& lockBox, LockOptions) override { return mBuffer.getSubVolume(lockBox); }
+        void unlockImpl() override {}
+        void blitFromMemory(const PixelBox& src, const Box& dstBox) override
+        {
+            PixelUtil::bulkPixelConversion(src, mBuffer.getSubVolume(dstBox));
+        }
+        void blitToMemory(const Box& srcBox, const PixelBox& dst) override
+        {
+            PixelUtil::bulkPixelConversion(mBuffer.getSubVolume(srcBox), dst);
+        }
+    };
+
+    class MemoryTexture : public Texture
+    {
+        Image mData;
+    public:
+        MemoryTexture(ResourceManager* creator, const String& name, ResourceHandle handle, const String& group)
+            : Texture(creator, name, handle, group)
+        {
+        }
+        ~MemoryTexture() { unload(); }
+    protected:
+        void createInternalResourcesImpl() override
+        {
+            // the top level is all the terrain reads back
+            mNumMipmaps = 0;
+            mData.create(mFormat, mWidth, mHeight);
+            memset(mData.getData(), 0, mData.getSize());
+            mSurfaceList.push_back(std::make_shared<MemoryPixelBuffer>(mData.getPixelBox()));
+        }
+        void freeInternalResourcesImpl() override { mSurfaceList.clear(); }
+        void loadImpl() override {}
+    };
+
+    Resource* createImpl(const String& name, ResourceHandle handle, const String& group, bool,
+                         ManualResourceLoader*, const NameValuePairList*) override
+    {
+        return new MemoryTexture(this, name, handle, group);
+    }
+
+public:
+    using TextureManager::createManual;
+    /// Same as TextureManager::createManual, without asking the render system for its capabilities
+    TexturePtr createManual(const String& name, const String& group, TextureType texType, uint width,
+                            uint height, uint depth, int numMipmaps, PixelFormat format, int usage,
+                            ManualResourceLoader* loader, bool, uint, const String&) override
+    {
+        TexturePtr ret = create(name, group, true, loader);
+        ret->setTextureType(texType);
+        ret->setWidth(width);
+        ret->setHeight(height);
+        ret->setDepth(depth);
+        ret->setFormat(format);
+        ret->setUsage(usage);
+        ret->createInternalResources();
+        return ret;
+    }
+};
+
+/// Bakes the composite map on the CPU, but generates materials that load without a render system
+class HeadlessMaterialGenerator : public TerrainMaterialGeneratorA
+{
+    static MaterialPtr plainMaterial(const String& name)
+    {
+        return static_pointer_cast<Material>(
+            MaterialManager::getSingleton().createOrRetrieve(name, RGN_DEFAULT).first);
+    }
+public:
+    HeadlessMaterialGenerator() { setCpuCompositeMapEnabled(true); }
+    MaterialPtr generate(const Terrain* terrain) override { return plainMaterial(terrain->getMaterialName()); }
+    MaterialPtr generateForCompositeMap(const Terrain* terrain) override
+    {
+        return plainMaterial(terrain->getMaterialName() + "/comp");
+    }
+    void updateParams(const MaterialPtr&, const Terrain*) override {}
+    void updateParamsForCompositeMap(const MaterialPtr&, const Terrain*) override {}
+};
+}
+
+TEST_F(TerrainTests, cpuCompositeMapLoaded)
+{
+    MemoryTextureManager texMgr;
+    DefaultHardwareBufferManager hbm;
+    mRoot->getWorkQueue()->startup();
+
+    Image layer(PF_BYTE_RGBA, 4, 4);
+    layer.setTo(ColourValue::Red);
+    layer.save("TerrainTestRed.png");
+    layer.setTo(ColourValue::Blue);
+    layer.save("TerrainTestBlue.png");
+    ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem", "TerrainTests");
+
+    // flat and lit from straight above
+    auto gen = std::make_shared<HeadlessMaterialGenerator>();
+    gen->setLightmapEnabled(true);
+    mTerrainOpts->setDefaultMaterialGenerator(gen);
+    mTerrainOpts->setCompositeMapSize(64);
+    mTerrainOpts->setLightMapSize(64);
+    mTerrainOpts->setLayerBlendMapSize(64);
+    mTerrainOpts->setLightMapDirection(Vector3::NEGATIVE_UNIT_Y);
+    mTerrainOpts->setCompositeMapAmbient(ColourValue(0.25, 0.25, 0.25));
+    mTerrainOpts->setCompositeMapDiffuse(ColourValue(0.75, 0.75, 0.75));
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Terrain::ImportData imp;
+    imp.terrainSize = 65;
+    imp.worldSize = 640;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+    imp.layerList.resize(2);
+    imp.layerList[0].worldSize = 160;
+    imp.layerList[0].textureNames = {"TerrainTestRed.png", ""};
+    imp.layerList[1].worldSize = 160;
+    imp.layerList[1].textureNames = {"TerrainTestBlue.png", ""};
+    ASSERT_TRUE(t->prepare(imp));
+    t->load();
+    t->waitForDerivedProcesses();
+    ASSERT_TRUE(t->isLoaded());
+    ASSERT_FALSE(t->getBlendTextures().empty());
+
+    // the second layer covers the top half, the left half is in shadow
+    TerrainLayerBlendMap* blendMap = t->getLayerBlendMap(1);
+    for (uint32 y = 0; y < 64; ++y)
+        for (uint32 x = 0; x < 64; ++x)
+            blendMap->setBlendValue(x, y, y < 32 ? 1.0f : 0.0f);
+    blendMap->update();
+    PixelBox* lightmap = OGRE_NEW PixelBox(64, 64, 1, PF_L8, OGRE_ALLOC_T(uint8, 64 * 64, MEMCATEGORY_GENERAL));
+    for (uint32 y = 0; y < 64; ++y)
+        for (uint32 x = 0; x < 64; ++x)
+            lightmap->data[y * 64 + x] = x < 32 ? 0 : 255;
+    t->finaliseLightmap(Rect(0, 0, 64, 64), lightmap);
+
+    Image full(PF_BYTE_RGBA, 64, 64);
+    gen->bakeCompositeMap(t, Rect(0, 0, 64, 64), full.getPixelBox());
+    EXPECT_EQ(full.getColourAt(8, 8, 0), ColourValue(0, 0, 64 / 255.0f));
+    EXPECT_EQ(full.getColourAt(56, 8, 0), ColourValue::Blue);
+    EXPECT_EQ(full.getColourAt(8, 56, 0), ColourValue(64 / 255.0f, 0, 0));
+    EXPECT_EQ(full.getColourAt(56, 56, 0), ColourValue::Red);
+
+    // updates go through a buffer of just the dirty region and leave the rest alone
+    const TexturePtr& compositeMap = t->getCompositeMap();
+    Image zero(PF_BYTE_RGBA, 64, 64);
+    zero.setTo(ColourValue::ZERO);
+    compositeMap->getBuffer()->blitFromMemory(zero.getPixelBox());
+    gen->updateCompositeMap(t, Rect(16, 8, 48, 40));
+    Image updated(PF_BYTE_RGBA, 64, 64);
+    compositeMap->getBuffer()->blitToMemory(updated.getPixelBox());
+    size_t inside = 0;
+    for (uint32 y = 0; y < 64; ++y)
+    {
+        for (uint32 x = 0; x < 64; ++x)
+        {
+            if (memcmp(updated.getData(x, y), zero.getData(x, y), 4) == 0)
+                continue;
+            ASSERT_EQ(memcmp(updated.getData(x, y), full.getData(x, y), 4), 0) << x << ", " << y;
+            ++inside;
+        }
+    }
+    EXPECT_GT(inside, 0u);
+    EXPECT_LT(inside, 64u * 64u);
+
+    // the global colour map only has a CPU copy until the terrain is loaded
+    t->setGlobalColourMapEnabled(true, 16);
+    EXPECT_THROW(gen->bakeCompositeMap(t, Rect(0, 0, 64, 64), full.getPixelBox()), InvalidStateException);
+    Image colour(PF_BYTE_RGB, 16, 16);
+    colour.setTo(ColourValue(128 / 255.0f, 1, 64 / 255.0f));
+    t->getGlobalColourMap()->getBuffer()->blitFromMemory(colour.getPixelBox());
+    {
+        StreamSerialiser ser(Root::createFileStream("TerrainTest.dat"));
+        t->save(ser);
+    }
+    Terrain* prepared = OGRE_NEW Terrain(mSceneMgr);
+    {
+        StreamSerialiser ser(Root::openFileStream("TerrainTest.dat"));
+        ASSERT_TRUE(prepared->prepare(ser));
+    }
+    Image tinted(PF_BYTE_RGBA, 64, 64);
+    gen->bakeCompositeMap(prepared, Rect(0, 0, 64, 64), tinted.getPixelBox());
+    for (uint32 y = 0; y < 64; ++y)
+    {
+        for (uint32 x = 0; x < 64; ++x)
+        {
+            ColourValue expected = full.getColourAt(x, y, 0) * ColourValue(128 / 255.0f, 1, 64 / 255.0f);
+            ColourValue actual = tinted.getColourAt(x, y, 0);
+            ASSERT_NEAR(actual.r, expected.r, 1.5f / 255) << x << ", " << y;
+            ASSERT_NEAR(actual.g, expected.g, 1.5f / 255) << x << ", " << y;
+            ASSERT_NEAR(actual.b, expected.b, 1.5f / 255) << x << ", " << y;
+        }
+    }
+
+    OGRE_DELETE prepared;
+    OGRE_DELETE t;
+    mRoot->getWorkQueue()->shutdown();
+    ResourceGroupManager::getSingleton().destroyResourceGroup("TerrainTests");
+    FileSystemLayer::removeFile("TerrainTest.dat");
+    FileSystemLayer::removeFile("TerrainTestRed.png");
+    FileSystemLayer::removeFile("TerrainTestBlue.png");
+}
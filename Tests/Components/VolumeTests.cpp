@@ -0,0 +1,283 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+
+#include "OgreBuildSettings.h"
+#include "OgreVolumeCSGSource.h"
+#include "OgreVolumeCacheSource.h"
+#include "OgreVolumeDualGridGenerator.h"
+#include "OgreVolumeIsoSurfaceMC.h"
+#include "OgreVolumeMeshBuilder.h"
+#include "OgreVolumeOctreeNode.h"
+#include "OgreVolumeOctreeNodeSplitPolicy.h"
+#include "OgreTimer.h"
+
+#include <map>
+
+#include <random>
+#include <thread>
+
+using namespace Ogre;
+using namespace Ogre::Volume;
+
+namespace
+{
+    std::vector<Vector3> randomPositions(size_t count, Real extent)
+    {
+        std::minstd_rand rng;
+        std::uniform_real_distribution<Real> coord(-extent, extent);
+        std::vector<Vector3> positions(count);
+        for (auto& p : positions)
+            p = Vector3(coord(rng), coord(rng), coord(rng));
+        return positions;
+    }
+
+    struct MeshCapture : public MeshBuilderCallback
+    {
+        VecVertex vertices;
+        VecIndices indices;
+        void ready(const SimpleRenderable*, const VecVertex& v, const VecIndices& i, size_t, int) override
+        {
+            vertices = v;
+            indices = i;
+        }
+    };
+
+    /// splits an octree over the volume and meshes it like a Chunk does
+    void meshVolume(const Source* src, Real extent, Real cellSize, MeshCapture& mesh,
+                    double* splitMs = NULL, double* meshMs = NULL)
+    {
+        Timer timer;
+        OctreeNode root(Vector3(-extent), Vector3(extent));
+        OctreeNodeSplitPolicy policy(src, cellSize);
+        root.split(&policy, src, 0);
+        if (splitMs)
+            *splitMs = timer.getMicroseconds() / 1000.0;
+
+        timer.reset();
+        MeshBuilder mb;
+        IsoSurfaceMC is(src);
+        DualGridGenerator generator;
+        generator.generateDualGrid(&root, &is, &mb, 0, root.getFrom(), root.getTo(), false);
+        if (meshMs)
+            *meshMs = timer.getMicroseconds() / 1000.0;
+        mb.executeCallback(&mesh, NULL, 0, 0);
+    }
+}
+//--------------------------------------------------------------------------
+TEST(VolumeTests, BatchValuesMatchSingleValues)
+{
+    Real frequencies[] = {1.01f, 0.48f};
+    Real amplitudes[] = {0.25f, 0.5f};
+    CSGSphereSource sphere(5, Vector3(1, 2, 3));
+    CSGPlaneSource plane(1, Vector3::UNIT_Y);
+    CSGCubeSource cube(Vector3(-2, -2, -2), Vector3(3, 1, 2));
+    CSGUnionSource unite(&sphere, &plane);
+    CSGDifferenceSource difference(&unite, &cube);
+    CSGScaleSource scale(&difference, 2);
+    CSGNoiseSource noise(&scale, frequencies, amplitudes, 2, 42);
+    CSGNegateSource negate(&noise);
+    CSGIntersectionSource intersection(&negate, &sphere);
+
+    // more positions than a batch of the CSG operations
+    std::vector<Vector3> positions = randomPositions(1000, 10);
+    std::vector<Real> values(positions.size());
+    intersection.getValues(positions.data(), values.data(), positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+        ASSERT_NEAR(values[i], intersection.getValue(positions[i]), 1e-4f);
+}
+//--------------------------------------------------------------------------
+TEST(VolumeTests, CacheSourceIsBounded)
+{
+    Real frequencies[] = {1.01f};
+    Real amplitudes[] = {0.25f};
+    CSGSphereSource sphere(5, Vector3::ZERO);
+    CSGNoiseSource noise(&sphere, frequencies, amplitudes, 1, 42);
+    CacheSource cache(&noise, (Real)1 / 1024, 256);
+    EXPECT_EQ(cache.getCapacity(), 256u);
+
+    // far more positions than fit, evicted ones are recomputed
+    std::vector<Vector3> positions = randomPositions(5000, 10);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (const auto& p : positions)
+        {
+            Vector4 expected = noise.getValueAndGradient(p);
+            Vector4 cached = cache.getValueAndGradient(p);
+            ASSERT_EQ(expected, cached);
+            ASSERT_EQ(noise.getValue(p), cache.getValue(p));
+        }
+    }
+}
+//--------------------------------------------------------------------------
+TEST(VolumeTests, CacheSourceKeys)
+{
+    CSGSphereSource sphere(5, Vector3::ZERO);
+
+    // exact by default, so positions closer than any quantum keep their own values
+    CacheSource exact(&sphere);
+    Vector3 p(1, 2, 3), q(1, 2, 3.0001f);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        EXPECT_EQ(exact.getValueAndGradient(p), sphere.getValueAndGradient(p));
+        EXPECT_EQ(exact.getValueAndGradient(q), sphere.getValueAndGradient(q));
+    }
+    EXPECT_NE(exact.getValue(p), exact.getValue(q));
+
+    // quantized positions that do not fit the key bypass the cache
+    CacheSource quantized(&sphere, (Real)1e-30);
+    Vector3 far(1e10f, 0, 0), farther(2e10f, 0, 0);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        EXPECT_EQ(quantized.getValueAndGradient(far), sphere.getValueAndGradient(far));
+        EXPECT_EQ(quantized.getValueAndGradient(farther), sphere.getValueAndGradient(farther));
+    }
+}
+//--------------------------------------------------------------------------
+#if OGRE_THREAD_SUPPORT
+TEST(VolumeTests, CacheSourceConcurrentAccess)
+{
+    CSGSphereSource sphere(5, Vector3::ZERO);
+    CacheSource cache(&sphere, (Real)1 / 1024, 1024);
+
+    // all threads share the positions, so lookups race with inserts and evictions
+    std::vector<Vector3> positions = randomPositions(4000, 10);
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (int pass = 0; pass < 4; ++pass)
+            {
+                for (size_t i = 0; i < positions.size(); ++i)
+                {
+                    const Vector3& p = positions[(i * (t + 1)) % positions.size()];
+                    if (cache.getValueAndGradient(p) != sphere.getValueAndGradient(p))
+                        mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    for (int m : mismatches)
+        EXPECT_EQ(m, 0);
+}
+#endif
+//--------------------------------------------------------------------------
+TEST(VolumeTests, MeshBuilderWeldsVertices)
+{
+    // enough distinct vertices to grow the index table several times
+    std::vector<Vector3> positions = randomPositions(3000, 10);
+    std::minstd_rand rng;
+    std::uniform_int_distribution<size_t> pick(0, positions.size() - 1);
+
+    MeshBuilder mb;
+    std::map<Vertex, uint32> reference;
+    VecIndices expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        Vector3 p[3] = {positions[pick(rng)], positions[pick(rng)], positions[pick(rng)]};
+        mb.addTriangle(p[0], Vector3::UNIT_Y, p[1], Vector3::UNIT_Y, p[2], Vector3::UNIT_Y);
+        for (const auto& v : p)
+        {
+            auto it = reference.emplace(Vertex(v, Vector3::UNIT_Y), uint32(reference.size())).first;
+            expected.push_back(it->second);
+        }
+    }
+
+    MeshCapture mesh;
+    mb.executeCallback(&mesh, NULL, 0, 0);
+    EXPECT_EQ(mesh.vertices.size(), reference.size());
+    EXPECT_EQ(mesh.indices, expected);
+    for (const auto& r : reference)
+        EXPECT_EQ(mesh.vertices[r.second], r.first);
+}
+//--------------------------------------------------------------------------
+TEST(VolumeTests, PooledOctreeMeshesSurface)
+{
+    CSGSphereSource sphere(5, Vector3::ZERO);
+    MeshCapture mesh;
+    meshVolume(&sphere, 8, 0.5, mesh);
+
+    ASSERT_FALSE(mesh.indices.empty());
+    EXPECT_EQ(mesh.indices.size() % 3, 0u);
+    // vertices are shared by the neighbouring triangles
+    EXPECT_LT(mesh.vertices.size() * 2, mesh.indices.size());
+    for (const auto& v : mesh.vertices)
+        EXPECT_NEAR(Vector3(v.x, v.y, v.z).length(), 5, 0.5);
+}
+//--------------------------------------------------------------------------
+TEST(VolumeTests, DISABLED_MeshingBenchmark)
+{
+    // metaballs like in the Isosurf sample
+    CSGSphereSource ball0(3, Vector3(-2, 0, 0));
+    CSGSphereSource ball1(3, Vector3(2, 1, 0));
+    CSGSphereSource ball2(2.5, Vector3(0, -2, 2));
+    CSGUnionSource balls01(&ball0, &ball1);
+    CSGUnionSource metaballs(&balls01, &ball2);
+
+    // a noisy, fractal like blob standing in for the VolumeTex sample
+    Real frequencies[] = {1.01f, 0.48f, 0.24f};
+    Real amplitudes[] = {0.25f, 0.5f, 1.5f};
+    CSGSphereSource blob(6, Vector3::ZERO);
+    CSGNoiseSource noise(&blob, frequencies, amplitudes, 3, 42);
+
+    const Source* volumes[] = {&metaballs, &noise};
+    const char* names[] = {"metaballs", "noise"};
+    for (int i = 0; i < 2; ++i)
+    {
+        MeshCapture mesh;
+        double splitMs, meshMs;
+        meshVolume(volumes[i], 10, 0.125, mesh, &splitMs, &meshMs);
+
+        // weld the same triangle stream with the former map to compare against
+        Timer timer;
+        std::map<Vertex, uint32> reference;
+        for (auto idx : mesh.indices)
+            reference.emplace(mesh.vertices[idx], uint32(reference.size()));
+        double mapMs = timer.getMicroseconds() / 1000.0;
+
+        timer.reset();
+        MeshBuilder mb;
+        for (size_t j = 0; j < mesh.indices.size(); j += 3)
+        {
+            const Vertex* v[3] = {&mesh.vertices[mesh.indices[j]], &mesh.vertices[mesh.indices[j + 1]],
+                                  &mesh.vertices[mesh.indices[j + 2]]};
+            mb.addTriangle(Vector3(v[0]->x, v[0]->y, v[0]->z), Vector3(v[0]->nX, v[0]->nY, v[0]->nZ),
+                           Vector3(v[1]->x, v[1]->y, v[1]->z), Vector3(v[1]->nX, v[1]->nY, v[1]->nZ),
+                           Vector3(v[2]->x, v[2]->y, v[2]->z), Vector3(v[2]->nX, v[2]->nY, v[2]->nZ));
+        }
+        double hashMs = timer.getMicroseconds() / 1000.0;
+        EXPECT_EQ(reference.size(), mesh.vertices.size());
+
+        std::cout << names[i] << ": " << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size()
+                  << " vertices, split " << splitMs << " ms, mesh " << meshMs << " ms, welding map "
+                  << mapMs << " ms, hash " << hashMs << " ms" << std::endl;
+    }
+}
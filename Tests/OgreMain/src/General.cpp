@@ -45,6 +45,9 @@ THE SOFTWARE.
 #include "OgreMesh.h"
 #include "OgreSkeletonManager.h"
 #include "OgreSkeletonInstance.h"
+#include "OgreBone.h"
+#include "OgreSkeletonSerializer.h"
+#include "OgreAnimationClip.h"
 #include "OgreCompositorManager.h"
 #include "OgreTextureManager.h"
 #include "OgreFileSystem.h"
@@ -56,8 +59,19 @@ THE SOFTWARE.
 
 #include "OgreBillboardSet.h"
 #include "OgreBillboard.h"
+#include "OgreBillboardChain.h"
+
+#include "OgrePlaneBoundedVolume.h"
+#include "OgreTimer.h"
+#include "OgreTriangleBVH.h"
+#include "OgreSubMesh.h"
+#include "OgreSubEntity.h"
+#include "OgreLightClusters.h"
+#include "OgreWorkQueue.h"
+#include "OgreHardwareBufferManager.h"
 
 #include <random>
+#include <set>
 using std::minstd_rand;
 
 using namespace Ogre;
@@ -277,6 +291,248 @@ TEST_F(SceneQueryTest, Ray) {
     ASSERT_EQ("397", results[1].movable->getName());
 }
 
+struct SceneQueryResults
+{
+    std::vector<std::vector<std::pair<String, Real>>> rays;
+    std::set<String> box, sphere, volume;
+    std::set<std::pair<String, String>> pairs;
+};
+
+static SceneQueryResults runSceneQueries(SceneManager* sceneMgr, const std::vector<Ray>& rays)
+{
+    SceneQueryResults ret;
+
+    std::unique_ptr<RaySceneQuery> rayQuery(sceneMgr->createRayQuery(Ray()));
+    std::vector<RaySceneQueryResult> rayResults;
+    rayQuery->executeBatch(rays.data(), rays.size(), rayResults);
+    for (const auto& result : rayResults)
+    {
+        ret.rays.emplace_back();
+        for (const auto& e : result)
+            ret.rays.back().emplace_back(e.movable->getName(), e.distance);
+        std::sort(ret.rays.back().begin(), ret.rays.back().end());
+    }
+
+    // the single ray path must agree with the batched one
+    rayQuery->setRay(rays[0]);
+    EXPECT_EQ(rayQuery->execute().size(), rayResults[0].size());
+
+    std::unique_ptr<AxisAlignedBoxSceneQuery> boxQuery(
+        sceneMgr->createAABBQuery(AxisAlignedBox(-1000, -500, -1000, 800, 500, 800)));
+    for (auto m : boxQuery->execute().movables)
+        ret.box.insert(m->getName());
+
+    std::unique_ptr<SphereSceneQuery> sphereQuery(sceneMgr->createSphereQuery(Sphere(Vector3(300, 0, 0), 900)));
+    for (auto m : sphereQuery->execute().movables)
+        ret.sphere.insert(m->getName());
+
+    PlaneBoundedVolume vol;
+    vol.planes.emplace_back(Vector3::UNIT_X, -1500);
+    vol.planes.emplace_back(Vector3::NEGATIVE_UNIT_Y, -200);
+    std::unique_ptr<PlaneBoundedVolumeListSceneQuery> volumeQuery(
+        sceneMgr->createPlaneBoundedVolumeQuery({vol}));
+    for (auto m : volumeQuery->execute().movables)
+        ret.volume.insert(m->getName());
+
+    std::unique_ptr<IntersectionSceneQuery> intersectionQuery(sceneMgr->createIntersectionQuery());
+    for (auto& p : intersectionQuery->execute().movables2movables)
+        ret.pairs.insert(std::minmax(p.first->getName(), p.second->getName()));
+
+    return ret;
+}
+
+static void expectSameResults(const SceneQueryResults& a, const SceneQueryResults& b)
+{
+    EXPECT_EQ(a.rays, b.rays);
+    EXPECT_EQ(a.box, b.box);
+    EXPECT_EQ(a.sphere, b.sphere);
+    EXPECT_EQ(a.volume, b.volume);
+    EXPECT_EQ(a.pairs, b.pairs);
+}
+
+TEST_F(SceneQueryTest, QueryTree)
+{
+    minstd_rand rng;
+    std::uniform_real_distribution<Real> coord(-2500, 2500);
+    std::vector<Ray> rays;
+    for (int i = 0; i < 100; i++)
+    {
+        Vector3 dir = Vector3(coord(rng), coord(rng), coord(rng)).normalisedCopy();
+        rays.emplace_back(Vector3(coord(rng), coord(rng), coord(rng)), dir);
+    }
+    rays.emplace_back(Vector3(0, 0, 500), Vector3::NEGATIVE_UNIT_Z);
+    rays.emplace_back(Vector3(0, 0, -5000), Vector3::UNIT_Z);
+
+    auto linear = runSceneQueries(mSceneMgr, rays);
+    EXPECT_FALSE(linear.box.empty());
+    EXPECT_FALSE(linear.sphere.empty());
+    EXPECT_FALSE(linear.volume.empty());
+    EXPECT_FALSE(linear.pairs.empty());
+
+    mSceneMgr->setQueryTreeEnabled(true);
+    expectSameResults(linear, runSceneQueries(mSceneMgr, rays));
+
+    // move some objects, destroy others and check that the tree follows
+    for (int i = 0; i < 500; i += 7)
+    {
+        auto ent = mSceneMgr->getEntity(StringConverter::toString(i));
+        if (i % 2)
+            ent->getParentSceneNode()->setPosition(coord(rng), coord(rng), coord(rng));
+        else
+            mSceneMgr->destroyEntity(ent);
+    }
+    mSceneMgr->_updateSceneGraph(mCamera);
+
+    // the tree must not touch the bounding spheres cached while rendering
+    auto moved = mSceneMgr->getEntity("7");
+    Vector3 cachedCenter = moved->getWorldBoundingSphere().getCenter();
+    auto tree = runSceneQueries(mSceneMgr, rays);
+    EXPECT_EQ(moved->getWorldBoundingSphere().getCenter(), cachedCenter);
+    EXPECT_NE(moved->getParentNode()->_getDerivedPosition(), cachedCenter);
+    mSceneMgr->setQueryTreeEnabled(false);
+    expectSameResults(runSceneQueries(mSceneMgr, rays), tree);
+}
+
+TEST_F(SceneQueryTest, PreciseRay)
+{
+    Entity* ent = mSceneMgr->getEntity("501");
+    const AxisAlignedBox& box = ent->getBoundingBox();
+
+    // brute force reference, the entity sits at the origin
+    Ray ray(Vector3(0, 0, 500), Vector3::NEGATIVE_UNIT_Z);
+    std::pair<bool, TriangleBVH::Hit> expected(false, TriangleBVH::Hit());
+    for (ushort i = 0; i < ent->getMesh()->getNumSubMeshes(); i++)
+    {
+        SubMesh* sm = ent->getMesh()->getSubMesh(i);
+        auto hit = TriangleBVH::intersects(ray, sm->useSharedVertices ? ent->getMesh()->sharedVertexData
+                                                                      : sm->vertexData,
+                                           sm->indexData, sm->operationType);
+        if (hit.first && (!expected.first || hit.second.distance < expected.second.distance))
+            expected = hit;
+    }
+    ASSERT_TRUE(expected.first);
+
+    std::unique_ptr<RaySceneQuery> rayQuery(mSceneMgr->createRayQuery(ray));
+    rayQuery->setSortByDistance(true, 1);
+    Real boxDistance = rayQuery->execute()[0].distance;
+
+    rayQuery->setPrecise(true);
+    RaySceneQueryResult& results = rayQuery->execute();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].movable, ent);
+    EXPECT_GE(results[0].distance, boxDistance);
+    EXPECT_FLOAT_EQ(results[0].distance, expected.second.distance);
+    EXPECT_EQ(results[0].triangle, expected.second.triangle);
+    EXPECT_TRUE(ent->getMesh()->isTriangleBVHBuilt());
+
+    // passes through a corner of the bounding box, but misses the sphere
+    Ray cornerRay(Vector3(box.getMaximum().x * 0.9f, box.getMaximum().y * 0.9f, 500), Vector3::NEGATIVE_UNIT_Z);
+    auto contains501 = [ent](const RaySceneQueryResult& r) {
+        return std::any_of(r.begin(), r.end(), [ent](const RaySceneQueryResultEntry& e) { return e.movable == ent; });
+    };
+    rayQuery->setRay(cornerRay);
+    rayQuery->setSortByDistance(false);
+    rayQuery->setPrecise(false);
+    EXPECT_TRUE(contains501(rayQuery->execute()));
+    rayQuery->setPrecise(true);
+    EXPECT_FALSE(contains501(rayQuery->execute()));
+
+    // the tree accelerated batch path refines the same way
+    mSceneMgr->setQueryTreeEnabled(true);
+    Ray rays[] = {ray, cornerRay};
+    std::vector<RaySceneQueryResult> batch;
+    rayQuery->executeBatch(rays, 2, batch);
+    ASSERT_TRUE(contains501(batch[0]));
+    EXPECT_FALSE(contains501(batch[1]));
+}
+
+TEST_F(RootWithoutRenderSystemFixture, TriangleBVHVertexStart)
+{
+    // 4 decoy vertices at z = 10 before the quad at z = 0 the indices refer to
+    const float positions[] = {-1, -1, 10, 1, -1, 10, -1, 1, 10, 1, 1, 10,
+                               -1, -1, 0,  1, -1, 0,  -1, 1, 0,  1, 1, 0};
+    const uint16 indices[] = {0, 1, 2, 2, 1, 3};
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual("VertexStart", RGN_DEFAULT);
+    SubMesh* sm = mesh->createSubMesh();
+    sm->useSharedVertices = false;
+    sm->vertexData = new VertexData();
+    sm->vertexData->vertexStart = 4;
+    sm->vertexData->vertexCount = 4;
+    sm->vertexData->vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+    auto vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(sizeof(float) * 3, 8,
+                                                                          HBU_CPU_ONLY);
+    vbuf->writeData(0, sizeof(positions), positions);
+    sm->vertexData->vertexBufferBinding->setBinding(0, vbuf);
+    sm->indexData->indexCount = 6;
+    sm->indexData->indexBuffer =
+        HardwareBufferManager::getSingleton().createIndexBuffer(HardwareIndexBuffer::IT_16BIT, 6, HBU_CPU_ONLY);
+    sm->indexData->indexBuffer->writeData(0, sizeof(indices), indices);
+    mesh->_setBounds(AxisAlignedBox(-1, -1, 0, 1, 1, 10));
+
+    Ray ray(Vector3(0.5f, 0.25f, 20), Vector3::NEGATIVE_UNIT_Z);
+    TriangleBVH bvh(mesh.get());
+    EXPECT_EQ(bvh.getTriangleCount(), 2u);
+    auto hit = bvh.intersects(ray);
+    ASSERT_TRUE(hit.first);
+    EXPECT_FLOAT_EQ(hit.second.distance, 20);
+    EXPECT_EQ(hit.second.triangle, 1u);
+
+    auto bruteForce = TriangleBVH::intersects(ray, sm->vertexData, sm->indexData, sm->operationType);
+    ASSERT_TRUE(bruteForce.first);
+    EXPECT_FLOAT_EQ(bruteForce.second.distance, 20);
+    EXPECT_EQ(bruteForce.second.triangle, 1u);
+
+    MeshManager::getSingleton().remove(mesh);
+}
+
+TEST_F(SceneQueryTest, DISABLED_QueryTreeBenchmark)
+{
+    Entity* ent = mSceneMgr->getEntity("501");
+    minstd_rand rng;
+    std::uniform_real_distribution<Real> coord(-10000, 10000);
+    for (int i = 0; i < 10000; i++)
+    {
+        auto node = mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(coord(rng), coord(rng), coord(rng)));
+        node->attachObject(ent->clone("bench" + StringConverter::toString(i)));
+    }
+    mSceneMgr->_updateSceneGraph(mCamera);
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < 10000; i++)
+        rays.emplace_back(Vector3(coord(rng), coord(rng), coord(rng)),
+                          Vector3(coord(rng), coord(rng), coord(rng)).normalisedCopy());
+
+    std::unique_ptr<RaySceneQuery> rayQuery(mSceneMgr->createRayQuery(Ray()));
+    rayQuery->setSortByDistance(true, 1);
+    std::vector<RaySceneQueryResult> results;
+
+    Timer timer;
+    rayQuery->executeBatch(rays.data(), rays.size(), results);
+    auto linear = timer.getMicroseconds();
+
+    mSceneMgr->setQueryTreeEnabled(true);
+    timer.reset();
+    mSceneMgr->_getQueryTree(); // initial build
+    auto build = timer.getMicroseconds();
+
+    timer.reset();
+    for (const auto& ray : rays)
+    {
+        rayQuery->setRay(ray);
+        rayQuery->execute();
+    }
+    auto single = timer.getMicroseconds();
+
+    timer.reset();
+    rayQuery->executeBatch(rays.data(), rays.size(), results);
+    auto batch = timer.getMicroseconds();
+
+    printf("%zu rays against %zu objects: linear %.1f ms, tree build %.1f ms, tree %.1f ms, tree packets %.1f ms\n",
+           rays.size(), mSceneMgr->getMovableObjects(MOT_ENTITY).size(), linear / 1000.0, build / 1000.0,
+           single / 1000.0, batch / 1000.0);
+}
+
 TEST(MaterialSerializer, Basic)
 {
     Root root;
@@ -573,6 +829,154 @@ TEST_F(SkeletonTests, linkedSkeletonAnimationSource)
     EXPECT_TRUE(entity->getAnimationState("Stealth")); // animation from ninja.sekeleton
 }
 
+static std::vector<float> getSkinnedPositions(Entity* entity)
+{
+    const VertexData* vdata = entity->getMesh()->sharedVertexData ? entity->_getSkelAnimVertexData()
+                                                                   : entity->getSubEntity(0)->_getSkelAnimVertexData();
+    auto elem = vdata->vertexDeclaration->findElementBySemantic(VES_POSITION);
+    auto buf = vdata->vertexBufferBinding->getBuffer(elem->getSource());
+    std::vector<float> ret(buf->getSizeInBytes() / sizeof(float));
+    buf->readData(0, buf->getSizeInBytes(), ret.data());
+    return ret;
+}
+
+TEST_F(SkeletonTests, UpdateAnimationsInParallel)
+{
+    mRoot->getWorkQueue()->startup();
+    auto sceneMgr = mRoot->createSceneManager();
+
+    std::vector<Entity*> serial, parallel;
+    for (int i = 0; i < 8; i++)
+    {
+        for (auto list : {&serial, &parallel})
+        {
+            auto entity = sceneMgr->createEntity("jaiqua.mesh");
+            sceneMgr->getRootSceneNode()->attachObject(entity);
+            auto state = entity->getAnimationState("Sneak");
+            state->setEnabled(true);
+            state->setTimePosition(0.1f * i);
+            list->push_back(entity);
+        }
+    }
+
+    for (auto entity : serial)
+        entity->_updateAnimation();
+    Entity::_updateAnimations(parallel);
+
+    EXPECT_NE(getSkinnedPositions(serial[0]), getSkinnedPositions(serial[1]));
+    for (size_t i = 0; i < serial.size(); i++)
+        EXPECT_EQ(getSkinnedPositions(serial[i]), getSkinnedPositions(parallel[i]));
+
+    mRoot->getWorkQueue()->shutdown();
+}
+
+TEST_F(SkeletonTests, AnimationLod)
+{
+    auto sceneMgr = mRoot->createSceneManager();
+    auto cam = sceneMgr->createCamera("Camera");
+    sceneMgr->getRootSceneNode()->attachObject(cam);
+
+    Entity* entities[2];
+    for (int i = 0; i < 2; i++)
+    {
+        entities[i] = sceneMgr->createEntity("jaiqua.mesh");
+        sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, -100 - 10000 * i))->attachObject(entities[i]);
+        entities[i]->getAnimationState("Sneak")->setEnabled(true);
+        entities[i]->setAnimationLodLevels({1000, 5000});
+    }
+    sceneMgr->_updateSceneGraph(cam);
+    for (auto e : entities)
+        e->_notifyCurrentCamera(cam);
+    EXPECT_EQ(entities[0]->getAnimationLodIndex(), 0);
+    EXPECT_EQ(entities[1]->getAnimationLodIndex(), 2);
+
+    const auto& tracks = entities[0]->getSkeleton()->getAnimation("Sneak")->_getNodeTrackList();
+    ushort animated = tracks.begin()->first, minor = tracks.rbegin()->first;
+    Bone* minorBones[2] = {entities[0]->getSkeleton()->getBone(minor), entities[1]->getSkeleton()->getBone(minor)};
+    minorBones[1]->setMinor(true);
+    Quaternion bindingPose = minorBones[1]->getOrientation();
+
+    Affine3 last;
+    for (int f = 0; f < 10; f++)
+    {
+        for (auto e : entities)
+        {
+            e->getAnimationState("Sneak")->addTime(0.05f);
+            e->_updateAnimation();
+        }
+
+        // distant entities are interpolated in between evaluations, so they still move every frame
+        Affine3 m = entities[1]->_getBoneMatrices()[animated];
+        if (f > 4)
+        {
+            EXPECT_NE(m, last);
+        }
+        last = m;
+
+        // rotating joints are blended without shrinking or shearing them
+        Matrix3 rot = m.linear();
+        for (int c = 0; c < 3; c++)
+        {
+            EXPECT_NEAR(rot.GetColumn(c).length(), 1, 1e-3);
+            EXPECT_NEAR(rot.GetColumn(c).dotProduct(rot.GetColumn((c + 1) % 3)), 0, 1e-3);
+        }
+
+        EXPECT_NE(minorBones[0]->getOrientation(), bindingPose);
+        EXPECT_EQ(minorBones[1]->getOrientation(), bindingPose);
+        mRoot->_fireFrameRenderingQueued();
+    }
+}
+
+TEST_F(SkeletonTests, BakedAnimationClip)
+{
+    SkeletonPtr skeletons[3];
+    for (int i = 0; i < 2; i++)
+    {
+        skeletons[i] = SkeletonManager::getSingleton().create(StringConverter::toString(i), RGN_DEFAULT, true);
+        auto stream = ResourceGroupManager::getSingleton().openResource("jaiqua.skeleton");
+        SkeletonSerializer().importSkeleton(stream, skeletons[i].get());
+    }
+
+    skeletons[1]->optimiseAllAnimations(false, 30);
+    const AnimationClip* clip = skeletons[1]->getAnimation("Sneak")->getClip();
+    ASSERT_TRUE(clip);
+    EXPECT_TRUE(skeletons[1]->getAnimation("Sneak")->_getNodeTrackList().empty());
+
+    // the clip survives a round trip through the serializer
+    auto stream = std::make_shared<MemoryDataStream>(size_t(4 << 20));
+    SkeletonSerializer().exportSkeleton(skeletons[1].get(), stream);
+    DataStreamPtr written = std::make_shared<MemoryDataStream>(stream->getPtr(), stream->tell());
+    skeletons[2] = SkeletonManager::getSingleton().create("2", RGN_DEFAULT, true);
+    SkeletonSerializer().importSkeleton(written, skeletons[2].get());
+    ASSERT_TRUE(skeletons[2]->getAnimation("Sneak")->getClip());
+    EXPECT_EQ(skeletons[2]->getAnimation("Sneak")->getClip()->getNumFrames(), clip->getNumFrames());
+
+    // older formats have no chunk for it
+    auto oldStream = std::make_shared<MemoryDataStream>(size_t(4 << 20));
+    EXPECT_THROW(SkeletonSerializer().exportSkeleton(skeletons[1].get(), oldStream, SKELETON_VERSION_1_8), Exception);
+
+    Real length = skeletons[0]->getAnimation("Sneak")->getLength();
+    for (Real t : {Real(0), length * 0.37f, length * 0.8f, length * 1.25f})
+    {
+        for (auto& skel : skeletons)
+        {
+            skel->reset(true);
+            skel->getAnimation("Sneak")->apply(skel.get(), t);
+        }
+
+        for (ushort h = 0; h < skeletons[0]->getNumBones(); h++)
+        {
+            Bone* ref = skeletons[0]->getBone(h);
+            for (int i = 1; i < 3; i++)
+            {
+                Bone* bone = skeletons[i]->getBone(h);
+                EXPECT_TRUE(bone->_getDerivedPosition().positionEquals(ref->_getDerivedPosition(), 0.05f));
+                EXPECT_TRUE(bone->_getDerivedOrientation().orientationEquals(ref->_getDerivedOrientation(), 1e-4f));
+            }
+        }
+    }
+}
+
 TEST(MaterialLoading, LateShadowCaster)
 {
     Root root("");
@@ -646,6 +1050,170 @@ TEST(Light, AnimationTrack)
     EXPECT_EQ(l.getAttenuation(), Vector4f(1.5, 3, 4.5, 6));
 }
 
+struct LightClusterSceneManager : public SceneManager
+{
+    LightClusterSceneManager() : SceneManager("LightClusters") {}
+    const String& getTypeName() const override
+    {
+        static String name = "LightClusterSceneManager";
+        return name;
+    }
+    using SceneManager::findLightsAffectingFrustum;
+};
+
+typedef RootWithoutRenderSystemFixture LightClustersTest;
+TEST_F(LightClustersTest, SameLightLists)
+{
+    // enough lights to build the grid in parallel
+    mRoot->getWorkQueue()->startup();
+    LightClusterSceneManager sm;
+    Camera* cam = sm.createCamera("Camera");
+    cam->setNearClipDistance(1);
+    cam->setFarClipDistance(1000);
+    cam->setFOVy(Degree(90));
+    sm.getRootSceneNode()->attachObject(cam);
+
+    minstd_rand rng;
+    std::uniform_real_distribution<Real> coord(-800, 800);
+    std::uniform_real_distribution<Real> range(5, 100);
+    for (int i = 0; i < 500; i++)
+    {
+        Light* l = sm.createLight(i % 5 ? Light::LT_POINT : Light::LT_SPOTLIGHT);
+        l->setAttenuation(range(rng), 1, 0, 0);
+        l->setCastShadows(i % 50 == 0);
+        l->setLightMask(i % 3 ? 0xFFFFFFFF : 0x1);
+        // mostly in front of the camera, so enough of them affect the frustum
+        Vector3 pos(coord(rng), coord(rng), -std::abs(coord(rng)) + 100);
+        SceneNode* node = sm.getRootSceneNode()->createChildSceneNode(pos);
+        node->setDirection(Vector3(coord(rng), coord(rng), coord(rng)));
+        node->attachObject(l);
+    }
+    sm.getRootSceneNode()->attachObject(sm.createLight(Light::LT_DIRECTIONAL));
+    sm._updateSceneGraph(cam);
+    sm.findLightsAffectingFrustum(cam);
+    ASSERT_GT(sm._getLightsAffectingFrustum().size(), 100u);
+
+    // the object spheres extend beyond the frustum as well
+    std::vector<Sphere> spheres;
+    for (int i = 0; i < 1000; i++)
+        spheres.emplace_back(Vector3(coord(rng), coord(rng), coord(rng)), range(rng) / 2);
+
+    std::vector<LightList> expected(spheres.size());
+    for (size_t i = 0; i < spheres.size(); i++)
+        sm._populateLightList(spheres[i].getCenter(), spheres[i].getRadius(), expected[i], i % 2 ? 0x1 : 0xFF);
+
+    sm.setLightClusteringEnabled(true);
+    sm._updateLightClusters(cam);
+    ASSERT_TRUE(sm.getLightClusters()->isValid());
+    EXPECT_FALSE(sm.getLightClusters()->getLightIndices().empty());
+
+    for (size_t i = 0; i < spheres.size(); i++)
+    {
+        LightList lights;
+        sm._populateLightList(spheres[i].getCenter(), spheres[i].getRadius(), lights, i % 2 ? 0x1 : 0xFF);
+        ASSERT_EQ(expected[i], lights) << i;
+    }
+
+    // the serial build produces the same grid
+    LightClusters* clusters = sm.getLightClusters();
+    auto ranges = clusters->getClusterRanges();
+    auto indices = clusters->getLightIndices();
+    mRoot->getWorkQueue()->shutdown();
+    sm._updateLightClusters(cam);
+    EXPECT_EQ(clusters->getClusterRanges(), ranges);
+    EXPECT_EQ(clusters->getLightIndices(), indices);
+}
+
+TEST_F(LightClustersTest, TextureExport)
+{
+    LightClusterSceneManager sm;
+    Camera* cam = sm.createCamera("Camera");
+    cam->setNearClipDistance(1);
+    cam->setFarClipDistance(1000);
+    sm.getRootSceneNode()->attachObject(cam);
+
+    Light* spot = sm.createLight(Light::LT_SPOTLIGHT);
+    spot->setAttenuation(100, 1, 0.5, 0.25);
+    spot->setSpotlightRange(Degree(30), Degree(60), 2);
+    spot->setDiffuseColour(ColourValue(1, 0.5, 0.25));
+    spot->setPowerScale(2);
+    sm.getRootSceneNode()->createChildSceneNode(Vector3(10, 0, -50))->attachObject(spot);
+    Light* point = sm.createLight(Light::LT_POINT);
+    point->setAttenuation(20, 1, 0, 0);
+    sm.getRootSceneNode()->createChildSceneNode(Vector3(-10, 5, -200))->attachObject(point);
+    sm.getRootSceneNode()->attachObject(sm.createLight(Light::LT_DIRECTIONAL));
+
+    sm._updateSceneGraph(cam);
+    sm.findLightsAffectingFrustum(cam);
+    sm.setLightClusteringEnabled(true);
+    sm._updateLightClusters(cam);
+    LightClusters* clusters = sm.getLightClusters();
+    const LightList& lights = sm._getLightsAffectingFrustum();
+    ASSERT_EQ(lights.size(), 3u);
+
+    Image img;
+    clusters->writeImage(LightClusters::TC_RANGES, lights, img);
+    ASSERT_EQ(img.getFormat(), PF_R32G32_UINT);
+    ASSERT_EQ(img.getWidth(), clusters->getTilesX() * clusters->getTilesY());
+    ASSERT_EQ(img.getHeight(), clusters->getSlices());
+    const auto& ranges = clusters->getClusterRanges();
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        EXPECT_EQ(img.getData<uint32>()[2 * i], ranges[i].first);
+        EXPECT_EQ(img.getData<uint32>()[2 * i + 1], ranges[i].second);
+    }
+
+    clusters->writeImage(LightClusters::TC_INDICES, lights, img);
+    ASSERT_EQ(img.getFormat(), PF_R32_UINT);
+    ASSERT_GE(img.getWidth() * img.getHeight(), clusters->getLightIndices().size());
+    EXPECT_TRUE(std::equal(clusters->getLightIndices().begin(), clusters->getLightIndices().end(),
+                           img.getData<uint32>()));
+
+    // a shader looking up the cluster of the point light finds it there
+    Vector3 v(-10, 5, -200);
+    Vector4f tile = clusters->getTileParams(), slice = clusters->getSliceParams();
+    uint32 x = uint32((v.x / -v.z - tile[0]) * tile[2]);
+    uint32 y = uint32((v.y / -v.z - tile[1]) * tile[3]);
+    uint32 z = uint32(std::log(-v.z / slice[0]) * slice[1]);
+    const auto& range = ranges[x + uint32(slice[2]) * y + clusters->getTilesX() * clusters->getTilesY() * z];
+    size_t pointIndex = std::find(lights.begin(), lights.end(), point) - lights.begin();
+    EXPECT_NE(std::find(img.getData<uint32>() + range.first, img.getData<uint32>() + range.first + range.second,
+                        uint32(pointIndex)),
+              img.getData<uint32>() + range.first + range.second);
+
+    clusters->writeImage(LightClusters::TC_LIGHTS, lights, img);
+    ASSERT_EQ(img.getFormat(), PF_FLOAT32_RGBA);
+    ASSERT_EQ(img.getHeight(), 3u);
+    size_t spotIndex = std::find(lights.begin(), lights.end(), spot) - lights.begin();
+    const float* texels = img.getData<float>(0, spotIndex);
+    EXPECT_EQ(Vector4f(texels), Vector4f(10, 0, -50, 100));
+    EXPECT_EQ(Vector4f(texels + 4), Vector4f(2, 1, 0.5, 2));
+    EXPECT_EQ(Vector3f(texels + 8), Vector3f(1, 0.5, 0.25));
+    EXPECT_FLOAT_EQ(texels[11], Math::Cos(Degree(15)));
+    EXPECT_FLOAT_EQ(texels[15], Math::Cos(Degree(30)));
+    EXPECT_EQ(img.getData<float>(0, pointIndex)[11], -2);
+}
+
+typedef RootWithoutRenderSystemFixture WorkQueueTests;
+TEST_F(WorkQueueTests, ProcessTasksParallel)
+{
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->startup();
+
+    std::vector<int> visited(1000, 0);
+    wq->processTasksParallel(visited.size(), [&visited](size_t i) { visited[i]++; });
+    EXPECT_EQ(std::count(visited.begin(), visited.end(), 1), int(visited.size()));
+
+    EXPECT_THROW(wq->processTasksParallel(10,
+                                          [](size_t i)
+                                          {
+                                              if (i == 5)
+                                                  OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "task failed");
+                                          }),
+                 InternalErrorException);
+    wq->shutdown();
+}
+
 TEST(GpuProgramParams, Variability)
 {
     auto constants = std::make_shared<GpuNamedConstants>();
@@ -695,4 +1263,153 @@ TEST(Billboard, TextureCoords)
             bb->setTexcoordIndex((ysegs - y - 1)*xsegs + x);
         }
     }
-}
\ No newline at end of file
+}
+
+typedef RootWithoutRenderSystemFixture HardwareBufferManagerTests;
+TEST_F(HardwareBufferManagerTests, TransientVertices)
+{
+    auto& mgr = HardwareBufferManager::getSingleton();
+    mgr.setTransientBufferSize(4096);
+
+    // allocations of a frame share the buffer without overlapping
+    auto a = mgr.allocateTransientVertices(24, 10);
+    auto b = mgr.allocateTransientVertices(24, 10);
+    EXPECT_EQ(a.buffer, b.buffer);
+    EXPECT_GE(b.start, a.start + 10);
+    EXPECT_EQ(b.start * 24 % 256, 0u);
+    EXPECT_EQ(b.lockOptions, HardwareBuffer::HBL_NO_OVERWRITE);
+
+    // a frame needing more than the ring holds gets a new buffer
+    auto c = mgr.allocateTransientVertices(24, 1000);
+    EXPECT_NE(c.buffer, a.buffer);
+    EXPECT_EQ(c.start, 0u);
+    EXPECT_EQ(c.lockOptions, HardwareBuffer::HBL_DISCARD);
+
+    // a later frame wraps around instead
+    mgr._releaseBufferCopies();
+    auto d = mgr.allocateTransientVertices(24, 1500);
+    EXPECT_EQ(d.buffer, c.buffer);
+    EXPECT_EQ(d.start, 0u);
+    EXPECT_EQ(d.lockOptions, HardwareBuffer::HBL_DISCARD);
+
+    // other vertex sizes use rings of their own
+    auto e = mgr.allocateTransientVertices(16, 4);
+    EXPECT_NE(e.buffer, d.buffer);
+    EXPECT_EQ(e.buffer->getVertexSize(), 16u);
+}
+
+struct TransientBillboardChain : public BillboardChain
+{
+    TransientBillboardChain() : BillboardChain("chain", 10, 2) {}
+    using BillboardChain::updateVertexBuffer;
+
+    const VertexData* getVertexData()
+    {
+        RenderOperation op;
+        getRenderOperation(op);
+        return op.vertexData;
+    }
+};
+
+TEST_F(HardwareBufferManagerTests, TransientBillboardChain)
+{
+    SceneManager* sm = mRoot->createSceneManager();
+    Camera* cam = sm->createCamera("cam");
+    sm->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, 500))->attachObject(cam);
+
+    TransientBillboardChain chain;
+    sm->getRootSceneNode()->attachObject(&chain);
+    chain.addChainElement(0, BillboardChain::Element(Vector3(0, 0, 0), 1, 0, ColourValue::White, Quaternion::IDENTITY));
+    chain.addChainElement(0, BillboardChain::Element(Vector3(0, 10, 0), 1, 1, ColourValue::White, Quaternion::IDENTITY));
+
+    // auto updated vertices go to the ring of their vertex size, after anything allocated before
+    chain.updateVertexBuffer(cam);
+    size_t vertexSize = chain.getVertexData()->vertexDeclaration->getVertexSize(0);
+    auto before = HardwareBufferManager::getSingleton().allocateTransientVertices(vertexSize, 1);
+    chain.updateVertexBuffer(cam);
+    EXPECT_EQ(chain.getVertexData()->vertexBufferBinding->getBuffer(0), before.buffer);
+    EXPECT_GT(chain.getVertexData()->vertexStart, before.start);
+
+    // otherwise the chain keeps a buffer of its own
+    chain.setAutoUpdate(false);
+    chain.updateVertexBuffer(cam);
+    EXPECT_NE(chain.getVertexData()->vertexBufferBinding->getBuffer(0), before.buffer);
+    EXPECT_EQ(chain.getVertexData()->vertexStart, 0u);
+
+    sm->getRootSceneNode()->detachObject(&chain);
+}
+
+TEST_F(RootWithoutRenderSystemFixture, BillboardBatch)
+{
+    SceneManager* sm = mRoot->createSceneManager();
+    Camera* cam = sm->createCamera("cam");
+    sm->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, 500))->attachObject(cam);
+
+    BillboardSet* bbs = sm->createBillboardSet();
+    bbs->setCullIndividually(true);
+    bbs->setUseTransientBuffers(false);
+    sm->getRootSceneNode()->createChildSceneNode(Vector3(10, 0, 0))->attachObject(bbs);
+
+    // process the chunks of large batches in parallel
+    mRoot->getWorkQueue()->startup();
+
+    minstd_rand rng(7);
+    std::uniform_real_distribution<float> pos(-300, 300);
+    // a single chunk, and several chunks of 2048 billboards with a partial last one
+    for (size_t count : {50, 5000})
+    {
+        std::vector<Billboard> billboards(count);
+        for (size_t i = 0; i < billboards.size(); ++i)
+        {
+            Billboard& bb = billboards[i];
+            // every 5th one behind the camera
+            bb.mPosition = Vector3(pos(rng), pos(rng), i % 5 ? pos(rng) : 1000);
+            bb.mColour = uint32(i * 0x01020304);
+            bb.mRotation = Radian(i % 3 ? pos(rng) / 100 : 0);
+            if (i % 2)
+                bb.setDimensions(pos(rng) + 400, pos(rng) + 400);
+            if (i % 7 == 0)
+                bb.setTexcoordRect(0.25, 0.5, 0.75, 1);
+        }
+        bbs->setPoolSize(count + 14);
+
+        auto generate = [&](bool batch) {
+            bbs->beginBillboards(billboards.size());
+            if (batch)
+                bbs->injectBillboards(billboards.data(), billboards.size());
+            else
+                for (const auto& bb : billboards)
+                    bbs->injectBillboard(bb);
+            bbs->endBillboards();
+
+            RenderOperation op;
+            bbs->getRenderOperation(op);
+            std::vector<float> vertices(op.vertexData->vertexCount * 6);
+            op.vertexData->vertexBufferBinding->getBuffer(0)->readData(
+                op.vertexData->vertexStart * 24, vertices.size() * sizeof(float), vertices.data());
+            return vertices;
+        };
+
+        for (auto rotationType : {BBR_TEXCOORD, BBR_VERTEX})
+        {
+            bbs->setBillboardRotationType(rotationType);
+            bbs->_notifyCurrentCamera(cam);
+
+            auto reference = generate(false);
+            auto batched = generate(true);
+            ASSERT_EQ(reference.size(), batched.size());
+            EXPECT_LT(reference.size(), billboards.size() * 24);
+            size_t mismatches = 0;
+            for (size_t i = 0; i < reference.size(); ++i)
+            {
+                if (i % 6 == 3) // colour
+                    mismatches += memcmp(&reference[i], &batched[i], sizeof(float)) != 0;
+                else
+                    mismatches += std::abs(reference[i] - batched[i]) > 1e-3f;
+            }
+            EXPECT_EQ(mismatches, 0u) << count << " billboards";
+        }
+    }
+
+    mRoot->getWorkQueue()->shutdown();
+}
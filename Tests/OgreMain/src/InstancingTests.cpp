@@ -28,7 +28,9 @@ THE SOFTWARE.
 
 #include "Ogre.h"
 #include "OgreInstancedEntity.h"
+#include "OgreInstanceBatchHW_VTF.h"
 #include "OgreInstanceBatchShader.h"
+#include "OgreOptimisedUtil.h"
 #include "RootWithoutRenderSystemFixture.h"
 
 using namespace Ogre;
@@ -53,5 +55,222 @@ TEST_F(Instancing, Bounds) {
     EXPECT_EQ(instanced_entity.getBoundingRadius(), entity->getBoundingRadius());
 }
 
+TEST_F(Instancing, CullSpheres) {
+    SceneManager* sceneMgr = mRoot->createSceneManager();
+    Camera* camera = sceneMgr->createCamera("cam");
+    camera->setNearClipDistance(1);
+    camera->setFarClipDistance(500);
+    sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(10, 20, 30))->attachObject(camera);
+
+    const size_t count = 1003;
+    std::vector<float> x(count), y(count), z(count), r(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        x[i] = Math::RangeRandom(-600, 600);
+        y[i] = Math::RangeRandom(-600, 600);
+        z[i] = Math::RangeRandom(-600, 600);
+        r[i] = i % 10 ? Math::RangeRandom(0, 50) : -std::numeric_limits<float>::infinity();
+    }
+
+    std::vector<uint32> expected;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (r[i] >= 0 && camera->isVisible(Sphere(Vector3(x[i], y[i], z[i]), r[i])))
+            expected.push_back(uint32(i));
+    }
+    ASSERT_FALSE(expected.empty());
+
+    for (const auto& impl : OptimisedUtil::getAvailableImplementations())
+    {
+        std::vector<uint32> visible(count);
+        size_t numVisible = impl.second->cullSpheres(
+            camera->getFrustumPlanes(), 6, x.data(), y.data(), z.data(), r.data(), visible.data(), count);
+        visible.resize(numVisible);
+        EXPECT_EQ(visible, expected) << impl.first;
+    }
+}
+
+struct CullingBatch : public InstanceBatchShader
+{
+    CullingBatch(MeshPtr& mesh, const MaterialPtr& material, size_t instancesPerBatch)
+        : InstanceBatchShader(NULL, mesh, material, instancesPerBatch, NULL, "Culling")
+    {
+        createAllInstancedEntities();
+    }
+
+    using InstanceBatchShader::findVisibleEntities;
+    using InstanceBatchShader::mInstancedEntities;
+    using InstanceBatchShader::mVisibleEntities;
+};
+
+TEST_F(Instancing, FindVisibleEntities) {
+    SceneManager* sceneMgr = mRoot->createSceneManager();
+    Camera* camera = sceneMgr->createCamera("cam");
+    camera->setNearClipDistance(1);
+    camera->setFarClipDistance(500);
+    sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(10, 20, 30))->attachObject(camera);
+
+    Entity* entity = sceneMgr->createEntity("robot.mesh");
+    MeshPtr mesh = entity->getMesh();
+
+    // more than one range of InstanceBatch::processRangesParallel
+    CullingBatch batch(mesh, entity->getSubEntity(0)->getMaterial(), 10000);
+    SceneNode* node = NULL;
+    for (size_t i = 0; i < batch.mInstancedEntities.size(); ++i)
+    {
+        InstancedEntity* instance = batch.mInstancedEntities[i];
+        // some stay unused, some share their node with the previous one
+        if (i % 7 == 0)
+            continue;
+        instance->setInUse(true);
+        if (i % 3 != 0)
+            node = sceneMgr->getRootSceneNode()->createChildSceneNode(
+                Vector3(Math::RangeRandom(-600, 600), Math::RangeRandom(-600, 600), Math::RangeRandom(-600, 600)));
+        node->attachObject(instance);
+        if (i % 5 == 0)
+            instance->setScale(Vector3(3, 3, 3));
+    }
+
+    // one by one, like InstancedEntity::findVisible
+    std::vector<uint32> expected;
+    for (size_t i = 0; i < batch.mInstancedEntities.size(); ++i)
+    {
+        const InstancedEntity* instance = batch.mInstancedEntities[i];
+        if (instance->isInScene() && instance->isVisible() &&
+            camera->isVisible(Sphere(instance->_getDerivedPosition(),
+                                     instance->getBoundingRadius() * instance->getMaxScaleCoef())))
+            expected.push_back(uint32(i));
+    }
+    ASSERT_FALSE(expected.empty());
+
+    mRoot->getWorkQueue()->startup();
+    size_t numVisible = batch.findVisibleEntities(camera);
+    mRoot->getWorkQueue()->shutdown();
+
+    std::vector<uint32> visible(batch.mVisibleEntities.begin(), batch.mVisibleEntities.begin() + numVisible);
+    EXPECT_EQ(visible, expected);
+}
+
+struct BakedAnimationBatch : public InstanceBatchHW_VTF
+{
+    BakedAnimationBatch(MeshPtr& mesh, const MaterialPtr& material)
+        : InstanceBatchHW_VTF(NULL, mesh, material, 1, &mesh->getSubMesh(0)->blendIndexToBoneIndexMap, "Baked")
+    {
+        setBakedAnimations(true, 8);
+    }
 
+    using BaseInstanceBatchVTF::calculateVertexTextureSize;
+    using BaseInstanceBatchVTF::bakeAnimations;
+    using BaseInstanceBatchVTF::getBakedAnimationFrames;
+    using BaseInstanceBatchVTF::mMatricesPerInstance;
+    using BaseInstanceBatchVTF::mMaxFloatsPerLine;
+};
 
+TEST_F(Instancing, BakedAnimations) {
+    typedef TransformBase<3, float> Matrix3x4f;
+
+    SceneManager* sceneMgr = mRoot->createSceneManager();
+    Entity* entity = sceneMgr->createEntity("robot.mesh");
+    MeshPtr mesh = entity->getMesh();
+    // as done by InstanceManager::buildNewBatch
+    SubMesh* subMesh = mesh->getSubMesh(0);
+    if (subMesh->blendIndexToBoneIndexMap.empty())
+        subMesh->blendIndexToBoneIndexMap = mesh->sharedBlendIndexToBoneIndexMap;
+
+    BakedAnimationBatch batch(mesh, entity->getSubEntity(0)->getMaterial());
+    size_t texWidth, texHeight;
+    batch.calculateVertexTextureSize(subMesh, texWidth, texHeight);
+    Image baked(PF_FLOAT32_RGBA, texWidth, texHeight);
+    batch.bakeAnimations(baked.getPixelBox());
+
+    InstancedEntity instance(&batch, 0);
+    sceneMgr->getRootSceneNode()->attachObject(&instance);
+
+    // reads a bone matrix of a baked frame from the texels the shader samples
+    const size_t numMatrices = batch.mMatricesPerInstance;
+    const size_t pixelsPerLine = std::min(texWidth, batch.mMaxFloatsPerLine / 4);
+    auto getBakedMatrix = [&](size_t frame, size_t bone)
+    {
+        size_t texel = frame * numMatrices * 3;
+        float rows[12];
+        for (size_t r = 0; r < 3; r++)
+        {
+            ColourValue c = baked.getColourAt(texel % pixelsPerLine + bone * 3 + r, texel / pixelsPerLine, 0);
+            std::copy(c.ptr(), c.ptr() + 4, rows + r * 4);
+        }
+        return Matrix3x4f(rows);
+    };
+
+    // the bone matrices the instance uploads when not baked
+    const Mesh::IndexMap& indexMap = *batch._getIndexToBoneMap();
+    std::vector<Matrix3x4f> expected(numMatrices);
+    auto getPosedMatrices = [&]()
+    {
+        for (size_t b = 0; b < numMatrices; b++)
+        {
+            Affine3 m;
+            instance.getSkeleton()->getBone(indexMap[b])->_getOffsetTransform(m);
+            expected[b] = Matrix3x4f(m[0]);
+        }
+    };
+
+    size_t frames[2];
+    float weight;
+
+    // no enabled animation shows the binding pose
+    batch.getBakedAnimationFrames(&instance, frames, weight);
+    EXPECT_EQ(frames[0], 0u);
+    EXPECT_EQ(frames[1], 0u);
+    Matrix3x4f bindPose = getBakedMatrix(0, 0);
+    for (int k = 0; k < 12; k++)
+        EXPECT_EQ(bindPose[0][k], Affine3::IDENTITY[0][k]);
+
+    AnimationState* walk = instance.getAnimationState("Walk");
+    walk->setEnabled(true);
+
+    // every sampled frame matches the skeleton posed by the instance
+    size_t firstFrame = 0;
+    for (size_t i = 0; i < walk->getLength() * 8; i++)
+    {
+        walk->setTimePosition(i / 8.0f);
+        instance._updateAnimation();
+        getPosedMatrices();
+
+        batch.getBakedAnimationFrames(&instance, frames, weight);
+        if (i == 0)
+            firstFrame = frames[0];
+        ASSERT_EQ(frames[0], firstFrame + i);
+        EXPECT_EQ(weight, 0);
+
+        for (size_t b = 0; b < numMatrices; b++)
+        {
+            Matrix3x4f m = getBakedMatrix(frames[0], b);
+            for (int k = 0; k < 12; k++)
+                EXPECT_NEAR(m[0][k], expected[b][0][k], 1e-4f);
+        }
+    }
+    EXPECT_GT(firstFrame, 0u);
+
+    // in between, the interpolated frames come closer than the frame before
+    walk->setTimePosition(3.5f / 8);
+    instance._updateAnimation();
+    getPosedMatrices();
+    batch.getBakedAnimationFrames(&instance, frames, weight);
+    EXPECT_EQ(frames[0], firstFrame + 3);
+    EXPECT_EQ(frames[1], firstFrame + 4);
+    EXPECT_EQ(weight, 0.5f);
+
+    float lerpError = 0, frameError = 0;
+    for (size_t b = 0; b < numMatrices; b++)
+    {
+        Matrix3x4f m0 = getBakedMatrix(frames[0], b), m1 = getBakedMatrix(frames[1], b);
+        for (int k = 0; k < 12; k++)
+        {
+            float lerp = m0[0][k] + (m1[0][k] - m0[0][k]) * weight;
+            lerpError += std::abs(lerp - expected[b][0][k]);
+            frameError += std::abs(m0[0][k] - expected[b][0][k]);
+        }
+    }
+    EXPECT_GT(frameError, 0);
+    EXPECT_LT(lerpError, frameError);
+}
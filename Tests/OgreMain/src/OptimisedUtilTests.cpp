@@ -0,0 +1,354 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+
+#include "OgreOptimisedUtil.h"
+#include "OgrePlane.h"
+#include "OgreTimer.h"
+
+#include <random>
+
+using namespace Ogre;
+
+namespace
+{
+// every implementation is checked against the portable one, which comes first
+struct OptimisedUtilTests : public ::testing::Test
+{
+    OptimisedUtil::ImplementationList impls;
+    std::minstd_rand rng;
+
+    void SetUp() override
+    {
+        impls = OptimisedUtil::getAvailableImplementations();
+        ASSERT_FALSE(impls.empty());
+        ASSERT_EQ(impls[0].first, "General");
+    }
+
+    float random(float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); }
+
+    std::vector<float> randomFloats(size_t count, float lo = -100, float hi = 100)
+    {
+        std::vector<float> ret(count);
+        for (auto& f : ret)
+            f = random(lo, hi);
+        return ret;
+    }
+
+    Affine3 randomAffine()
+    {
+        Quaternion q(random(-1, 1), random(-1, 1), random(-1, 1), random(-1, 1));
+        q.normalise();
+        return Affine3(Vector3(random(-50, 50), random(-50, 50), random(-50, 50)), q,
+                       Vector3(random(0.5, 2)));
+    }
+};
+
+void expectNear(const std::vector<float>& expected, const std::vector<float>& actual, const String& impl,
+                float tolerance = 1e-3f)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        // relative for large values
+        float tol = tolerance * std::max(1.0f, std::abs(expected[i]));
+        ASSERT_NEAR(expected[i], actual[i], tol) << impl << " at " << i;
+    }
+}
+
+/// interleaved position and normal with padding, as in a shared vertex buffer
+const size_t SKIN_VERTEX_FLOATS = 8;
+const size_t NUM_VERTICES = 1027;
+} // namespace
+
+TEST_F(OptimisedUtilTests, SoftwareVertexSkinning)
+{
+    std::vector<Affine3> matrices(32);
+    for (auto& m : matrices)
+        m = randomAffine();
+    std::vector<const Affine3*> matrixPtrs;
+    for (auto& m : matrices)
+        matrixPtrs.push_back(&m);
+
+    auto src = randomFloats(NUM_VERTICES * SKIN_VERTEX_FLOATS);
+    std::vector<unsigned char> indices(NUM_VERTICES * 4);
+    for (auto& i : indices)
+        i = rng() % matrices.size();
+
+    for (size_t numWeights = 1; numWeights <= 4; numWeights++)
+    {
+        std::vector<float> weights(NUM_VERTICES * 4, 0);
+        for (size_t v = 0; v < NUM_VERTICES; v++)
+        {
+            // weights must be normalised, and the first one is never zero
+            float sum = 0;
+            for (size_t w = 0; w < numWeights; w++)
+                sum += weights[v * 4 + w] = w == 0 || (v + w) % 7 ? random(0.1f, 1) : 0;
+            for (size_t w = 0; w < numWeights; w++)
+                weights[v * 4 + w] /= sum;
+        }
+
+        for (bool normals : {false, true})
+        {
+            // shared buffers, and separate packed ones with positions only
+            size_t srcStride = normals ? SKIN_VERTEX_FLOATS : 3;
+            std::vector<float> packed(NUM_VERTICES * 3);
+            for (size_t v = 0; v < NUM_VERTICES; v++)
+                std::copy_n(&src[v * SKIN_VERTEX_FLOATS], 3, &packed[v * 3]);
+            const float* srcPos = normals ? src.data() : packed.data();
+
+            std::vector<float> expected;
+            for (const auto& impl : impls)
+            {
+                std::vector<float> dst(NUM_VERTICES * srcStride, 0);
+                impl.second->softwareVertexSkinning(
+                    srcPos, dst.data(), normals ? srcPos + 3 : NULL, normals ? dst.data() + 3 : NULL,
+                    weights.data(), indices.data(), matrixPtrs.data(), srcStride * sizeof(float),
+                    srcStride * sizeof(float), srcStride * sizeof(float), srcStride * sizeof(float),
+                    4 * sizeof(float), 4, numWeights, NUM_VERTICES);
+                if (expected.empty())
+                    expected = dst;
+                else
+                    expectNear(expected, dst, impl.first);
+            }
+        }
+    }
+}
+
+TEST_F(OptimisedUtilTests, SoftwareVertexMorph)
+{
+    auto src1 = randomFloats(NUM_VERTICES * 8);
+    auto src2 = randomFloats(NUM_VERTICES * 8);
+
+    // packed positions and positions with normals, the only layouts the SIMD versions take
+    const size_t layouts[][4] = {{3, 3, 3, 0}, {6, 6, 6, 1}};
+    for (const auto& l : layouts)
+    {
+        std::vector<float> expected;
+        for (const auto& impl : impls)
+        {
+            std::vector<float> dst(NUM_VERTICES * l[2], 0);
+            impl.second->softwareVertexMorph(0.3f, src1.data(), src2.data(), dst.data(), l[0] * sizeof(float),
+                                             l[1] * sizeof(float), l[2] * sizeof(float), NUM_VERTICES, l[3]);
+            if (expected.empty())
+                expected = dst;
+            else
+                expectNear(expected, dst, impl.first);
+        }
+    }
+}
+
+TEST_F(OptimisedUtilTests, ConcatenateAffineMatrices)
+{
+    Affine3 base = randomAffine();
+    std::vector<Affine3> src(67);
+    for (auto& m : src)
+        m = randomAffine();
+
+    std::vector<float> expected;
+    for (const auto& impl : impls)
+    {
+        std::vector<Affine3> dst(src.size(), Affine3::ZERO);
+        impl.second->concatenateAffineMatrices(base, src.data(), dst.data(), dst.size());
+
+        std::vector<float> values(dst[0][0], dst[0][0] + dst.size() * 12);
+        if (expected.empty())
+        {
+            expected = values;
+            EXPECT_EQ(dst[5], base * src[5]);
+        }
+        else
+            expectNear(expected, values, impl.first);
+    }
+}
+
+TEST_F(OptimisedUtilTests, CalculateFaceNormals)
+{
+    // the normals are not normalised, so keep them small enough for a fixed tolerance
+    auto positions = randomFloats(NUM_VERTICES * 3, -1, 1);
+    std::vector<EdgeData::Triangle> triangles(1001);
+    for (auto& t : triangles)
+    {
+        for (auto& i : t.vertIndex)
+            i = rng() % NUM_VERTICES;
+    }
+
+    std::vector<float> expected;
+    for (const auto& impl : impls)
+    {
+        std::vector<Vector4> normals(triangles.size(), Vector4::ZERO);
+        impl.second->calculateFaceNormals(positions.data(), triangles.data(), normals.data(), normals.size());
+
+        std::vector<float> values(normals[0].ptr(), normals[0].ptr() + normals.size() * 4);
+        if (expected.empty())
+            expected = values;
+        else
+            expectNear(expected, values, impl.first);
+    }
+}
+
+TEST_F(OptimisedUtilTests, CalculateLightFacing)
+{
+    std::vector<Vector4> normals(1001);
+    for (auto& n : normals)
+        n = Vector4(random(-1, 1), random(-1, 1), random(-1, 1), random(-100, 100));
+
+    for (const auto& lightPos : {Vector4(10, 20, -30, 1), Vector4(0.3f, -0.5f, 0.2f, 0)})
+    {
+        std::vector<char> expected;
+        for (const auto& impl : impls)
+        {
+            std::vector<char> facing(normals.size(), 2);
+            impl.second->calculateLightFacing(lightPos, normals.data(), facing.data(), facing.size());
+            if (expected.empty())
+            {
+                expected = facing;
+                continue;
+            }
+
+            for (size_t i = 0; i < normals.size(); i++)
+            {
+                // the sign of a dot product close to zero depends on the rounding
+                if (std::abs(lightPos.dotProduct(normals[i])) > 1e-3f)
+                {
+                    ASSERT_EQ(expected[i], facing[i]) << impl.first << " at " << i;
+                }
+            }
+        }
+        EXPECT_NE(std::count(expected.begin(), expected.end(), 1), 0);
+        EXPECT_NE(std::count(expected.begin(), expected.end(), 0), 0);
+    }
+}
+
+TEST_F(OptimisedUtilTests, ExtrudeVertices)
+{
+    auto src = randomFloats(NUM_VERTICES * 3);
+    for (const auto& lightPos : {Vector4(10, 20, -30, 1), Vector4(0.3f, -0.5f, 0.2f, 0)})
+    {
+        std::vector<float> expected;
+        for (const auto& impl : impls)
+        {
+            std::vector<float> dst(src.size(), 0);
+            impl.second->extrudeVertices(lightPos, 10, src.data(), dst.data(), NUM_VERTICES);
+            if (expected.empty())
+                expected = dst;
+            else
+                expectNear(expected, dst, impl.first, 5e-3f); // SSE uses an approximate rsqrt
+        }
+    }
+}
+
+TEST_F(OptimisedUtilTests, CullSpheres)
+{
+    // all planes face the origin, so some of the spheres around it are visible
+    std::vector<Plane> planes;
+    for (int i = 0; i < 6; i++)
+        planes.emplace_back(Vector3(random(-1, 1), random(-1, 1), random(-1, 1)).normalisedCopy(), -random(50, 200));
+
+    size_t count = 1003;
+    auto x = randomFloats(count, -300, 300), y = randomFloats(count, -300, 300), z = randomFloats(count, -300, 300);
+    auto r = randomFloats(count, 0, 50);
+    r[7] = -std::numeric_limits<float>::infinity(); // never visible
+
+    for (size_t numPlanes : {1, 6})
+    {
+        std::vector<uint32> expected;
+        for (size_t i = 0; i < count; i++)
+        {
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes; p++)
+                visible &= planes[p].getDistance(Vector3(x[i], y[i], z[i])) >= -r[i];
+            if (visible)
+                expected.push_back(uint32(i));
+        }
+        ASSERT_FALSE(expected.empty());
+        ASSERT_LT(expected.size(), count - 1);
+
+        for (const auto& impl : impls)
+        {
+            std::vector<uint32> visible(count);
+            visible.resize(impl.second->cullSpheres(planes.data(), numPlanes, x.data(), y.data(), z.data(),
+                                                     r.data(), visible.data(), count));
+            EXPECT_EQ(visible, expected) << impl.first;
+        }
+    }
+}
+
+TEST_F(OptimisedUtilTests, DISABLED_Benchmark)
+{
+    const size_t numVertices = 100000;
+    std::vector<Affine3> matrices(64);
+    for (auto& m : matrices)
+        m = randomAffine();
+    std::vector<const Affine3*> matrixPtrs;
+    for (auto& m : matrices)
+        matrixPtrs.push_back(&m);
+
+    auto src = randomFloats(numVertices * SKIN_VERTEX_FLOATS);
+    std::vector<float> dst(src.size());
+    auto weights = randomFloats(numVertices * 4, 0, 0.5f);
+    std::vector<unsigned char> indices(numVertices * 4);
+    for (auto& i : indices)
+        i = rng() % matrices.size();
+
+    auto positions = randomFloats(numVertices * 3);
+    std::vector<float> extruded(positions.size());
+    std::vector<EdgeData::Triangle> triangles(numVertices * 2);
+    for (auto& t : triangles)
+    {
+        for (auto& i : t.vertIndex)
+            i = rng() % numVertices;
+    }
+    std::vector<Vector4> normals(triangles.size());
+    std::vector<char> facing(triangles.size());
+    Vector4 lightPos(10, 20, 30, 1);
+
+    for (const auto& impl : impls)
+    {
+        Timer timer;
+        for (int i = 0; i < 10; i++)
+            impl.second->softwareVertexSkinning(src.data(), dst.data(), src.data() + 3, dst.data() + 3,
+                                                weights.data(), indices.data(), matrixPtrs.data(),
+                                                SKIN_VERTEX_FLOATS * sizeof(float), SKIN_VERTEX_FLOATS * sizeof(float),
+                                                SKIN_VERTEX_FLOATS * sizeof(float), SKIN_VERTEX_FLOATS * sizeof(float),
+                                                4 * sizeof(float), 4, 4, numVertices);
+        auto skinning = timer.getMicroseconds();
+
+        timer.reset();
+        for (int i = 0; i < 10; i++)
+        {
+            impl.second->calculateFaceNormals(positions.data(), triangles.data(), normals.data(), normals.size());
+            impl.second->calculateLightFacing(lightPos, normals.data(), facing.data(), facing.size());
+            impl.second->extrudeVertices(lightPos, 1000, positions.data(), extruded.data(), numVertices);
+        }
+        auto shadows = timer.getMicroseconds();
+
+        printf("%-8s skinning %.1f ms, shadow volumes %.1f ms\n", impl.first.c_str(), skinning / 10000.0,
+               shadows / 10000.0);
+    }
+}
@@ -8,8 +8,15 @@
 
 #include <OgrePlugin.h>
 #include <OgreConfigFile.h>
+#include <OgreControllerManager.h>
 #include <OgreEntity.h>
 #include <OgreSubEntity.h>
+#include <OgreParticleSystem.h>
+#include <OgreParticleAffector.h>
+#include <OgreParticleEmitter.h>
+#include <OgreParticleSystemManager.h>
+#include <OgreSceneManager.h>
+#include <OgreWorkQueue.h>
 
 #include "RootWithoutRenderSystemFixture.h"
 
@@ -68,4 +75,192 @@ TEST_F(DotSceneTests, exportImport)
     FileSystemLayer::removeFile("DotSceneTest.scene");
 
     mRoot->getInstalledPlugins().front()->shutdown();
-}
\ No newline at end of file
+}
+
+struct ParticleFXTests : public RootWithoutRenderSystemFixture
+{
+    std::unique_ptr<ControllerManager> mControllerMgr;
+
+    void SetUp() override
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+
+        String pluginsCfg = mFSLayer->getConfigFilePath("plugins.cfg");
+        ConfigFile cf;
+        cf.load(pluginsCfg);
+
+        auto pluginDir = cf.getSetting("PluginFolder");
+
+        try
+        {
+            mRoot->loadPlugin(pluginDir+"/Plugin_ParticleFX");
+        }
+        catch (const std::exception& e)
+        {
+            GTEST_SKIP() << "Plugin_ParticleFX not found";
+        }
+        // what Root::initialise sets up for particle systems
+        mControllerMgr.reset(new ControllerManager());
+        ParticleSystemManager::getSingleton()._initialise();
+    }
+};
+
+TEST_F(ParticleFXTests, affectParticleData)
+{
+    auto sceneMgr = mRoot->createSceneManager();
+    // not a multiple of ParticleData::BATCH_SIZE
+    const size_t count = 37;
+    auto psys = sceneMgr->createParticleSystem("Particles", count);
+    sceneMgr->getRootSceneNode()->attachObject(psys);
+    // allocates the particles
+    psys->_update(0);
+
+    std::vector<Particle*> particles;
+    std::vector<Particle> initial;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Particle* p = psys->createParticle();
+        ASSERT_TRUE(p);
+        p->mPosition = Vector3(Math::RangeRandom(-10, 10), Math::RangeRandom(-10, 10), Math::RangeRandom(-10, 10));
+        p->mDirection = Vector3(Math::RangeRandom(-10, 10), Math::RangeRandom(-10, 10), Math::RangeRandom(-10, 10));
+        p->setDimensions(Math::RangeRandom(0, 2), Math::RangeRandom(0, 2));
+        p->mRotation = Radian(Math::RangeRandom(-Math::PI, Math::PI));
+        p->mRotationSpeed = Radian(Math::RangeRandom(-1, 1));
+        p->mTotalTimeToLive = 5;
+        p->mTimeToLive = Math::RangeRandom(0, 5);
+        p->mColour = ColourValue(Math::UnitRandom(), Math::UnitRandom(), Math::UnitRandom(), Math::UnitRandom()).getAsBYTE();
+        particles.push_back(p);
+        initial.push_back(*p);
+    }
+
+    std::vector<ParticleAffector*> affectors = {
+        psys->addAffector("LinearForce"), psys->addAffector("LinearForce"), psys->addAffector("ColourFader"),
+        psys->addAffector("ColourFader2"), psys->addAffector("Scaler"), psys->addAffector("Rotator")};
+    affectors[0]->setParameter("force_vector", "1 -2 3");
+    affectors[1]->setParameter("force_vector", "4 5 -6");
+    affectors[1]->setParameter("force_application", "average");
+    affectors[2]->setParameter("red", "-0.5");
+    affectors[2]->setParameter("green", "0.25");
+    affectors[2]->setParameter("alpha", "-1");
+    affectors[3]->setParameter("red1", "0.5");
+    affectors[3]->setParameter("blue2", "-0.75");
+    affectors[3]->setParameter("alpha2", "2");
+    affectors[3]->setParameter("state_change", "2.5");
+    affectors[4]->setParameter("rate", "-3");
+
+    // the same arrays ParticleSystem fills for the affectors
+    const size_t padded = 40;
+    aligned_vector<Real> reals(padded * 12);
+    aligned_vector<RGBA> colours(padded);
+    ParticleData data;
+    data.count = count;
+    data.paddedCount = padded;
+    Real** arrays[] = {&data.positionX, &data.positionY, &data.positionZ, &data.directionX,
+                       &data.directionY, &data.directionZ, &data.width, &data.height,
+                       &data.rotation, &data.rotationSpeed, &data.timeToLive, &data.totalTimeToLive};
+    for (size_t a = 0; a < 12; ++a)
+        *arrays[a] = reals.data() + a * padded;
+    data.colour = colours.data();
+
+    const Real timeElapsed = 0.1;
+    for (auto affector : affectors)
+    {
+        ASSERT_TRUE(affector->_supportsParticleData()) << affector->getType();
+
+        for (size_t i = 0; i < count; ++i)
+            *particles[i] = initial[i];
+        affector->_affectParticles(psys, timeElapsed);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Particle& p = initial[i];
+            data.positionX[i] = p.mPosition.x;
+            data.positionY[i] = p.mPosition.y;
+            data.positionZ[i] = p.mPosition.z;
+            data.directionX[i] = p.mDirection.x;
+            data.directionY[i] = p.mDirection.y;
+            data.directionZ[i] = p.mDirection.z;
+            data.width[i] = p.mWidth;
+            data.height[i] = p.mHeight;
+            data.rotation[i] = p.mRotation.valueRadians();
+            data.rotationSpeed[i] = p.mRotationSpeed.valueRadians();
+            data.timeToLive[i] = p.mTimeToLive;
+            data.totalTimeToLive[i] = p.mTotalTimeToLive;
+            data.colour[i] = p.mColour;
+        }
+        affector->_affectParticleData(data, timeElapsed);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Particle& p = *particles[i];
+            EXPECT_FLOAT_EQ(data.positionX[i], p.mPosition.x) << affector->getType();
+            EXPECT_FLOAT_EQ(data.positionY[i], p.mPosition.y) << affector->getType();
+            EXPECT_FLOAT_EQ(data.positionZ[i], p.mPosition.z) << affector->getType();
+            EXPECT_FLOAT_EQ(data.directionX[i], p.mDirection.x) << affector->getType();
+            EXPECT_FLOAT_EQ(data.directionY[i], p.mDirection.y) << affector->getType();
+            EXPECT_FLOAT_EQ(data.directionZ[i], p.mDirection.z) << affector->getType();
+            EXPECT_FLOAT_EQ(data.width[i], p.mWidth) << affector->getType();
+            EXPECT_FLOAT_EQ(data.height[i], p.mHeight) << affector->getType();
+            EXPECT_FLOAT_EQ(data.rotation[i], p.mRotation.valueRadians()) << affector->getType();
+            EXPECT_EQ(data.colour[i], p.mColour) << affector->getType();
+        }
+    }
+
+    sceneMgr->destroyParticleSystem(psys);
+}
+
+TEST_F(ParticleFXTests, parallelUpdate)
+{
+    auto sceneMgr = mRoot->createSceneManager();
+    auto& particleMgr = ParticleSystemManager::getSingleton();
+
+    auto simulate = [&](bool parallel)
+    {
+        particleMgr.setParallelUpdateEnabled(parallel);
+
+        std::vector<ParticleSystem*> systems;
+        for (int i = 0; i < 4; ++i)
+        {
+            auto psys = sceneMgr->createParticleSystem("Particles" + std::to_string(i), 200);
+            psys->setRandomSeed(i + 1);
+            auto emitter = psys->addEmitter("Point");
+            emitter->setEmissionRate(100);
+            emitter->setAngle(Degree(30));
+            emitter->setTimeToLive(0.5, 2);
+            emitter->setParticleVelocity(1, 5);
+            // one affector drawing random values, one working on the particle arrays
+            psys->addAffector("DirectionRandomiser")->setParameter("randomness", "10");
+            psys->addAffector("LinearForce")->setParameter("force_vector", "0 -10 0");
+            sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(i, 0, 0))->attachObject(psys);
+            systems.push_back(psys);
+        }
+
+        for (int frame = 0; frame < 30; ++frame)
+            particleMgr._updateSystems(0.05);
+
+        std::vector<Particle> particles;
+        for (auto psys : systems)
+        {
+            for (auto p : psys->_getActiveParticles())
+                particles.push_back(*p);
+            sceneMgr->destroyParticleSystem(psys);
+        }
+        return particles;
+    };
+
+    auto serial = simulate(false);
+    mRoot->getWorkQueue()->startup();
+    auto parallel = simulate(true);
+    mRoot->getWorkQueue()->shutdown();
+    particleMgr.setParallelUpdateEnabled(false);
+
+    ASSERT_FALSE(serial.empty());
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        EXPECT_EQ(serial[i].mPosition, parallel[i].mPosition);
+        EXPECT_EQ(serial[i].mDirection, parallel[i].mDirection);
+        EXPECT_EQ(serial[i].mTimeToLive, parallel[i].mTimeToLive);
+        EXPECT_EQ(serial[i].mColour, parallel[i].mColour);
+    }
+}
@@ -0,0 +1,386 @@
+// This file is part of the OGRE project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at https://www.ogre3d.org/licensing.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreEntity.h"
+#include "OgreCamera.h"
+#include "OgreLight.h"
+#include "OgreViewport.h"
+#include "OgreRenderWindow.h"
+#include "OgreRenderTexture.h"
+#include "OgreTextureManager.h"
+#include "OgreHardwarePixelBuffer.h"
+#include "OgreImage.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreRenderObjectListener.h"
+#include "OgreAutoParamDataSource.h"
+#include "OgreShadowCameraSetupPSSM.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreConfigFile.h"
+
+using namespace Ogre;
+
+namespace
+{
+/// Render targets in system memory, so the shadow texture passes run without a GPU
+class HeadlessRenderTexture : public RenderTexture
+{
+public:
+    HeadlessRenderTexture(const String& name, HardwarePixelBuffer* buffer) : RenderTexture(buffer, 0)
+    {
+        mName = name;
+    }
+    bool requiresTextureFlipping() const override { return false; }
+};
+
+class HeadlessPixelBuffer : public HardwarePixelBuffer
+{
+    Image mData;
+public:
+    HeadlessPixelBuffer(const String& parentName, uint32 width, uint32 height, PixelFormat format, int usage)
+        : HardwarePixelBuffer(width, height, 1, format, Usage(usage), false), mData(format, width, height)
+    {
+        if (usage & TU_RENDERTARGET)
+        {
+            mSliceTRT.push_back(new HeadlessRenderTexture(getNameForRenderTexture(parentName), this));
+            Root::getSingleton().getRenderSystem()->attachRenderTarget(*mSliceTRT.back());
+        }
+    }
+    PixelBox lockImpl(const Box& lockBox, LockOptions) override { return mData.getPixelBox().getSubVolume(lockBox); }
+    void unlockImpl() override {}
+    void blitFromMemory(const PixelBox& src, const Box& dstBox) override
+    {
+        PixelUtil::bulkPixelConversion(src, mData.getPixelBox().getSubVolume(dstBox));
+    }
+    void blitToMemory(const Box& srcBox, const PixelBox& dst) override
+    {
+        PixelUtil::bulkPixelConversion(mData.getPixelBox().getSubVolume(srcBox), dst);
+    }
+};
+
+class HeadlessTexture : public Texture
+{
+public:
+    HeadlessTexture(ResourceManager* creator, const String& name, ResourceHandle handle, const String& group)
+        : Texture(creator, name, handle, group)
+    {
+    }
+    ~HeadlessTexture() { unload(); }
+
+protected:
+    void createInternalResourcesImpl() override
+    {
+        mNumMipmaps = 0;
+        mSurfaceList.push_back(std::make_shared<HeadlessPixelBuffer>(mName, mWidth, mHeight, mFormat, mUsage));
+    }
+    void freeInternalResourcesImpl() override { mSurfaceList.clear(); }
+    void loadImpl() override {}
+};
+
+class HeadlessTextureManager : public TextureManager
+{
+    Resource* createImpl(const String& name, ResourceHandle handle, const String& group, bool,
+                         ManualResourceLoader*, const NameValuePairList*) override
+    {
+        return new HeadlessTexture(this, name, handle, group);
+    }
+
+public:
+    HeadlessTextureManager() { ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this); }
+    ~HeadlessTextureManager() { ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType); }
+    PixelFormat getNativeFormat(TextureType, PixelFormat format, int) override { return format; }
+};
+
+class HeadlessWindow : public RenderWindow
+{
+public:
+    void create(const String& name, unsigned int width, unsigned int height, bool fullScreen,
+                const NameValuePairList*) override
+    {
+        mName = name;
+        mWidth = width;
+        mHeight = height;
+        mIsFullScreen = fullScreen;
+        mActive = true;
+    }
+    void destroy() override {}
+#if OGRE_PLATFORM == OGRE_PLATFORM_ANDROID || OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+    void _notifySurfaceDestroyed() override {}
+    void _notifySurfaceCreated(void*, void*) override {}
+#endif
+    void copyContentsToMemory(const Box&, const PixelBox&, FrameBuffer) override {}
+    bool requiresTextureFlipping() const override { return false; }
+};
+
+/// Goes through the whole frame, including render to texture, but does not draw anything
+class HeadlessRenderSystem : public RenderSystem
+{
+    std::unique_ptr<HardwareBufferManager> mHardwareBufferManager;
+
+public:
+    ~HeadlessRenderSystem() { shutdown(); }
+
+    const String& getName() const override
+    {
+        static String name("Headless Rendering Subsystem");
+        return name;
+    }
+    RenderSystemCapabilities* createRenderSystemCapabilities() const override
+    {
+        auto rsc = new RenderSystemCapabilities();
+        rsc->setRenderSystemName(getName());
+        rsc->setNumTextureUnits(8);
+        rsc->setCapability(RSC_FIXED_FUNCTION);
+        rsc->setCapability(RSC_HWRENDER_TO_TEXTURE);
+        rsc->setCapability(RSC_NON_POWER_OF_2_TEXTURES);
+        rsc->setCapability(RSC_TEXTURE_FLOAT);
+        rsc->setCapability(RSC_DEPTH_CLAMP);
+        rsc->setCapability(RSC_32BIT_INDEX);
+        return rsc;
+    }
+    void initialiseFromRenderSystemCapabilities(RenderSystemCapabilities*, RenderTarget*) override
+    {
+        mHardwareBufferManager.reset(new DefaultHardwareBufferManager());
+        mTextureManager = new HeadlessTextureManager();
+    }
+    void shutdown() override
+    {
+        RenderSystem::shutdown();
+        delete mTextureManager;
+        mTextureManager = NULL;
+        mHardwareBufferManager.reset();
+    }
+    RenderWindow* _createRenderWindow(const String& name, unsigned int width, unsigned int height,
+                                      bool fullScreen, const NameValuePairList* miscParams) override
+    {
+        RenderSystem::_createRenderWindow(name, width, height, fullScreen, miscParams);
+
+        RenderWindow* win = new HeadlessWindow();
+        win->create(name, width, height, fullScreen, miscParams);
+        attachRenderTarget(*win);
+
+        if (!mRealCapabilities)
+        {
+            mRealCapabilities = createRenderSystemCapabilities();
+            mCurrentCapabilities = mRealCapabilities;
+            initialiseFromRenderSystemCapabilities(mCurrentCapabilities, win);
+        }
+        return win;
+    }
+
+    void setConfigOption(const String&, const String&) override {}
+    HardwareOcclusionQuery* createHardwareOcclusionQuery() override { return NULL; }
+    MultiRenderTarget* createMultiRenderTarget(const String&) override { return NULL; }
+    DepthBuffer* _createDepthBufferFor(RenderTarget*) override { return NULL; }
+    void _setSampler(size_t, Sampler&) override {}
+    void _setTexture(size_t, bool, const TexturePtr&) override {}
+    void setColourBlendState(const ColourBlendState&) override {}
+    void _setAlphaRejectSettings(CompareFunction, unsigned char, bool) override {}
+    void _endFrame() override {}
+    void _setViewport(Viewport* vp) override { mActiveViewport = vp; }
+    void _setCullingMode(CullingMode) override {}
+    void _setDepthBufferParams(bool, bool, CompareFunction) override {}
+    void _setDepthBias(float, float) override {}
+    void _convertProjectionMatrix(const Matrix4& matrix, Matrix4& dest, bool) override { dest = matrix; }
+    void _setPolygonMode(PolygonMode) override {}
+    void setStencilState(const StencilState&) override {}
+    void bindGpuProgramParameters(GpuProgramType, const GpuProgramParametersPtr&, uint16) override {}
+    void setScissorTest(bool, const Rect&) override {}
+    void clearFrameBuffer(uint32, const ColourValue&, float, uint16) override {}
+    Real getMinimumDepthInputValue() override { return -1; }
+    Real getMaximumDepthInputValue() override { return 1; }
+    void _setRenderTarget(RenderTarget* target) override { mActiveRenderTarget = target; }
+    void beginProfileEvent(const String&) override {}
+    void endProfileEvent() override {}
+    void markProfileEvent(const String&) override {}
+};
+
+/// Collects the renderables drawn per camera
+struct RenderedObjects : public RenderObjectListener
+{
+    std::map<const Camera*, std::set<Renderable*>> rendered;
+    void notifyRenderSingleObject(Renderable* rend, const Pass*, const AutoParamDataSource* source,
+                                  const LightList*, bool) override
+    {
+        rendered[source->getCurrentCamera()].insert(rend);
+    }
+};
+}
+
+struct ShadowTextureTests : public ::testing::Test
+{
+    std::unique_ptr<FileSystemLayer> mFSLayer;
+    std::unique_ptr<Root> mRoot;
+    std::unique_ptr<HeadlessRenderSystem> mRenderSystem;
+    RenderWindow* mWindow;
+
+    void SetUp() override
+    {
+        mFSLayer.reset(new FileSystemLayer(OGRE_VERSION_NAME));
+        mRoot.reset(new Root(""));
+
+        // the shadow materials are in Media/Main
+        ConfigFile resources;
+        resources.load(mFSLayer->getConfigFilePath("resources.cfg"));
+        for (const auto& location : resources.getSettings(RGN_INTERNAL))
+            ResourceGroupManager::getSingleton().addResourceLocation(location.second, location.first, RGN_INTERNAL);
+
+        ConfigFile cf;
+        cf.load(mFSLayer->getConfigFilePath("plugins.cfg"));
+        try
+        {
+            mRoot->loadPlugin(cf.getSetting("PluginFolder") + "/Plugin_OctreeSceneManager");
+        }
+        catch (const std::exception&)
+        {
+            // only the generic SceneManager is tested then
+        }
+
+        mRenderSystem.reset(new HeadlessRenderSystem());
+        mRoot->setRenderSystem(mRenderSystem.get());
+        mRoot->initialise(false);
+        mWindow = mRoot->createRenderWindow("ShadowTextureTests", 64, 64, false);
+        ResourceGroupManager::getSingleton().initialiseResourceGroup(RGN_INTERNAL);
+    }
+    void TearDown() override
+    {
+        // the resources need the render system on shutdown, but Root must not use it afterwards
+        mRoot->shutdown();
+        mRoot->setRenderSystem(NULL);
+        mRenderSystem.reset();
+        mRoot.reset();
+    }
+
+    std::vector<String> getSceneManagerTypes() const
+    {
+        std::vector<String> types = {SMT_DEFAULT};
+        const auto& available = mRoot->getSceneManagerTypes();
+        if (std::find(available.begin(), available.end(), "OctreeSceneManager") != available.end())
+            types.push_back("OctreeSceneManager");
+        return types;
+    }
+
+    /// A grid of cubes lit by a PSSM sun and a spotlight, so every shadow texture sees other casters
+    SceneManager* createScene(const String& type)
+    {
+        SceneManager* sceneMgr = mRoot->createSceneManager(type);
+        sceneMgr->setShadowTechnique(SHADOWTYPE_TEXTURE_ADDITIVE_INTEGRATED);
+        sceneMgr->setShadowTextureSettings(64, 4);
+        sceneMgr->setShadowTextureCountPerLightType(Light::LT_DIRECTIONAL, 3);
+        sceneMgr->setShadowFarDistance(1000);
+
+        for (int x = -5; x <= 5; ++x)
+        {
+            for (int z = -5; z <= 5; ++z)
+            {
+                auto node = sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(x * 300, 0, z * 300));
+                node->attachObject(sceneMgr->createEntity(SceneManager::PT_CUBE));
+            }
+        }
+
+        Camera* camera = sceneMgr->createCamera("Camera");
+        camera->setNearClipDistance(1);
+        camera->setFarClipDistance(1000);
+        auto camNode = sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(0, 200, 600));
+        camNode->attachObject(camera);
+        camNode->lookAt(Vector3::ZERO, Node::TS_WORLD);
+        mWindow->removeAllViewports();
+        mWindow->addViewport(camera);
+
+        auto pssm = std::make_shared<PSSMShadowCameraSetup>();
+        pssm->calculateSplitPoints(3, camera->getNearClipDistance(), camera->getFarClipDistance());
+        Light* sun = sceneMgr->createLight(Light::LT_DIRECTIONAL);
+        sun->setCustomShadowCameraSetup(pssm);
+        auto sunNode = sceneMgr->getRootSceneNode()->createChildSceneNode();
+        sunNode->setDirection(Vector3(-1, -1, -1), Node::TS_WORLD);
+        sunNode->attachObject(sun);
+
+        Light* spot = sceneMgr->createLight(Light::LT_SPOTLIGHT);
+        spot->setSpotlightRange(Degree(30), Degree(40));
+        spot->setAttenuation(500, 1, 0, 0);
+        auto spotNode = sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(100, 300, 100));
+        spotNode->setDirection(Vector3::NEGATIVE_UNIT_Y, Node::TS_WORLD);
+        spotNode->attachObject(spot);
+
+        return sceneMgr;
+    }
+
+    std::map<const Camera*, std::set<Renderable*>> renderFrame(SceneManager* sceneMgr)
+    {
+        RenderedObjects listener;
+        sceneMgr->addRenderObjectListener(&listener);
+        mWindow->update();
+        sceneMgr->removeRenderObjectListener(&listener);
+        return listener.rendered;
+    }
+};
+
+TEST_F(ShadowTextureTests, ParallelCulling)
+{
+    for (const auto& type : getSceneManagerTypes())
+    {
+        SCOPED_TRACE(type);
+        SceneManager* sceneMgr = createScene(type);
+
+        sceneMgr->setShadowTextureParallelCulling(false);
+        auto serial = renderFrame(sceneMgr);
+        sceneMgr->setShadowTextureParallelCulling(true);
+        auto parallel = renderFrame(sceneMgr);
+
+        EXPECT_EQ(serial, parallel);
+
+        // three PSSM splits and the spotlight, each seeing a part of the casters
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const Camera* shadowCam =
+                sceneMgr->getShadowTexture(i)->getBuffer()->getRenderTarget()->getViewport(0)->getCamera();
+            ASSERT_TRUE(parallel.count(shadowCam)) << i;
+            EXPECT_FALSE(parallel[shadowCam].empty()) << i;
+            EXPECT_LT(parallel[shadowCam].size(), 121u) << i;
+        }
+
+        mWindow->removeAllViewports();
+        mRoot->destroySceneManager(sceneMgr);
+    }
+}
+
+TEST_F(ShadowTextureTests, Caching)
+{
+    SceneManager* sceneMgr = createScene(SMT_DEFAULT);
+    for (const auto& light : sceneMgr->getMovableObjects(MOT_LIGHT))
+        static_cast<Light*>(light.second)->setShadowTextureCaching(true);
+
+    // in the cone of the spotlight
+    SceneNode* caster = sceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(150, 0, 150));
+    caster->attachObject(sceneMgr->createEntity(SceneManager::PT_CUBE));
+
+    const Camera* camera = sceneMgr->getCamera("Camera");
+    auto shadowRenders = [&]() {
+        auto rendered = renderFrame(sceneMgr);
+        return rendered.size() - rendered.count(camera);
+    };
+
+    EXPECT_EQ(shadowRenders(), 4u);
+    // the PSSM cameras focus on what the main camera saw in the previous frame
+    renderFrame(sceneMgr);
+    // nothing changed, so all textures are kept
+    EXPECT_EQ(shadowRenders(), 0u);
+
+    // stays within the bounds of the scene, so the PSSM cameras do not change
+    caster->translate(Vector3(10, 0, 0));
+    EXPECT_GT(shadowRenders(), 0u);
+    EXPECT_EQ(shadowRenders(), 0u);
+
+    sceneMgr->invalidateShadowTextureCache();
+    EXPECT_EQ(shadowRenders(), 4u);
+    EXPECT_EQ(shadowRenders(), 0u);
+
+    mWindow->removeAllViewports();
+    mRoot->destroySceneManager(sceneMgr);
+}
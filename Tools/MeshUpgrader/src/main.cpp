@@ -54,6 +54,7 @@ void help(void)
 {
     cout <<
 R"HELP(Usage: OgreMeshUpgrader [opts] sourcefile [destfile]
+       OgreMeshUpgrader [opts] sourcedir [destdir]
 
   Upgrades or downgrades .mesh file versions.
 
@@ -76,9 +77,15 @@ R"HELP(Usage: OgreMeshUpgrader [opts] sourcefile [destfile]
 -V version     = Specify OGRE version format to write instead of latest
                  Options are: 1.10, 1.8, 1.7, 1.4, 1.0
 -log filename  = name of the log file (default: 'OgreMeshUpgrader.log')
+-lodmem mb     = Memory budget in MB for the meshes generating LOD levels
+                 at once when converting a directory (default: no limit)
 sourcefile     = name of file to convert
 destfile       = optional name of file to write to. If you don't
                  specify this OGRE overwrites the existing file.
+sourcedir      = convert all .mesh files in this directory. LOD
+                 levels are generated for several meshes in parallel
+destdir        = optional existing directory to write to. If you don't
+                 specify this OGRE overwrites the existing files.
 )HELP";
 }
 
@@ -101,6 +108,7 @@ struct UpgradeOptions {
     bool recalcBounds;
     MeshVersion targetVersion;
     String logFile;
+    size_t lodMemoryBudget;
 };
 
 UpgradeOptions parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
@@ -126,6 +134,7 @@ UpgradeOptions parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.usePercent = true;
     opts.recalcBounds = false;
     opts.targetVersion = MESH_VERSION_LATEST;
+    opts.lodMemoryBudget = 0;
 
     opts.generateEdgeLists = unOpts["-el"];
     opts.generateTangents = unOpts["-t"];
@@ -169,6 +178,11 @@ UpgradeOptions parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
         opts.usePercent = false;
     }
 
+    bi = binOpts.find("-lodmem");
+    if (!bi->second.empty()) {
+        opts.lodMemoryBudget = StringConverter::parseSizeT(bi->second) << 20;
+    }
+
     bi = binOpts.find("-E");
     if (!bi->second.empty()) {
         if (bi->second == "big") {
@@ -312,18 +326,15 @@ void printLodConfig(const LodConfig& lodConfig)
     }
 }
 
-void buildLod(UpgradeOptions& opts, MeshPtr& mesh)
+bool getLodConfig(const UpgradeOptions& opts, MeshPtr& mesh, MeshLodGenerator& gen, LodConfig& lodConfig)
 {
-    String response;
-
     // Prompt for LOD generation?
     bool genLod = (opts.numLods != 0 || opts.lodAutoconfigure);
     if (!genLod) {
-        return;
+        return false;
     }
 
     int numLod;
-    LodConfig lodConfig;
     lodConfig.mesh = mesh;
     lodConfig.strategy = DistanceLodBoxStrategy::getSingletonPtr();
 
@@ -348,12 +359,21 @@ void buildLod(UpgradeOptions& opts, MeshPtr& mesh)
     // ensure we use correct bounds
     recalcBounds(mesh.get());
 
-    MeshLodGenerator gen;
     if (opts.lodAutoconfigure) {
         // In this case we ignore other settings
         gen.getAutoconfig(mesh, lodConfig);
     }
     printLodConfig(lodConfig);
+    return true;
+}
+
+void buildLod(UpgradeOptions& opts, MeshPtr& mesh)
+{
+    MeshLodGenerator gen;
+    LodConfig lodConfig;
+    if (!getLodConfig(opts, mesh, gen, lodConfig)) {
+        return;
+    }
 
     LogManager::getSingleton().logMessage("Generating LOD levels...");
     gen.generateLodLevels(lodConfig);
@@ -408,6 +428,102 @@ void resolveColourAmbiguities(Mesh* mesh)
     }
 }
 
+MeshPtr loadMesh(MeshSerializer& meshSerializer, const String& source, const String& name)
+{
+    struct stat tagStat;
+
+    FILE* pFile = fopen( source.c_str(), "rb" );
+    if (!pFile) {
+        OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+            "File " + source + " not found.", "OgreMeshUpgrader");
+    }
+    stat( source.c_str(), &tagStat );
+    MemoryDataStream* memstream = new MemoryDataStream(source, tagStat.st_size, true);
+    size_t result = fread( (void*)memstream->getPtr(), 1, tagStat.st_size, pFile );
+    if (result != size_t(tagStat.st_size))
+        OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+            "Unexpected error while reading file " + source, "OgreMeshUpgrader");
+    fclose( pFile );
+
+    MeshPtr meshPtr = MeshManager::getSingleton().createManual(name, RGN_DEFAULT);
+
+    DataStreamPtr stream(memstream);
+    meshSerializer.importMesh(stream, meshPtr.get());
+    return meshPtr;
+}
+
+/// everything that has to happen before the LOD levels are generated
+void prepareMesh(const UpgradeOptions& opts, Mesh* mesh)
+{
+    reorganiseVertexBuffers(opts, *mesh);
+
+    // Deal with VET_COLOUR ambiguities
+    resolveColourAmbiguities(mesh);
+}
+
+/// everything that has to happen after the LOD levels are generated
+void finishMesh(UpgradeOptions opts, Mesh* mesh)
+{
+    auto& logMgr = LogManager::getSingleton();
+
+    // Make sure we generate edge lists, provided they are not deliberately disabled
+    if (opts.generateEdgeLists) {
+        logMgr.logMessage("Generating edge lists...");
+        mesh->buildEdgeList();
+        logMgr.logMessage("Generating edge lists... success");
+    } else {
+        mesh->freeEdgeList();
+    }
+    // Generate tangents?
+    if (opts.generateTangents) {
+        unsigned short srcTex;
+        bool existing = mesh->suggestTangentVectorBuildParams(srcTex);
+        if (existing) {
+            // safe
+            opts.generateTangents = false;
+        }
+        if (opts.generateTangents) {
+            logMgr.logMessage("Generating tangent vectors...");
+            mesh->buildTangentVectors(srcTex, opts.tangentSplitMirrored, opts.tangentSplitRotated,
+                                      opts.tangentUseParity);
+            logMgr.logMessage("Generating tangent vectors... success");
+        }
+    }
+
+    if(opts.packNormalsTangents)
+    {
+        logMgr.logMessage("Pack normals and tangents into INT_10_10_10_2...");
+        mesh->_convertVertexElement(VES_NORMAL, VET_INT_10_10_10_2_NORM);
+        mesh->_convertVertexElement(VES_TANGENT, VET_INT_10_10_10_2_NORM);
+        logMgr.logMessage("Pack normals and tangents into INT_10_10_10_2... success");
+    }
+
+    if (opts.recalcBounds) {
+        recalcBounds(mesh);
+    }
+
+    if(opts.optimiseVertexCache)
+    {
+        logMgr.logMessage("Vertex cache optimization...");
+        VertexCacheProfiler vcp;
+        VertexCacheProfiler vcpnew;
+
+        for (auto s : mesh->getSubMeshes())
+        {
+            if(!s->indexData->indexBuffer)
+                continue;
+            vcp.profile(s->indexData->indexBuffer);
+            s->indexData->optimiseVertexCacheTriList();
+            vcpnew.profile(s->indexData->indexBuffer);
+            vcp.flush();
+            vcpnew.flush();
+        }
+
+        logMgr.logMessage(StringUtil::format("Vertex cache optimization: ACMR change %.2f -> %.2f",
+                                             vcp.getAvgCacheMissRatio(), vcpnew.getAvgCacheMissRatio()));
+    }
+}
+
 struct MeshResourceCreator : public MeshSerializerListener
 {
     void processMaterialName(Mesh *mesh, String *name) override
@@ -470,6 +586,7 @@ int main(int numargs, char** args)
         binOptList["-ts"] = "";
         binOptList["-V"] = "";
         binOptList["-log"] = "OgreMeshUpgrader.log";
+        binOptList["-lodmem"] = "";
 
         int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
 
@@ -506,104 +623,82 @@ int main(int numargs, char** args)
         // don't pad during upgrade
         MeshManager::getSingleton().setBoundsPaddingFactor(0.0f);
 
-        // Load the mesh
         struct stat tagStat;
-
-        FILE* pFile = fopen( source.c_str(), "rb" );
-        if (!pFile) {
-            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
-                "File " + source + " not found.", "OgreMeshUpgrader");
-        }
-        stat( source.c_str(), &tagStat );
-        MemoryDataStream* memstream = new MemoryDataStream(source, tagStat.st_size, true);
-        size_t result = fread( (void*)memstream->getPtr(), 1, tagStat.st_size, pFile );
-        if (result != size_t(tagStat.st_size))
-            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
-                "Unexpected error while reading file " + source, "OgreMeshUpgrader");
-        fclose( pFile );
-
-        MeshPtr meshPtr = MeshManager::getSingleton().createManual("TmpConversionMesh", RGN_DEFAULT);
-        Mesh* mesh = meshPtr.get();
-
-        DataStreamPtr stream(memstream);
-        meshSerializer.importMesh(stream, mesh);
-
-        // Write out the converted mesh
-        String dest;
-        if (numargs == startIdx + 2) {
-            dest = args[startIdx + 1];
-        } else {
-            dest = source;
-        }
-
-        String response;
-
-        reorganiseVertexBuffers(opts, *mesh);
-
-        // Deal with VET_COLOUR ambiguities
-        resolveColourAmbiguities(mesh);
-
-        buildLod(opts, meshPtr);
-
-        // Make sure we generate edge lists, provided they are not deliberately disabled
-        if (opts.generateEdgeLists) {
-            logMgr.logMessage("Generating edge lists...");
-            mesh->buildEdgeList();
-            logMgr.logMessage("Generating edge lists... success");
-        } else {
-            mesh->freeEdgeList();
-        }
-        // Generate tangents?
-        if (opts.generateTangents) {
-            unsigned short srcTex;
-            bool existing = mesh->suggestTangentVectorBuildParams(srcTex);
-            if (existing) {
-                // safe
-                opts.generateTangents = false;
+        if (stat(source.c_str(), &tagStat) == 0 && (tagStat.st_mode & S_IFDIR)) {
+            String srcDir = StringUtil::standardisePath(source);
+            String destDir = numargs == startIdx + 2 ? StringUtil::standardisePath(args[startIdx + 1]) : srcDir;
+
+            Archive* arch = ArchiveManager::getSingleton().load(srcDir, "FileSystem", true);
+            StringVectorPtr names = arch->find("*.mesh", false);
+            ArchiveManager::getSingleton().unload(arch);
+
+            auto writeMesh = [&](const MeshPtr& mesh, const String& name) {
+                logMgr.logMessage("Writing " + destDir + name + "...");
+                finishMesh(opts, mesh.get());
+                meshSerializer.exportMesh(mesh.get(), destDir + name, opts.targetVersion, opts.endian);
+                MeshManager::getSingleton().remove(mesh);
+            };
+
+            // Meshes are loaded when the LOD generation asks for them, and written and
+            // released as soon as they are done, so only a few are held at a time
+            MeshLodGenerator gen;
+            size_t nextName = 0;
+            StringVector lodNames;
+            auto nextMesh = [&](LodConfig& lodConfig) {
+                while (nextName < names->size()) {
+                    const String& name = (*names)[nextName++];
+                    logMgr.logMessage("Loading " + name + "...");
+                    MeshPtr mesh = loadMesh(meshSerializer, srcDir + name, "TmpConversionMesh/" + name);
+                    prepareMesh(opts, mesh.get());
+
+                    lodConfig = LodConfig();
+                    if (getLodConfig(opts, mesh, gen, lodConfig)) {
+                        lodNames.push_back(name);
+                        return true;
+                    }
+                    writeMesh(mesh, name);
+                }
+                return false;
+            };
+
+            if (opts.numLods != 0 || opts.lodAutoconfigure) {
+                // LOD generation runs on the work queue, one mesh per worker
+                WorkQueue* queue = root.getWorkQueue();
+                queue->setWorkerThreadCount(std::max(1, int(OGRE_THREAD_HARDWARE_CONCURRENCY)));
+                queue->startup();
+
+                logMgr.logMessage("Generating LOD levels for " + StringConverter::toString(names->size()) +
+                                  " meshes...");
+                gen.generateBatchLodLevels(
+                    nextMesh, [&](size_t index, LodConfig& lodConfig) { writeMesh(lodConfig.mesh, lodNames[index]); },
+                    opts.lodMemoryBudget);
+                queue->shutdown();
+                logMgr.logMessage("Generating LOD levels... success");
+            } else {
+                // converts every mesh, as none needs LOD levels
+                LodConfig lodConfig;
+                nextMesh(lodConfig);
             }
-            if (opts.generateTangents) {
-                logMgr.logMessage("Generating tangent vectors...");
-                mesh->buildTangentVectors(srcTex, opts.tangentSplitMirrored, opts.tangentSplitRotated,
-                                          opts.tangentUseParity);
-                logMgr.logMessage("Generating tangent vectors... success");
+        } else {
+            MeshPtr meshPtr = loadMesh(meshSerializer, source, "TmpConversionMesh");
+
+            // Write out the converted mesh
+            String dest;
+            if (numargs == startIdx + 2) {
+                dest = args[startIdx + 1];
+            } else {
+                dest = source;
             }
-        }
 
-        if(opts.packNormalsTangents)
-        {
-            logMgr.logMessage("Pack normals and tangents into INT_10_10_10_2...");
-            mesh->_convertVertexElement(VES_NORMAL, VET_INT_10_10_10_2_NORM);
-            mesh->_convertVertexElement(VES_TANGENT, VET_INT_10_10_10_2_NORM);
-            logMgr.logMessage("Pack normals and tangents into INT_10_10_10_2... success");
-        }
+            prepareMesh(opts, meshPtr.get());
 
-        if (opts.recalcBounds) {
-            recalcBounds(mesh);
-        }
+            buildLod(opts, meshPtr);
 
-        if(opts.optimiseVertexCache)
-        {
-            logMgr.logMessage("Vertex cache optimization...");
-            VertexCacheProfiler vcp;
-            VertexCacheProfiler vcpnew;
-
-            for (auto s : mesh->getSubMeshes())
-            {
-                if(!s->indexData->indexBuffer)
-                    continue;
-                vcp.profile(s->indexData->indexBuffer);
-                s->indexData->optimiseVertexCacheTriList();
-                vcpnew.profile(s->indexData->indexBuffer);
-                vcp.flush();
-                vcpnew.flush();
-            }
+            finishMesh(opts, meshPtr.get());
 
-            logMgr.logMessage(StringUtil::format("Vertex cache optimization: ACMR change %.2f -> %.2f",
-                                                 vcp.getAvgCacheMissRatio(), vcpnew.getAvgCacheMissRatio()));
+            meshSerializer.exportMesh(meshPtr.get(), dest, opts.targetVersion, opts.endian);
         }
 
-        meshSerializer.exportMesh(mesh, dest, opts.targetVersion, opts.endian);
-
         logMgr.setDefaultLog(NULL); // swallow shutdown messages
     }
     catch (Exception& e)